@@ -43,14 +43,30 @@
 double settings_version = 2.01;
 
 
+QElapsedTimer LASwaveMonitor::startupClock;
+
+
 LASwaveMonitor::LASwaveMonitor (int32_t *argc, char **argv, QWidget * parent):
   QMainWindow (parent, 0)
 {
   extern char     *optarg;
 
 
+  if (!startupClock.isValid ()) startupClock.start ();
+  startup_timing = NVFalse;
+  startup_reported = NVFalse;
+  startupMark (tr ("QApplication"));
+
+
   strcpy (progname, argv[0]);
+  echoView = NULL;
   filError = NULL;
+  laz = NULL;
+  wdc = NULL;
+  sharedCache = NULL;
+  recordRing = NULL;
+  ring_next_attach = 0;
+  failClock.start ();
   lock_track = NVFalse;
 
   endian = big_endian ();
@@ -70,24 +86,6 @@ LASwaveMonitor::LASwaveMonitor (int32_t *argc, char **argv, QWidget * parent):
   QResource::registerResource ("/icons.rcc");
 
 
-  //  Read the acknowledgments file for the Acknowledgments Help button.  This way I only have
-  //  to change one file and copy it to the other programs icon folders to change the Acknowledgments
-  //  Help text instead of changing it in every single program I use it in.
-
-  QFile *aDataFile = new QFile (":/icons/ACKNOWLEDGMENTS");
-
-  if (aDataFile->open (QIODevice::ReadOnly))
-    {
-      char string[256];
-
-      while (aDataFile->readLine (string, sizeof (string)) > 0)
-        {
-	  acknowledgmentsText.append (string);
-        }
-      aDataFile->close ();
-    }
-
-
   //  Have to set the focus policy or keypress events don't work properly at first in Focus Follows Mouse mode
 
   setFocusPolicy (Qt::WheelFocus);
@@ -99,6 +97,8 @@ LASwaveMonitor::LASwaveMonitor (int32_t *argc, char **argv, QWidget * parent):
 
 
   kill_switch = ANCILLARY_FORCE_EXIT;
+  tail_mode = NVFalse;
+  tail_wait = NVFalse;
 
   int32_t option_index = 0;
   while (NVTrue) 
@@ -109,6 +109,9 @@ LASwaveMonitor::LASwaveMonitor (int32_t *argc, char **argv, QWidget * parent):
                                              {"actionkey03", required_argument, 0, 0},
                                              {"shared_memory_key", required_argument, 0, 0},
                                              {"kill_switch", required_argument, 0, 0},
+                                             {"tail", no_argument, 0, 0},
+                                             {"timing", no_argument, 0, 0},
+                                             {"metrics", required_argument, 0, 0},
                                              {0, no_argument, 0, 0}};
 
       char c = (char) getopt_long (*argc, argv, "o", long_options, &option_index);
@@ -130,6 +133,18 @@ LASwaveMonitor::LASwaveMonitor (int32_t *argc, char **argv, QWidget * parent):
               sscanf (optarg, "%d", &kill_switch);
               break;
 
+            case 6:
+              tail_mode = NVTrue;
+              break;
+
+            case 7:
+              startup_timing = NVTrue;
+              break;
+
+            case 8:
+              metrics_path = QString (optarg);
+              break;
+
             default:
               char tmp;
               sscanf (optarg, "%1c", &tmp);
@@ -141,21 +156,12 @@ LASwaveMonitor::LASwaveMonitor (int32_t *argc, char **argv, QWidget * parent):
     }
 
 
-  //  This is the "tools" toolbar.  We have to do this here so that we can restore the toolbar location(s).
-
-  QToolBar *tools = addToolBar (tr ("Tools"));
-  tools->setObjectName (tr ("LASwaveMonitor main toolbar"));
-
-
-  envin ();
-
-
-  // Set the application font
+  startupMark (tr ("Options"));
 
-  QApplication::setFont (font);
 
+  //  The counters have to be turned on before any of the reading threads are started.
 
-  setWindowTitle (QString (VERSION));
+  if (!metrics_path.isEmpty ()) slas_metrics_enable ();
 
 
   /******************************************* IMPORTANT NOTE ABOUT SHARED MEMORY **************************************** \
@@ -195,6 +201,76 @@ LASwaveMonitor::LASwaveMonitor (int32_t *argc, char **argv, QWidget * parent):
 
   abe_share = (ABE_SHARE *) abeShare->data ();
 
+  startupMark (tr ("Shared memory attached"));
+
+
+  //  Attach to (or create) the decoded waveform cache that is shared by all of the waveform monitors on this machine.
+  //  If we can't, we just read everything ourselves.
+
+  sharedCache = slas_shared_cache_attach (SLAS_SHARED_CACHE_KEY, SLAS_SHARED_CACHE_DEFAULT_SIZE);
+
+
+  //  Serve the counters on a local socket (--metrics).
+
+  metrics = NULL;
+  metrics_pending = NVFalse;
+
+  if (!metrics_path.isEmpty ()) metrics = new metricsServer (this, metrics_path, key, sharedCache);
+
+
+  //  We were (almost certainly) started to look at the record that's in ABE_SHARE right now so we start reading it while
+  //  the window is being built (see startFirstRecord).
+
+  startFirstRecord ();
+
+  startupMark (tr ("First record read started"));
+
+
+  //  Start reading the LAS file list from the PFM(s) in the background.  The header scan is started from trackCursor once
+  //  the list is ready (see startCatalogScan).
+
+  catalog = NULL;
+  catalog_reported = NVFalse;
+  catalog_listed = 0;
+  startCatalog ();
+
+  startupMark (tr ("Catalog list started"));
+
+
+  //  In tail mode we watch the files that we're waiting on (inotify on Linux) and also check their sizes twice a second
+  //  since file system notification doesn't work on network file systems.
+
+  tailWatcher = NULL;
+
+  if (tail_mode)
+    {
+      tailWatcher = new QFileSystemWatcher (this);
+      connect (tailWatcher, SIGNAL (fileChanged (const QString &)), this, SLOT (slotTailCheck ()));
+
+      QTimer *tailTimer = new QTimer (this);
+      connect (tailTimer, SIGNAL (timeout ()), this, SLOT (slotTailCheck ()));
+      tailTimer->start (TAIL_CHECK_INTERVAL);
+    }
+
+
+  //  This is the "tools" toolbar.  We have to do this here so that we can restore the toolbar location(s).
+
+  QToolBar *tools = addToolBar (tr ("Tools"));
+  tools->setObjectName (tr ("LASwaveMonitor main toolbar"));
+
+
+  envin ();
+
+
+  // Set the application font
+
+  QApplication::setFont (font);
+
+
+  setWindowTitle (QString (VERSION));
+
+  startupMark (tr ("Settings read"));
+
 
   //  Set the window size and location from the defaults
 
@@ -205,6 +281,8 @@ LASwaveMonitor::LASwaveMonitor (int32_t *argc, char **argv, QWidget * parent):
   //  Set all of the default values.
 
   wave_read = 0;
+  zoom_first = zoom_count = 0;
+  bounds.total = 0;
 
 
   //  Set the map values from the defaults
@@ -239,7 +317,6 @@ LASwaveMonitor::LASwaveMonitor (int32_t *argc, char **argv, QWidget * parent):
   //  Make the map.
 
   map = new nvMap (this, &mapdef);
-  map->setWhatsThis (mapText);
 
 
   //  Connect to the signals from the map class.
@@ -248,6 +325,7 @@ LASwaveMonitor::LASwaveMonitor (int32_t *argc, char **argv, QWidget * parent):
   connect (map, SIGNAL (mouseMoveSignal (QMouseEvent *, double, double)), this, SLOT (slotMouseMove (QMouseEvent *, double, double)));
   connect (map, SIGNAL (resizeSignal (QResizeEvent *)), this, SLOT (slotResize (QResizeEvent *)));
   connect (map, SIGNAL (postRedrawSignal (NVMAP_DEF)), this, SLOT (slotPlotWaves (NVMAP_DEF)));
+  connect (map, SIGNAL (keyPressSignal (QKeyEvent *)), this, SLOT (slotKeyPress (QKeyEvent *)));
 
 
   //  Layouts, what fun!
@@ -257,8 +335,10 @@ LASwaveMonitor::LASwaveMonitor (int32_t *argc, char **argv, QWidget * parent):
 
   vBox->addWidget (map);
 
+  startupMark (tr ("Map"));
+
 
-  for (int32_t i = 0 ; i < 8 ; i++)
+  for (int32_t i = 0 ; i < 9 ; i++)
     {
       statusBar[i] = new QStatusBar (frame);
       statusBar[i]->setSizeGripEnabled (false);
@@ -270,7 +350,6 @@ LASwaveMonitor::LASwaveMonitor (int32_t *argc, char **argv, QWidget * parent):
   dateLabel = new QLabel ("0000-00-00 (000) 00:00:00.00", this);
   dateLabel->setAlignment (Qt::AlignCenter);
   dateLabel->setMinimumSize (dateLabel->sizeHint ());
-  dateLabel->setWhatsThis (dateLabelText);
   dateLabel->setToolTip (tr ("Date and time"));
 
   intensity = new QLabel (" 00000 ", this);
@@ -291,43 +370,36 @@ LASwaveMonitor::LASwaveMonitor (int32_t *argc, char **argv, QWidget * parent):
   synthetic = new QLabel (" 0 ", this);
   synthetic->setAlignment (Qt::AlignCenter);
   synthetic->setMinimumSize (synthetic->sizeHint ());
-  synthetic->setWhatsThis (syntheticText);
   synthetic->setToolTip (tr ("Synthetic flag"));
 
   keypoint = new QLabel (" 0 ", this);
   keypoint->setAlignment (Qt::AlignCenter);
   keypoint->setMinimumSize (keypoint->sizeHint ());
-  keypoint->setWhatsThis (keypointText);
   keypoint->setToolTip (tr ("Keypoint flag"));
 
   withheld = new QLabel (" 0 ", this);
   withheld->setAlignment (Qt::AlignCenter);
   withheld->setMinimumSize (withheld->sizeHint ());
-  withheld->setWhatsThis (withheldText);
   withheld->setToolTip (tr ("Withheld flag"));
 
   overlap = new QLabel (" 0 ", this);
   overlap->setAlignment (Qt::AlignCenter);
   overlap->setMinimumSize (overlap->sizeHint ());
-  overlap->setWhatsThis (overlapText);
   overlap->setToolTip (tr ("Overlap flag"));
 
   scannerChan = new QLabel (" 0 ", this);
   scannerChan->setAlignment (Qt::AlignCenter);
   scannerChan->setMinimumSize (scannerChan->sizeHint ());
-  scannerChan->setWhatsThis (scannerChanText);
   scannerChan->setToolTip (tr ("Scanner channel"));
 
   scanDir = new QLabel (" 0 ", this);
   scanDir->setAlignment (Qt::AlignCenter);
   scanDir->setMinimumSize (scanDir->sizeHint ());
-  scanDir->setWhatsThis (scanDirText);
   scanDir->setToolTip (tr ("Scan direction flag"));
 
   edge = new QLabel (" 0 ", this);
   edge->setAlignment (Qt::AlignCenter);
   edge->setMinimumSize (edge->sizeHint ());
-  edge->setWhatsThis (edgeText);
   edge->setToolTip (tr ("Flightline edge flag"));
 
   classification = new QLabel (" 0 ", this);
@@ -368,7 +440,6 @@ LASwaveMonitor::LASwaveMonitor (int32_t *argc, char **argv, QWidget * parent):
   NIR = new QLabel (" 00000 ", this);
   NIR->setAlignment (Qt::AlignCenter);
   NIR->setMinimumSize (NIR->sizeHint ());
-  NIR->setWhatsThis (NIRText);
   NIR->setToolTip (tr ("NIR"));
 
   wdi = new QLabel (" 000 ", this);
@@ -406,6 +477,31 @@ LASwaveMonitor::LASwaveMonitor (int32_t *argc, char **argv, QWidget * parent):
   Zt->setMinimumSize (Zt->sizeHint ());
   Zt->setToolTip (tr ("Z(t)"));
 
+  waveBaseline = new QLabel (" 0000000.0 (000000.0) ", this);
+  waveBaseline->setAlignment (Qt::AlignCenter);
+  waveBaseline->setMinimumSize (waveBaseline->sizeHint ());
+  waveBaseline->setToolTip (tr ("Waveform baseline (noise)"));
+
+  wavePeak = new QLabel (" 0000000.0 @ 00000.00 ", this);
+  wavePeak->setAlignment (Qt::AlignCenter);
+  wavePeak->setMinimumSize (wavePeak->sizeHint ());
+  wavePeak->setToolTip (tr ("Waveform peak above the baseline @ sample"));
+
+  waveFWHM = new QLabel (" 0000.00 (0000.00 ns) ", this);
+  waveFWHM->setAlignment (Qt::AlignCenter);
+  waveFWHM->setMinimumSize (waveFWHM->sizeHint ());
+  waveFWHM->setToolTip (tr ("Pulse width (full width at half maximum) in samples"));
+
+  waveEnergy = new QLabel (" 0000000000 ", this);
+  waveEnergy->setAlignment (Qt::AlignCenter);
+  waveEnergy->setMinimumSize (waveEnergy->sizeHint ());
+  waveEnergy->setToolTip (tr ("Waveform energy"));
+
+  waveSaturated = new QLabel (" 00000 ", this);
+  waveSaturated->setAlignment (Qt::AlignCenter);
+  waveSaturated->setMinimumSize (waveSaturated->sizeHint ());
+  waveSaturated->setToolTip (tr ("Saturated samples"));
+
 
   statusBar[0]->addWidget (dateLabel);
   statusBar[0]->addWidget (intensity);
@@ -441,13 +537,20 @@ LASwaveMonitor::LASwaveMonitor (int32_t *argc, char **argv, QWidget * parent):
   statusBar[7]->addWidget (Yt);
   statusBar[7]->addWidget (Zt);
 
+  statusBar[8]->addWidget (waveBaseline);
+  statusBar[8]->addWidget (wavePeak);
+  statusBar[8]->addWidget (waveFWHM);
+  statusBar[8]->addWidget (waveEnergy);
+  statusBar[8]->addWidget (waveSaturated);
+
+  startupMark (tr ("Status bars"));
+
 
   //  Button, button, who's got the buttons?
 
   bQuit = new QToolButton (this);
   bQuit->setIcon (QIcon (":/icons/quit.png"));
   bQuit->setToolTip (tr ("Quit"));
-  bQuit->setWhatsThis (quitText);
   connect (bQuit, SIGNAL (clicked ()), this, SLOT (slotQuit ()));
   tools->addWidget (bQuit);
 
@@ -462,17 +565,33 @@ LASwaveMonitor::LASwaveMonitor (int32_t *argc, char **argv, QWidget * parent):
       bMode->setIcon (QIcon (":/icons/mode_dot.png"));
     }
   bMode->setToolTip (tr ("Toggle wave drawing mode between line and dots"));
-  bMode->setWhatsThis (modeText);
   bMode->setCheckable (true);
   bMode->setChecked (wave_line_mode);
   connect (bMode, SIGNAL (toggled (bool)), this, SLOT (slotMode (bool)));
   tools->addWidget (bMode);
 
 
+  bPersist = new QToolButton (this);
+  bPersist->setIcon (QIcon (":/icons/mode_persist.png"));
+  bPersist->setToolTip (tr ("Toggle the persistence display"));
+  bPersist->setCheckable (true);
+  bPersist->setChecked (persist_mode);
+  connect (bPersist, SIGNAL (toggled (bool)), this, SLOT (slotPersist (bool)));
+  tools->addWidget (bPersist);
+
+
+  bEchogram = new QToolButton (this);
+  bEchogram->setIcon (QIcon (":/icons/echogram.png"));
+  bEchogram->setToolTip (tr ("Toggle the echogram window"));
+  bEchogram->setCheckable (true);
+  bEchogram->setChecked (echogram_mode);
+  connect (bEchogram, SIGNAL (toggled (bool)), this, SLOT (slotEchogram (bool)));
+  tools->addWidget (bEchogram);
+
+
   bPrefs = new QToolButton (this);
   bPrefs->setIcon (QIcon (":/icons/prefs.png"));
   bPrefs->setToolTip (tr ("Change application preferences"));
-  bPrefs->setWhatsThis (prefsText);
   connect (bPrefs, SIGNAL (clicked ()), this, SLOT (slotPrefs ()));
   tools->addWidget (bPrefs);
 
@@ -522,6 +641,8 @@ LASwaveMonitor::LASwaveMonitor (int32_t *argc, char **argv, QWidget * parent):
   helpMenu->addAction (acknowledgments);
   helpMenu->addAction (aboutQtAct);
 
+  startupMark (tr ("Toolbar and menus"));
+
 
   map->setCursor (Qt::ArrowCursor);
 
@@ -531,6 +652,174 @@ LASwaveMonitor::LASwaveMonitor (int32_t *argc, char **argv, QWidget * parent):
   QTimer *track = new QTimer (this);
   connect (track, SIGNAL (timeout ()), this, SLOT (trackCursor ()));
   track->start (10);
+
+
+  //  The persistence display keeps fading after the cursor stops so it has its own frame timer.
+
+  wave_persist_init (&persist, (float) persist_half_life);
+  persist_new = persist_fade = NVFalse;
+  persist_frame_time = 0;
+  persistClock.start ();
+
+  persistTimer = new QTimer (this);
+  persistTimer->setTimerType (Qt::PreciseTimer);
+  connect (persistTimer, SIGNAL (timeout ()), this, SLOT (slotPersistFrame ()));
+  if (persist_mode) persistTimer->start (WAVE_PERSIST_FRAME_INTERVAL);
+
+
+  wave_history_init (&history, history_size, history_memory);
+  history_pos = 0;
+  history_show = NVFalse;
+
+
+  //  The echogram is a separate window that follows the current record.  It isn't made until it's turned on.
+
+  if (echogram_mode) slotEchogram (true);
+
+
+  //  By now the first record's header has (almost certainly) been read so we just pick it up.  It goes in the catalog
+  //  when the catalog is started (see startCatalogScan).
+
+  if (firstRecordThread.joinable ()) firstRecordThread.join ();
+
+  startupMark (tr ("First record header"));
+
+
+  //  The What's This help isn't needed to show the first waveform so it's set up after the window is up.
+
+  QTimer::singleShot (STARTUP_DEFER_DELAY, this, SLOT (slotDeferredSetup ()));
+
+  startupMark (tr ("Window built"));
+}
+
+
+
+//  Start reading the record that's in ABE_SHARE when we start up.  The header is read in a thread while the constructor
+//  builds the window (and put in the catalog when it's done) and the waveform is decoded into the shared waveform cache in
+//  the background so the first trackCursor hit doesn't have to read anything but the point record.
+
+void
+LASwaveMonitor::startFirstRecord ()
+{
+  first_status = -1;
+  first_filename[0] = 0;
+  first_recnum = 0;
+
+
+  //  We don't lock ABE_SHARE (see the note in the constructor).  If the parent is changing the record while we copy it we
+  //  just prefetch the wrong one (or fail to open a garbled file name), trackCursor reads the real one anyway.
+
+  if (abe_share->mwShare.multiType[0] == PFM_LAS_DATA)
+    {
+      strncpy (first_filename, abe_share->nearest_filename, sizeof (first_filename) - 1);
+      first_filename[sizeof (first_filename) - 1] = 0;
+      first_recnum = (uint64_t) (uint32_t) abe_share->mwShare.multiRecord[0];
+    }
+
+
+  if (!first_filename[0] || !first_recnum) return;
+
+
+  firstRecordThread = std::thread ([this] ()
+    {
+      FILE *fp = fopen64 (first_filename, "rb");
+
+      if (fp == NULL) return;
+
+      if (slas_read_header (fp, endian, &first_header) < 0)
+        {
+          fclose (fp);
+          return;
+        }
+
+      if (tail_mode) slas_refresh_point_count (fp, endian, &first_header);
+
+      fclose (fp);
+
+      first_status = 0;
+
+
+      //  trackCursor will complain about anything else.
+
+      if (first_header.version_major == 1 && (first_header.version_minor == 3 || first_header.version_minor == 4) &&
+          (first_header.global_encoding & 0x6) && first_recnum - 1 < first_header.extended_number_of_point_records)
+        {
+          std::vector<uint64_t> recnums (1, first_recnum - 1);
+
+          slas_shared_cache_prefetch (sharedCache, first_filename, &first_header, endian, recnums);
+        }
+    });
+}
+
+
+
+//  Add a time to the startup timing report (--timing).
+
+void
+LASwaveMonitor::startupMark (QString what)
+{
+  if (startup_reported || startupNames.contains (what)) return;
+
+  startupNames += what;
+  startupTimes += startupClock.nsecsElapsed () / 1000000.0;
+}
+
+
+
+//  Print the startup timing report (--timing).  This is done when the first waveform has been drawn (or when we quit if
+//  that never happened).  The times are kept whether or not we're going to print them since it costs next to nothing.
+
+void
+LASwaveMonitor::startupReport ()
+{
+  if (startup_reported) return;
+
+  startup_reported = NVTrue;
+
+  if (!startup_timing) return;
+
+
+  fprintf (stderr, "\n%s startup (milliseconds since the program started)\n\n", VERSION);
+  fprintf (stderr, "      Total       Step\n");
+
+  for (int32_t i = 0 ; i < startupNames.size () ; i++)
+    {
+      double step = i ? startupTimes[i] - startupTimes[i - 1] : startupTimes[i];
+
+      fprintf (stderr, "  %9.1f  %9.1f  %s\n", startupTimes[i], step, startupNames[i].toLocal8Bit ().constData ());
+    }
+
+  fprintf (stderr, "\n");
+  fflush (stderr);
+}
+
+
+
+//  Things that aren't needed to show the first waveform.
+
+void
+LASwaveMonitor::slotDeferredSetup ()
+{
+  map->setWhatsThis (mapText);
+  dateLabel->setWhatsThis (dateLabelText);
+  synthetic->setWhatsThis (syntheticText);
+  keypoint->setWhatsThis (keypointText);
+  withheld->setWhatsThis (withheldText);
+  overlap->setWhatsThis (overlapText);
+  scannerChan->setWhatsThis (scannerChanText);
+  scanDir->setWhatsThis (scanDirText);
+  edge->setWhatsThis (edgeText);
+  NIR->setWhatsThis (NIRText);
+  waveBaseline->setWhatsThis (analyticsText);
+  wavePeak->setWhatsThis (analyticsText);
+  waveFWHM->setWhatsThis (analyticsText);
+  waveEnergy->setWhatsThis (analyticsText);
+  waveSaturated->setWhatsThis (analyticsText);
+  bQuit->setWhatsThis (quitText);
+  bMode->setWhatsThis (modeText);
+  bPersist->setWhatsThis (persistText);
+  bEchogram->setWhatsThis (echogramText);
+  bPrefs->setWhatsThis (prefsText);
 }
 
 
@@ -565,38 +854,84 @@ LASwaveMonitor::slotHelp ()
 
 
 
+//  The samples run down the screen so the vertical pixel position tells us which sample was clicked.  Left click zooms in
+//  (by a factor of two) centered on that sample.
+
 void 
-LASwaveMonitor::leftMouse (double x __attribute__ ((unused)), double y __attribute__ ((unused)))
+LASwaveMonitor::leftMouse (int32_t x __attribute__ ((unused)), int32_t y)
 {
-  //  Placeholder
+  if (!wave_read || !bounds.total) return;
+
+  NVMAP_DEF l_mapdef = map->getMapdef ();
+
+  int32_t center = bounds.min_x + NINT (((float) y / (float) l_mapdef.draw_height) * (float) bounds.range_x);
+  int32_t count = bounds.length / 2;
+
+  setZoom (center - count / 2, count);
 }
 
 
 
+//  Middle click goes back to the whole waveform.
+
 void 
-LASwaveMonitor::midMouse (double x __attribute__ ((unused)), double y __attribute__ ((unused)))
+LASwaveMonitor::midMouse (int32_t x __attribute__ ((unused)), int32_t y __attribute__ ((unused)))
 {
-  //  Placeholder
+  setZoom (0, 0);
 }
 
 
 
+//  Right click zooms out by a factor of two around the center of the window.
+
 void 
-LASwaveMonitor::rightMouse (double x __attribute__ ((unused)), double y __attribute__ ((unused)))
+LASwaveMonitor::rightMouse (int32_t x __attribute__ ((unused)), int32_t y __attribute__ ((unused)))
 {
-  //  Placeholder
+  if (!zoom_count) return;
+
+  int32_t count = zoom_count * 2;
+
+  setZoom (zoom_first + zoom_count / 2 - count / 2, count);
 }
 
 
 
-//  Signal from the map class.
+//  Set the zoomed sample window and read the waveform again.  The window is clipped to the current waveform here and
+//  again in trackCursor (since the next waveform may be shorter).
+
+void 
+LASwaveMonitor::setZoom (int32_t first, int32_t count)
+{
+  if (count < MIN_ZOOM_SAMPLES) count = MIN_ZOOM_SAMPLES;
+
+  if (!bounds.total || count >= bounds.total)
+    {
+      zoom_first = zoom_count = 0;
+    }
+  else
+    {
+      zoom_first = qBound (0, first, bounds.total - count);
+      zoom_count = count;
+    }
+
+
+  //  Zooming reads the current record again so it takes us out of the history.
+
+  history_pos = 0;
+
+  force_redraw = NVTrue;
+}
+
+
 
 void 
-LASwaveMonitor::slotMousePress (QMouseEvent * e, double x, double y)
+LASwaveMonitor::slotMousePress (QMouseEvent * e, double x __attribute__ ((unused)), double y __attribute__ ((unused)))
 {
-  if (e->button () == Qt::LeftButton) leftMouse (x, y);
-  if (e->button () == Qt::MidButton) midMouse (x, y);
-  if (e->button () == Qt::RightButton) rightMouse (x, y);
+  //  We draw in pixels (not map coordinates) so we pass the pixel position.
+
+  if (e->button () == Qt::LeftButton) leftMouse (e->pos ().x (), e->pos ().y ());
+  if (e->button () == Qt::MidButton) midMouse (e->pos ().x (), e->pos ().y ());
+  if (e->button () == Qt::RightButton) rightMouse (e->pos ().x (), e->pos ().y ());
 }
 
 
@@ -616,12 +951,9 @@ LASwaveMonitor::slotMouseMove (QMouseEvent *e __attribute__ ((unused)), double x
 void
 LASwaveMonitor::trackCursor ()
 {
-  static uint32_t         prev_rec = -1;
+  static uint64_t         prev_rec = -1;
   static ABE_SHARE        l_share;
   FILE                    *las_fp = NULL, *las_wfp = NULL;
-  LASreadOpener           lasreadopener;
-  LASreader               *lasreader;
-  SLAS_WAVEFORM_PACKET_DESCRIPTOR slas_wf_packet_desc[255];
 
 
   //  Since this is always a child process of something we want to exit if we see the CHILD_PROCESS_FORCE_EXIT key.
@@ -637,19 +969,33 @@ LASwaveMonitor::trackCursor ()
   if (lock_track) return;
 
 
+  //  Once the PFM list files have been read, start the catalog scan.  Once that has finished, report any files that it
+  //  couldn't read.
+
+  if (catalog_listed == 1) startCatalogScan ();
+
+  if (catalog && !catalog_reported && catalog->done) reportCatalogFailures ();
+
+
+  //  Get the records that the cursor passed over since the last time (if the parent is queueing them).
+
+  drainRecordRing ();
+
+
   //  Locking makes sure another process does not have memory locked.  It will block until it can lock it.
   //  At that point we copy the contents and then unlock it so other processes can continue.
 
   abeShare->lock ();
 
 
-  //  Check for change of record and correct record type
+  //  Check for change of record and correct record type.  The record number in ABE_SHARE is a signed 32 bit value so we
+  //  treat it as unsigned to get to records past 2^31.  Everything from here on uses 64 bit record numbers.
 
   uint8_t hit = NVFalse;
-  if (prev_rec != abe_share->mwShare.multiRecord[0] && abe_share->mwShare.multiType[0] == PFM_LAS_DATA)
+  if (prev_rec != (uint64_t) (uint32_t) abe_share->mwShare.multiRecord[0] && abe_share->mwShare.multiType[0] == PFM_LAS_DATA)
     {
       l_share = *abe_share;
-      prev_rec = l_share.mwShare.multiRecord[0];
+      prev_rec = (uint64_t) (uint32_t) l_share.mwShare.multiRecord[0];
       hit = NVTrue;
     }
 
@@ -666,51 +1012,86 @@ LASwaveMonitor::trackCursor ()
     {
       force_redraw = NVFalse;
 
+
+      //  A new record takes us out of the history.  Any other redraw (resize, color change) while we're looking back
+      //  through the history just draws the snapshot again.
+
+      if (hit)
+        {
+          history_pos = 0;
+
+
+          //  Start the record to pixel clock (--metrics).  If the last record we saw never got drawn we skipped it.
+
+          if (metrics)
+            {
+              if (metrics_pending) slas_metrics_add (SLAS_METRIC_RECORDS_SKIPPED, 1);
+
+              metricsClock.start ();
+              metrics_pending = NVTrue;
+            }
+        }
+      else if (history_pos)
+        {
+          history_show = NVTrue;
+          map->redrawMapArea (NVTrue);
+          return;
+        }
+
  
       //  Save for slotPlotWaves.
 
-      recnum = l_share.mwShare.multiRecord[0];
+      recnum = prev_rec;
       strcpy (filename, l_share.nearest_filename);
 
 
-      //  Open the LAS file with LASlib and read the header.
+      //  Open the LAS file and read the parts of the header that we need.
 
-      lasreadopener.set_file_name (filename);
-      lasreader = lasreadopener.open ();
-      if (!lasreader)
+      //  If this file failed to open recently and hasn't changed since then, don't try again.
+
+      if (checkFailedOpen (filename)) return;
+
+
+      if ((las_fp = fopen64 (filename, "rb")) == NULL)
         {
-          if (filError) filError->close ();
-          filError = new QMessageBox (QMessageBox::Warning, "LASwaveMonitor", tr ("Error opening ") + 
-                                      QDir::toNativeSeparators (QString (filename)) + " : " + 
-                                      QString (strerror (errno)), QMessageBox::NoButton, this, 
-                                      (Qt::WindowFlags) Qt::WA_DeleteOnClose);
-          filError->show ();
+          setFailedOpen (filename, filename, tr ("Error opening ") + QString (strerror (errno)));
           return;
         }
 
 
-      lasheader = lasreader->header;
+      //  If the catalog has a current copy of the header we don't need to read it.  In tail mode the file has probably
+      //  just grown so we only need to update the point counts of the cached header.
+
+      if (slas_catalog_lookup (catalog, filename, &lasheader) < 0 &&
+          (!tail_mode || slas_catalog_extend (catalog, filename, las_fp, &lasheader) < 0))
+        {
+          if (slas_read_header (las_fp, endian, &lasheader) < 0)
+            {
+              fclose (las_fp);
+              setFailedOpen (filename, filename, tr ("Error reading LAS header"));
+              return;
+            }
+
+          if (tail_mode) slas_refresh_point_count (las_fp, endian, &lasheader);
+
+          slas_catalog_insert (catalog, filename, &lasheader);
+        }
 
 
       if (lasheader.version_major != 1)
         {
-          lasreader->close ();
-          if (filError) filError->close ();
-          string.sprintf ("\nLAS major version %d incorrect, file %s : %s %s %d\n\n", lasheader.version_major, filename, __FILE__, __FUNCTION__, __LINE__);
-          filError = new QMessageBox (QMessageBox::Warning, "LASwaveMonitor", string, QMessageBox::NoButton, this, 
-                                      (Qt::WindowFlags) Qt::WA_DeleteOnClose);
-          filError->show ();
+          fclose (las_fp);
+          string.sprintf ("LAS major version %d incorrect", lasheader.version_major);
+          setFailedOpen (filename, filename, string);
           return;
         }
 
 
       if (lasheader.version_minor != 3 && lasheader.version_minor != 4)
         {
-          lasreader->close ();
-          string.sprintf ("\nLAS minor version %d incorrect, file %s : %s %s %d\n\n", lasheader.version_minor, filename, __FILE__, __FUNCTION__, __LINE__);
-          filError = new QMessageBox (QMessageBox::Warning, "LASwaveMonitor", string, QMessageBox::NoButton, this, 
-                                      (Qt::WindowFlags) Qt::WA_DeleteOnClose);
-          filError->show ();
+          fclose (las_fp);
+          string.sprintf ("LAS minor version %d incorrect", lasheader.version_minor);
+          setFailedOpen (filename, filename, string);
           return;
         }
 
@@ -719,7 +1100,7 @@ LASwaveMonitor::trackCursor ()
 
       if (!(lasheader.global_encoding & 0x6))
         {
-          lasreader->close ();
+          fclose (las_fp);
 
           string = tr ("<b>No waveforms!</b>");
           dateLabel->setText (string);
@@ -728,68 +1109,93 @@ LASwaveMonitor::trackCursor ()
         }
 
 
-      //  Look for the waveform information in the VLRs.
+      //  In tail mode a record past the end of the file may just not have been written yet.  Check for new records and,
+      //  if it still isn't there, wait for the file to grow (see slotTailCheck).
 
-      for (int32_t i = 0 ; i < (int32_t) lasheader.number_of_variable_length_records ; i++)
+      char wave_name[1024];
+      slas_wave_file_name (filename, wave_name);
+
+      if (tail_mode && recnum - 1 >= lasheader.extended_number_of_point_records)
         {
-          if (lasheader.vlrs[i].record_id > 99 && lasheader.vlrs[i].record_id < 355)
+          if (slas_refresh_point_count (las_fp, endian, &lasheader) > 0) slas_catalog_insert (catalog, filename, &lasheader);
+
+          if (recnum - 1 >= lasheader.extended_number_of_point_records)
             {
-              LASvlr_wave_packet_descr *vlr_wave_packet_descr = (LASvlr_wave_packet_descr *) lasheader.vlrs[i].data;
-
-              int32_t ndx = lasheader.vlrs[i].record_id - 99;
-              slas_wf_packet_desc[ndx].bits_per_sample = vlr_wave_packet_descr->getBitsPerSample ();
-              slas_wf_packet_desc[ndx].compression_type = vlr_wave_packet_descr->getCompressionType ();
-              slas_wf_packet_desc[ndx].number_of_samples = vlr_wave_packet_descr->getNumberOfSamples ();
-              slas_wf_packet_desc[ndx].temporal_spacing = vlr_wave_packet_descr->getTemporalSpacing ();
-              slas_wf_packet_desc[ndx].digitizer_gain = vlr_wave_packet_descr->getDigitizerGain ();
-              slas_wf_packet_desc[ndx].digitizer_offset = vlr_wave_packet_descr->getDigitizerOffset ();
+              fclose (las_fp);
+              setTailWait (filename, (lasheader.global_encoding & 0x4) ? wave_name : "");
+              return;
             }
         }
 
 
-      //  Now close it since all we really wanted was the header.
+      //  Move the echogram marker (this starts a new echogram if the file changed).
 
-      lasreader->close ();
+      if (echogram_mode)
+        {
+          echoView->setColors (backgroundColor, waveColor, primaryColor);
+          echoView->setRecord (filename, &lasheader, endian, recnum - 1);
+        }
 
 
-      if ((las_fp = fopen64 (filename, "rb")) == NULL)
+      //  LAZ files can't be read with fixed width records so we go through the LAZ chunk cache.  We keep the LAZ
+      //  handle open until the file changes so that moves within the same chunk don't have to decompress again.  We
+      //  go by the compression bits in the header, not the file name, since a missed LAZ chunk has to be decompressed.
+
+      if (lasheader.compressed)
         {
-          string = tr ("Error opening ") + QDir::toNativeSeparators (QString (filename)) + " : " + QString (strerror (errno));
-          filError = new QMessageBox (QMessageBox::Warning, "LASwaveMonitor", string, QMessageBox::NoButton, this, 
-                                      (Qt::WindowFlags) Qt::WA_DeleteOnClose);
-          filError->show ();
-          return;
-        }
+          fclose (las_fp);
+          las_fp = NULL;
 
 
-      slas_read_point_data (las_fp, l_share.mwShare.multiRecord[0] - 1, &lasheader, endian, &slas);
+          //  LASzip doesn't support internal waveforms so they have to be in an external .wdp file.
 
+          if (!(lasheader.global_encoding & 0x4))
+            {
+              string = tr ("<b>Internal waveforms not supported in LAZ files!</b>");
+              dateLabel->setText (string);
 
-      //  If the waveforms are external...
+              return;
+            }
 
-      if (lasheader.global_encoding & 0x4)
-        {
-          QString waveName = QString (filename).replace (".las", ".wdp");
-          char wave_name[1024];
-          strcpy (wave_name, waveName.toLatin1 ());
 
-          if ((las_wfp = fopen64 (wave_name, "rb")) == NULL)
+          if (laz && strcmp (laz->filename, filename))
             {
-              string = tr ("Error opening ") + QDir::toNativeSeparators (QString (wave_name)) + " : " + QString (strerror (errno));
-              filError = new QMessageBox (QMessageBox::Warning, "LASwaveMonitor", string, QMessageBox::NoButton, this, 
-                                          (Qt::WindowFlags) Qt::WA_DeleteOnClose);
-              filError->show ();
-              fclose (las_fp);
+              slaz_close (laz);
+              laz = NULL;
+            }
+
+          if (!laz && (laz = slaz_open (filename)) == NULL)
+            {
+              setFailedOpen (filename, filename, tr ("Error opening ") + QString (strerror (errno)));
+              return;
+            }
+
+          if (slaz_read_point_data (laz, recnum - 1, &slas) < 0)
+            {
+              string = tr ("<b>Error reading point record %1!</b>").arg (recnum);
+              dateLabel->setText (string);
+
               return;
             }
         }
+      else if (slas_read_point_data (las_fp, recnum - 1, &lasheader, endian, &slas) < 0)
+        {
+          //  Don't go on to the shared cache with the previous point record, we'd look up (or store) the wrong waveform
+          //  under this record number.  In tail mode the record may only be partly written.
 
+          fclose (las_fp);
 
-      //  Otherwise, the waveforms are internal (since we already checked global_encoding to make sure there were waveforms).
+          if (tail_mode)
+            {
+              setTailWait (filename, (lasheader.global_encoding & 0x4) ? wave_name : "");
+            }
+          else
+            {
+              string = tr ("<b>Error reading point record %1!</b>").arg (recnum);
+              dateLabel->setText (string);
+            }
 
-      else
-        {
-          las_wfp = las_fp;
+          return;
         }
 
 
@@ -797,69 +1203,487 @@ LASwaveMonitor::trackCursor ()
                                                lasheader.point_data_format == 9 || lasheader.point_data_format == 10))
         {
           int32_t ndx = slas.wavepacket_descriptor_index;
-          bounds.length = slas_wf_packet_desc[ndx].number_of_samples;
-          bounds.temporal_spacing = slas_wf_packet_desc[ndx].temporal_spacing;
 
+          wave_plot_bounds (&lasheader.wf_packet_desc[ndx], zoom_first, zoom_count, &bounds);
 
-          bounds.min_y = 0;
-          bounds.height = bounds.max_y = NINT (pow (2.0, (double) slas_wf_packet_desc[ndx].bits_per_sample));
-          bounds.min_x = 0;
-          bounds.max_x = bounds.length;
+          int32_t bits = lasheader.wf_packet_desc[ndx].bits_per_sample;
 
+          try
+            {
+              sample.resize (bounds.length, bits);
+              full_sample.resize (bounds.total, bits);
+            }
+          catch (std::bad_alloc&)
+            {
+              if (las_fp) fclose (las_fp);
+              fprintf (stderr, "%s %s %s %d - sample - %s\n", progname, __FILE__, __FUNCTION__, __LINE__, strerror (errno));
+              abeShare->detach ();
+              exit (-1);
+            }
 
-          //  Add pixels to the X axis.
 
-          bounds.range_x = bounds.max_x - bounds.min_x;
-          bounds.buffer_size = 25;
-          bounds.min_x = bounds.min_x - bounds.buffer_size;
-          bounds.max_x = bounds.max_x + 10;
-          bounds.range_x = bounds.max_x - bounds.min_x;
-          bounds.range_y = bounds.max_y - bounds.min_y;
+          //  See if we (or another waveform monitor) have already decoded this waveform.  If not, we read it and put it in
+          //  the shared cache for everybody else.  We always get the whole waveform (even when we're zoomed in) so that
+          //  the analytics are for the whole waveform and don't change as the zoom window moves.
 
+          uint64_t file_id = sharedCache ? slas_shared_cache_file_id (filename) : 0;
 
-          //  Add pixels to the Y axis.
+          int32_t wave_status = slas_shared_cache_get (sharedCache, file_id, recnum - 1, 0, bounds.total, &full_sample);
 
-          bounds.range_y = bounds.max_y - bounds.min_y;
-          bounds.buffer_size = 25;
-          bounds.min_y = bounds.min_y - bounds.buffer_size;
-          bounds.max_y = bounds.max_y + 10;
-          bounds.range_y = bounds.max_y - bounds.min_y;
-          bounds.range_y = bounds.max_y - bounds.min_y;
+          if (wave_status < 0)
+            {
+              //  If the waveforms are external...
 
-          try
+              if (lasheader.global_encoding & 0x4)
+                {
+                  if ((las_wfp = fopen64 (wave_name, "rb")) == NULL)
+                    {
+                      QString reason = tr ("Error opening ") + QString (strerror (errno));
+
+
+                      //  If there's no .wdp file, use the compressed waveform (.wdc) file if there is one.  We keep it
+                      //  open until we change files since it has to read the block table when it's opened.
+
+                      char wdc_name[1024];
+                      slas_wdc_file_name (filename, wdc_name);
+
+                      if (wdc == NULL || wdc_file != wdc_name)
+                        {
+                          slas_wdc_close (wdc);
+                          wdc_file = wdc_name;
+                          wdc = slas_wdc_open (wdc_name);
+                        }
+
+                      if (wdc == NULL)
+                        {
+                          setFailedOpen (filename, wave_name, reason);
+                          if (las_fp) fclose (las_fp);
+                          return;
+                        }
+                    }
+                }
+
+
+              //  Otherwise, the waveforms are internal (since we already checked global_encoding to make sure there were
+              //  waveforms).
+
+              else
+                {
+                  las_wfp = las_fp;
+                }
+
+
+              if (las_wfp == NULL)
+                {
+                  wave_status = slas_wdc_read_waveform_data (wdc, &lasheader, &slas, &full_sample);
+                }
+              else
+                {
+                  wave_status = slas_read_waveform_data (las_wfp, &lasheader, &slas, &full_sample);
+                }
+
+
+              //  We only get here if both the point record and the waveform were read.
+
+              if (!wave_status) slas_shared_cache_put (sharedCache, file_id, recnum - 1, &full_sample);
+            }
+
+
+          //  Analyze the whole waveform and keep the samples in the zoom window for the plot.
+
+          if (!wave_status)
             {
-              sample.resize (bounds.length);
+              wave_stats_compute (full_sample, bits, &wave_stats);
+
+              int32_t count = qBound (0, (int32_t) full_sample.size () - bounds.first, bounds.length);
+
+              sample.resize (count, bits);
+
+              for (int32_t i = 0 ; i < count ; i++) sample.set (i, full_sample[bounds.first + i]);
             }
-          catch (std::bad_alloc&)
+          else
             {
-              fclose (las_fp);
-              fprintf (stderr, "%s %s %s %d - sample - %s\n", progname, __FILE__, __FUNCTION__, __LINE__, strerror (errno));
-              abeShare->detach ();
-              exit (-1);
+              memset (&wave_stats, 0, sizeof (WAVE_STATS));
+            }
+
+
+          //  In tail mode the waveform may not have been written yet (the point usually gets written first).
+
+          if (wave_status < 0 && tail_mode)
+            {
+              if (las_fp) fclose (las_fp);
+              if ((lasheader.global_encoding & 0x4) && las_wfp) fclose (las_wfp);
+              setTailWait (filename, (lasheader.global_encoding & 0x4) ? wave_name : "");
+              return;
+            }
+
+          wave_read = NVTrue;
+        }
+      else
+        {
+          if (las_fp) fclose (las_fp);
+          if ((lasheader.global_encoding & 0x4) && las_wfp) fclose (las_wfp);
+          return;
+        }
+
+
+      if (las_fp) fclose (las_fp);
+      if ((lasheader.global_encoding & 0x4) && las_wfp) fclose (las_wfp);
+
+
+      //  It worked so, if it failed before, take it out of the failed list.
+
+      clearFailedOpen (filename);
+      tail_wait = NVFalse;
+
+
+      l_share.key = 0;
+      abe_share->key = 0;
+      abe_share->modcode = PFM_LAS_DATA;
+
+
+      //  Only new records go into the persistence display (not redraws of the same one).
+
+      persist_new = hit;
+
+      startupMark (tr ("First record read"));
+
+      map->redrawMapArea (NVTrue);
+    }
+}
+
+
+
+//  Tail mode.  The record (or its waveform) that we want hasn't been written yet so we remember the sizes of the LAS file
+//  and the .wdp file (if there is one) and watch them.  When either one changes slotTailCheck forces trackCursor to try
+//  again.  Nothing is reopened or rescanned until then.
+
+void 
+LASwaveMonitor::setTailWait (QString las_name, QString wave_name)
+{
+  QStringList files;
+
+  files += las_name;
+  if (!wave_name.isEmpty ()) files += wave_name;
+
+
+  if (files != tailFiles)
+    {
+      if (!tailWatcher->files ().isEmpty ()) tailWatcher->removePaths (tailWatcher->files ());
+
+      tailFiles = files;
+      tailWatcher->addPaths (tailFiles);
+    }
+
+
+  tailSizes.clear ();
+
+  for (int32_t i = 0 ; i < tailFiles.size () ; i++) tailSizes += QFileInfo (tailFiles[i]).size ();
+
+  tail_wait = NVTrue;
+
+
+  string = tr ("<b>Waiting for record %1</b>").arg (recnum);
+  dateLabel->setText (string);
+}
+
+
+
+//  Drain the record change ring that the parent program fills (see record_ring.hpp).  ABE_SHARE only has the current record
+//  (which is still what we draw) so this is the only way to see the records that the cursor went over between checks.
+//  Those are decoded into the shared waveform cache in the background so that going back over them is fast for us and any
+//  other monitor.  They aren't put in the waveform history, that's what was displayed (with the bounds it was drawn with)
+//  and reading them here would stall the tracker.  If the parent doesn't make a ring, or it overflows, we just have what's
+//  in ABE_SHARE.
+
+void
+LASwaveMonitor::drainRecordRing ()
+{
+  if (recordRing == NULL)
+    {
+      if (failClock.elapsed () < ring_next_attach) return;
+
+      ring_next_attach = failClock.elapsed () + RECORD_RING_RETRY;
+
+      if ((recordRing = record_ring_attach (key)) == NULL) return;
+    }
+
+
+  std::vector<RECORD_RING_EVENT> events;
+  uint64_t dropped;
+
+  record_ring_drain (recordRing, events, &dropped);
+
+  slas_metrics_add (SLAS_METRIC_RING_OVERFLOWS, dropped);
+
+  if (events.empty ()) return;
+
+
+  //  The last one is (probably) the one in ABE_SHARE that trackCursor is about to read.
+
+  events.pop_back ();
+
+  slas_metrics_add (SLAS_METRIC_RECORDS_SKIPPED, events.size ());
+
+  if (sharedCache == NULL) return;
+
+
+  std::map<std::string, std::vector<uint64_t> > files;
+
+  for (size_t i = 0 ; i < events.size () ; i++)
+    {
+      if (events[i].type == PFM_LAS_DATA && events[i].recnum) files[events[i].filename].push_back (events[i].recnum - 1);
+    }
+
+  for (std::map<std::string, std::vector<uint64_t> >::iterator it = files.begin () ; it != files.end () ; ++it)
+    {
+      SLAS_HEADER header;
+
+      if (slas_catalog_lookup (catalog, it->first.c_str (), &header) < 0) continue;
+
+      if (slas_shared_cache_prefetch (sharedCache, it->first.c_str (), &header, endian, it->second) < 0) break;
+    }
+}
+
+
+
+void 
+LASwaveMonitor::slotTailCheck ()
+{
+  if (!tail_wait) return;
+
+
+  uint8_t changed = NVFalse;
+
+  for (int32_t i = 0 ; i < tailFiles.size () ; i++)
+    {
+      QFileInfo info (tailFiles[i]);
+
+      if (info.size () != tailSizes[i]) changed = NVTrue;
+
+
+      //  The watcher drops files that are replaced (renamed over) so put them back.
+
+      if (info.exists () && !tailWatcher->files ().contains (tailFiles[i])) tailWatcher->addPath (tailFiles[i]);
+    }
+
+
+  if (changed)
+    {
+      tail_wait = NVFalse;
+      force_redraw = NVTrue;
+    }
+}
+
+
+
+//  Check the negative cache of files that failed to open.  Returns NVTrue if we shouldn't bother trying to open the file.
+//  After a failure we only look at the file (one stat) once every backoff interval and, if it hasn't appeared or changed,
+//  we double the interval.  If it has changed we let the caller try to open it again.
+
+uint8_t 
+LASwaveMonitor::checkFailedOpen (QString las_name)
+{
+  if (!failedOpens.contains (las_name)) return (NVFalse);
+
+  FAILED_OPEN *fail = &failedOpens[las_name];
+
+  int64_t now = failClock.elapsed ();
+
+  if (now < fail->next_check) return (NVTrue);
+
+
+  QFileInfo info (fail->path);
+
+  if (info.exists () != (bool) fail->exists || info.size () != fail->size || info.lastModified ().toMSecsSinceEpoch () != fail->mtime)
+    return (NVFalse);
+
+
+  fail->backoff = qMin (fail->backoff * 2, FAILED_OPEN_MAX_BACKOFF);
+  fail->next_check = now + fail->backoff;
+
+  return (NVTrue);
+}
+
+
+
+//  Add (or update) a file in the negative cache and show it in the error panel.  The las_name is the file name from
+//  ABE_SHARE, the path is the file that actually failed (the LAS file or its .wdp file).
+
+void 
+LASwaveMonitor::setFailedOpen (QString las_name, QString path, QString reason)
+{
+  FAILED_OPEN fail;
+  QFileInfo info (path);
+
+
+  fail.path = path;
+  fail.reason = reason;
+  fail.exists = info.exists ();
+  fail.size = info.size ();
+  fail.mtime = info.lastModified ().toMSecsSinceEpoch ();
+  fail.backoff = FAILED_OPEN_MIN_BACKOFF;
+  fail.next_check = failClock.elapsed () + fail.backoff;
+
+  failedOpens.insert (las_name, fail);
+
+  slas_metrics_add (SLAS_METRIC_OPEN_FAILURES, 1);
+
+  updateErrorPanel ();
+}
+
+
+
+void 
+LASwaveMonitor::clearFailedOpen (QString las_name)
+{
+  if (failedOpens.remove (las_name)) updateErrorPanel ();
+}
+
+
+
+//  One error panel for all of the files that are failing instead of a new message box for every failure.
+
+void 
+LASwaveMonitor::updateErrorPanel ()
+{
+  if (failedOpens.isEmpty ())
+    {
+      if (filError) filError->hide ();
+      return;
+    }
+
+
+  QString text;
+
+  QHash<QString, FAILED_OPEN>::const_iterator i = failedOpens.constBegin ();
+  while (i != failedOpens.constEnd ())
+    {
+      text += QDir::toNativeSeparators (i.value ().path) + " : " + i.value ().reason + "\n";
+      ++i;
+    }
+
+
+  if (!filError)
+    {
+      filError = new QMessageBox (QMessageBox::Warning, "LASwaveMonitor", "", QMessageBox::Close, this);
+      filError->setModal (false);
+    }
+
+  filError->setText (tr ("Unable to read the following files (they will be checked again periodically) :"));
+  filError->setInformativeText (text);
+  filError->show ();
+}
+
+
+
+//  Get the list of LAS files from the PFM list file(s) in a thread so that opening the PFM files doesn't hold up the
+//  window on large projects.  The catalog cache file name is based on the list file names so that each project gets its
+//  own cache file.
+
+void 
+LASwaveMonitor::startCatalog ()
+{
+  //  We don't lock ABE_SHARE (see the note in the constructor), we just copy what we need before starting the thread.
+
+  std::vector<PFM_OPEN_ARGS> open_args (abe_share->open_args, abe_share->open_args + qBound (0, abe_share->pfm_count, MAX_ABE_PFMS));
+
+
+  catalogThread = std::thread ([this, open_args] () mutable
+    {
+      QString lists;
+      char    path[1024];
+      int16_t type;
+
+
+      for (size_t pfm = 0 ; pfm < open_args.size () ; pfm++)
+        {
+          open_args[pfm].checkpoint = 0;
+
+          int32_t pfm_handle = open_existing_pfm_file (&open_args[pfm]);
+          if (pfm_handle < 0) continue;
+
+          lists += QString (open_args[pfm].list_path);
+
+          int16_t count = get_next_list_file_number (pfm_handle);
+
+          for (int16_t i = 0 ; i < count ; i++)
+            {
+              if (read_list_file (pfm_handle, i, path, &type)) break;
+
+
+              //  Skip files that have been marked as deleted.
+
+              if (type == PFM_LAS_DATA && path[0] != '*') catalog_files.push_back (path);
             }
 
-          slas_read_waveform_data (las_wfp, &lasheader, &slas, slas_wf_packet_desc, sample.data ());
+          close_pfm_file (pfm_handle);
+        }
+
+
+#ifdef NVWIN3X
+      catalog_cache_file = QString (getenv ("USERPROFILE")) + "/ABE.config/LASwaveMonitor_catalog_";
+#else
+      catalog_cache_file = QString (getenv ("HOME")) + "/ABE.config/LASwaveMonitor_catalog_";
+#endif
+
+      catalog_cache_file += QString (QCryptographicHash::hash (lists.toLocal8Bit (), QCryptographicHash::Md5).toHex ()) + ".dat";
+
+      catalog_listed = 1;
+    });
+}
+
+
+
+//  Start the background scan of the LAS headers once startCatalog has the file list (called from trackCursor) and put
+//  the first record's header (see startFirstRecord) in the catalog.
+
+void 
+LASwaveMonitor::startCatalogScan ()
+{
+  catalogThread.join ();
+
+  catalog_listed = 2;
+
+
+  if (catalog_files.empty ()) return;
+
+  catalog = slas_catalog_build (catalog_files, catalog_cache_file.toLocal8Bit ().constData (), endian, 0);
+
+  if (!first_status) slas_catalog_insert (catalog, first_filename, &first_header);
+
 
-          wave_read = NVTrue;
-        }
-      else
-        {
-          fclose (las_fp);
-          if (lasheader.global_encoding & 0x4) fclose (las_wfp);
-          return;
-        }
+  std::vector<std::string> ().swap (catalog_files);
+}
 
 
-      fclose (las_fp);
-      if (lasheader.global_encoding & 0x4) fclose (las_wfp);
 
+//  Put the files that the catalog scan couldn't read into the failed open cache so they show up in the error panel
+//  right away instead of when the cursor first hits them.
 
-      l_share.key = 0;
-      abe_share->key = 0;
-      abe_share->modcode = PFM_LAS_DATA;
+void 
+LASwaveMonitor::reportCatalogFailures ()
+{
+  std::vector<std::string> names;
+  std::vector<int32_t>     status;
 
 
-      map->redrawMapArea (NVTrue);
+  catalog_reported = NVTrue;
+
+  slas_catalog_failures (catalog, names, status);
+
+  for (size_t i = 0 ; i < names.size () ; i++)
+    {
+      QString name = QString::fromLocal8Bit (names[i].c_str ());
+
+      if (status[i] == SLAS_CATALOG_OPEN_ERROR)
+        {
+          setFailedOpen (name, name, tr ("Error opening file"));
+        }
+      else
+        {
+          setFailedOpen (name, name, tr ("Error reading LAS header"));
+        }
     }
 }
 
@@ -895,6 +1719,60 @@ LASwaveMonitor::slotKeyPress (QKeyEvent *e)
     {
       force_redraw = NVTrue;
     }
+
+
+  //  The left and right arrow keys step back and forward through the waveforms that have been displayed (nothing is read)
+  //  and the End key goes back to the current record.
+
+  int32_t pos = history_pos;
+
+  switch (e->key ())
+    {
+    case Qt::Key_Left:
+      if (history_pos + 1 < history.count) pos++;
+      break;
+
+    case Qt::Key_Right:
+      if (history_pos) pos--;
+      break;
+
+    case Qt::Key_End:
+      pos = 0;
+      break;
+    }
+
+  if (pos != history_pos)
+    {
+      history_pos = pos;
+      history_show = NVTrue;
+      map->redrawMapArea (NVTrue);
+    }
+
+
+  //  When zoomed in, the up and down arrow keys pan through the waveform by half a window (page up and page down pan by
+  //  a whole window).  Only the part of the waveform that is on screen is read.
+
+  if (zoom_count)
+    {
+      switch (e->key ())
+        {
+        case Qt::Key_Up:
+          setZoom (zoom_first - zoom_count / 2, zoom_count);
+          break;
+
+        case Qt::Key_Down:
+          setZoom (zoom_first + zoom_count / 2, zoom_count);
+          break;
+
+        case Qt::Key_PageUp:
+          setZoom (zoom_first - zoom_count, zoom_count);
+          break;
+
+        case Qt::Key_PageDown:
+          setZoom (zoom_first + zoom_count, zoom_count);
+          break;
+        }
+    }
 }
 
 
@@ -911,6 +1789,22 @@ LASwaveMonitor::slotQuit ()
 
   envout ();
 
+  startupReport ();
+
+
+  //  Close the LAZ and .wdc files (if we have them open), stop the catalog scan and the echogram (if they're still
+  //  running), stop serving the metrics (this removes the socket), and detach from the shared waveform cache and the
+  //  record ring.
+
+  delete echoView;
+  delete metrics;
+  if (catalogThread.joinable ()) catalogThread.join ();
+  slaz_close (laz);
+  slas_wdc_close (wdc);
+  slas_catalog_close (catalog);
+  slas_shared_cache_detach (sharedCache);
+  record_ring_detach (recordRing);
+
 
   //  Let go of the shared memory.
 
@@ -941,6 +1835,132 @@ LASwaveMonitor::slotMode (bool on)
 
 
 
+void 
+LASwaveMonitor::slotPersist (bool on)
+{
+  persist_mode = on;
+
+  if (on)
+    {
+      wave_persist_clear (&persist);
+      persistTimer->start (WAVE_PERSIST_FRAME_INTERVAL);
+    }
+  else
+    {
+      persistTimer->stop ();
+    }
+
+  force_redraw = NVTrue;
+}
+
+
+
+//  Draw a frame of the fading persistence display if nothing else has drawn one recently.
+
+void 
+LASwaveMonitor::slotPersistFrame ()
+{
+  if (!persist_mode || !wave_read || lock_track || persist.peak <= 0.0) return;
+
+  if (persistClock.elapsed () - persist_frame_time < WAVE_PERSIST_FRAME_INTERVAL) return;
+
+  persist_fade = NVTrue;
+  map->redrawMapArea (NVTrue);
+}
+
+
+
+void 
+LASwaveMonitor::slotHalfLife (int value)
+{
+  persist_half_life = value;
+  persist.half_life = (float) value;
+}
+
+
+
+//  Changing the size or memory limit of the history starts it over.
+
+void 
+LASwaveMonitor::slotHistorySize (int value)
+{
+  history_size = value;
+
+  if (history.size != history_size)
+    {
+      wave_history_init (&history, history_size, history_memory);
+      history_pos = 0;
+    }
+}
+
+
+
+void 
+LASwaveMonitor::slotHistoryMemory (int value)
+{
+  history_memory = value;
+
+  if (history.max_bytes != (int64_t) history_memory * 1048576)
+    {
+      wave_history_init (&history, history_size, history_memory);
+      history_pos = 0;
+    }
+}
+
+
+
+void 
+LASwaveMonitor::slotHistoryOverlay (int value)
+{
+  history_overlay = value;
+
+
+  //  The displayed waveform is in the history so we don't have to read it again.
+
+  if (history.count)
+    {
+      history_show = NVTrue;
+      map->redrawMapArea (NVTrue);
+    }
+}
+
+
+
+void 
+LASwaveMonitor::slotEchogram (bool on)
+{
+  echogram_mode = on;
+
+  if (on)
+    {
+      if (echoView == NULL)
+        {
+          echoView = new echogram (this, echogram_order);
+          connect (echoView, SIGNAL (closed ()), this, SLOT (slotEchogramClosed ()));
+        }
+
+      echoView->show ();
+      force_redraw = NVTrue;
+    }
+  else if (echoView)
+    {
+      echoView->hide ();
+      echoView->clear ();
+    }
+}
+
+
+
+//  The user closed the echogram window.
+
+void 
+LASwaveMonitor::slotEchogramClosed ()
+{
+  bEchogram->setChecked (false);
+}
+
+
+
 void 
 LASwaveMonitor::setFields ()
 {
@@ -1000,6 +2020,12 @@ LASwaveMonitor::setFields ()
   bBackgroundPalette.setColor (QPalette::Normal, QPalette::Button, backgroundColor);
   bBackgroundPalette.setColor (QPalette::Inactive, QPalette::Button, backgroundColor);
   bBackgroundColor->setPalette (bBackgroundPalette);
+
+
+  halfLife->setValue (persist_half_life);
+  historySize->setValue (history_size);
+  historyMemory->setValue (history_memory);
+  historyOverlay->setValue (history_overlay);
 }
 
 
@@ -1095,6 +2121,52 @@ LASwaveMonitor::slotPrefs ()
   vbox->addWidget (cbox, 1);
 
 
+  QGroupBox *pbox = new QGroupBox (tr ("Persistence"), this);
+  QHBoxLayout *pboxLayout = new QHBoxLayout;
+  pbox->setLayout (pboxLayout);
+
+  halfLife = new QSpinBox (pbox);
+  halfLife->setRange (50, 60000);
+  halfLife->setSingleStep (100);
+  halfLife->setSuffix (tr (" ms"));
+  halfLife->setToolTip (tr ("Time for the persistence display to fade to half brightness"));
+  halfLife->setWhatsThis (halfLifeText);
+  pboxLayout->addWidget (new QLabel (tr ("Half life"), pbox));
+  pboxLayout->addWidget (halfLife, 1);
+
+  vbox->addWidget (pbox, 1);
+
+
+  QGroupBox *hbox = new QGroupBox (tr ("History"), this);
+  QHBoxLayout *hboxLayout = new QHBoxLayout;
+  hbox->setLayout (hboxLayout);
+
+  historySize = new QSpinBox (hbox);
+  historySize->setRange (1, WAVE_HISTORY_MAX_SIZE);
+  historySize->setSingleStep (64);
+  historySize->setToolTip (tr ("Number of waveforms kept in the history"));
+  historySize->setWhatsThis (historySizeText);
+  hboxLayout->addWidget (new QLabel (tr ("Size"), hbox));
+  hboxLayout->addWidget (historySize, 1);
+
+  historyMemory = new QSpinBox (hbox);
+  historyMemory->setRange (1, WAVE_HISTORY_MAX_MEMORY);
+  historyMemory->setSuffix (tr (" MB"));
+  historyMemory->setToolTip (tr ("Maximum memory used by the history"));
+  historyMemory->setWhatsThis (historyMemoryText);
+  hboxLayout->addWidget (new QLabel (tr ("Memory"), hbox));
+  hboxLayout->addWidget (historyMemory, 1);
+
+  historyOverlay = new QSpinBox (hbox);
+  historyOverlay->setRange (0, WAVE_HISTORY_MAX_OVERLAY);
+  historyOverlay->setToolTip (tr ("Number of previous waveforms drawn under the current waveform"));
+  historyOverlay->setWhatsThis (historyOverlayText);
+  hboxLayout->addWidget (new QLabel (tr ("Overlay"), hbox));
+  hboxLayout->addWidget (historyOverlay, 1);
+
+  vbox->addWidget (hbox, 1);
+
+
   QHBoxLayout *actions = new QHBoxLayout (0);
   vbox->addLayout (actions);
 
@@ -1120,6 +2192,11 @@ LASwaveMonitor::slotPrefs ()
 
   setFields ();
 
+  connect (halfLife, SIGNAL (valueChanged (int)), this, SLOT (slotHalfLife (int)));
+  connect (historySize, SIGNAL (valueChanged (int)), this, SLOT (slotHistorySize (int)));
+  connect (historyMemory, SIGNAL (valueChanged (int)), this, SLOT (slotHistoryMemory (int)));
+  connect (historyOverlay, SIGNAL (valueChanged (int)), this, SLOT (slotHistoryOverlay (int)));
+
 
   prefsD->show ();
 }
@@ -1218,8 +2295,7 @@ LASwaveMonitor::slotBackgroundColor ()
 void 
 LASwaveMonitor::scaleWave (int32_t x, int32_t y, int32_t *new_x, int32_t *new_y, NVMAP_DEF l_mapdef, BOUNDS *bnds)
 {
-  *new_y = NINT (((float) (x - bnds->min_x) / (float) bnds->range_x) * (float) l_mapdef.draw_height);
-  *new_x = NINT (((float) (y - bnds->min_y) / (float) bnds->range_y) * (float) l_mapdef.draw_width);
+  wave_plot_scale (x, y, new_x, new_y, l_mapdef.draw_width, l_mapdef.draw_height, bnds);
 }
 
 
@@ -1227,293 +2303,241 @@ LASwaveMonitor::scaleWave (int32_t x, int32_t y, int32_t *new_x, int32_t *new_y,
 void 
 LASwaveMonitor::slotPlotWaves (NVMAP_DEF l_mapdef)
 {
-  static std::vector<uint32_t> save_sample;
+  static SLAS_SAMPLES     save_sample;
   static SLAS_POINT_DATA  save_slas;
   static QString          save_name;
-  static LASheader        save_lasheader;
+  static SLAS_HEADER      save_lasheader;
   static BOUNDS           save_bounds;
-  int32_t                 pix_x[2], pix_y[2];
-  QString                 stat;
-  int64_t                 las_timestamp, tv_sec;
-  int32_t                 year, day, mday, month, hour, minute;
-  float                   second;
+  static uint8_t          save_history = NVFalse;
+  static WAVE_STATS       save_stats;
 
 
   if (!wave_read) return;
 
 
+  //  A persistence fade frame redraws the last point so there's nothing new to save.
+
+  uint8_t fade_only = persist_fade;
+  persist_fade = NVFalse;
+
+  uint8_t from_history = history_show;
+  history_show = NVFalse;
+
+
   //  Because the trackCursor function may be changing the data while we're still plotting it we save it
   //  to this static structure.  lock_track stops trackCursor from updating while we're trying to get an
   //  atomic snapshot of the data for the latest point.
 
-  lock_track = NVTrue;
+  //  When stepping through the history the snapshot is drawn instead.
 
-  try
-    {
-      save_sample.resize (bounds.length);
-    }
-  catch (std::bad_alloc&)
+  if (from_history)
     {
-      fprintf (stderr, "%s %s %s %d - save_sample - %s\n", progname, __FILE__, __FUNCTION__, __LINE__, strerror (errno));
-      abeShare->detach ();
-      exit (-1);
-    }
-
-  save_sample = sample;
-  sample.clear ();
-  save_slas = slas;
-  save_lasheader = lasheader;
-  save_bounds = bounds;
+      const WAVE_SNAPSHOT *snap = wave_history_get (&history, history_pos);
 
-  lock_track = NVFalse;
+      if (!snap) return;
 
+      save_sample = snap->samples;
+      save_slas = snap->slas;
+      save_lasheader = *snap->header;
+      save_bounds = snap->bounds;
+      save_stats = snap->stats;
+      save_history = NVTrue;
+    }
+  else if (!fade_only)
+    {
+      lock_track = NVTrue;
 
-  //  Draw the axes
+      //  Take the samples instead of copying them (sample is cleared for the next point anyway).
 
-  int32_t inc_x = bounds.length / 5;
-  int32_t inc_y = bounds.height / 5;
-  int32_t x_tics = bounds.length / inc_x + 1;
-  int32_t y_tics = bounds.height / inc_y + 1;
+      save_sample.swap (sample);
+      sample.clear ();
+      save_slas = slas;
+      save_lasheader = lasheader;
+      save_bounds = bounds;
+      save_stats = wave_stats;
+      save_history = NVFalse;
 
-  scaleWave (0, 0, &pix_x[0], &pix_y[0], l_mapdef, &save_bounds);
-  scaleWave (0, bounds.length, &pix_x[1], &pix_y[1], l_mapdef, &save_bounds);
+      if (save_sample.size ())
+        wave_history_push (&history, filename, recnum, &save_lasheader, &save_slas, &save_bounds, &save_stats, save_sample);
 
-  map->drawLine (pix_x[0], pix_y[0], pix_x[1], pix_y[1], Qt::gray, 2, NVFalse, Qt::SolidLine);
+      lock_track = NVFalse;
+    }
 
-  scaleWave (0, 0, &pix_x[0], &pix_y[0], l_mapdef, &save_bounds);
-  scaleWave (bounds.height, 0, &pix_x[1], &pix_y[1], l_mapdef, &save_bounds);
 
-  map->drawLine (pix_x[0], pix_y[0], pix_x[1], pix_y[1], Qt::gray, 2, NVFalse, Qt::SolidLine);
+  //  In persistence mode the accumulated waveforms are drawn first.  The buffer is faded by the time since the last
+  //  frame and then the new waveform (if there is one) is added.
 
-  for (int32_t i = 0 ; i < x_tics ; i++)
+  if (persist_mode)
     {
-      int32_t num = i * inc_x;
+      int64_t now = persistClock.elapsed ();
 
-      scaleWave (num, 0, &pix_x[0], &pix_y[0], l_mapdef, &save_bounds);
-      scaleWave (num, -2, &pix_x[1], &pix_y[1], l_mapdef, &save_bounds);
+      wave_persist_colors (&persist, backgroundColor.rgb (), waveColor.rgb ());
+      wave_persist_resize (&persist, l_mapdef.draw_width, l_mapdef.draw_height, &save_bounds);
+      wave_persist_decay (&persist, (float) (now - persist_frame_time));
+      if (persist_new && !fade_only) wave_persist_add (&persist, save_sample, wave_line_mode);
 
-      map->drawLine (pix_x[0], pix_y[0], pix_x[1], pix_y[1], Qt::gray, 2, NVFalse, Qt::SolidLine);
+      persist_new = NVFalse;
+      persist_frame_time = now;
 
-      QString number;
-      number.setNum (num);
-      scaleWave (num + 4, -22, &pix_x[1], &pix_y[1], l_mapdef, &save_bounds);
-      map->drawText (number, pix_x[1], pix_y[1], 90.0, 8, Qt::gray, NVTrue);
+      QImage image ((const uchar *) persist.image.data (), persist.width, persist.height, QImage::Format_RGB32);
+      QPixmap pixmap = QPixmap::fromImage (image);
+
+      map->drawPixmap (0, 0, &pixmap, 0, 0, persist.width, persist.height, NVFalse);
     }
 
-  for (int32_t i = 0 ; i < y_tics ; i++)
-    {
-      int32_t num = i * inc_y;
 
-      scaleWave (0, num, &pix_x[0], &pix_y[0], l_mapdef, &save_bounds);
-      scaleWave (-2, num, &pix_x[1], &pix_y[1], l_mapdef, &save_bounds);
+  //  The plot is drawn by the same code that the render and benchmark modes use (see wave_plot.cpp).
 
-      map->drawLine (pix_x[0], pix_y[0], pix_x[1], pix_y[1], Qt::gray, 2, NVFalse, Qt::SolidLine);
+  WAVE_PLOT_CANVAS canvas;
+  WAVE_PLOT_STYLE style;
 
-      QString number;
-      number.setNum (num);
-      scaleWave (-10, num - 10, &pix_x[1], &pix_y[1], l_mapdef, &save_bounds);
-      map->drawText (number, pix_x[1], pix_y[1], 90.0, 8, Qt::gray, NVTrue);
-    }
+  canvas.map = map;
+  canvas.painter = NULL;
+  canvas.draw_width = l_mapdef.draw_width;
+  canvas.draw_height = l_mapdef.draw_height;
 
+  style.wave_color = waveColor;
+  style.primary_color = primaryColor;
+  style.background_color = backgroundColor;
+  style.wave_line_mode = wave_line_mode;
 
-  //  Draw the waveform.
+  wave_plot_draw_axes (&canvas, &save_bounds);
 
-  scaleWave (1, save_sample[0], &pix_x[0], &pix_y[0], l_mapdef, &save_bounds);
 
-  for (int32_t i = 1 ; i < save_bounds.length ; i++)
-    {
-      scaleWave (i, save_sample[i], &pix_x[1], &pix_y[1], l_mapdef, &save_bounds);
+  //  Overlay the waveforms that were displayed before this one.
 
-      if (wave_line_mode)
-        {
-          map->drawLine (pix_x[0], pix_y[0], pix_x[1], pix_y[1], waveColor, 2, NVFalse, Qt::SolidLine);
-        }
-      else
-        {
-          map->fillRectangle (pix_x[0], pix_y[0], SPOT_SIZE, SPOT_SIZE, waveColor, NVFalse);
-        }
-      pix_x[0] = pix_x[1];
-      pix_y[0] = pix_y[1];
-    }
+  if (history_overlay && !persist_mode) drawHistoryOverlay (l_mapdef, &save_bounds, save_history ? history_pos : 0);
 
 
-  //  Figure out where the return location is on the waveform.
+  //  Draw the waveform (unless it's already in the persistence display), the return point, and the baseline, peak, and
+  //  pulse width.  Waveforms from the history aren't in the persistence display so they're always drawn.
 
-  int32_t bin = save_slas.return_point_waveform_location / save_bounds.temporal_spacing;
+  wave_plot_draw_wave (&canvas, &save_bounds, save_sample, save_slas.return_point_waveform_location, &save_stats,
+                       !persist_mode || save_history, &style);
 
-  scaleWave (bin, save_sample[bin], &pix_x[0], &pix_y[0], l_mapdef, &save_bounds);
-  drawX (pix_x[0], pix_y[0], 10, 2, primaryColor);
 
+  //  Show where we are in the history.
 
-  save_sample.clear ();
+  if (save_history && history_pos)
+    {
+      string = tr ("History %1 of %2").arg (history_pos).arg (history.count - 1);
+      map->drawText (string, 10, 20, 90.0, 10, primaryColor, NVTrue);
+    }
 
 
-  //  Set the status bar labels
+  //  The persistence fade frames still need the samples for the return point marker.
 
-  if (save_lasheader.point_data_format != 2)
-    {
-      if (save_lasheader.global_encoding & 0x01)
-        {
-	  //  Note, GPS time is ahead of UTC time by some number of leap seconds depending on the date of the survey.
-	  //  The leap seconds that are relevant for CHARTS and/or CZMIL data are as follows
-	  //
-	  //  December 31 2005 23:59:59 - 1136073599 - 14 seconds ahead
-	  //  December 31 2008 23:59:59 - 1230767999 - 15 seconds ahead
-	  //  June 30 2012 23:59:59     - 1341100799 - 16 seconds ahead
-	  //  June 30 2015 23:59:59     - 1435708799 - 17 seconds ahead
-
-	  las_time_offset = 1000000000.0 - 13.0;
-
-	  tv_sec = slas.gps_time + gps_start_time + las_time_offset;
-	  if (tv_sec > 1136073599) las_time_offset -= 1.0;
-	  if (tv_sec > 1230767999) las_time_offset -= 1.0;
-	  if (tv_sec > 1341100799) las_time_offset -= 1.0;
-	  if (tv_sec > 1435708799) las_time_offset -= 1.0;
-
-          las_timestamp = (int64_t) ((slas.gps_time + gps_start_time + las_time_offset) * 1000000.0);
-          time_t tv_sec = las_timestamp / 1000000;
-          long tv_nsec = las_timestamp % 1000000;
-
-          cvtime (tv_sec, tv_nsec, &year, &day, &hour, &minute, &second);
-          jday2mday (year, day, &month, &mday);
-          month++;
-
-          string.sprintf ("<b>Date/time : </b>%d-%02d-%02d (%03d) %02d:%02d:%05.2f", year + 1900, month, mday, day, hour, minute, second);
-        }
-      else
-        {
-          string.sprintf ("<b>GPS seconds : </b>%.6f", save_slas.gps_time);
-        }
-    }
+  if (!persist_mode) save_sample.clear ();
 
-  dateLabel->setText (string);
+  if (fade_only) return;
 
-  string.sprintf ("<b>Intensity : </b>%hd", save_slas.intensity);
-  intensity->setText (string);
 
-  string.sprintf ("<b>Return : </b>%d", save_slas.return_number);
-  returnNum->setText (string);
+  //  Set the status bar labels
 
-  string.sprintf ("<b>Number of returns : </b>%d", save_slas.number_of_returns);
-  numReturns->setText (string);
+  QString labels[WAVE_PLOT_LABELS];
+  QLabel *label[WAVE_PLOT_LABELS] = {dateLabel, intensity, returnNum, numReturns, synthetic, keypoint, withheld, overlap, scannerChan,
+                                     scanDir, edge, classification, userData, scanAngle, pointSource, red, green, blue, NIR, wdi, bowd,
+                                     wps, rpwl, Xt, Yt, Zt};
 
-  string.sprintf ("<b>Synthetic : </b>%d", save_slas.synthetic);
-  synthetic->setText (string);
+  wave_plot_labels (&save_lasheader, &save_slas, gps_start_time, labels);
 
-  string.sprintf ("<b>Keypoint : </b>%d", save_slas.keypoint);
-  keypoint->setText (string);
+  for (int32_t i = 0 ; i < WAVE_PLOT_LABELS ; i++) label[i]->setText (labels[i]);
 
-  string.sprintf ("<b>Withheld : </b>%d", save_slas.withheld);
-  withheld->setText (string);
 
-  string.sprintf ("<b>Overlap : </b>%d", save_slas.overlap);
-  overlap->setText (string);
+  //  The waveform analytics (of the whole waveform, see trackCursor).  Sample locations are from the start of the waveform.
 
-  if (save_lasheader.point_data_format > 5)
+  if (save_stats.valid)
     {
-      string.sprintf ("<b>Scanner channel : </b>%d", save_slas.scanner_channel);
+      waveBaseline->setText (QString ("%1 (%2)").arg (save_stats.baseline, 0, 'f', 1).arg (save_stats.noise, 0, 'f', 1));
+      wavePeak->setText (QString ("%1 @ %2").arg (save_stats.peak_amplitude, 0, 'f', 1)
+                         .arg (save_stats.peak_location, 0, 'f', 2));
+      waveFWHM->setText (QString ("%1 (%2 ns)").arg (save_stats.fwhm, 0, 'f', 2)
+                         .arg (save_stats.fwhm * save_bounds.temporal_spacing / 1000.0, 0, 'f', 2));
+      waveEnergy->setText (QString::number (save_stats.energy, 'f', 0));
+      waveSaturated->setText (QString::number (save_stats.saturated));
     }
   else
     {
-      string = "<b>Scanner channel : </b>N/A";
+      waveBaseline->setText (tr ("N/A"));
+      wavePeak->setText (tr ("N/A"));
+      waveFWHM->setText (tr ("N/A"));
+      waveEnergy->setText (tr ("N/A"));
+      waveSaturated->setText (tr ("N/A"));
+    }
+
+
+  //  The new record is on the screen (--metrics).
+
+  if (metrics_pending && !from_history)
+    {
+      slas_metrics_latency (metricsClock.nsecsElapsed () / 1000000000.0);
+      slas_metrics_add (SLAS_METRIC_RECORDS_DISPLAYED, 1);
+      metrics_pending = NVFalse;
     }
-  scannerChan->setText (string);
 
-  string.sprintf ("<b>Scan direction flag : </b>%d", save_slas.scan_direction_flag);
-  scanDir->setText (string);
 
-  string.sprintf ("<b>Edge of flightline flag : </b>%d", save_slas.edge_of_flightline);
-  edge->setText (string);
+  if (!startup_reported)
+    {
+      startupMark (tr ("First waveform drawn"));
+      startupReport ();
+    }
+}
 
-  string.sprintf ("<b>Classification : </b>%d", save_slas.classification);
-  classification->setText (string);
 
-  string.sprintf ("<b>User data : </b>%d", save_slas.user_data);
-  userData->setText (string);
 
-  string.sprintf ("<b>Scan angle : </b>%d", save_slas.scan_angle);
-  scanAngle->setText (string);
+//  Draw the history_overlay waveforms that were displayed before the one at base (in the history) with the scale of the
+//  current plot.  Older waveforms fade toward the background color.  Only the samples in the current window are drawn.
 
-  string.sprintf ("<b>Point source ID : </b>%d", save_slas.point_source_id);
-  pointSource->setText (string);
+void 
+LASwaveMonitor::drawHistoryOverlay (NVMAP_DEF l_mapdef, BOUNDS *bnds, int32_t base)
+{
+  int32_t pix_x[2], pix_y[2];
 
-  QString R, G, B;
 
-  if (save_lasheader.point_data_format == 2 || save_lasheader.point_data_format == 3 || save_lasheader.point_data_format == 5 ||
-      save_lasheader.point_data_format == 7 || save_lasheader.point_data_format == 8 || save_lasheader.point_data_format == 10)
-    {
-      R.sprintf ("<b>Red : </b>%hd", save_slas.red);
-      G.sprintf ("<b>Green : </b>%hd", save_slas.green);
-      B.sprintf ("<b>Blue : </b>%hd", save_slas.blue);
-    }
-  else
+  //  Oldest first so the newer ones are on top.
+
+  for (int32_t k = history_overlay ; k > 0 ; k--)
     {
-      R = "<b>Red : </b>N/A";
-      G = "<b>Green : </b>N/A";
-      B = "<b>Blue : </b>N/A";
-    }
+      const WAVE_SNAPSHOT *snap = wave_history_get (&history, base + k);
 
-  red->setText (R);
-  green->setText (G);
-  blue->setText (B);
+      if (!snap) continue;
 
-  if (save_lasheader.point_data_format == 8 || save_lasheader.point_data_format == 10)
-    {
-      string.sprintf ("<b>NIR : </b>%hd", save_slas.NIR);
-    }
-  else
-    {
-      string = "<b>NIR : </b>N/A";
-    }
-  NIR->setText (string);
 
-  QString wdi_s, bowd_s, wps_s, rpwl_s, Xt_s, Yt_s, Zt_s;
+      float t = (float) k / (float) (history_overlay + 1);
 
-  if (save_lasheader.point_data_format == 4 || save_lasheader.point_data_format == 5 || save_lasheader.point_data_format == 9 ||
-      save_lasheader.point_data_format == 10)
-    {
-      wdi_s.sprintf ("<b>Waveform descriptor index : </b>%d", save_slas.wavepacket_descriptor_index);
+      QColor color (waveColor.red () + NINT ((backgroundColor.red () - waveColor.red ()) * t),
+                    waveColor.green () + NINT ((backgroundColor.green () - waveColor.green ()) * t),
+                    waveColor.blue () + NINT ((backgroundColor.blue () - waveColor.blue ()) * t));
 
-#ifdef _WIN32
-      bowd_s.sprintf ("<b>Byte offset to waveforms : </b>%I64d", save_slas.byte_offset_to_waveform_data);
-#else
-      bowd_s.sprintf ("<b>Byte offset to waveforms : </b>%ld", save_slas.byte_offset_to_waveform_data);
-#endif
-      wps_s.sprintf ("<b>Waveform packet size : </b>%d", save_slas.waveform_packet_size);
-      rpwl_s.sprintf ("<b>Return point waveform location : </b>%.2f", save_slas.return_point_waveform_location);
-      Xt_s.sprintf ("<b>X(t) : </b>%.11f", save_slas.Xt);
-      Yt_s.sprintf ("<b>Y(t) : </b>%.11f", save_slas.Yt);
-      Zt_s.sprintf ("<b>Z(t) : </b>%.11f", save_slas.Zt);
-    }
-  else
-    {
-      wdi_s = "<b>Waveform descriptor index : </b>N/A";
-      bowd_s = "<b>Byte offset to waveforms : </b>N/A";
-      wps_s = "<b>Waveform packet size : </b>N/A";
-      rpwl_s = "<b>Return point waveform location : </b>N/A";
-      Xt_s = "<b>X(t) : </b>N/A";
-      Yt_s = "<b>Y(t) : </b>N/A";
-      Zt_s = "<b>Z(t) : </b>N/A<";
-    }
 
-  wdi->setText (wdi_s);
-  bowd->setText (bowd_s);
-  wps->setText (wps_s);
-  rpwl->setText (rpwl_s);
-  Xt->setText (Xt_s);
-  Yt->setText (Yt_s);
-  Zt->setText (Zt_s);
-}
+      uint8_t have_prev = NVFalse;
 
+      for (uint32_t i = 0 ; i < snap->samples.size () ; i++)
+        {
+          int32_t num = snap->bounds.first + i;
 
+          if (num < bnds->first || num >= bnds->first + bnds->length)
+            {
+              have_prev = NVFalse;
+              continue;
+            }
 
-void 
-LASwaveMonitor::drawX (int32_t x, int32_t y, int32_t size, int32_t width, QColor color)
-{
-  int32_t hs = size / 2;
+          scaleWave (num, qMin ((int32_t) snap->samples[i], bnds->height), &pix_x[1], &pix_y[1], l_mapdef, bnds);
+
+          if (!wave_line_mode)
+            {
+              map->fillRectangle (pix_x[1], pix_y[1], SPOT_SIZE, SPOT_SIZE, color, NVFalse);
+            }
+          else if (have_prev)
+            {
+              map->drawLine (pix_x[0], pix_y[0], pix_x[1], pix_y[1], color, 1, NVFalse, Qt::SolidLine);
+            }
 
-  map->drawLine (x - hs, y + hs, x + hs, y - hs, color, width, NVTrue, Qt::SolidLine);
-  map->drawLine (x + hs, y + hs, x - hs, y - hs, color, width, NVTrue, Qt::SolidLine);
+          pix_x[0] = pix_x[1];
+          pix_y[0] = pix_y[1];
+          have_prev = NVTrue;
+        }
+    }
 }
 
 
@@ -1527,6 +2551,13 @@ LASwaveMonitor::slotRestoreDefaults ()
   width = WAVE_X_SIZE;
   height = WAVE_Y_SIZE;
   wave_line_mode = NVTrue;
+  persist_mode = NVFalse;
+  persist_half_life = WAVE_PERSIST_DEFAULT_HALF_LIFE;
+  history_size = WAVE_HISTORY_DEFAULT_SIZE;
+  history_memory = WAVE_HISTORY_DEFAULT_MEMORY;
+  history_overlay = WAVE_HISTORY_DEFAULT_OVERLAY;
+  echogram_mode = NVFalse;
+  echogram_order = SLAS_ECHOGRAM_RECORD_ORDER;
   window_x = 0;
   window_y = 0;
   waveColor = Qt::white;
@@ -1536,7 +2567,12 @@ LASwaveMonitor::slotRestoreDefaults ()
 
   //  The first time will be called from envin and the prefs dialog won't exist yet.
 
-  if (!first) setFields ();
+  if (!first)
+    {
+      setFields ();
+      bPersist->setChecked (persist_mode);
+      bEchogram->setChecked (echogram_mode);
+    }
   first = NVFalse;
 
   force_redraw = NVTrue;
@@ -1556,6 +2592,27 @@ LASwaveMonitor::about ()
 void
 LASwaveMonitor::slotAcknowledgments ()
 {
+  //  Read the acknowledgments file for the Acknowledgments Help button.  This way I only have
+  //  to change one file and copy it to the other programs icon folders to change the Acknowledgments
+  //  Help text instead of changing it in every single program I use it in.  It's only read the first
+  //  time it's needed.
+
+  if (acknowledgmentsText.isEmpty ())
+    {
+      QFile aDataFile (":/icons/ACKNOWLEDGMENTS");
+
+      if (aDataFile.open (QIODevice::ReadOnly))
+        {
+          char string[256];
+
+          while (aDataFile.readLine (string, sizeof (string)) > 0)
+            {
+              acknowledgmentsText.append (string);
+            }
+          aDataFile.close ();
+        }
+    }
+
   QMessageBox::about (this, VERSION, acknowledgmentsText);
 }
 
@@ -1637,6 +2694,20 @@ LASwaveMonitor::envin ()
 
   wave_line_mode = settings.value (tr ("Wave line mode flag"), wave_line_mode).toBool ();
 
+  persist_mode = settings.value (tr ("Persistence mode flag"), persist_mode).toBool ();
+
+  persist_half_life = settings.value (tr ("Persistence half life"), persist_half_life).toInt ();
+
+  history_size = settings.value (tr ("History size"), history_size).toInt ();
+
+  history_memory = settings.value (tr ("History memory"), history_memory).toInt ();
+
+  history_overlay = settings.value (tr ("History overlay"), history_overlay).toInt ();
+
+  echogram_mode = settings.value (tr ("Echogram window flag"), echogram_mode).toBool ();
+
+  echogram_order = settings.value (tr ("Echogram order"), echogram_order).toInt ();
+
   int32_t r = settings.value (tr ("Wave color/red"), waveColor.red ()).toInt ();
   int32_t g = settings.value (tr ("Wave color/green"), waveColor.green ()).toInt ();
   int32_t b = settings.value (tr ("Wave color/blue"), waveColor.blue ()).toInt ();
@@ -1708,6 +2779,20 @@ LASwaveMonitor::envout ()
 
   settings.setValue (tr ("Wave line mode flag"), wave_line_mode);
 
+  settings.setValue (tr ("Persistence mode flag"), persist_mode);
+
+  settings.setValue (tr ("Persistence half life"), persist_half_life);
+
+  settings.setValue (tr ("History size"), history_size);
+
+  settings.setValue (tr ("History memory"), history_memory);
+
+  settings.setValue (tr ("History overlay"), history_overlay);
+
+  settings.setValue (tr ("Echogram window flag"), echogram_mode);
+
+  settings.setValue (tr ("Echogram order"), echoView ? echoView->getOrder () : echogram_order);
+
 
   settings.setValue (tr ("Wave color/red"), waveColor.red ());
   settings.setValue (tr ("Wave color/green"), waveColor.green ());
@@ -47,6 +47,8 @@
 #include <sys/types.h>
 #include <getopt.h>
 #include <cmath>
+#include <thread>
+#include <atomic>
 
 #include "nvutility.h"
 #include "nvutility.hpp"
@@ -56,6 +58,17 @@
 
 #include "lasreader.hpp"
 #include "slas.hpp"
+#include "slas_catalog.hpp"
+#include "slas_shared_cache.hpp"
+#include "record_ring.hpp"
+#include "slas_wdc.hpp"
+#include "slaz.hpp"
+#include "wave_plot.hpp"
+#include "wave_persist.hpp"
+#include "wave_history.hpp"
+#include "wave_stats.hpp"
+#include "echogram.hpp"
+#include "metrics_server.hpp"
 
 #include "version.hpp"
 
@@ -70,6 +83,14 @@
 #define WAVE_X_SIZE       440
 #define WAVE_Y_SIZE       620
 #define SPOT_SIZE         2
+#define MIN_ZOOM_SAMPLES  10
+
+#define TAIL_CHECK_INTERVAL       500      //  Milliseconds
+#define RECORD_RING_RETRY         1000     //  Milliseconds between tries to attach to the parent's record ring
+#define STARTUP_DEFER_DELAY       500      //  Milliseconds after the window is built to set up things the first waveform doesn't need
+
+#define FAILED_OPEN_MIN_BACKOFF   1000     //  Milliseconds
+#define FAILED_OPEN_MAX_BACKOFF   60000
 
 #define GCS_NAD83 4269
 #define GCS_WGS_84 4326
@@ -88,19 +109,18 @@
 
 
 
+//  Negative cache entry for files that failed to open.
+
 typedef struct
 {
-  int32_t             min_x;
-  int32_t             max_x;
-  int32_t             min_y;
-  int32_t             max_y;
-  int32_t             range_x;
-  int32_t             range_y;
-  int32_t             length;
-  int32_t             height;
-  uint32_t            temporal_spacing;
-  uint32_t            buffer_size;
-} BOUNDS;
+  QString             path;            //  The file that failed (the LAS file or its .wdp file)
+  QString             reason;
+  uint8_t             exists;
+  int64_t             size;
+  int64_t             mtime;
+  int64_t             backoff;         //  Milliseconds
+  int64_t             next_check;      //  Milliseconds since failClock was started
+} FAILED_OPEN;
 
 
 class LASwaveMonitor:public QMainWindow
@@ -113,6 +133,8 @@ public:
   LASwaveMonitor (int32_t *argc = 0, char **argv = 0, QWidget *parent = 0);
   ~LASwaveMonitor ();
 
+  static QElapsedTimer startupClock;   //  Started by main so the startup timing report (--timing) includes QApplication
+
 
 protected:
 
@@ -130,29 +152,119 @@ protected:
 
   char            filename[512], progname[256];
 
-  int32_t         recnum;
+  uint64_t        recnum;
 
   uint8_t         wave_line_mode, lock_track, endian;
 
-  double          gps_start_time;  //  For LAS data using GPS time instead of GPS seconds of the week.
+  uint8_t         persist_mode, persist_new, persist_fade;   //  Persistence display
+
+  int32_t         persist_half_life;
+
+  WAVE_PERSIST    persist;
+
+  QElapsedTimer   persistClock;
+
+  int64_t         persist_frame_time;
+
+  QTimer          *persistTimer;
+
+  WAVE_HISTORY    history;         //  The last waveforms that were displayed
+
+  int32_t         history_pos;     //  How far back in the history the displayed waveform is (0 is the current record)
+
+  int32_t         history_size, history_memory, history_overlay;
+
+  uint8_t         history_show;    //  Draw the history_pos snapshot instead of the record that was just read
+
+  uint8_t         echogram_mode;   //  Echogram (waterfall) window
+
+  int32_t         echogram_order;
+
+  echogram        *echoView;
+
+  uint8_t         startup_timing, startup_reported;   //  Startup timing report (--timing)
+
+  QStringList     startupNames;
+
+  QList<double>   startupTimes;
+
+  std::thread     firstRecordThread;   //  Reads the header of the first record while the window is being built
+
+  SLAS_HEADER     first_header;
+
+  char            first_filename[512];
+
+  uint64_t        first_recnum;
+
+  int32_t         first_status;
+
+  QString         metrics_path;    //  Metrics endpoint socket or directory (--metrics)
 
-  double          las_time_offset;
+  metricsServer   *metrics;
+
+  QElapsedTimer   metricsClock;    //  Started when trackCursor sees a new record
+
+  uint8_t         metrics_pending; //  A new record hasn't been drawn yet
+
+  uint8_t         tail_mode, tail_wait;        //  Tail mode (--tail) for files that are still being written
+
+  QFileSystemWatcher *tailWatcher;
+
+  QStringList     tailFiles;
+
+  QList<int64_t>  tailSizes;
+
+  double          gps_start_time;  //  For LAS data using GPS time instead of GPS seconds of the week.
 
   SLAS_POINT_DATA slas;
 
-  LASheader       lasheader;
+  SLAS_HEADER     lasheader;
+
+  SLAZ_HANDLE     *laz;
+
+  SLAS_WDC        *wdc;            //  Compressed waveform file used when there's no .wdp file
+
+  QString         wdc_file;
+
+  SLAS_CATALOG    *catalog;
+
+  std::thread     catalogThread;       //  Reads the LAS file list from the PFM(s) so the constructor doesn't have to
 
-  std::vector<uint32_t> sample;
+  std::atomic<uint8_t> catalog_listed; //  The file list is ready for startCatalogScan
+
+  std::vector<std::string> catalog_files;
+
+  QString         catalog_cache_file;
+
+  SLAS_SHARED_CACHE *sharedCache;
+
+  RECORD_RING     *recordRing;     //  Every record change from the parent (if it makes one)
+
+  int64_t         ring_next_attach;
+
+  uint8_t         catalog_reported;
+
+  int32_t         zoom_first, zoom_count;    //  Zoomed sample window (zoom_count of 0 means the whole waveform)
+
+  SLAS_SAMPLES    sample;          //  The samples in the zoom window
+
+  SLAS_SAMPLES    full_sample;     //  The whole waveform (what the analytics are computed from)
+
+  WAVE_STATS      wave_stats;
 
   int32_t         wave_read;
 
   QMessageBox     *filError;
 
-  QStatusBar      *statusBar[8];
+  QHash<QString, FAILED_OPEN> failedOpens;
+
+  QElapsedTimer   failClock;
+
+  QStatusBar      *statusBar[9];
 
   QLabel          *dateLabel, *intensity, *returnNum, *numReturns, *classFlags, *synthetic, *keypoint, *withheld, *overlap, *scannerChan,
                   *scanDir, *edge, *classification, *userData, *scanAngle, *pointSource, *red, *green, *blue, *NIR, *wdi, *bowd, *wps,
-                  *rpwl, *Xt, *Yt, *Zt, *curLoc;
+                  *rpwl, *Xt, *Yt, *Zt, *curLoc, *waveBaseline, *wavePeak, *waveFWHM, *waveEnergy, *waveSaturated;
 
   QColor          waveColor, primaryColor, backgroundColor;
 
@@ -174,7 +286,9 @@ protected:
 
   QDialog         *prefsD;
 
-  QToolButton     *bQuit, *bPrefs, *bMode;
+  QToolButton     *bQuit, *bPrefs, *bMode, *bPersist, *bEchogram;
+
+  QSpinBox        *halfLife, *historySize, *historyMemory, *historyOverlay;
 
   QString         pos_format, parentName, acknowledgmentsText, string;
 
@@ -182,12 +296,25 @@ protected:
   void envin ();
   void envout ();
 
-  void leftMouse (double x, double y);
-  void midMouse (double x, double y);
-  void rightMouse (double x, double y);
+  void leftMouse (int32_t x, int32_t y);
+  void midMouse (int32_t x, int32_t y);
+  void rightMouse (int32_t x, int32_t y);
+  void setZoom (int32_t first, int32_t count);
   void scaleWave (int32_t x, int32_t y, int32_t *new_x, int32_t *new_y, NVMAP_DEF l_mapdef, BOUNDS *bnds);
-  void drawX (int32_t x, int32_t y, int32_t size, int32_t width, QColor color);
+  void drawHistoryOverlay (NVMAP_DEF l_mapdef, BOUNDS *bnds, int32_t base);
   void setFields ();
+  uint8_t checkFailedOpen (QString las_name);
+  void setFailedOpen (QString las_name, QString path, QString reason);
+  void clearFailedOpen (QString las_name);
+  void updateErrorPanel ();
+  void startCatalog ();
+  void startCatalogScan ();
+  void reportCatalogFailures ();
+  void setTailWait (QString las_name, QString wave_name);
+  void drainRecordRing ();
+  void startFirstRecord ();
+  void startupMark (QString what);
+  void startupReport ();
 
 
 protected slots:
@@ -199,6 +326,7 @@ protected slots:
   void slotPlotWaves (NVMAP_DEF l_mapdef);
 
   void trackCursor ();
+  void slotTailCheck ();
 
   void slotKeyPress (QKeyEvent *e);
 
@@ -207,6 +335,15 @@ protected slots:
   void slotQuit ();
 
   void slotMode (bool state);
+  void slotPersist (bool state);
+  void slotPersistFrame ();
+  void slotHalfLife (int value);
+  void slotHistorySize (int value);
+  void slotHistoryMemory (int value);
+  void slotHistoryOverlay (int value);
+  void slotEchogram (bool state);
+  void slotEchogramClosed ();
+  void slotDeferredSetup ();
 
   void slotPrefs ();
   void slotPosClicked (int id);
@@ -1,5 +1,5 @@
 contains(QT_CONFIG, opengl): QT += opengl
-QT += 
+QT += network
 RESOURCES = icons.qrc
 INCLUDEPATH += /c/PFM_ABEv7.0.0_Win64/include
 LIBS += -L /c/PFM_ABEv7.0.0_Win64/lib -llas -lnvutility -lpfm -lgdal -lxml2 -lpoppler -liconv
@@ -18,7 +18,7 @@ DEPENDPATH += .
 INCLUDEPATH += .
 
 # Input
-HEADERS += LASwaveMonitor.hpp LASwaveMonitorHelp.hpp slas.hpp version.hpp
-SOURCES += LASwaveMonitor.cpp main.cpp slas.cpp
+HEADERS += LASwaveMonitor.hpp LASwaveMonitorHelp.hpp batch.hpp batch_benchmark.hpp batch_render.hpp batch_shard.hpp echogram.hpp metrics_server.hpp record_ring.hpp slas.hpp slas_batch.hpp slas_block.hpp slas_catalog.hpp slas_echogram.hpp slas_metrics.hpp slas_rewrite.hpp slas_samples.hpp slas_shared_cache.hpp slas_wdc.hpp slaz.hpp version.hpp wave_history.hpp wave_persist.hpp wave_plot.hpp wave_stats.hpp
+SOURCES += LASwaveMonitor.cpp batch.cpp batch_benchmark.cpp batch_render.cpp batch_shard.cpp echogram.cpp main.cpp metrics_server.cpp record_ring.cpp slas.cpp slas_batch.cpp slas_block.cpp slas_catalog.cpp slas_echogram.cpp slas_metrics.cpp slas_rewrite.cpp slas_shared_cache.cpp slas_wdc.cpp slaz.cpp wave_history.cpp wave_persist.cpp wave_plot.cpp wave_stats.cpp
 RESOURCES += icons.qrc
 TRANSLATIONS += LASwaveMonitor_xx.ts
@@ -43,6 +43,42 @@ QString modeText =
   LASwaveMonitor::tr ("<img source=\":/icons/mode_line.png\"> <img source=\":/icons/mode_dot.png\"> Click this button to toggle between "
                       "line and dot drawing modes for the wave display.  When selected the waves are drawn as lines, when unselected the "
                       "waves are drawn as discrete dots.");
+QString persistText = 
+  LASwaveMonitor::tr ("<img source=\":/icons/mode_persist.png\"> Click this button to toggle the persistence display.  When "
+                      "selected, every waveform that is displayed is added to the display and fades away over time (like an "
+                      "oscilloscope with persistence) so you can see the spread of the waveform shapes as you move over the data.  "
+                      "Places where many waveforms overlap are drawn brighter, going from the waveform color to white.  "
+                      "The fade time is set in the Preferences dialog.  The display is cleared when the waveform length, the "
+                      "zoom, or the window size changes.");
+
+QString echogramText = 
+  LASwaveMonitor::tr ("<img source=\":/icons/echogram.png\"> Click this button to open the echogram window.  The echogram shows "
+                      "the waveforms of all of the points in the current LAS file side by side (like a sonar echogram) with the first "
+                      "sample at the top, so you can follow the water surface, the water column, and the bottom along the "
+                      "flightline.  The current point is marked with the return point marker color.  The waveforms are read in "
+                      "the background so the echogram fills in as they are read.<br><br>"
+                      "Use the mouse wheel (or the <b>+</b> and <b>-</b> keys) to zoom in and out, drag with the <b>left</b> "
+                      "mouse button (or use the <b>Left</b>, <b>Right</b>, <b>Home</b>, and <b>End</b> keys) to move along the "
+                      "file, and press <b>F</b> (or <b>Space</b>) to go back to following the cursor.  The <b>right</b> mouse "
+                      "button menu switches between point record order and GPS time order and reloads the file (to pick up new "
+                      "points in tail mode).");
+
+QString halfLifeText = 
+  LASwaveMonitor::tr ("Set the time, in milliseconds, that it takes for waveforms in the persistence display to fade to half of "
+                      "their brightness.");
+
+QString historySizeText = 
+  LASwaveMonitor::tr ("Set the number of waveforms that are kept in the history.  The <b>Left</b> and <b>Right</b> arrow keys step "
+                      "through the history.  Changing this clears the history.");
+
+QString historyMemoryText = 
+  LASwaveMonitor::tr ("Set the maximum amount of memory, in megabytes, used by the history.  If the waveforms are large the oldest "
+                      "ones are dropped before the history is full.  Changing this clears the history.");
+
+QString historyOverlayText = 
+  LASwaveMonitor::tr ("Set the number of previous waveforms that are drawn under the current waveform.  Older waveforms fade toward "
+                      "the background color.  They are drawn with the current waveform's scale.  Set this to 0 to turn the overlay "
+                      "off.  The overlay isn't drawn in persistence mode.");
 
 QString quitText = 
   LASwaveMonitor::tr ("<img source=\":/icons/quit.png\"> Click this button to <b><em>exit</em></b> from the program.  "
@@ -50,6 +86,15 @@ QString quitText =
 QString mapText = 
   LASwaveMonitor::tr ("This is the LASwaveMonitor program, a companion to the pfmEdit3D program for viewing LAS "
                       "waveforms.<br><br>"
+                      "Click the <b>left</b> mouse button on the waveform to zoom in (by a factor of two) around that point, the "
+                      "<b>right</b> mouse button to zoom out, and the <b>middle</b> mouse button to go back to the whole waveform.  "
+                      "When zoomed in, the <b>Up</b> and <b>Down</b> arrow keys move through the waveform by half of the window and "
+                      "the <b>Page Up</b> and <b>Page Down</b> keys move by a whole window.  Only the part of the waveform that is "
+                      "displayed is read from the file.<br><br>"
+                      "The <b>Left</b> and <b>Right</b> arrow keys step back and forward through the waveforms that have been "
+                      "displayed (the history) without reading anything, and the <b>End</b> key goes back to the current point.  "
+                      "Moving the cursor in the parent program or zooming also goes back to the current point.  The previous "
+                      "waveforms can be drawn under the current one (see <b>Overlay</b> in the Preferences dialog).<br><br>"
                       "Help is available on most fields in LASwaveMonitor using the What's This pointer.");
 
 QString bGrpText = 
@@ -97,3 +142,20 @@ QString edgeText =
 
 QString NIRText = 
   LASwaveMonitor::tr ("This is the Near Infrared channel value.");
+
+QString analyticsText = 
+  LASwaveMonitor::tr ("These are computed from the samples of the waveform that is displayed (only the zoom window when zoomed "
+                      "in).  From left to right they are:<br><br>"
+                      "<ul><li>The <b>baseline</b>, and in parentheses the <b>noise</b> (standard deviation), of whichever end of "
+                      "the waveform is lower.  This is drawn as a dashed gray line.</li>"
+                      "<li>The <b>peak</b> amplitude above the baseline and its location in samples from the start of the waveform.  "
+                      "The peak is interpolated between samples with a parabola through the largest sample and its neighbors (or is "
+                      "the middle of a flat top).</li>"
+                      "<li>The pulse width (<b>FWHM</b>, full width at half maximum) of the peak pulse in samples and, in "
+                      "parentheses, nanoseconds.  This is drawn in the return point marker color as a line between the half "
+                      "maximum crossings with a dashed line up to the peak.</li>"
+                      "<li>The <b>energy</b>, the sum of the samples above the baseline (less the baseline) for the samples more "
+                      "than three times the noise above the baseline.</li>"
+                      "<li>The number of <b>saturated</b> samples (samples at 2<sup>bits per sample</sup> - 1).  If there are any, "
+                      "the full scale value is drawn as a dashed red line.</li></ul>");
+
@@ -0,0 +1,800 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! or / / ! are being used by Doxygen to
+    document the software.  Dashes in these comment blocks are used to create bullet lists.
+    The lack of blank lines after a block of dash preceeded comments means that the next
+    block of dash preceeded comments is a new, indented bullet list.  I've tried to keep the
+    Doxygen formatting to a minimum but there are some other items (like <br> and <pre>)
+    that need to be left alone.  If you see a comment that starts with / * ! or / / ! and
+    there is something that looks a bit weird it is probably due to some arcane Doxygen
+    syntax.  Be very careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+#include "batch.hpp"
+
+
+/*!  Batch mode lets us use the LAS waveform code without the GUI (or a PFM editor).  It is run as:
+
+     LASwaveMonitor --batch MODE [OPTIONS] ARGUMENTS
+
+     The modes are:
+
+     - rewrite [--hilbert] [--memory MB] INPUT_LAS OUTPUT_LAS
+       - Rewrite a LAS file and its .wdp file so that the waveform packets are in point record order (or Hilbert curve
+         order of the point positions with --hilbert).  See slas_rewrite.
+     - compress [--threads N] [--memory MB] LAS [LAS...]
+       - Compress the .wdp file of each LAS file to a .wdc file.  See slas_wdc_convert.
+     - qc [SHARD OPTIONS] OUTPUT LAS [LAS...]
+       - Write a CSV line of waveform statistics for every point record.
+     - extract [SHARD OPTIONS] OUTPUT LAS [LAS...]
+       - Write a CSV line with the waveform samples for every point record.
+     - benchmark [--samples LIST] [--sizes LIST] [--frames N] [--time MS] [--lines] [--dots] [--csv]
+       - Time offscreen redraws of the waveform plot for synthetic waveforms.  See batch_benchmark.
+
+     The qc and extract modes are split into shards that any number of processes (on any number of hosts that share the
+     shard directory) can work on at the same time.  See batch_shard.hpp.  */
+
+
+#define BATCH_QC                  0
+#define BATCH_EXTRACT             1
+
+
+//  Shard aggregates for the qc and extract modes.  They're all counts or sums so they can be added up in any order.
+
+#define SCAN_AGG_RECORDS          0
+#define SCAN_AGG_OK               1
+#define SCAN_AGG_ERRORS           2
+#define SCAN_AGG_SAMPLES          3
+#define SCAN_AGG_SATURATED        4        //  Waveforms with at least one saturated sample
+#define SCAN_AGG_PEAK_SUM         5
+#define SCAN_AGG_HISTOGRAM        6        //  Peak histogram by fraction of full scale
+#define SCAN_HISTOGRAM_BINS       16
+#define SCAN_AGG_COUNT            (SCAN_AGG_HISTOGRAM + SCAN_HISTOGRAM_BINS)
+
+
+static void batch_usage ()
+{
+  fprintf (stderr, "\n%s\n\n", VERSION);
+  fprintf (stderr, "Usage: LASwaveMonitor --batch MODE [OPTIONS] ARGUMENTS\n\n");
+  fprintf (stderr, "Modes:\n\n");
+  fprintf (stderr, "  rewrite [--hilbert] [--memory MB] INPUT_LAS OUTPUT_LAS\n\n");
+  fprintf (stderr, "    Rewrite the LAS file and its external waveform (.wdp) file so that the waveform packets are\n");
+  fprintf (stderr, "    stored in point record order (or Hilbert curve order of the point positions if --hilbert is\n");
+  fprintf (stderr, "    set).  Duplicate packets are only written once.  The point records are not reordered so PFM\n");
+  fprintf (stderr, "    record numbers are still valid.  --memory is the approximate memory limit in megabytes\n");
+  fprintf (stderr, "    (default %d).\n\n", SLAS_REWRITE_DEFAULT_MEMORY);
+  fprintf (stderr, "  compress [--threads N] [--memory MB] LAS [LAS...]\n\n");
+  fprintf (stderr, "    Compress the external waveform (.wdp) file of each LAS file to a .wdc file.  Only the waveform\n");
+  fprintf (stderr, "    packets used by the point records are stored.  LASwaveMonitor reads the .wdc file when the .wdp\n");
+  fprintf (stderr, "    file isn't there so the .wdp file can be archived or removed.  --threads is the number of\n");
+  fprintf (stderr, "    compression threads (default is one per core, maximum %d).  --memory is the approximate memory\n",
+           SLAS_WDC_MAX_THREADS);
+  fprintf (stderr, "    limit for the list of packets in megabytes (default %d).\n\n", SLAS_WDC_DEFAULT_MEMORY);
+  fprintf (stderr, "  qc [SHARD OPTIONS] OUTPUT LAS [LAS...]\n\n");
+  fprintf (stderr, "    Write a CSV file with the peak amplitude, peak sample, mean, and number of saturated samples of the\n");
+  fprintf (stderr, "    waveform of every point record.\n\n");
+  fprintf (stderr, "  extract [SHARD OPTIONS] OUTPUT LAS [LAS...]\n\n");
+  fprintf (stderr, "    Write a CSV file with the waveform samples of every point record.\n\n");
+  fprintf (stderr, "  render [--sheet COLSxROWS] [--tile WxH] [--pdf] [--dots] [--threads N] OUTPUT LIST\n\n");
+  fprintf (stderr, "    Render the waveform plot and attributes that LASwaveMonitor displays for each point record in LIST\n");
+  fprintf (stderr, "    (- for standard input).  Each line of LIST is a LAS file name and a zero based point record number\n");
+  fprintf (stderr, "    separated by a comma or spaces, so qc or extract output can be used as is.  The plots are tiled on\n");
+  fprintf (stderr, "    COLSxROWS sheets (default %dx%d) of WxH tiles (default %dx%d) that are written to OUTPUT_0001.png,\n",
+           RENDER_DEFAULT_COLUMNS, RENDER_DEFAULT_ROWS, RENDER_DEFAULT_TILE_WIDTH, RENDER_DEFAULT_TILE_HEIGHT);
+  fprintf (stderr, "    OUTPUT_0002.png, etc. or, with --pdf (or an OUTPUT ending in .pdf), one page per sheet.  The colors\n");
+  fprintf (stderr, "    and line mode are the LASwaveMonitor settings (--dots draws dots).  --threads is the number of\n");
+  fprintf (stderr, "    rendering threads (default is one per core).\n\n");
+  fprintf (stderr, "  benchmark [--samples LIST] [--sizes LIST] [--frames N] [--time MS] [--bits N] [--lines] [--dots]\n");
+  fprintf (stderr, "            [--csv] [--save PREFIX]\n\n");
+  fprintf (stderr, "    Time full offscreen redraws of the waveform plot (axes, tick text, trace, return marker, and the\n");
+  fprintf (stderr, "    attribute text), drawn on the map the same way as the monitor, for synthetic waveforms of each\n");
+  fprintf (stderr, "    number of samples in LIST (default %s)\n", BENCHMARK_DEFAULT_SAMPLES);
+  fprintf (stderr, "    at each WxH window size in LIST (default %s), in line and dot mode (--lines or --dots\n",
+           BENCHMARK_DEFAULT_SIZES);
+  fprintf (stderr, "    for just one).  Each case is drawn N times or for MS milliseconds (default %d).  --bits is the bits\n",
+           BENCHMARK_DEFAULT_TIME);
+  fprintf (stderr, "    per sample (8, 16, or 32, default %d).  The frame times and frames per second are printed as a table\n",
+           BENCHMARK_DEFAULT_BITS);
+  fprintf (stderr, "    (or CSV with --csv).  --save writes the last frame of each case to PREFIX_WxH_SAMPLES_MODE.png.\n\n");
+  fprintf (stderr, "  The qc and extract jobs are split into shards of point records.  Run the same command in as many\n");
+  fprintf (stderr, "  processes, on as many hosts, as you like (the shard directory and output must be on a file system\n");
+  fprintf (stderr, "  they all mount).  Each process claims shards until there are none left and the last one to finish\n");
+  fprintf (stderr, "  merges the output.  If one dies its shards are taken over when its claims get stale (right away if it\n");
+  fprintf (stderr, "  was on the same host) and restarted from the last checkpoint.  Totals for each file and for the whole\n");
+  fprintf (stderr, "  job are written to OUTPUT.summary.\n\n");
+  fprintf (stderr, "  Shard options:\n\n");
+  fprintf (stderr, "    --shard-dir DIR     Shard directory (default OUTPUT.shards)\n");
+  fprintf (stderr, "    --shard-size N      Point records per shard (default %d)\n", BATCH_SHARD_DEFAULT_RECORDS);
+  fprintf (stderr, "    --stale SECONDS     Age of an unfinished claim before it is taken over (default %d)\n", BATCH_SHARD_DEFAULT_STALE);
+  fprintf (stderr, "    --checkpoint N      Point records between shard checkpoints (default %d)\n", BATCH_SHARD_DEFAULT_CHECKPOINT);
+  fprintf (stderr, "    --jobs N            Number of local processes to run (default 1)\n\n");
+  fflush (stderr);
+}
+
+
+
+static int32_t batch_rewrite (int32_t argc, char **argv)
+{
+  int32_t order = SLAS_REWRITE_POINT_ORDER;
+  int64_t memory = SLAS_REWRITE_DEFAULT_MEMORY;
+  int32_t option_index = 0;
+
+
+  while (NVTrue) 
+    {
+      static struct option long_options[] = {{"hilbert", no_argument, 0, 0},
+                                             {"memory", required_argument, 0, 0},
+                                             {0, no_argument, 0, 0}};
+
+      char c = (char) getopt_long (argc, argv, "", long_options, &option_index);
+      if (c == -1) break;
+
+      switch (c) 
+        {
+        case 0:
+          switch (option_index)
+            {
+            case 0:
+              order = SLAS_REWRITE_HILBERT_ORDER;
+              break;
+
+            case 1:
+              sscanf (optarg, "%" SCNd64, &memory);
+              break;
+            }
+          break;
+
+        default:
+          batch_usage ();
+          return (-1);
+        }
+    }
+
+
+  if (argc - optind != 2)
+    {
+      batch_usage ();
+      return (-1);
+    }
+
+
+  return (slas_rewrite (argv[optind], argv[optind + 1], big_endian (), order, memory));
+}
+
+
+
+static int32_t batch_compress (int32_t argc, char **argv)
+{
+  int32_t nthreads = 0;
+  int64_t memory = SLAS_WDC_DEFAULT_MEMORY;
+  int32_t option_index = 0;
+
+
+  while (NVTrue) 
+    {
+      static struct option long_options[] = {{"threads", required_argument, 0, 0},
+                                             {"memory", required_argument, 0, 0},
+                                             {0, no_argument, 0, 0}};
+
+      char c = (char) getopt_long (argc, argv, "", long_options, &option_index);
+      if (c == -1) break;
+
+      switch (c) 
+        {
+        case 0:
+          switch (option_index)
+            {
+            case 0:
+              sscanf (optarg, "%d", &nthreads);
+              break;
+
+            case 1:
+              sscanf (optarg, "%" SCNd64, &memory);
+              break;
+            }
+          break;
+
+        default:
+          batch_usage ();
+          return (-1);
+        }
+    }
+
+
+  if (optind >= argc)
+    {
+      batch_usage ();
+      return (-1);
+    }
+
+
+  //  Keep going if one of them fails but let the caller know.
+
+  int32_t status = 0;
+
+  for (int32_t i = optind ; i < argc ; i++)
+    {
+      if (slas_wdc_convert (argv[i], big_endian (), nthreads, memory) < 0) status = -1;
+    }
+
+
+  return (status);
+}
+
+
+
+//  Per process state for the qc and extract modes.
+
+typedef struct
+{
+  int32_t                     mode;
+  int32_t                     file;           //  File whose header is in header (-1 for none)
+  SLAS_HEADER                 *header;
+  uint64_t                    checkpoint;     //  Records between checkpoints
+  uint64_t                    first;          //  First record of the chunk being scanned
+  std::vector<std::string>    lines;          //  Output for each record of the chunk (in record order)
+  std::vector<int32_t>        status;         //  Status of each record of the chunk
+  std::vector<uint32_t>       samples;        //  Number of samples of each record of the chunk
+  std::vector<uint32_t>       peak;           //  Peak of each record of the chunk (in SCAN_HISTOGRAM_BINS of full scale)
+  std::vector<uint64_t>       peak_value;
+  std::vector<uint8_t>        saturated;
+} SCAN_DATA;
+
+
+//  Waveform statistics for the qc mode.
+
+typedef struct
+{
+  uint32_t                    max_value;
+  uint32_t                    peak;
+  uint32_t                    peak_sample;
+  uint32_t                    saturated;
+  double                      mean;
+
+  template <typename T> void run (const T *samples, uint32_t count)
+  {
+    uint64_t sum = 0;
+
+    peak = peak_sample = saturated = 0;
+
+    for (uint32_t i = 0 ; i < count ; i++)
+      {
+        if (samples[i] > peak)
+          {
+            peak = samples[i];
+            peak_sample = i;
+          }
+
+        if (samples[i] >= max_value) saturated++;
+
+        sum += samples[i];
+      }
+
+    mean = count ? (double) sum / (double) count : 0.0;
+  }
+} QC_KERNEL;
+
+
+
+//  Start a record's output line.
+
+static void scan_line (SCAN_DATA *data, uint64_t index, uint64_t recnum, double gps_time, int32_t status)
+{
+  char text[256];
+
+
+  data->status[index] = status;
+
+  snprintf (text, sizeof (text), ",%" PRIu64 ",%.6f,%d", recnum, gps_time, status);
+  data->lines[index] = text;
+}
+
+
+
+//  Add the waveform to a record's output line (the samples for extract, the statistics for qc).
+
+template <typename T> static void scan_waveform (SCAN_DATA *data, uint64_t index, uint8_t wavepacket_descriptor_index, const T *samples,
+                                                 uint32_t count)
+{
+  SLAS_WAVEFORM_PACKET_DESCRIPTOR *desc = &data->header->wf_packet_desc[wavepacket_descriptor_index];
+  std::string &line = data->lines[index];
+  char text[256];
+
+
+  snprintf (text, sizeof (text), ",%d,%u", wavepacket_descriptor_index, count);
+  line += text;
+
+  data->samples[index] = count;
+
+  if (data->mode == BATCH_QC)
+    {
+      QC_KERNEL kernel;
+
+      kernel.max_value = (uint32_t) ((1ULL << desc->bits_per_sample) - 1);
+      kernel.run (samples, count);
+
+      snprintf (text, sizeof (text), ",%u,%u,%.3f,%u", kernel.peak, kernel.peak_sample, kernel.mean, kernel.saturated);
+      line += text;
+
+      data->peak_value[index] = kernel.peak;
+      data->peak[index] = (uint32_t) std::min ((uint64_t) SCAN_HISTOGRAM_BINS - 1,
+                                               (uint64_t) kernel.peak * SCAN_HISTOGRAM_BINS / ((uint64_t) kernel.max_value + 1));
+      data->saturated[index] = (kernel.saturated != 0);
+    }
+  else
+    {
+      line += ",";
+
+      for (uint32_t i = 0 ; i < count ; i++)
+        {
+          snprintf (text, sizeof (text), i ? " %u" : "%u", (uint32_t) samples[i]);
+          line += text;
+        }
+    }
+}
+
+
+
+//  Run scan_waveform on one record's samples (through slas_dispatch_samples).
+
+typedef struct
+{
+  SCAN_DATA                   *data;
+  uint64_t                    index;
+  uint8_t                     wavepacket_descriptor_index;
+
+  template <typename T> void run (const T *samples, uint32_t count)
+  {
+    scan_waveform (data, index, wavepacket_descriptor_index, samples, count);
+  }
+} SCAN_RECORD_KERNEL;
+
+
+
+//  Run scan_waveform on every row of a block that loaded (through slas_dispatch_block).
+
+typedef struct
+{
+  SCAN_DATA                   *data;
+  const SLAS_BLOCK            *block;
+
+  template <typename T> void run (const T *samples, int64_t rows, uint32_t stride, uint32_t number_of_samples)
+  {
+    for (int64_t i = 0 ; i < rows ; i++)
+      {
+        if (!block->row[i].status)
+          scan_waveform (data, i, block->wavepacket_descriptor_index, samples + (size_t) i * stride, number_of_samples);
+      }
+  }
+} SCAN_BLOCK_KERNEL;
+
+
+
+static void scan_record (void *user_data, uint64_t recnum, SLAS_POINT_DATA *record, SLAS_SAMPLES *wave, int32_t status)
+{
+  SCAN_DATA *data = (SCAN_DATA *) user_data;
+  uint64_t index = recnum - data->first;
+
+
+  scan_line (data, index, recnum, record->gps_time, status);
+
+  if (status < 0) return;
+
+
+  SCAN_RECORD_KERNEL kernel;
+
+  kernel.data = data;
+  kernel.index = index;
+  kernel.wavepacket_descriptor_index = record->wavepacket_descriptor_index;
+
+  slas_dispatch_samples (*wave, kernel);
+}
+
+
+
+//  Scan count records starting at data->first.  Almost every file uses a single waveform packet descriptor so the
+//  records are loaded into an aligned block for the first descriptor in the header and the kernels run over its rows.
+//  The records that use some other descriptor are read and scanned one at a time afterwards.
+
+static int32_t scan_chunk (SCAN_DATA *data, const char *name, const uint64_t *recnums, uint64_t count)
+{
+  uint8_t wdi = 0;
+  std::vector<uint64_t> rest;
+
+
+  for (int32_t i = 1 ; i < 256 && !wdi ; i++)
+    {
+      if (data->header->wf_packet_desc[i].bits_per_sample && data->header->wf_packet_desc[i].number_of_samples) wdi = i;
+    }
+
+  SLAS_BLOCK *block = wdi ? slas_block_alloc (data->header, wdi, count) : NULL;
+
+  if (block == NULL)
+    {
+      rest.assign (recnums, recnums + count);
+    }
+  else
+    {
+      if (slas_block_load (name, data->header, big_endian (), recnums, SLAS_BATCH_DEFAULT_QUEUE_DEPTH, block) < 0)
+        {
+          slas_block_free (block);
+          return (-1);
+        }
+
+      for (uint64_t i = 0 ; i < count ; i++)
+        {
+          SLAS_BLOCK_ROW *row = &block->row[i];
+
+          if (row->status && row->wavepacket_descriptor_index != wdi)
+            {
+              rest.push_back (recnums[i]);
+            }
+          else
+            {
+              scan_line (data, i, row->recnum, row->gps_time, row->status == 1 ? -1 : row->status);
+            }
+        }
+
+      SCAN_BLOCK_KERNEL kernel;
+
+      kernel.data = data;
+      kernel.block = block;
+
+      slas_dispatch_block (block, kernel);
+
+      slas_block_free (block);
+    }
+
+
+  if (rest.empty ()) return (0);
+
+  return (slas_batch_fetch_waveforms (name, data->header, big_endian (), SLAS_MASK_WAVEFORM_TIME, rest.data (), rest.size (),
+                                      SLAS_BATCH_DEFAULT_QUEUE_DEPTH, scan_record, data));
+}
+
+
+
+static int32_t scan_shard (BATCH_SHARDS *plan, int32_t shard, FILE *out, BATCH_CHECKPOINT *checkpoint, void *user_data)
+{
+  SCAN_DATA *data = (SCAN_DATA *) user_data;
+  BATCH_SHARD *sh = &plan->shards[shard];
+  const char *name = plan->files[sh->file].c_str ();
+
+
+  if (data->file != sh->file)
+    {
+      FILE *fp = fopen64 (name, "rb");
+
+      data->file = -1;
+
+      if (fp == NULL || slas_read_header (fp, big_endian (), data->header) < 0)
+        {
+          fprintf (stderr, "Error reading the header of %s\n", name);
+          if (fp) fclose (fp);
+          return (-1);
+        }
+
+      fclose (fp);
+      data->file = sh->file;
+    }
+
+
+  //  A fresh shard (or a checkpoint from some other version of us).
+
+  if (checkpoint->aggregates.size () != SCAN_AGG_COUNT)
+    {
+      checkpoint->done = 0;
+      checkpoint->aggregates.assign (SCAN_AGG_COUNT, 0);
+    }
+
+
+  //  Do the shard a checkpoint's worth at a time starting wherever the last process stopped.
+
+  std::vector<int64_t> &agg = checkpoint->aggregates;
+  std::vector<uint64_t> recnums;
+
+  while (checkpoint->done < sh->count)
+    {
+      uint64_t count = std::min (data->checkpoint, sh->count - checkpoint->done);
+
+      data->first = sh->first + checkpoint->done;
+      data->lines.assign (count, std::string ());
+      data->status.assign (count, -1);
+      data->samples.assign (count, 0);
+      data->peak.assign (count, 0);
+      data->peak_value.assign (count, 0);
+      data->saturated.assign (count, 0);
+
+      recnums.resize (count);
+      for (uint64_t i = 0 ; i < count ; i++) recnums[i] = data->first + i;
+
+      if (scan_chunk (data, name, recnums.data (), count) < 0) return (-1);
+
+
+      for (uint64_t i = 0 ; i < count ; i++)
+        {
+          if (fprintf (out, "%s%s\n", name, data->lines[i].c_str ()) < 0) return (-1);
+
+          agg[SCAN_AGG_RECORDS]++;
+
+          if (data->status[i] < 0)
+            {
+              agg[SCAN_AGG_ERRORS]++;
+              continue;
+            }
+
+          agg[SCAN_AGG_OK]++;
+          agg[SCAN_AGG_SAMPLES] += data->samples[i];
+
+          if (data->mode == BATCH_QC)
+            {
+              agg[SCAN_AGG_SATURATED] += data->saturated[i];
+              agg[SCAN_AGG_PEAK_SUM] += data->peak_value[i];
+              agg[SCAN_AGG_HISTOGRAM + data->peak[i]]++;
+            }
+        }
+
+      checkpoint->done += count;
+
+      if (batch_shard_checkpoint (plan, shard, out, checkpoint) < 0)
+        {
+          fprintf (stderr, "Error checkpointing shard %d :\n%s\n", shard, strerror (errno));
+          return (-1);
+        }
+    }
+
+
+  return (0);
+}
+
+
+
+static void scan_summary (BATCH_SHARDS *plan, int32_t file, const std::vector<int64_t> &aggregates, FILE *out, void *user_data)
+{
+  SCAN_DATA *data = (SCAN_DATA *) user_data;
+  std::vector<int64_t> agg (aggregates);
+
+
+  agg.resize (SCAN_AGG_COUNT, 0);
+
+  fprintf (out, "[%s]\n", file < 0 ? "total" : plan->files[file].c_str ());
+  fprintf (out, "records %" PRId64 "\n", agg[SCAN_AGG_RECORDS]);
+  fprintf (out, "waveforms %" PRId64 "\n", agg[SCAN_AGG_OK]);
+  fprintf (out, "errors %" PRId64 "\n", agg[SCAN_AGG_ERRORS]);
+  fprintf (out, "samples %" PRId64 "\n", agg[SCAN_AGG_SAMPLES]);
+
+  if (data->mode == BATCH_QC)
+    {
+      fprintf (out, "saturated %" PRId64 "\n", agg[SCAN_AGG_SATURATED]);
+      fprintf (out, "mean_peak %.3f\n", agg[SCAN_AGG_OK] ? (double) agg[SCAN_AGG_PEAK_SUM] / (double) agg[SCAN_AGG_OK] : 0.0);
+
+      fprintf (out, "peak_histogram");
+      for (int32_t i = 0 ; i < SCAN_HISTOGRAM_BINS ; i++) fprintf (out, " %" PRId64, agg[SCAN_AGG_HISTOGRAM + i]);
+      fprintf (out, "\n");
+    }
+
+  fprintf (out, "\n");
+}
+
+
+
+static int32_t batch_scan (int32_t argc, char **argv, int32_t mode)
+{
+  std::string shard_dir;
+  uint64_t shard_size = BATCH_SHARD_DEFAULT_RECORDS;
+  int64_t stale = BATCH_SHARD_DEFAULT_STALE;
+  uint64_t checkpoint = BATCH_SHARD_DEFAULT_CHECKPOINT;
+  int32_t jobs = 1;
+  int32_t option_index = 0;
+
+
+  while (NVTrue) 
+    {
+      static struct option long_options[] = {{"shard-dir", required_argument, 0, 0},
+                                             {"shard-size", required_argument, 0, 0},
+                                             {"stale", required_argument, 0, 0},
+                                             {"jobs", required_argument, 0, 0},
+                                             {"checkpoint", required_argument, 0, 0},
+                                             {0, no_argument, 0, 0}};
+
+      char c = (char) getopt_long (argc, argv, "", long_options, &option_index);
+      if (c == -1) break;
+
+      switch (c) 
+        {
+        case 0:
+          switch (option_index)
+            {
+            case 0:
+              shard_dir = optarg;
+              break;
+
+            case 1:
+              sscanf (optarg, "%" SCNu64, &shard_size);
+              break;
+
+            case 2:
+              sscanf (optarg, "%" SCNd64, &stale);
+              break;
+
+            case 3:
+              sscanf (optarg, "%d", &jobs);
+              break;
+
+            case 4:
+              sscanf (optarg, "%" SCNu64, &checkpoint);
+              if (!checkpoint) checkpoint = BATCH_SHARD_DEFAULT_CHECKPOINT;
+              break;
+            }
+          break;
+
+        default:
+          batch_usage ();
+          return (-1);
+        }
+    }
+
+
+  if (argc - optind < 2)
+    {
+      batch_usage ();
+      return (-1);
+    }
+
+  const char *output = argv[optind];
+  std::vector<std::string> files (&argv[optind + 1], &argv[argc]);
+
+  if (shard_dir.empty ()) shard_dir = std::string (output) + ".shards";
+
+
+  //  Start the other local processes.  They all do exactly what we do.
+
+  std::vector<pid_t> children;
+
+#ifndef _WIN32
+  for (int32_t i = 1 ; i < jobs ; i++)
+    {
+      pid_t pid = fork ();
+
+      if (!pid)
+        {
+          children.clear ();
+          break;
+        }
+
+      if (pid > 0) children.push_back (pid);
+    }
+#endif
+
+
+  BATCH_SHARDS plan;
+  SCAN_DATA data;
+  int32_t status;
+
+  data.mode = mode;
+  data.file = -1;
+  data.checkpoint = checkpoint;
+  data.header = (SLAS_HEADER *) calloc (1, sizeof (SLAS_HEADER));
+
+  if (data.header == NULL || batch_shard_plan (&plan, shard_dir.c_str (), mode == BATCH_QC ? "qc" : "extract", files, shard_size, stale) < 0)
+    {
+      status = -1;
+    }
+  else
+    {
+      status = batch_shard_run (&plan, scan_shard, scan_summary, &data, output, mode == BATCH_QC ?
+                                "file,point,gps_time,status,descriptor,samples,peak,peak_sample,mean,saturated\n" :
+                                "file,point,gps_time,status,descriptor,samples,values\n");
+    }
+
+  free (data.header);
+
+
+#ifndef _WIN32
+  for (size_t i = 0 ; i < children.size () ; i++)
+    {
+      int child_status;
+
+      if (waitpid (children[i], &child_status, 0) < 0 || !WIFEXITED (child_status) || WEXITSTATUS (child_status)) status = -1;
+    }
+#endif
+
+
+  return (status);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    batch_main
+
+ - Purpose:     Run one of the batch (command line) modes.
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - argc           =    Argument count starting with --batch
+                - argv           =    Arguments starting with --batch
+
+ - Returns:     int32_t          =    Exit status (0 on success)
+
+*********************************************************************************************/
+
+int32_t batch_main (int32_t argc, char **argv)
+{
+  if (argc < 2)
+    {
+      batch_usage ();
+      return (-1);
+    }
+
+
+  //  Skip --batch so that argv[0] is the mode (getopt_long starts at argv[1]).
+
+  argc--;
+  argv++;
+
+  int32_t status;
+
+  if (!strcmp (argv[0], "rewrite"))
+    {
+      status = batch_rewrite (argc, argv);
+    }
+  else if (!strcmp (argv[0], "compress"))
+    {
+      status = batch_compress (argc, argv);
+    }
+  else if (!strcmp (argv[0], "qc"))
+    {
+      status = batch_scan (argc, argv, BATCH_QC);
+    }
+  else if (!strcmp (argv[0], "extract"))
+    {
+      status = batch_scan (argc, argv, BATCH_EXTRACT);
+    }
+  else if (!strcmp (argv[0], "render"))
+    {
+      if ((status = batch_render (argc, argv)) == RENDER_USAGE_ERROR) batch_usage ();
+    }
+  else if (!strcmp (argv[0], "benchmark"))
+    {
+      if ((status = batch_benchmark (argc, argv)) == BENCHMARK_USAGE_ERROR) batch_usage ();
+    }
+  else
+    {
+      batch_usage ();
+      status = -1;
+    }
+
+
+  return (status < 0 ? 1 : 0);
+}
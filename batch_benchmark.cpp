@@ -0,0 +1,544 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! or / / ! are being used by Doxygen to
+    document the software.  Dashes in these comment blocks are used to create bullet lists.
+    The lack of blank lines after a block of dash preceeded comments means that the next
+    block of dash preceeded comments is a new, indented bullet list.  I've tried to keep the
+    Doxygen formatting to a minimum but there are some other items (like <br> and <pre>)
+    that need to be left alone.  If you see a comment that starts with / * ! or / / ! and
+    there is something that looks a bit weird it is probably due to some arcane Doxygen
+    syntax.  Be very careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+#include "batch_benchmark.hpp"
+
+#include "version.hpp"
+
+
+#define BENCHMARK_WAVEFORMS           8        //  Synthetic waveforms per case (a new one each frame like moving the cursor)
+
+
+typedef struct
+{
+  int32_t                     width;
+  int32_t                     height;
+} BENCHMARK_SIZE;
+
+
+typedef struct
+{
+  int32_t                     frames;
+  double                      mean;           //  Milliseconds per frame
+  double                      median;
+  double                      p95;
+  double                      fps;
+} BENCHMARK_RESULT;
+
+
+
+//  Parse a comma separated list of positive numbers.
+
+static int32_t benchmark_parse_samples (const char *list, std::vector<int32_t> *samples)
+{
+  const char *ptr = list;
+
+
+  samples->clear ();
+
+  while (*ptr)
+    {
+      char *end;
+      long value = strtol (ptr, &end, 10);
+
+      if (end == ptr || value < 1 || value > BENCHMARK_MAX_SAMPLES || (*end && *end != ','))
+        {
+          fprintf (stderr, "Bad sample count list %s\n", list);
+          return (-1);
+        }
+
+      samples->push_back ((int32_t) value);
+
+      ptr = *end ? end + 1 : end;
+    }
+
+
+  return (samples->empty () ? -1 : 0);
+}
+
+
+
+//  Parse a comma separated list of WxH window sizes.
+
+static int32_t benchmark_parse_sizes (const char *list, std::vector<BENCHMARK_SIZE> *sizes)
+{
+  const char *ptr = list;
+
+
+  sizes->clear ();
+
+  while (*ptr)
+    {
+      BENCHMARK_SIZE size;
+      int32_t used = 0;
+
+      if (sscanf (ptr, "%dx%d%n", &size.width, &size.height, &used) != 2 || size.width < 100 || size.height < 100 ||
+          size.width > 8192 || size.height > 8192 || (ptr[used] && ptr[used] != ','))
+        {
+          fprintf (stderr, "Bad window size list %s\n", list);
+          return (-1);
+        }
+
+      sizes->push_back (size);
+
+      ptr += used;
+      if (*ptr) ptr++;
+    }
+
+
+  return (sizes->empty () ? -1 : 0);
+}
+
+
+
+/*  Make a waveform that looks like a bathymetric return (surface peak, decaying water column, bottom peak) with some
+    noise.  The variant moves the bottom and changes the noise so consecutive frames don't draw the same trace.  */
+
+static void benchmark_waveform (int32_t count, int32_t bits, int32_t variant, SLAS_SAMPLES *wave, float *return_location,
+                                uint32_t temporal_spacing)
+{
+  double full_scale = pow (2.0, (double) bits) - 1.0;
+  double surface = count * 0.1;
+  double bottom = count * (0.45 + 0.05 * variant / BENCHMARK_WAVEFORMS);
+  double width = qMax (1.0, count / 200.0);
+  uint32_t seed = 12345 + variant;
+
+
+  wave->resize (count, bits);
+
+  for (int32_t i = 0 ; i < count ; i++)
+    {
+      double ds = (i - surface) / width;
+      double db = (i - bottom) / (width * 1.5);
+      double value = 0.05 + 0.85 * exp (-0.5 * ds * ds) + 0.45 * exp (-0.5 * db * db);
+
+      if (i > surface) value += 0.2 * exp (-(i - surface) / (count * 0.1));
+
+
+      //  Cheap deterministic noise (the benchmark shouldn't depend on the C library's rand).
+
+      seed = seed * 1103515245 + 12345;
+      value += 0.02 * ((double) ((seed >> 16) & 0x7fff) / 32767.0 - 0.5);
+
+      wave->set (i, (uint32_t) NINT (qBound (0.0, value, 1.0) * full_scale));
+    }
+
+  *return_location = (float) (NINT (bottom) * temporal_spacing);
+}
+
+
+
+//  Draw frames until we have --frames of them or we've been drawing for --time milliseconds.
+
+static BENCHMARK_RESULT benchmark_case (const BENCHMARK_SIZE *size, int32_t count, int32_t bits, uint8_t line_mode, int32_t frames,
+                                        int32_t time_limit, const SLAS_HEADER *header, double gps_start_time, const char *save)
+{
+  SLAS_WAVEFORM_PACKET_DESCRIPTOR desc;
+  SLAS_SAMPLES wave[BENCHMARK_WAVEFORMS];
+  float return_location[BENCHMARK_WAVEFORMS];
+  SLAS_POINT_DATA record;
+  WAVE_PLOT_STYLE style;
+  WAVE_STATS stats;
+  BOUNDS bounds;
+  QString labels[WAVE_PLOT_LABELS];
+  std::vector<double> times;
+  BENCHMARK_RESULT result;
+
+
+  memset (&desc, 0, sizeof (SLAS_WAVEFORM_PACKET_DESCRIPTOR));
+  desc.index = 1;
+  desc.bits_per_sample = bits;
+  desc.number_of_samples = count;
+  desc.temporal_spacing = 1000;
+
+  wave_plot_bounds (&desc, 0, 0, &bounds);
+
+  for (int32_t i = 0 ; i < BENCHMARK_WAVEFORMS ; i++)
+    benchmark_waveform (count, bits, i, &wave[i], &return_location[i], desc.temporal_spacing);
+
+
+  memset (&record, 0, sizeof (SLAS_POINT_DATA));
+  record.gps_time = 1.0e8;
+  record.intensity = 1024;
+  record.return_number = 1;
+  record.number_of_returns = 2;
+  record.classification = 2;
+  record.wavepacket_descriptor_index = 1;
+  record.waveform_packet_size = count * ((bits + 7) / 8);
+
+
+  //  The monitor's default colors.
+
+  style.wave_color = Qt::white;
+  style.primary_color = Qt::green;
+  style.background_color = Qt::black;
+  style.wave_line_mode = line_mode;
+
+
+  //  The map is set up the same way as the monitor's.  Each frame is a redraw of the map, the plot (drawn where the
+  //  monitor's slotPlotWaves is called from the post redraw signal), and the paint of the window.
+
+  NVMAP_DEF mapdef;
+
+  mapdef.projection = NO_PROJECTION;
+  mapdef.draw_width = size->width;
+  mapdef.draw_height = size->height;
+  mapdef.overlap_percent = 5;
+  mapdef.grid_inc_x = 0.0;
+  mapdef.grid_inc_y = 0.0;
+  mapdef.coasts = NVFalse;
+  mapdef.landmask = NVFalse;
+  mapdef.border = 0;
+  mapdef.coast_color = Qt::white;
+  mapdef.grid_color = QColor (160, 160, 160, 127);
+  mapdef.background_color = style.background_color;
+  mapdef.initial_bounds.min_x = 0;
+  mapdef.initial_bounds.min_y = 0;
+  mapdef.initial_bounds.max_x = 300;
+  mapdef.initial_bounds.max_y = 500;
+
+  nvMap *map = new nvMap (NULL, &mapdef);
+
+  map->resize (size->width, size->height);
+  map->show ();
+
+
+  //  The plot is drawn with the same functions that the monitor's slotPlotWaves uses (see wave_plot.cpp).
+
+  WAVE_PLOT_CANVAS canvas;
+
+  canvas.map = map;
+  canvas.painter = NULL;
+
+  QCoreApplication::processEvents ();
+
+
+  QElapsedTimer total, clock;
+  int32_t drawn = 0;
+
+
+  total.start ();
+
+  for (int32_t frame = 0 ; ; frame++)
+    {
+      int32_t ndx = frame % BENCHMARK_WAVEFORMS;
+
+      if (frames)
+        {
+          if (drawn >= frames) break;
+        }
+      else
+        {
+          if (drawn >= BENCHMARK_MIN_FRAMES && total.elapsed () >= time_limit) break;
+        }
+
+
+      clock.start ();
+
+      record.return_point_waveform_location = return_location[ndx];
+      record.byte_offset_to_waveform_data = (uint64_t) ndx * record.waveform_packet_size;
+      wave_plot_labels (header, &record, gps_start_time, labels);
+
+      wave_stats_compute (wave[ndx], bits, &stats);
+
+      map->redrawMapArea (NVTrue);
+
+      NVMAP_DEF l_mapdef = map->getMapdef ();
+
+      canvas.draw_width = l_mapdef.draw_width;
+      canvas.draw_height = l_mapdef.draw_height;
+
+      wave_plot_draw (&canvas, &bounds, wave[ndx], return_location[ndx], &stats, &style);
+      QCoreApplication::processEvents ();
+
+      double ms = clock.nsecsElapsed () / 1000000.0;
+
+
+      //  Don't count the first few frames (font and glyph caches are filled then).
+
+      if (frame < BENCHMARK_WARMUP_FRAMES)
+        {
+          total.start ();
+          continue;
+        }
+
+      times.push_back (ms);
+      drawn++;
+    }
+
+
+  double sum = 0.0;
+
+  for (size_t i = 0 ; i < times.size () ; i++) sum += times[i];
+
+  std::sort (times.begin (), times.end ());
+
+  result.frames = drawn;
+  result.mean = sum / times.size ();
+  result.median = times[times.size () / 2];
+  result.p95 = times[qMin (times.size () - 1, (size_t) (times.size () * 0.95))];
+  result.fps = sum > 0.0 ? times.size () / (sum / 1000.0) : 0.0;
+
+
+  if (save)
+    {
+      char name[1024];
+
+      snprintf (name, sizeof (name), "%s_%dx%d_%d_%s.png", save, size->width, size->height, count, line_mode ? "lines" : "dots");
+
+      if (!map->grab ().save (QString::fromLocal8Bit (name), "PNG")) fprintf (stderr, "Error writing %s\n", name);
+    }
+
+  delete map;
+
+
+  return (result);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    batch_benchmark
+
+ - Purpose:     Time full redraws of the waveform plot (background, axes, tick text,
+                trace, return marker, and the attribute text) offscreen for synthetic
+                waveforms of several lengths at several window sizes in line and dot
+                mode, and print the frame times and frames per second.  The plot is
+                analyzed and drawn on an nvMap by the same wave_plot functions that the
+                monitor uses so the numbers can be used to evaluate drawing changes and
+                to catch regressions.
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - argc           =    Argument count starting with the mode
+                - argv           =    Arguments starting with the mode
+
+ - Returns:     int32_t          =    BENCHMARK_USAGE_ERROR for bad arguments, other
+                                      negative numbers on error, 0 on success
+
+*********************************************************************************************/
+
+int32_t batch_benchmark (int32_t argc, char **argv)
+{
+  std::vector<int32_t> samples;
+  std::vector<BENCHMARK_SIZE> sizes;
+  int32_t frames = 0, time_limit = BENCHMARK_DEFAULT_TIME, bits = BENCHMARK_DEFAULT_BITS;
+  uint8_t lines = NVTrue, dots = NVTrue, csv = NVFalse;
+  const char *save = NULL;
+  int32_t option_index = 0;
+
+
+  benchmark_parse_samples (BENCHMARK_DEFAULT_SAMPLES, &samples);
+  benchmark_parse_sizes (BENCHMARK_DEFAULT_SIZES, &sizes);
+
+  while (NVTrue) 
+    {
+      static struct option long_options[] = {{"samples", required_argument, 0, 0},
+                                             {"sizes", required_argument, 0, 0},
+                                             {"frames", required_argument, 0, 0},
+                                             {"time", required_argument, 0, 0},
+                                             {"bits", required_argument, 0, 0},
+                                             {"lines", no_argument, 0, 0},
+                                             {"dots", no_argument, 0, 0},
+                                             {"csv", no_argument, 0, 0},
+                                             {"save", required_argument, 0, 0},
+                                             {0, no_argument, 0, 0}};
+
+      char c = (char) getopt_long (argc, argv, "", long_options, &option_index);
+      if (c == -1) break;
+
+      switch (c) 
+        {
+        case 0:
+          switch (option_index)
+            {
+            case 0:
+              if (benchmark_parse_samples (optarg, &samples) < 0) return (BENCHMARK_USAGE_ERROR);
+              break;
+
+            case 1:
+              if (benchmark_parse_sizes (optarg, &sizes) < 0) return (BENCHMARK_USAGE_ERROR);
+              break;
+
+            case 2:
+              sscanf (optarg, "%d", &frames);
+              break;
+
+            case 3:
+              sscanf (optarg, "%d", &time_limit);
+              break;
+
+            case 4:
+              sscanf (optarg, "%d", &bits);
+              break;
+
+            case 5:
+              dots = NVFalse;
+              break;
+
+            case 6:
+              lines = NVFalse;
+              break;
+
+            case 7:
+              csv = NVTrue;
+              break;
+
+            case 8:
+              save = optarg;
+              break;
+            }
+          break;
+
+        default:
+          return (BENCHMARK_USAGE_ERROR);
+        }
+    }
+
+  if (argc != optind) return (BENCHMARK_USAGE_ERROR);
+
+
+  //  --lines and --dots together means both, the same as neither.
+
+  if (!lines && !dots) lines = dots = NVTrue;
+
+  if (bits != 8 && bits != 16 && bits != 32)
+    {
+      fprintf (stderr, "Bits per sample must be 8, 16, or 32\n");
+      return (BENCHMARK_USAGE_ERROR);
+    }
+
+  frames = qMax (0, frames);
+  time_limit = qMax (1, time_limit);
+
+
+  //  The map is a widget so we need a QApplication but we don't want a window system.
+
+  if (qgetenv ("QT_QPA_PLATFORM").isEmpty ()) qputenv ("QT_QPA_PLATFORM", "offscreen");
+
+  int qt_argc = 1;
+  QApplication app (qt_argc, argv);
+
+
+  //  The attribute text is made for a LAS 1.4 point data format 4 record with GPS time, like the monitor's status bar.
+
+  SLAS_HEADER *header = (SLAS_HEADER *) calloc (1, sizeof (SLAS_HEADER));
+
+  if (header == NULL)
+    {
+      perror ("Allocating memory");
+      return (-1);
+    }
+
+  header->version_major = 1;
+  header->version_minor = 4;
+  header->point_data_format = 4;
+  header->global_encoding = 0x01;
+
+
+  time_t gps_tv_sec;
+  long gps_tv_nsec;
+
+  inv_cvtime (80, 6, 0, 0, 0.0, &gps_tv_sec, &gps_tv_nsec);
+  double gps_start_time = (int64_t) gps_tv_sec;
+
+
+  if (csv)
+    {
+      fprintf (stdout, "width,height,samples,mode,frames,mean_ms,median_ms,p95_ms,fps\n");
+    }
+  else
+    {
+      fprintf (stdout, "%s\n\n", VERSION);
+      fprintf (stdout, "Platform %s, %d bits per sample, ", qPrintable (QGuiApplication::platformName ()), bits);
+
+      if (frames)
+        {
+          fprintf (stdout, "%d frames per case\n\n", frames);
+        }
+      else
+        {
+          fprintf (stdout, "%d milliseconds per case\n\n", time_limit);
+        }
+
+      fprintf (stdout, "     Window   Samples   Mode   Frames   Mean ms   Median ms   95%% ms       FPS\n");
+    }
+  fflush (stdout);
+
+
+  for (size_t i = 0 ; i < sizes.size () ; i++)
+    {
+      for (size_t j = 0 ; j < samples.size () ; j++)
+        {
+          for (int32_t mode = 0 ; mode < 2 ; mode++)
+            {
+              uint8_t line_mode = mode ? NVFalse : NVTrue;
+
+              if ((line_mode && !lines) || (!line_mode && !dots)) continue;
+
+              BENCHMARK_RESULT result = benchmark_case (&sizes[i], samples[j], bits, line_mode, frames, time_limit, header,
+                                                        gps_start_time, save);
+
+              if (csv)
+                {
+                  fprintf (stdout, "%d,%d,%d,%s,%d,%.4f,%.4f,%.4f,%.1f\n", sizes[i].width, sizes[i].height, samples[j],
+                           line_mode ? "lines" : "dots", result.frames, result.mean, result.median, result.p95, result.fps);
+                }
+              else
+                {
+                  char window[32];
+
+                  snprintf (window, sizeof (window), "%dx%d", sizes[i].width, sizes[i].height);
+
+                  fprintf (stdout, "%11s %9d %6s %8d %9.3f %11.3f %8.3f %9.1f\n", window, samples[j],
+                           line_mode ? "lines" : "dots", result.frames, result.mean, result.median, result.p95, result.fps);
+                }
+              fflush (stdout);
+            }
+        }
+    }
+
+  free (header);
+
+
+  return (0);
+}
@@ -0,0 +1,83 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! or / / ! are being used by Doxygen to
+    document the software.  Dashes in these comment blocks are used to create bullet lists.
+    The lack of blank lines after a block of dash preceeded comments means that the next
+    block of dash preceeded comments is a new, indented bullet list.  I've tried to keep the
+    Doxygen formatting to a minimum but there are some other items (like <br> and <pre>)
+    that need to be left alone.  If you see a comment that starts with / * ! or / / ! and
+    there is something that looks a bit weird it is probably due to some arcane Doxygen
+    syntax.  Be very careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+/*  Waveform plot rendering benchmark definitions.  */
+
+#ifndef __BATCH_BENCHMARK_HPP__
+#define __BATCH_BENCHMARK_HPP__
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <errno.h>
+#include <getopt.h>
+#include <sys/types.h>
+
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "nvutility.h"
+#include "nvutility.hpp"
+
+#include "slas.hpp"
+#include "wave_plot.hpp"
+#include "wave_stats.hpp"
+
+#include <QtCore>
+#include <QtGui>
+#if QT_VERSION >= 0x050000
+#include <QtWidgets>
+#endif
+
+
+#define BENCHMARK_DEFAULT_SAMPLES     "100,500,2000,5000,20000"
+#define BENCHMARK_DEFAULT_SIZES       "440x620,880x1240,1920x1080"
+#define BENCHMARK_DEFAULT_TIME        1000     //  Milliseconds of drawing for each case (when --frames isn't set)
+#define BENCHMARK_DEFAULT_BITS        8
+#define BENCHMARK_MIN_FRAMES          5
+#define BENCHMARK_WARMUP_FRAMES       2
+#define BENCHMARK_MAX_SAMPLES         1000000
+#define BENCHMARK_USAGE_ERROR         -2       //  Bad arguments (the caller prints the usage)
+
+
+int32_t batch_benchmark (int32_t argc, char **argv);
+
+
+#endif
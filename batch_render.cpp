@@ -0,0 +1,622 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! or / / ! are being used by Doxygen to
+    document the software.  Dashes in these comment blocks are used to create bullet lists.
+    The lack of blank lines after a block of dash preceeded comments means that the next
+    block of dash preceeded comments is a new, indented bullet list.  I've tried to keep the
+    Doxygen formatting to a minimum but there are some other items (like <br> and <pre>)
+    that need to be left alone.  If you see a comment that starts with / * ! or / / ! and
+    there is something that looks a bit weird it is probably due to some arcane Doxygen
+    syntax.  Be very careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+#include "batch_render.hpp"
+#include "nvutility.h"
+#include "nvutility.hpp"
+
+#include "version.hpp"
+
+
+typedef struct
+{
+  int32_t                     file;           //  Index into the file list
+  uint64_t                    recnum;         //  Zero based point record number
+  int32_t                     status;
+  SLAS_POINT_DATA             record;
+  SLAS_SAMPLES                wave;
+} RENDER_ITEM;
+
+
+typedef struct
+{
+  std::vector<std::string>    files;
+  std::vector<SLAS_HEADER *>  headers;        //  NULL if the header couldn't be read
+  std::vector<RENDER_ITEM>    items;
+  WAVE_PLOT_STYLE             style;
+  QColor                      text_color;
+  int32_t                     tile_width;
+  int32_t                     tile_height;
+  int32_t                     columns;
+  int32_t                     rows;
+  double                      gps_start_time;
+} RENDER_JOB;
+
+
+typedef struct
+{
+  RENDER_JOB                  *job;
+  std::multimap<uint64_t, size_t> *index;     //  Record number to items (the same record may be in the list more than once)
+} RENDER_FETCH;
+
+
+
+//  Read the list of records.  Each line has the LAS file name and the zero based point record number separated by a comma
+//  (or white space if there's no comma) (so the first two columns of the qc or extract CSV output can be used as is).  Anything else on the line
+//  is ignored, as are lines that don't have a record number (like the CSV header).
+
+static int32_t render_read_list (const char *list, RENDER_JOB *job)
+{
+  FILE *fp = strcmp (list, "-") ? fopen (list, "r") : stdin;
+  std::map<std::string, int32_t> file_index;
+  char line[4096];
+
+
+  if (fp == NULL)
+    {
+      fprintf (stderr, "Error opening %s :\n%s\n", list, strerror (errno));
+      return (-1);
+    }
+
+  while (fgets (line, sizeof (line), fp))
+    {
+      char *sep = strchr (line, ',');
+      if (sep == NULL) sep = strpbrk (line, " \t");
+      uint64_t recnum;
+      char *end;
+
+      if (sep == NULL || sep == line || line[0] == '#') continue;
+
+      std::string name (line, sep - line);
+
+      sep += strspn (sep, ", \t");
+      if (*sep < '0' || *sep > '9') continue;
+
+      recnum = strtoull (sep, &end, 10);
+      if (*end && !strchr (", \t\r\n", *end)) continue;
+
+
+      std::map<std::string, int32_t>::iterator it = file_index.find (name);
+
+      if (it == file_index.end ())
+        {
+          it = file_index.insert (std::make_pair (name, (int32_t) job->files.size ())).first;
+          job->files.push_back (name);
+        }
+
+      RENDER_ITEM item;
+
+      item.file = it->second;
+      item.recnum = recnum;
+      item.status = -1;
+      memset (&item.record, 0, sizeof (SLAS_POINT_DATA));
+
+      job->items.push_back (item);
+    }
+
+  if (fp != stdin) fclose (fp);
+
+
+  return (0);
+}
+
+
+
+//  Use the monitor's colors and line mode so the plots look like the display.
+
+static void render_style (RENDER_JOB *job)
+{
+#ifdef NVWIN3X
+  QString ini_file = QString (getenv ("USERPROFILE")) + "/ABE.config/LASwaveMonitor.ini";
+#else
+  QString ini_file = QString (getenv ("HOME")) + "/ABE.config/LASwaveMonitor.ini";
+#endif
+
+  QSettings settings (ini_file, QSettings::IniFormat);
+  settings.beginGroup ("LASwaveMonitor");
+
+  job->style.wave_line_mode = settings.value ("Wave line mode flag", true).toBool ();
+
+  job->style.wave_color.setRgb (settings.value ("Wave color/red", 255).toInt (), settings.value ("Wave color/green", 255).toInt (),
+                                settings.value ("Wave color/blue", 255).toInt (), settings.value ("Wave color/alpha", 255).toInt ());
+
+  job->style.primary_color.setRgb (settings.value ("Return point marker color/red", 0).toInt (),
+                                   settings.value ("Return point marker color/green", 255).toInt (),
+                                   settings.value ("Return point marker color/blue", 0).toInt (),
+                                   settings.value ("Return point marker color/alpha", 255).toInt ());
+
+  job->style.background_color.setRgb (settings.value ("Background color/red", 0).toInt (),
+                                      settings.value ("Background color/green", 0).toInt (),
+                                      settings.value ("Background color/blue", 0).toInt (),
+                                      settings.value ("Background color/alpha", 255).toInt ());
+
+  settings.endGroup ();
+
+
+  int32_t hue, sat, val;
+
+  job->style.background_color.getHsv (&hue, &sat, &val);
+  job->text_color = val < 128 ? Qt::white : Qt::black;
+}
+
+
+
+static void render_fetch_callback (void *user_data, uint64_t recnum, SLAS_POINT_DATA *record, SLAS_SAMPLES *wave, int32_t status)
+{
+  RENDER_FETCH *fetch = (RENDER_FETCH *) user_data;
+  std::pair<std::multimap<uint64_t, size_t>::iterator, std::multimap<uint64_t, size_t>::iterator> range = fetch->index->equal_range (recnum);
+
+
+  for (std::multimap<uint64_t, size_t>::iterator it = range.first ; it != range.second ; it++)
+    {
+      RENDER_ITEM *item = &fetch->job->items[it->second];
+
+      item->status = status;
+      item->record = *record;
+      if (status >= 0) item->wave = *wave;
+    }
+}
+
+
+
+//  Read the point records and waveforms for items first through last - 1, a file at a time.
+
+static void render_fetch (RENDER_JOB *job, size_t first, size_t last)
+{
+  std::map<int32_t, std::multimap<uint64_t, size_t> > by_file;
+
+
+  for (size_t i = first ; i < last ; i++)
+    {
+      if (job->headers[job->items[i].file] != NULL) by_file[job->items[i].file].insert (std::make_pair (job->items[i].recnum, i));
+    }
+
+
+  for (std::map<int32_t, std::multimap<uint64_t, size_t> >::iterator it = by_file.begin () ; it != by_file.end () ; it++)
+    {
+      SLAS_HEADER *header = job->headers[it->first];
+      std::vector<uint64_t> recnums;
+
+      for (std::multimap<uint64_t, size_t>::iterator rec = it->second.begin () ; rec != it->second.end () ; rec = it->second.upper_bound (rec->first))
+        {
+          if (rec->first < header->extended_number_of_point_records) recnums.push_back (rec->first);
+        }
+
+      RENDER_FETCH fetch = {job, &it->second};
+
+      if (!recnums.empty () && slas_batch_fetch_waveforms (job->files[it->first].c_str (), header, big_endian (), SLAS_MASK_ALL, recnums.data (),
+                                                           recnums.size (), SLAS_BATCH_DEFAULT_QUEUE_DEPTH, render_fetch_callback, &fetch) < 0)
+        {
+          fprintf (stderr, "Error reading waveforms from %s\n", job->files[it->first].c_str ());
+        }
+    }
+}
+
+
+
+//  Draw one tile (the title, the waveform plot, and the attribute panel).  The painter's origin is the tile's upper left
+//  corner.
+
+static void render_tile (const RENDER_JOB *job, const RENDER_ITEM *item, QPainter *painter)
+{
+  QFont font = painter->font ();
+  font.setPointSize (WAVE_PLOT_FONT_SIZE);
+
+  QFont bold = font;
+  bold.setBold (true);
+
+  QFontMetrics metrics (font);
+  int32_t line_height = metrics.height ();
+  int32_t title_height = line_height + 6;
+  int32_t panel_rows = (WAVE_PLOT_LABELS + 1) / 2;
+  int32_t panel_height = panel_rows * line_height + 8;
+  int32_t plot_height = job->tile_height - title_height - panel_height;
+  int32_t column_width = job->tile_width / 2;
+  const SLAS_HEADER *header = job->headers[item->file];
+
+
+  painter->fillRect (0, 0, job->tile_width, job->tile_height, job->style.background_color);
+
+
+  //  Title
+
+  painter->setFont (bold);
+  painter->setPen (job->text_color);
+
+  QString title = QString ("%1   point %2").arg (QFileInfo (QString::fromLocal8Bit (job->files[item->file].c_str ())).fileName ())
+    .arg ((qulonglong) item->recnum);
+
+  painter->drawText (QRect (4, 0, job->tile_width - 8, title_height), Qt::AlignLeft | Qt::AlignVCenter,
+                     metrics.elidedText (title, Qt::ElideMiddle, job->tile_width - 8));
+
+
+  //  Waveform plot
+
+  uint8_t waveform = (header && item->status >= 0 && item->record.wavepacket_descriptor_index &&
+                      (header->point_data_format == 4 || header->point_data_format == 5 || header->point_data_format == 9 ||
+                       header->point_data_format == 10));
+
+  painter->save ();
+  painter->translate (0, title_height);
+  painter->setClipRect (0, 0, job->tile_width, plot_height);
+
+  if (waveform)
+    {
+      const SLAS_WAVEFORM_PACKET_DESCRIPTOR *desc = &header->wf_packet_desc[item->record.wavepacket_descriptor_index];
+      WAVE_PLOT_CANVAS canvas;
+      WAVE_STATS stats;
+      BOUNDS bounds;
+
+      canvas.map = NULL;
+      canvas.painter = painter;
+      canvas.draw_width = job->tile_width;
+      canvas.draw_height = plot_height;
+
+      wave_plot_bounds (desc, 0, 0, &bounds);
+      wave_stats_compute (item->wave, desc->bits_per_sample, &stats);
+      wave_plot_draw (&canvas, &bounds, item->wave, item->record.return_point_waveform_location, &stats, &job->style);
+    }
+  else
+    {
+      painter->setFont (font);
+      painter->setPen (job->text_color);
+      painter->drawText (QRect (0, 0, job->tile_width, plot_height), Qt::AlignCenter,
+                         header == NULL ? "Unable to read LAS header" : item->status < 0 ? "Unable to read point record" : "No waveform");
+    }
+
+  painter->restore ();
+
+
+  //  Attribute panel (the monitor's status bar fields).
+
+  if (header == NULL || item->status < 0) return;
+
+  QString labels[WAVE_PLOT_LABELS];
+
+  wave_plot_labels (header, &item->record, job->gps_start_time, labels);
+
+  for (int32_t i = 0 ; i < WAVE_PLOT_LABELS ; i++)
+    {
+      int32_t x = 4 + (i / panel_rows) * column_width;
+      int32_t y = title_height + plot_height + 4 + (i % panel_rows) * line_height + metrics.ascent ();
+      int32_t split = labels[i].indexOf ("</b>");
+      QString name = labels[i].mid (3, split - 3);
+      QString value = labels[i].mid (split + 4);
+
+      painter->setFont (bold);
+      painter->drawText (x, y, name);
+
+#if QT_VERSION >= 0x050b00
+      int32_t name_width = QFontMetrics (bold).horizontalAdvance (name);
+#else
+      int32_t name_width = QFontMetrics (bold).width (name);
+#endif
+
+      painter->setFont (font);
+      painter->drawText (x + name_width, y, metrics.elidedText (value, Qt::ElideRight, qMax (0, column_width - name_width - 8)));
+    }
+}
+
+
+
+//  Render one sheet of tiles.
+
+static QImage render_sheet (const RENDER_JOB *job, size_t first, size_t last)
+{
+  QImage image (job->columns * job->tile_width, job->rows * job->tile_height, QImage::Format_RGB32);
+  QPainter painter (&image);
+
+
+  image.fill (job->style.background_color);
+
+  for (size_t i = first ; i < last ; i++)
+    {
+      int32_t tile = (int32_t) (i - first);
+      int32_t x = (tile % job->columns) * job->tile_width;
+      int32_t y = (tile / job->columns) * job->tile_height;
+
+      painter.save ();
+      painter.translate (x, y);
+      painter.setClipRect (0, 0, job->tile_width, job->tile_height);
+      render_tile (job, &job->items[i], &painter);
+      painter.restore ();
+
+      painter.setPen (QPen (Qt::gray, 1));
+      painter.drawRect (x, y, job->tile_width - 1, job->tile_height - 1);
+    }
+
+  painter.end ();
+
+
+  return (image);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    batch_render
+
+ - Purpose:     Render waveform plots (the same plot and attributes that the monitor
+                displays) for a list of point records to PNG sheets or a multi-page PDF.
+                The records are read with the batch waveform fetch and the sheets are
+                rendered to QImages on all of the cores.
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - argc           =    Argument count starting with the mode
+                - argv           =    Arguments starting with the mode
+
+ - Returns:     int32_t          =    RENDER_USAGE_ERROR for bad arguments, other negative
+                                      numbers on error, 0 on success
+
+*********************************************************************************************/
+
+int32_t batch_render (int32_t argc, char **argv)
+{
+  RENDER_JOB job;
+  uint8_t pdf = NVFalse, dots = NVFalse;
+  int32_t nthreads = 0;
+  int32_t option_index = 0;
+
+
+  job.tile_width = RENDER_DEFAULT_TILE_WIDTH;
+  job.tile_height = RENDER_DEFAULT_TILE_HEIGHT;
+  job.columns = RENDER_DEFAULT_COLUMNS;
+  job.rows = RENDER_DEFAULT_ROWS;
+
+  while (NVTrue) 
+    {
+      static struct option long_options[] = {{"sheet", required_argument, 0, 0},
+                                             {"tile", required_argument, 0, 0},
+                                             {"pdf", no_argument, 0, 0},
+                                             {"dots", no_argument, 0, 0},
+                                             {"threads", required_argument, 0, 0},
+                                             {0, no_argument, 0, 0}};
+
+      char c = (char) getopt_long (argc, argv, "", long_options, &option_index);
+      if (c == -1) break;
+
+      switch (c) 
+        {
+        case 0:
+          switch (option_index)
+            {
+            case 0:
+              sscanf (optarg, "%dx%d", &job.columns, &job.rows);
+              break;
+
+            case 1:
+              sscanf (optarg, "%dx%d", &job.tile_width, &job.tile_height);
+              break;
+
+            case 2:
+              pdf = NVTrue;
+              break;
+
+            case 3:
+              dots = NVTrue;
+              break;
+
+            case 4:
+              sscanf (optarg, "%d", &nthreads);
+              break;
+            }
+          break;
+
+        default:
+          return (RENDER_USAGE_ERROR);
+        }
+    }
+
+  if (argc - optind != 2) return (RENDER_USAGE_ERROR);
+
+  const char *output = argv[optind];
+
+  if (strlen (output) > 4 && !strcasecmp (output + strlen (output) - 4, ".pdf")) pdf = NVTrue;
+
+  job.columns = qBound (1, job.columns, 64);
+  job.rows = qBound (1, job.rows, 64);
+  job.tile_width = qBound (100, job.tile_width, 4096);
+  job.tile_height = qBound (300, job.tile_height, 4096);
+
+  if (nthreads <= 0) nthreads = std::thread::hardware_concurrency ();
+  nthreads = qBound (1, nthreads, RENDER_MAX_THREADS);
+
+
+  if (render_read_list (argv[optind + 1], &job) < 0) return (-1);
+
+  if (job.items.empty ())
+    {
+      fprintf (stderr, "No point records in %s\n", argv[optind + 1]);
+      return (-1);
+    }
+
+
+  //  Read the headers.
+
+  job.headers.assign (job.files.size (), NULL);
+
+  for (size_t i = 0 ; i < job.files.size () ; i++)
+    {
+      FILE *fp = fopen64 (job.files[i].c_str (), "rb");
+      SLAS_HEADER *header = (SLAS_HEADER *) calloc (1, sizeof (SLAS_HEADER));
+
+      if (fp == NULL || header == NULL || slas_read_header (fp, big_endian (), header) < 0)
+        {
+          fprintf (stderr, "Error reading the header of %s\n", job.files[i].c_str ());
+          free (header);
+          header = NULL;
+        }
+
+      if (fp) fclose (fp);
+
+      job.headers[i] = header;
+    }
+
+
+  //  Text drawing needs a QGuiApplication but we don't want a window system.
+
+  if (qgetenv ("QT_QPA_PLATFORM").isEmpty ()) qputenv ("QT_QPA_PLATFORM", "offscreen");
+
+  int qt_argc = 1;
+  QGuiApplication app (qt_argc, argv);
+
+  render_style (&job);
+  if (dots) job.style.wave_line_mode = NVFalse;
+
+
+  //  Set the GPS start time (00:00:00 on 6 January 1980) in POSIX form.
+
+  time_t gps_tv_sec;
+  long gps_tv_nsec;
+
+  inv_cvtime (80, 6, 0, 0, 0.0, &gps_tv_sec, &gps_tv_nsec);
+  job.gps_start_time = (int64_t) gps_tv_sec;
+
+
+  QPdfWriter *writer = NULL;
+  QPainter *pdf_painter = NULL;
+
+  if (pdf)
+    {
+      writer = new QPdfWriter (QString::fromLocal8Bit (output));
+      writer->setCreator (VERSION);
+      writer->setTitle ("LAS waveforms");
+      writer->setPageOrientation (job.columns * job.tile_width > job.rows * job.tile_height ? QPageLayout::Landscape : QPageLayout::Portrait);
+
+      pdf_painter = new QPainter;
+
+      if (!pdf_painter->begin (writer))
+        {
+          fprintf (stderr, "Error creating %s\n", output);
+          delete pdf_painter;
+          delete writer;
+          for (size_t i = 0 ; i < job.headers.size () ; i++) free (job.headers[i]);
+          return (-1);
+        }
+    }
+
+
+  //  Read and render a few sheets per thread at a time so memory doesn't depend on the length of the list.
+
+  size_t per_sheet = job.columns * job.rows;
+  size_t sheets = (job.items.size () + per_sheet - 1) / per_sheet;
+  size_t group = nthreads * RENDER_SHEETS_PER_THREAD;
+  std::atomic<int32_t> errors (0);
+  QElapsedTimer clock;
+
+  clock.start ();
+
+  for (size_t first_sheet = 0 ; first_sheet < sheets ; first_sheet += group)
+    {
+      size_t last_sheet = qMin (sheets, first_sheet + group);
+      size_t last_item = qMin (job.items.size (), last_sheet * per_sheet);
+
+      render_fetch (&job, first_sheet * per_sheet, last_item);
+
+
+      std::vector<QImage> images (last_sheet - first_sheet);
+      std::atomic<size_t> next (first_sheet);
+      std::vector<std::thread> threads;
+
+      for (int32_t t = 0 ; t < nthreads ; t++)
+        {
+          threads.push_back (std::thread ([&] ()
+            {
+              size_t sheet;
+
+              while ((sheet = next++) < last_sheet)
+                {
+                  QImage image = render_sheet (&job, sheet * per_sheet, qMin (job.items.size (), (sheet + 1) * per_sheet));
+
+                  if (pdf)
+                    {
+                      images[sheet - first_sheet] = image;
+                    }
+                  else
+                    {
+                      QString name = QString ("%1_%2.png").arg (QString::fromLocal8Bit (output)).arg ((qulonglong) sheet + 1, 4, 10, QChar ('0'));
+
+                      if (!image.save (name, "PNG"))
+                        {
+                          fprintf (stderr, "Error writing %s\n", name.toLocal8Bit ().constData ());
+                          errors++;
+                        }
+                    }
+                }
+            }));
+        }
+
+      for (size_t t = 0 ; t < threads.size () ; t++) threads[t].join ();
+
+
+      //  PDF pages have to be written in order by one thread.
+
+      for (size_t i = 0 ; pdf && i < images.size () ; i++)
+        {
+          if (first_sheet + i) writer->newPage ();
+
+          QRect page = pdf_painter->viewport ();
+          QSize size = images[i].size ().scaled (page.size (), Qt::KeepAspectRatio);
+
+          pdf_painter->drawImage (QRect (page.x (), page.y (), size.width (), size.height ()), images[i]);
+        }
+
+
+      for (size_t i = first_sheet * per_sheet ; i < last_item ; i++) job.items[i].wave.clear ();
+
+      fprintf (stdout, "%" PRIu64 " of %" PRIu64 " sheets rendered (%.1f seconds)\n", (uint64_t) last_sheet, (uint64_t) sheets,
+               (double) clock.elapsed () / 1000.0);
+      fflush (stdout);
+    }
+
+
+  if (pdf)
+    {
+      if (!pdf_painter->end ()) errors++;
+      delete pdf_painter;
+      delete writer;
+    }
+
+  for (size_t i = 0 ; i < job.headers.size () ; i++) free (job.headers[i]);
+
+
+  return (errors ? -1 : 0);
+}
@@ -0,0 +1,933 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! or / / ! are being used by Doxygen to
+    document the software.  Dashes in these comment blocks are used to create bullet lists.
+    The lack of blank lines after a block of dash preceeded comments means that the next
+    block of dash preceeded comments is a new, indented bullet list.  I've tried to keep the
+    Doxygen formatting to a minimum but there are some other items (like <br> and <pre>)
+    that need to be left alone.  If you see a comment that starts with / * ! or / / ! and
+    there is something that looks a bit weird it is probably due to some arcane Doxygen
+    syntax.  Be very careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+#include <stddef.h>
+#include <fcntl.h>
+#include <time.h>
+#include <sys/stat.h>
+#include <utime.h>
+#ifndef _WIN32
+#include <signal.h>
+#endif
+
+#include <algorithm>
+#include <thread>
+#include <chrono>
+
+#include "batch_shard.hpp"
+#include "nvutility.hpp"
+
+#include <QtCore>
+
+
+#define SHARD_PLAN_MAGIC          "SLAS_SHARDS 1"
+#define SHARD_CHECKPOINT_MAGIC    "SLAS_CHECKPOINT_2"
+
+
+
+//  Create a lock (claim) file.  This fails if it already exists.
+
+static int32_t shard_create (const std::string &path, const std::string &owner)
+{
+  int fd = open (path.c_str (), O_WRONLY | O_CREAT | O_EXCL, 0644);
+
+  if (fd < 0) return (-1);
+
+  char line[512];
+  int32_t len = snprintf (line, sizeof (line), "%s %" PRId64 "\n", owner.c_str (), (int64_t) time (NULL));
+
+  if (write (fd, line, len) != len) len = -1;
+
+  close (fd);
+
+
+  return (len < 0 ? -1 : 0);
+}
+
+
+
+//  Seconds since a file was modified (-1 if it doesn't exist).
+
+static int64_t shard_age (const std::string &path)
+{
+  struct stat st;
+
+  if (stat (path.c_str (), &st)) return (-1);
+
+  return ((int64_t) time (NULL) - (int64_t) st.st_mtime);
+}
+
+
+
+//  What is in a lock file plus its inode and modification time.  A takeover compares this before and after it moves the
+//  lock so it knows it moved the same lock that it decided was stale (empty if the lock doesn't exist).
+
+static std::string shard_lock_id (const std::string &path, int64_t *mtime)
+{
+  struct stat st;
+  char line[512];
+  FILE *fp = fopen (path.c_str (), "r");
+
+  if (fp == NULL) return (std::string ());
+
+  if (fstat (fileno (fp), &st) || !fgets (line, sizeof (line), fp)) line[0] = 0;
+
+  fclose (fp);
+
+  if (!line[0]) return (std::string ());
+
+
+  *mtime = (int64_t) st.st_mtime;
+
+  return (std::string (line) + " " + std::to_string ((int64_t) st.st_ino) + " " + std::to_string (*mtime));
+}
+
+
+
+//  Check to see if a lock was made by a process on this host that isn't running any more (so a restarted job doesn't
+//  have to wait for its old claims to go stale).
+
+static uint8_t shard_owner_dead (BATCH_SHARDS *plan, const std::string &id)
+{
+#ifdef _WIN32
+  return (NVFalse);
+#else
+  FILE *fp;
+  char owner[512];
+
+  if (sscanf (id.c_str (), "%511s", owner) != 1) return (NVFalse);
+
+
+  //  The owner is host.pid and ours is the same host with our pid.
+
+  char *dot = strrchr (owner, '.');
+  size_t host_len = plan->owner.rfind ('.');
+
+  if (dot == NULL || (size_t) (dot - owner) != host_len || strncmp (owner, plan->owner.c_str (), host_len)) return (NVFalse);
+
+  pid_t pid = (pid_t) atol (dot + 1);
+
+  if (pid <= 0) return (NVFalse);
+
+  if (kill (pid, 0) < 0 && errno == ESRCH) return (NVTrue);
+
+
+#ifdef __linux__
+  //  A dead --jobs child stays a zombie until its parent is done with its own shards and waits for it.
+
+  char stat_name[64], state = 0;
+
+  snprintf (stat_name, sizeof (stat_name), "/proc/%d/stat", (int32_t) pid);
+
+  if ((fp = fopen (stat_name, "r")) != NULL)
+    {
+      if (fscanf (fp, "%*d (%*[^)]) %c", &state) != 1) state = 0;
+      fclose (fp);
+    }
+
+  if (state == 'Z') return (NVTrue);
+#endif
+
+
+  return (NVFalse);
+#endif
+}
+
+
+
+//  Check to see if a lock is older than the stale time (or, if check_owner is set, was made by a dead process on this
+//  host).  The lock's id is returned for shard_take_over.
+
+static uint8_t shard_stale (BATCH_SHARDS *plan, const std::string &path, int64_t stale, uint8_t check_owner, std::string *id)
+{
+  int64_t mtime = 0;
+
+  *id = shard_lock_id (path, &mtime);
+
+  if (id->empty ()) return (NVFalse);
+
+  return ((int64_t) time (NULL) - mtime > stale || (check_owner && shard_owner_dead (plan, *id)));
+}
+
+
+
+//  Take over a stale lock.  Renaming it out of the way is atomic so only one process can do it, but somebody else may
+//  have taken it over (and made a new lock) between our check and the rename.  If what we moved isn't the lock we judged
+//  stale it is put back (unless another lock has been made since) and we leave it alone.
+
+static int32_t shard_take_over (BATCH_SHARDS *plan, const std::string &path, const std::string &id)
+{
+  std::string stale = path + ".stale." + plan->owner;
+  int64_t mtime;
+
+  if (rename (path.c_str (), stale.c_str ())) return (-1);
+
+  if (shard_lock_id (stale, &mtime) != id)
+    {
+#ifdef _WIN32
+      rename (stale.c_str (), path.c_str ());
+#else
+      if (link (stale.c_str (), path.c_str ())) fprintf (stderr, "Lock %s was taken over by another process\n", path.c_str ());
+#endif
+      remove (stale.c_str ());
+      return (-1);
+    }
+
+  remove (stale.c_str ());
+
+  fprintf (stderr, "Taking over stale lock %s\n", path.c_str ());
+  fflush (stderr);
+
+
+  return (shard_create (path, plan->owner));
+}
+
+
+
+static std::string shard_name (BATCH_SHARDS *plan, const char *sub, int32_t shard, const std::string &ext)
+{
+  char name[64];
+  snprintf (name, sizeof (name), "/%s/%08d", sub, shard);
+
+  return (plan->dir + name + ext);
+}
+
+
+
+//  Check to see if we still hold the claim on a shard (it may have been taken over if we were thought to be dead).
+
+static uint8_t shard_holds_claim (BATCH_SHARDS *plan, int32_t shard)
+{
+  FILE *fp = fopen (shard_name (plan, "claims", shard, "").c_str (), "r");
+  char owner[512];
+
+  if (fp == NULL) return (NVFalse);
+
+  uint8_t ok = (fscanf (fp, "%511s", owner) == 1 && plan->owner == owner);
+  fclose (fp);
+
+  return (ok);
+}
+
+
+
+//  Write the plan.  It goes to a temporary file that is renamed so nobody can read a partial plan.
+
+static int32_t shard_write_plan (BATCH_SHARDS *plan, uint64_t shard_records)
+{
+  for (size_t i = 0 ; i < plan->files.size () ; i++)
+    {
+      FILE *fp;
+      SLAS_HEADER *header = (SLAS_HEADER *) calloc (1, sizeof (SLAS_HEADER));
+
+      if (header == NULL || (fp = fopen64 (plan->files[i].c_str (), "rb")) == NULL)
+        {
+          fprintf (stderr, "Error opening %s :\n%s\n", plan->files[i].c_str (), strerror (errno));
+          free (header);
+          return (-1);
+        }
+
+      int32_t status = slas_read_header (fp, big_endian (), header);
+      uint64_t count = header->extended_number_of_point_records;
+
+      fclose (fp);
+      free (header);
+
+      if (status < 0)
+        {
+          fprintf (stderr, "Error reading the header of %s\n", plan->files[i].c_str ());
+          return (-1);
+        }
+
+      for (uint64_t first = 0 ; first < count ; first += shard_records)
+        {
+          BATCH_SHARD shard;
+
+          shard.file = (int32_t) i;
+          shard.first = first;
+          shard.count = std::min (shard_records, count - first);
+
+          plan->shards.push_back (shard);
+        }
+    }
+
+
+  std::string tmp = plan->dir + "/plan.tmp." + plan->owner;
+  FILE *fp = fopen (tmp.c_str (), "w");
+
+  if (fp == NULL)
+    {
+      fprintf (stderr, "Error creating %s :\n%s\n", tmp.c_str (), strerror (errno));
+      return (-1);
+    }
+
+  fprintf (fp, "%s\n%s\n%d\n", SHARD_PLAN_MAGIC, plan->mode.c_str (), (int32_t) plan->files.size ());
+
+  for (size_t i = 0 ; i < plan->files.size () ; i++) fprintf (fp, "%s\n", plan->files[i].c_str ());
+
+  fprintf (fp, "%d\n", (int32_t) plan->shards.size ());
+
+  for (size_t i = 0 ; i < plan->shards.size () ; i++)
+    fprintf (fp, "%d %" PRIu64 " %" PRIu64 "\n", plan->shards[i].file, plan->shards[i].first, plan->shards[i].count);
+
+  if (fclose (fp) || rename (tmp.c_str (), (plan->dir + "/plan").c_str ()))
+    {
+      fprintf (stderr, "Error writing %s :\n%s\n", tmp.c_str (), strerror (errno));
+      remove (tmp.c_str ());
+      return (-1);
+    }
+
+
+  return (0);
+}
+
+
+
+//  Read a plan written by another process and make sure it's for the same job.
+
+static int32_t shard_read_plan (BATCH_SHARDS *plan, const std::vector<std::string> &files)
+{
+  std::string name = plan->dir + "/plan";
+  FILE *fp = fopen (name.c_str (), "r");
+  char line[2048];
+  int32_t count, status = -1;
+
+
+  if (fp == NULL) return (-1);
+
+  plan->files.clear ();
+  plan->shards.clear ();
+
+  if (fgets (line, sizeof (line), fp) && !strncmp (line, SHARD_PLAN_MAGIC, strlen (SHARD_PLAN_MAGIC)) &&
+      fgets (line, sizeof (line), fp) && plan->mode == std::string (line, strcspn (line, "\n")) &&
+      fgets (line, sizeof (line), fp) && sscanf (line, "%d", &count) == 1)
+    {
+      for (int32_t i = 0 ; i < count && fgets (line, sizeof (line), fp) ; i++) plan->files.push_back (std::string (line, strcspn (line, "\n")));
+
+      if (fgets (line, sizeof (line), fp) && sscanf (line, "%d", &count) == 1)
+        {
+          for (int32_t i = 0 ; i < count && fgets (line, sizeof (line), fp) ; i++)
+            {
+              BATCH_SHARD shard;
+
+              if (sscanf (line, "%d %" SCNu64 " %" SCNu64, &shard.file, &shard.first, &shard.count) == 3) plan->shards.push_back (shard);
+            }
+
+          if ((int32_t) plan->shards.size () == count) status = 0;
+        }
+    }
+
+  fclose (fp);
+
+
+  if (status < 0)
+    {
+      fprintf (stderr, "%s is not a %s plan\n", name.c_str (), plan->mode.c_str ());
+      return (-2);
+    }
+
+  if (plan->files != files)
+    {
+      fprintf (stderr, "%s is for a different list of files\n", name.c_str ());
+      return (-2);
+    }
+
+
+  return (0);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    batch_shard_plan
+
+ - Purpose:     Make the shard plan for a batch job, or read it if another process (on this
+                or another host) already made it.
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - plan           =    The plan
+                - dir            =    The shard directory (created if needed)
+                - mode           =    The batch mode
+                - files          =    The LAS files
+                - shard_records  =    Point records per shard
+                - stale          =    Seconds before an unfinished claim is taken over
+
+ - Returns:     int32_t          =    Negative number on error, 0 on success
+
+*********************************************************************************************/
+
+int32_t batch_shard_plan (BATCH_SHARDS *plan, const char *dir, const char *mode, const std::vector<std::string> &files, uint64_t shard_records,
+                          int64_t stale)
+{
+  char host[256];
+
+
+  if (gethostname (host, sizeof (host))) strcpy (host, "localhost");
+  host[sizeof (host) - 1] = 0;
+
+  plan->dir = dir;
+  plan->mode = mode;
+  plan->stale = stale;
+  plan->owner = std::string (host) + "." + std::to_string ((int64_t) getpid ());
+  plan->next = 0;
+
+  if (shard_records < 1) shard_records = BATCH_SHARD_DEFAULT_RECORDS;
+
+
+  if (!QDir ().mkpath (QString::fromLocal8Bit (dir) + "/claims") || !QDir ().mkpath (QString::fromLocal8Bit (dir) + "/parts"))
+    {
+      fprintf (stderr, "Error creating the shard directory %s\n", dir);
+      return (-1);
+    }
+
+
+  //  Only one process makes the plan.  Everybody else waits for it as long as the plan lock is fresh.  If the process
+  //  making the plan fails it removes the lock and if it dies the lock goes stale, either way somebody else makes it.
+
+  std::string lock = plan->dir + "/plan.lock", id;
+  uint8_t wrote = NVFalse;
+
+  while (!wrote && shard_age (plan->dir + "/plan") < 0)
+    {
+      if (!shard_create (lock, plan->owner) || (shard_stale (plan, lock, stale, NVTrue, &id) && !shard_take_over (plan, lock, id)))
+        {
+          plan->files = files;
+
+          if (shard_write_plan (plan, shard_records) < 0)
+            {
+              remove (lock.c_str ());
+              return (-1);
+            }
+
+          wrote = NVTrue;
+        }
+      else if (shard_age (lock) >= 0)
+        {
+          std::this_thread::sleep_for (std::chrono::seconds (1));
+        }
+    }
+
+  if (!wrote && shard_read_plan (plan, files) < 0) return (-1);
+
+
+  plan->failed.assign (plan->shards.size (), 0);
+
+  if (!plan->shards.empty ()) plan->next = (int32_t) (getpid () % plan->shards.size ());
+
+
+  return (0);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    batch_shard_claim
+
+ - Purpose:     Claim the next shard that hasn't been finished or claimed (or whose claim is
+                stale).
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - plan           =    The plan from batch_shard_plan
+
+ - Returns:     int32_t          =    The shard or -1 if there are none left
+
+*********************************************************************************************/
+
+int32_t batch_shard_claim (BATCH_SHARDS *plan)
+{
+  int32_t count = (int32_t) plan->shards.size ();
+
+
+  //  Each process starts somewhere else so they don't all fight over the same claims.
+
+  for (int32_t j = 0 ; j < count ; j++)
+    {
+      int32_t i = (plan->next + j) % count;
+
+      if (plan->failed[i] || shard_age (shard_name (plan, "parts", i, ".out")) >= 0) continue;
+
+      std::string claim = shard_name (plan, "claims", i, ""), id;
+
+      if (!shard_create (claim, plan->owner) ||
+          (shard_stale (plan, claim, plan->stale, NVTrue, &id) && !shard_take_over (plan, claim, id)))
+        {
+          plan->next = (i + 1) % count;
+
+
+          //  Somebody may have finished it between our check and the claim.
+
+          if (shard_age (shard_name (plan, "parts", i, ".out")) >= 0) continue;
+
+          return (i);
+        }
+    }
+
+
+  return (-1);
+}
+
+
+
+//  Write a checkpoint (or aggregate) file.  It is written to a temporary file and renamed so it's never partly written.
+
+static int32_t shard_write_checkpoint (BATCH_SHARDS *plan, const std::string &path, BATCH_CHECKPOINT *checkpoint)
+{
+  std::string tmp = path + ".tmp." + plan->owner;
+  FILE *fp = fopen (tmp.c_str (), "w");
+
+  if (fp == NULL) return (-1);
+
+  fprintf (fp, "%s %" PRIu64 " %" PRId64 " %s %d", SHARD_CHECKPOINT_MAGIC, checkpoint->done, checkpoint->output_size,
+           checkpoint->partial.empty () ? "-" : checkpoint->partial.c_str (), (int32_t) checkpoint->aggregates.size ());
+
+  for (size_t i = 0 ; i < checkpoint->aggregates.size () ; i++) fprintf (fp, " %" PRId64, checkpoint->aggregates[i]);
+
+  fprintf (fp, "\n");
+
+  if (fclose (fp) || rename (tmp.c_str (), path.c_str ()))
+    {
+      remove (tmp.c_str ());
+      return (-1);
+    }
+
+
+  return (0);
+}
+
+
+
+static int32_t shard_read_checkpoint (const std::string &path, BATCH_CHECKPOINT *checkpoint)
+{
+  FILE *fp = fopen (path.c_str (), "r");
+  char magic[32], partial[512];
+  int32_t count;
+
+
+  checkpoint->done = 0;
+  checkpoint->output_size = 0;
+  checkpoint->partial.clear ();
+  checkpoint->aggregates.clear ();
+
+  if (fp == NULL) return (-1);
+
+  int32_t status = -1;
+
+  if (fscanf (fp, "%31s %" SCNu64 " %" SCNd64 " %511s %d", magic, &checkpoint->done, &checkpoint->output_size, partial, &count) == 5 &&
+      !strcmp (magic, SHARD_CHECKPOINT_MAGIC) && count >= 0 && count <= BATCH_SHARD_MAX_AGGREGATES)
+    {
+      if (strcmp (partial, "-")) checkpoint->partial = partial;
+
+      checkpoint->aggregates.resize (count);
+
+      status = 0;
+      for (int32_t i = 0 ; i < count ; i++) if (fscanf (fp, "%" SCNd64, &checkpoint->aggregates[i]) != 1) status = -1;
+    }
+
+  fclose (fp);
+
+
+  if (status < 0)
+    {
+      checkpoint->done = 0;
+      checkpoint->output_size = 0;
+      checkpoint->partial.clear ();
+      checkpoint->aggregates.clear ();
+    }
+
+  return (status);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    batch_shard_checkpoint
+
+ - Purpose:     Checkpoint a shard.  The shard output is flushed to disk and then the
+                number of records done, the output size, and the aggregates are saved.  If
+                the job is interrupted, whoever picks the shard up starts from here.
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - plan           =    The plan from batch_shard_plan
+                - shard          =    The shard
+                - out            =    The shard output file passed to the work function
+                - checkpoint     =    The checkpoint (done and aggregates set by the caller,
+                                      output_size is set here)
+
+ - Returns:     int32_t          =    Negative number on error (or if another process took
+                                      the shard over), 0 on success
+
+*********************************************************************************************/
+
+int32_t batch_shard_checkpoint (BATCH_SHARDS *plan, int32_t shard, FILE *out, BATCH_CHECKPOINT *checkpoint)
+{
+  if (fflush (out)) return (-1);
+
+
+  //  If somebody decided we were dead and took the shard over, the checkpoint is theirs now.
+
+  if (!shard_holds_claim (plan, shard))
+    {
+      fprintf (stderr, "Shard %d was taken over by another process\n", shard);
+      fflush (stderr);
+      return (-1);
+    }
+
+#ifdef _WIN32
+  _commit (fileno (out));
+#else
+  fsync (fileno (out));
+#endif
+
+  checkpoint->output_size = ftello64 (out);
+
+
+  //  Keep the claim fresh so nobody thinks we're dead.
+
+  std::string claim = shard_name (plan, "claims", shard, "");
+  utime (claim.c_str (), NULL);
+
+
+  return (shard_write_checkpoint (plan, shard_name (plan, "parts", shard, ".ckpt"), checkpoint));
+}
+
+
+
+//  Concatenate the parts (in shard order) to the output file and add up the aggregates.
+
+static int32_t shard_merge (BATCH_SHARDS *plan, const char *output, const char *output_header, BATCH_SHARD_SUMMARY summary, void *user_data)
+{
+  std::string tmp = std::string (output) + ".tmp." + plan->owner;
+  FILE *fp = fopen64 (tmp.c_str (), "wb");
+  std::vector<char> buffer (1048576);
+  std::vector<std::vector<int64_t> > file_aggregates (plan->files.size ());
+  std::vector<int64_t> total;
+  int32_t status = 0;
+
+
+  if (fp == NULL)
+    {
+      fprintf (stderr, "Error creating %s :\n%s\n", tmp.c_str (), strerror (errno));
+      return (-1);
+    }
+
+  if (output_header && fputs (output_header, fp) < 0) status = -1;
+
+  for (int32_t i = 0 ; i < (int32_t) plan->shards.size () && !status ; i++)
+    {
+      std::string part = shard_name (plan, "parts", i, ".out");
+      FILE *pfp = fopen64 (part.c_str (), "rb");
+      size_t n;
+
+      if (pfp == NULL)
+        {
+          fprintf (stderr, "Error opening %s :\n%s\n", part.c_str (), strerror (errno));
+          status = -1;
+          break;
+        }
+
+      while ((n = fread (buffer.data (), 1, buffer.size (), pfp)) > 0)
+        {
+          if (fwrite (buffer.data (), n, 1, fp) != 1)
+            {
+              status = -1;
+              break;
+            }
+        }
+
+      fclose (pfp);
+
+
+      BATCH_CHECKPOINT agg;
+
+      if (summary && !shard_read_checkpoint (shard_name (plan, "parts", i, ".agg"), &agg))
+        {
+          std::vector<int64_t> &sum = file_aggregates[plan->shards[i].file];
+
+          if (sum.size () < agg.aggregates.size ()) sum.resize (agg.aggregates.size (), 0);
+          if (total.size () < agg.aggregates.size ()) total.resize (agg.aggregates.size (), 0);
+
+          for (size_t j = 0 ; j < agg.aggregates.size () ; j++)
+            {
+              sum[j] += agg.aggregates[j];
+              total[j] += agg.aggregates[j];
+            }
+        }
+    }
+
+  if (fclose (fp)) status = -1;
+
+  if (status < 0 || rename (tmp.c_str (), output))
+    {
+      fprintf (stderr, "Error writing %s :\n%s\n", output, strerror (errno));
+      remove (tmp.c_str ());
+      return (-1);
+    }
+
+
+  //  Write the summary.
+
+  if (summary)
+    {
+      std::string name = std::string (output) + ".summary";
+      std::string stmp = name + ".tmp." + plan->owner;
+
+      if ((fp = fopen (stmp.c_str (), "w")) == NULL)
+        {
+          fprintf (stderr, "Error creating %s :\n%s\n", stmp.c_str (), strerror (errno));
+          return (-1);
+        }
+
+      for (int32_t i = 0 ; i < (int32_t) plan->files.size () ; i++) (*summary) (plan, i, file_aggregates[i], fp, user_data);
+
+      (*summary) (plan, -1, total, fp, user_data);
+
+      if (fclose (fp) || rename (stmp.c_str (), name.c_str ()))
+        {
+          fprintf (stderr, "Error writing %s :\n%s\n", name.c_str (), strerror (errno));
+          remove (stmp.c_str ());
+          return (-1);
+        }
+    }
+
+
+  return (0);
+}
+
+
+
+//  Get the output file for a shard.  Every owner writes its own file (parts/NNNNNNNN.OWNER.partial) so a process that
+//  was wrongly thought to be dead can't write over the output of the one that took its shard.  If the shard was
+//  checkpointed (by a process that died, or that we took it from) we copy the checkpointed part of that process's output
+//  to ours and carry on from there, otherwise we start over.
+
+static FILE *shard_open_output (BATCH_SHARDS *plan, int32_t shard, BATCH_CHECKPOINT *checkpoint)
+{
+  std::string partial = shard_name (plan, "parts", shard, "." + plan->owner + ".partial");
+  FILE *fp = NULL, *src = NULL;
+
+
+  if (!shard_read_checkpoint (shard_name (plan, "parts", shard, ".ckpt"), checkpoint) && checkpoint->done <= plan->shards[shard].count &&
+      !checkpoint->partial.empty () && (src = fopen64 ((plan->dir + "/parts/" + checkpoint->partial).c_str (), "rb")) != NULL)
+    {
+      uint8_t ok = NVFalse;
+
+      fseeko64 (src, 0, SEEK_END);
+
+      if (ftello64 (src) >= checkpoint->output_size && !fseeko64 (src, 0, SEEK_SET) && (fp = fopen64 (partial.c_str (), "wb")) != NULL)
+        {
+          std::vector<char> buffer (1048576);
+          int64_t left = checkpoint->output_size;
+
+          while (left > 0)
+            {
+              size_t n = fread (buffer.data (), 1, (size_t) std::min ((int64_t) buffer.size (), left), src);
+
+              if (!n || fwrite (buffer.data (), n, 1, fp) != 1) break;
+
+              left -= n;
+            }
+
+          ok = (left == 0);
+        }
+
+      fclose (src);
+
+      if (ok)
+        {
+          fprintf (stdout, "Resuming shard %d at record %" PRIu64 " of %" PRIu64 "\n", shard, checkpoint->done, plan->shards[shard].count);
+          fflush (stdout);
+
+          checkpoint->partial = partial.substr (partial.rfind ('/') + 1);
+
+          return (fp);
+        }
+
+      if (fp) fclose (fp);
+    }
+
+
+  checkpoint->done = 0;
+  checkpoint->output_size = 0;
+  checkpoint->partial = partial.substr (partial.rfind ('/') + 1);
+  checkpoint->aggregates.clear ();
+
+
+  return (fopen64 (partial.c_str (), "wb"));
+}
+
+
+
+//  Remove the partial output files (of every owner) of a shard.
+
+static void shard_remove_partials (BATCH_SHARDS *plan, int32_t shard)
+{
+  char pattern[32];
+  snprintf (pattern, sizeof (pattern), "%08d.*.partial", shard);
+
+  QDir parts (QString::fromLocal8Bit ((plan->dir + "/parts").c_str ()));
+  QStringList names = parts.entryList (QStringList (pattern), QDir::Files);
+
+  for (int32_t i = 0 ; i < names.size () ; i++) parts.remove (names[i]);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    batch_shard_run
+
+ - Purpose:     Claim and process shards until there are none left and then, if all of the
+                shards are finished, merge the output (unless another process is already
+                doing it).
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - plan           =    The plan from batch_shard_plan
+                - work           =    Called to process each shard
+                - summary        =    Called to write the aggregates to OUTPUT.summary when
+                                      the output is merged (may be NULL)
+                - user_data      =    Passed to work and summary
+                - output         =    The merged output file
+                - output_header  =    Written at the start of the merged output (may be NULL)
+
+ - Returns:     int32_t          =    Negative number if a shard or the merge failed, 0
+                                      otherwise (even if other processes still have shards
+                                      to finish)
+
+*********************************************************************************************/
+
+int32_t batch_shard_run (BATCH_SHARDS *plan, BATCH_SHARD_WORK work, BATCH_SHARD_SUMMARY summary, void *user_data, const char *output,
+                         const char *output_header)
+{
+  int32_t shard, failures = 0, done = 0;
+
+
+  while ((shard = batch_shard_claim (plan)) >= 0)
+    {
+      std::string part = shard_name (plan, "parts", shard, ".out");
+      BATCH_CHECKPOINT checkpoint;
+      FILE *fp = shard_open_output (plan, shard, &checkpoint);
+      int32_t status = -1;
+
+      if (fp != NULL)
+        {
+          status = (*work) (plan, shard, fp, &checkpoint, user_data);
+          if (fclose (fp)) status = -1;
+        }
+
+
+      //  Only the process that still holds the claim finishes the shard.  The aggregates go in first since the .out file
+      //  means that the shard is done.
+
+      uint8_t holds = shard_holds_claim (plan, shard);
+
+      if (status < 0 || !holds || shard_write_checkpoint (plan, shard_name (plan, "parts", shard, ".agg"), &checkpoint) < 0 ||
+          rename (shard_name (plan, "parts", shard, "." + plan->owner + ".partial").c_str (), part.c_str ()))
+        {
+          fprintf (stderr, "Shard %d (%s records %" PRIu64 " to %" PRIu64 ") failed, leaving it for another process\n", shard,
+                   plan->files[plan->shards[shard].file].c_str (), plan->shards[shard].first,
+                   plan->shards[shard].first + plan->shards[shard].count - 1);
+          fflush (stderr);
+
+          if (holds) remove (shard_name (plan, "claims", shard, "").c_str ());
+          plan->failed[shard] = 1;
+          failures++;
+          continue;
+        }
+
+      remove (shard_name (plan, "parts", shard, ".ckpt").c_str ());
+      shard_remove_partials (plan, shard);
+      done++;
+    }
+
+
+  //  See if everything is finished.
+
+  int32_t finished = 0;
+
+  for (int32_t i = 0 ; i < (int32_t) plan->shards.size () ; i++) if (shard_age (shard_name (plan, "parts", i, ".out")) >= 0) finished++;
+
+  fprintf (stdout, "%s : %d shards done by %s, %d of %d finished\n", plan->dir.c_str (), done, plan->owner.c_str (), finished,
+           (int32_t) plan->shards.size ());
+  fflush (stdout);
+
+  if (finished < (int32_t) plan->shards.size ()) return (failures ? -1 : 0);
+
+
+  //  Whoever gets the merge lock writes the output.
+
+  //  The merge lock is left behind when the merge is done so its owner being gone doesn't make it stale.
+
+  std::string lock = plan->dir + "/merge.lock", id;
+
+  if (shard_create (lock, plan->owner) && (!shard_stale (plan, lock, plan->stale, NVFalse, &id) || shard_take_over (plan, lock, id)))
+    return (failures ? -1 : 0);
+
+  if (shard_merge (plan, output, output_header, summary, user_data) < 0)
+    {
+      remove (lock.c_str ());
+      return (-1);
+    }
+
+  fprintf (stdout, "%s : merged %d shards\n", output, (int32_t) plan->shards.size ());
+  fflush (stdout);
+
+
+  return (failures ? -1 : 0);
+}
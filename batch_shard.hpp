@@ -0,0 +1,142 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! or / / ! are being used by Doxygen to
+    document the software.  Dashes in these comment blocks are used to create bullet lists.
+    The lack of blank lines after a block of dash preceeded comments means that the next
+    block of dash preceeded comments is a new, indented bullet list.  I've tried to keep the
+    Doxygen formatting to a minimum but there are some other items (like <br> and <pre>)
+    that need to be left alone.  If you see a comment that starts with / * ! or / / ! and
+    there is something that looks a bit weird it is probably due to some arcane Doxygen
+    syntax.  Be very careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+/*  Sharded (multi-process, multi-host) batch processing definitions.  */
+
+#ifndef __BATCH_SHARD_HPP__
+#define __BATCH_SHARD_HPP__
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/types.h>
+
+#include <string>
+#include <vector>
+
+#include "slas.hpp"
+
+
+#define BATCH_SHARD_DEFAULT_RECORDS   50000    //!<  Point records per shard
+#define BATCH_SHARD_DEFAULT_STALE     3600     //!<  Seconds before an unfinished claim is taken over
+#define BATCH_SHARD_DEFAULT_CHECKPOINT 10000    //!<  Point records between checkpoints
+
+
+/*!  A batch job over a list of LAS files is split into shards of (file, first record, number of records).  Every process
+     that works on the job (on this host or any other host that mounts the shard directory) does the same thing:
+
+     - Make the plan (DIR/plan) if nobody has yet.  The process that creates DIR/plan.lock writes it to a temporary
+       file and renames it into place so nobody reads a partial plan.  Everybody else waits (while the lock is fresh)
+       and reads it.
+     - Claim shards by creating DIR/claims/NNNNNNNN with O_EXCL (atomic on local file systems and NFS v3 and up).  A
+       claim that is older than the stale time without its output is renamed out of the way (and checked to make sure it's
+       the claim that was judged stale) and claimed again.
+     - Write each shard's output to DIR/parts/NNNNNNNN.OWNER.partial and, if the claim is still ours, rename it to
+       NNNNNNNN.out when it's finished.
+     - When every shard has its output, whoever creates DIR/merge.lock first concatenates the parts, in shard order, to
+       the output file.
+
+     Nothing but the file system is shared so it runs the same way as several local processes (--jobs) or on several
+     hosts.  Shard output only depends on the shard so the merged output is the same no matter who did what.
+
+     Long shards are checkpointed.  The work function processes the shard in pieces and, after each one, calls
+     batch_shard_checkpoint which flushes the shard output and writes the name of the output file, the number of records
+     done, the size of the output for them, and the partial aggregates to DIR/parts/NNNNNNNN.ckpt.  Whoever claims the
+     shard next (a restarted job takes over claims of dead processes on the same host right away) copies the checkpointed
+     part of that file to its own output file and carries on from there, so the result is byte for byte the same as an
+     uninterrupted run.
+     The aggregates of all of the shards are added up by file when the output is merged.  */
+
+typedef struct
+{
+  int32_t                     file;           //!<  Index into files
+  uint64_t                    first;          //!<  First (zero based) point record
+  uint64_t                    count;
+} BATCH_SHARD;
+
+
+typedef struct
+{
+  std::string                 dir;
+  std::string                 mode;           //!<  Batch mode (so one directory can't be used for two different jobs)
+  std::vector<std::string>    files;
+  std::vector<BATCH_SHARD>    shards;
+  int64_t                     stale;          //!<  Seconds
+  std::string                 owner;          //!<  host.pid, written in our claims
+  int32_t                     next;           //!<  Where this process starts looking for a shard to claim
+  std::vector<uint8_t>        failed;         //!<  Shards that failed in this process (left for somebody else)
+} BATCH_SHARDS;
+
+
+#define BATCH_SHARD_MAX_AGGREGATES    64
+
+
+/*!  Checkpoint of a shard.  Aggregates are integers so that adding them up doesn't depend on the order.  */
+
+typedef struct
+{
+  uint64_t                    done;           //!<  Records of the shard that are finished
+  int64_t                     output_size;    //!<  Bytes of shard output for them
+  std::string                 partial;        //!<  Shard output file (in DIR/parts) that output_size is for
+  std::vector<int64_t>        aggregates;     //!<  Work specific partial aggregates (the work function sizes it)
+} BATCH_CHECKPOINT;
+
+
+/*!  Called to process one shard.  It starts at record checkpoint->done of the shard (with checkpoint->aggregates as they
+     were) and writes the shard's output to out.  It should call batch_shard_checkpoint every now and then.  Return a
+     negative number on error (the shard is released so that it will be tried again).  */
+
+typedef int32_t (*BATCH_SHARD_WORK) (BATCH_SHARDS *plan, int32_t shard, FILE *out, BATCH_CHECKPOINT *checkpoint, void *user_data);
+
+
+/*!  Called once, by the process that merges the output, with the aggregates of every file (file is -1 for the total of
+     all files).  */
+
+typedef void (*BATCH_SHARD_SUMMARY) (BATCH_SHARDS *plan, int32_t file, const std::vector<int64_t> &aggregates, FILE *out, void *user_data);
+
+
+int32_t batch_shard_plan (BATCH_SHARDS *plan, const char *dir, const char *mode, const std::vector<std::string> &files, uint64_t shard_records,
+                          int64_t stale);
+int32_t batch_shard_claim (BATCH_SHARDS *plan);
+int32_t batch_shard_checkpoint (BATCH_SHARDS *plan, int32_t shard, FILE *out, BATCH_CHECKPOINT *checkpoint);
+int32_t batch_shard_run (BATCH_SHARDS *plan, BATCH_SHARD_WORK work, BATCH_SHARD_SUMMARY summary, void *user_data, const char *output,
+                         const char *output_header);
+
+
+#endif
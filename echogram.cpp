@@ -0,0 +1,548 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! or / / ! are being used by Doxygen to
+    document the software.  Dashes in these comment blocks are used to create bullet lists.
+    The lack of blank lines after a block of dash preceeded comments means that the next
+    block of dash preceeded comments is a new, indented bullet list.  I've tried to keep the
+    Doxygen formatting to a minimum but there are some other items (like <br> and <pre>)
+    that need to be left alone.  If you see a comment that starts with / * ! or / / ! and
+    there is something that looks a bit weird it is probably due to some arcane Doxygen
+    syntax.  Be very careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+#include "echogram.hpp"
+
+
+
+//  Blend two colors (t from 0 to 1).
+
+static QRgb echogram_blend (QColor a, QColor b, double t)
+{
+  return (qRgb (a.red () + qRound ((b.red () - a.red ()) * t), a.green () + qRound ((b.green () - a.green ()) * t),
+                a.blue () + qRound ((b.blue () - a.blue ()) * t)));
+}
+
+
+
+echogram::echogram (QWidget *parent, int32_t ord):
+  QWidget (parent, (Qt::WindowFlags) Qt::Window)
+{
+  echo = NULL;
+  swap = NVFalse;
+  follow = NVTrue;
+  dragging = NVFalse;
+  order = ord;
+  generation = -1;
+  drag_x = 0;
+  mouse_x = -1;
+  recnum = 0;
+  start = 0.0;
+  scale = 1.0;
+  drag_start = 0.0;
+  memset (&lasheader, 0, sizeof (SLAS_HEADER));
+
+
+  setWindowTitle (tr ("LASwaveMonitor Echogram"));
+  resize (ECHOGRAM_X_SIZE, ECHOGRAM_Y_SIZE);
+  setMouseTracking (true);
+  setFocusPolicy (Qt::StrongFocus);
+  setAttribute (Qt::WA_OpaquePaintEvent);
+
+  setColors (Qt::black, Qt::white, Qt::red);
+
+
+  //  The tiles are built in the background so we check for new ones every so often.
+
+  refreshTimer = new QTimer (this);
+  connect (refreshTimer, SIGNAL (timeout ()), this, SLOT (slotRefresh ()));
+  refreshTimer->start (ECHOGRAM_REFRESH);
+}
+
+
+
+echogram::~echogram ()
+{
+  slas_echogram_close (echo);
+}
+
+
+
+//  Set the current record.  A new echogram is started when the file changes.
+
+void 
+echogram::setRecord (const char *name, SLAS_HEADER *header, uint8_t swp, uint64_t rec)
+{
+  recnum = rec;
+
+  if (!echo || las_name != QString (name))
+    {
+      las_name = QString (name);
+      lasheader = *header;
+      swap = swp;
+      follow = NVTrue;
+
+      openEchogram ();
+    }
+
+
+  //  Keep the current record in view unless the user has moved away from it.
+
+  if (follow && echo)
+    {
+      int64_t column = slas_echogram_column (echo, recnum);
+      double span = (double) width () * scale;
+
+      if (column >= 0 && (column < start + span * ECHOGRAM_FOLLOW_MARGIN || column > start + span * (1.0 - ECHOGRAM_FOLLOW_MARGIN)))
+        centerOn (column);
+    }
+
+  update ();
+}
+
+
+
+//  The color table goes from the background color through the waveform color to white.  The square root stretch brings
+//  out the weak water column returns.
+
+void 
+echogram::setColors (QColor background, QColor wave, QColor marker)
+{
+  if (colorTable.size () == 256 && background == backgroundColor && wave == waveColor && marker == markerColor) return;
+
+  backgroundColor = background;
+  waveColor = wave;
+  markerColor = marker;
+
+  colorTable.resize (256);
+
+  for (int32_t i = 0 ; i < 256 ; i++)
+    {
+      double t = sqrt ((double) i / 255.0);
+
+      if (t < 0.7)
+        {
+          colorTable[i] = echogram_blend (backgroundColor, waveColor, t / 0.7);
+        }
+      else
+        {
+          colorTable[i] = echogram_blend (waveColor, Qt::white, (t - 0.7) / 0.3);
+        }
+    }
+
+  update ();
+}
+
+
+
+int32_t 
+echogram::getOrder ()
+{
+  return (order);
+}
+
+
+
+//  Free the echogram (when the window is turned off).
+
+void 
+echogram::clear ()
+{
+  slas_echogram_close (echo);
+  echo = NULL;
+  las_name = "";
+}
+
+
+
+void 
+echogram::openEchogram ()
+{
+  slas_echogram_close (echo);
+
+  echo = slas_echogram_open (las_name.toLocal8Bit ().constData (), &lasheader, swap, order, 0);
+  generation = -1;
+
+  setWindowTitle (tr ("LASwaveMonitor Echogram : ") + QFileInfo (las_name).fileName ());
+
+  scale = 1.0;
+  if (echo) centerOn (slas_echogram_column (echo, recnum));
+}
+
+
+
+void 
+echogram::centerOn (int64_t column)
+{
+  if (column < 0) return;
+
+  start = (double) column - (double) width () * scale / 2.0;
+
+  clampView ();
+}
+
+
+
+//  Keep the zoom between ECHOGRAM_MIN_SCALE and the whole file in the window, and keep part of the file in the window.
+
+void 
+echogram::clampView ()
+{
+  if (!echo) return;
+
+  double max_scale = 1.0;
+  while (max_scale * width () < echo->columns) max_scale *= 2.0;
+
+  scale = qMax (ECHOGRAM_MIN_SCALE, qMin (scale, max_scale));
+
+  double span = (double) width () * scale;
+
+  start = qMax (-span / 2.0, qMin (start, (double) echo->columns - span / 2.0));
+}
+
+
+
+//  The bottom line of the window is used for the status text.
+
+int32_t 
+echogram::plotHeight ()
+{
+  return (qMax (1, height () - fontMetrics ().height () - 4));
+}
+
+
+
+void 
+echogram::paintEvent (QPaintEvent *e __attribute__ ((unused)))
+{
+  QPainter painter (this);
+
+  painter.fillRect (rect (), QColor (colorTable[0]));
+
+  int32_t plot_h = plotHeight ();
+  int32_t text_y = height () - fontMetrics ().descent () - 2;
+
+
+  if (!echo)
+    {
+      painter.setPen (waveColor);
+      painter.drawText (QRect (0, 0, width (), plot_h), Qt::AlignCenter, las_name.isEmpty () ? tr ("No file") : tr ("No waveforms"));
+      return;
+    }
+
+
+  //  Use the level where one tile column is about one pixel.
+
+  int32_t level = 0;
+  if (scale > 1.0) level = qMin (echo->levels - 1, (int32_t) floor (log2 (scale) + 0.001));
+
+  int64_t span = (int64_t) SLAS_ECHOGRAM_TILE_COLUMNS << level;
+  int64_t first_tile = qMax ((int64_t) 0, (int64_t) floor (start / span));
+  int64_t last_tile = qMin (slas_echogram_tile_count (echo, level) - 1, (int64_t) floor ((start + width () * scale) / span));
+
+  for (int64_t t = first_tile ; t <= last_tile ; t++)
+    {
+      QRectF target (((double) (t * span) - start) / scale, 0.0, (double) span / scale, (double) plot_h);
+
+
+      //  If the tile isn't there yet, stretch the part of the nearest coarser tile that covers it.
+
+      SLAS_ECHOGRAM_TILE tile;
+
+      for (int32_t l = level ; l < echo->levels ; l++)
+        {
+          int64_t index = (t * span) / ((int64_t) SLAS_ECHOGRAM_TILE_COLUMNS << l);
+
+          if (slas_echogram_tile (echo, l, index, &tile))
+            {
+              QImage image (tile->data (), SLAS_ECHOGRAM_TILE_COLUMNS, echo->height, SLAS_ECHOGRAM_TILE_COLUMNS, QImage::Format_Indexed8);
+              image.setColorTable (colorTable);
+
+              double sx = (double) (t * span - index * ((int64_t) SLAS_ECHOGRAM_TILE_COLUMNS << l)) / (double) (1 << l);
+
+              painter.drawImage (target, image, QRectF (sx, 0.0, (double) span / (double) (1 << l), (double) echo->height));
+              break;
+            }
+        }
+    }
+
+
+  //  Mark the current record.
+
+  int64_t column = slas_echogram_column (echo, recnum);
+
+  if (column >= 0)
+    {
+      double x = ((double) column + 0.5 - start) / scale;
+
+      painter.setPen (QPen (markerColor, qMax (1.0, 1.0 / scale)));
+      painter.drawLine (QPointF (x, 0.0), QPointF (x, (double) plot_h));
+    }
+
+
+  //  Status line.  Record numbers are shown the way the parent program shows them (starting at 1).
+
+  QString status = tr ("Record %1").arg (recnum + 1);
+
+  if (mouse_x >= 0 && echo->ordered)
+    {
+      int64_t mouse_col = (int64_t) floor (start + (double) mouse_x * scale);
+
+      if (mouse_col >= 0 && mouse_col < echo->columns)
+        status += tr ("    Cursor record %1").arg (slas_echogram_record (echo, mouse_col) + 1);
+    }
+
+  if (scale > 1.0)
+    {
+      status += tr ("    %1 records per pixel").arg ((int64_t) scale);
+    }
+
+  if (echo->status < 0)
+    {
+      status += tr ("    Error reading waveforms");
+    }
+  else if (!echo->ordered)
+    {
+      status += tr ("    Sorting by GPS time");
+    }
+  else if (!echo->done)
+    {
+      status += tr ("    Reading waveforms %1%").arg ((int32_t) (100 * echo->built / echo->columns));
+    }
+
+  painter.setPen (waveColor);
+  painter.drawText (4, text_y, status);
+}
+
+
+
+//  Zoom in or out by a factor of two around the mouse.
+
+void 
+echogram::wheelEvent (QWheelEvent *e)
+{
+  if (!echo) return;
+
+  double column = start + (double) e->x () * scale;
+
+  if (e->delta () > 0)
+    {
+      scale /= 2.0;
+    }
+  else
+    {
+      scale *= 2.0;
+    }
+
+  clampView ();
+
+  start = column - (double) e->x () * scale;
+
+  clampView ();
+  update ();
+}
+
+
+
+//  Drag with the left mouse button to pan.  That stops following the cursor.
+
+void 
+echogram::mousePressEvent (QMouseEvent *e)
+{
+  if (e->button () != Qt::LeftButton) return;
+
+  dragging = NVTrue;
+  follow = NVFalse;
+  drag_x = e->x ();
+  drag_start = start;
+}
+
+
+
+void 
+echogram::mouseMoveEvent (QMouseEvent *e)
+{
+  mouse_x = e->x ();
+
+  if (dragging)
+    {
+      start = drag_start - (double) (e->x () - drag_x) * scale;
+      clampView ();
+    }
+
+  update ();
+}
+
+
+
+void 
+echogram::mouseReleaseEvent (QMouseEvent *e)
+{
+  if (e->button () == Qt::LeftButton) dragging = NVFalse;
+}
+
+
+
+void 
+echogram::keyPressEvent (QKeyEvent *e)
+{
+  if (!echo) return;
+
+  double span = (double) width () * scale;
+
+  switch (e->key ())
+    {
+    case Qt::Key_Left:
+      follow = NVFalse;
+      start -= span / 2.0;
+      break;
+
+    case Qt::Key_Right:
+      follow = NVFalse;
+      start += span / 2.0;
+      break;
+
+    case Qt::Key_Home:
+      follow = NVFalse;
+      start = 0.0;
+      break;
+
+    case Qt::Key_End:
+      follow = NVFalse;
+      start = (double) echo->columns - span;
+      break;
+
+    case Qt::Key_Plus:
+    case Qt::Key_Equal:
+      scale /= 2.0;
+      start += span / 4.0;
+      break;
+
+    case Qt::Key_Minus:
+      scale *= 2.0;
+      start -= span / 2.0;
+      break;
+
+    case Qt::Key_F:
+    case Qt::Key_Space:
+      follow = NVTrue;
+      centerOn (slas_echogram_column (echo, recnum));
+      break;
+
+    default:
+      QWidget::keyPressEvent (e);
+      return;
+    }
+
+  clampView ();
+  update ();
+}
+
+
+
+void 
+echogram::contextMenuEvent (QContextMenuEvent *e)
+{
+  QMenu menu (this);
+
+  QAction *followAct = menu.addAction (tr ("Follow the cursor"));
+  followAct->setCheckable (true);
+  followAct->setChecked (follow);
+
+  menu.addSeparator ();
+
+  QAction *recordAct = menu.addAction (tr ("Record order"));
+  recordAct->setCheckable (true);
+  recordAct->setChecked (order == SLAS_ECHOGRAM_RECORD_ORDER);
+
+  QAction *timeAct = menu.addAction (tr ("GPS time order"));
+  timeAct->setCheckable (true);
+  timeAct->setChecked (order == SLAS_ECHOGRAM_TIME_ORDER);
+
+  menu.addSeparator ();
+
+  QAction *reloadAct = menu.addAction (tr ("Reload"));
+
+
+  QAction *act = menu.exec (e->globalPos ());
+
+  if (act == followAct)
+    {
+      follow = !follow;
+      if (follow && echo) centerOn (slas_echogram_column (echo, recnum));
+    }
+  else if ((act == recordAct && order != SLAS_ECHOGRAM_RECORD_ORDER) || (act == timeAct && order != SLAS_ECHOGRAM_TIME_ORDER))
+    {
+      order = (act == timeAct) ? SLAS_ECHOGRAM_TIME_ORDER : SLAS_ECHOGRAM_RECORD_ORDER;
+      if (!las_name.isEmpty ()) openEchogram ();
+    }
+  else if (act == reloadAct)
+    {
+      //  Pick up records that were added to the file since the echogram was started (tail mode).
+
+      FILE *fp;
+
+      if (!las_name.isEmpty () && (fp = fopen64 (las_name.toLocal8Bit ().constData (), "rb")) != NULL)
+        {
+          slas_refresh_point_count (fp, swap, &lasheader);
+          fclose (fp);
+
+          openEchogram ();
+        }
+    }
+
+  update ();
+}
+
+
+
+void 
+echogram::closeEvent (QCloseEvent *e)
+{
+  emit closed ();
+
+  QWidget::closeEvent (e);
+}
+
+
+
+//  Redraw when tiles have been added.  In GPS time order the current record's column isn't known until the sort is done
+//  so we check for that too.
+
+void 
+echogram::slotRefresh ()
+{
+  if (!echo || !isVisible ()) return;
+
+  if (generation != echo->generation)
+    {
+      if (generation < 0 && follow) centerOn (slas_echogram_column (echo, recnum));
+
+      generation = echo->generation;
+      update ();
+    }
+}
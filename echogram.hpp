@@ -0,0 +1,144 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! or / / ! are being used by Doxygen to
+    document the software.  Dashes in these comment blocks are used to create bullet lists.
+    The lack of blank lines after a block of dash preceeded comments means that the next
+    block of dash preceeded comments is a new, indented bullet list.  I've tried to keep the
+    Doxygen formatting to a minimum but there are some other items (like <br> and <pre>)
+    that need to be left alone.  If you see a comment that starts with / * ! or / / ! and
+    there is something that looks a bit weird it is probably due to some arcane Doxygen
+    syntax.  Be very careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+
+/*  Echogram (waterfall) window definitions.  */
+
+#ifndef ECHOGRAM_H
+#define ECHOGRAM_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <cmath>
+
+#include "nvutility.h"
+
+#include "slas.hpp"
+#include "slas_echogram.hpp"
+
+
+#include <QtCore>
+#include <QtGui>
+#if QT_VERSION >= 0x050000
+#include <QtWidgets>
+#endif
+
+
+#define ECHOGRAM_X_SIZE           800
+#define ECHOGRAM_Y_SIZE           300
+#define ECHOGRAM_REFRESH          100      //  Milliseconds between checks for new tiles
+#define ECHOGRAM_MIN_SCALE        0.125    //  Columns per pixel when zoomed all the way in
+#define ECHOGRAM_FOLLOW_MARGIN    0.1      //  Part of the window at each edge that makes the view recenter when following
+
+
+/*  Echogram window.  Each point record's waveform is drawn as a column of intensities (first sample at the top) so the
+    water surface, water column, and bottom can be followed along the flightline.  The tiles come from the SLAS_ECHOGRAM
+    pyramid level that matches the zoom.  Tiles that haven't been built yet are drawn from the nearest coarser level
+    that has them.  */
+
+class echogram:public QWidget
+{
+  Q_OBJECT 
+
+
+public:
+
+  echogram (QWidget *parent = 0, int32_t order = SLAS_ECHOGRAM_RECORD_ORDER);
+  ~echogram ();
+
+  void setRecord (const char *las_name, SLAS_HEADER *lasheader, uint8_t swap, uint64_t rec);
+  void setColors (QColor background, QColor wave, QColor marker);
+  int32_t getOrder ();
+  void clear ();
+
+
+signals:
+
+  void closed ();
+
+
+protected:
+
+  SLAS_ECHOGRAM   *echo;
+
+  QString         las_name;
+
+  SLAS_HEADER     lasheader;
+
+  uint8_t         swap, follow, dragging;
+
+  int32_t         order, generation, drag_x, mouse_x;
+
+  uint64_t        recnum;           //  Current record (records start at 0)
+
+  double          start;            //  Column at the left edge of the window
+
+  double          scale;            //  Columns per pixel
+
+  double          drag_start;
+
+  QVector<QRgb>   colorTable;
+
+  QColor          backgroundColor, waveColor, markerColor;
+
+  QTimer          *refreshTimer;
+
+
+  void openEchogram ();
+  void centerOn (int64_t column);
+  void clampView ();
+  int32_t plotHeight ();
+
+  void paintEvent (QPaintEvent *e);
+  void wheelEvent (QWheelEvent *e);
+  void mousePressEvent (QMouseEvent *e);
+  void mouseMoveEvent (QMouseEvent *e);
+  void mouseReleaseEvent (QMouseEvent *e);
+  void keyPressEvent (QKeyEvent *e);
+  void contextMenuEvent (QContextMenuEvent *e);
+  void closeEvent (QCloseEvent *e);
+
+
+protected slots:
+
+  void slotRefresh ();
+
+
+ private:
+};
+
+#endif
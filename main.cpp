@@ -37,12 +37,23 @@
 
 
 #include "LASwaveMonitor.hpp"
+#include "batch.hpp"
 #include <qapplication.h>
 
 
 int32_t
 main (int32_t argc, char **argv)
 {
+    //  Batch (command line) modes don't need the GUI or shared memory.
+
+    if (argc > 1 && !strcmp (argv[1], "--batch")) return (batch_main (argc - 1, &argv[1]));
+
+
+    //  Startup is timed from here (see --timing).
+
+    LASwaveMonitor::startupClock.start ();
+
+
     QApplication a (argc, argv);
 
     LASwaveMonitor *wm = new LASwaveMonitor (&argc, argv);
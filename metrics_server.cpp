@@ -0,0 +1,335 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! or / / ! are being used by Doxygen to
+    document the software.  Dashes in these comment blocks are used to create bullet lists.
+    The lack of blank lines after a block of dash preceeded comments means that the next
+    block of dash preceeded comments is a new, indented bullet list.  I've tried to keep the
+    Doxygen formatting to a minimum but there are some other items (like <br> and <pre>)
+    that need to be left alone.  If you see a comment that starts with / * ! or / / ! and
+    there is something that looks a bit weird it is probably due to some arcane Doxygen
+    syntax.  Be very careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+#include "metrics_server.hpp"
+
+
+
+metricsServer::metricsServer (QObject *parent, QString name, int32_t key, SLAS_SHARED_CACHE *cache):
+  QObject (parent)
+{
+  sharedCache = cache;
+  upClock.start ();
+
+  labels = QString ("pid=\"%1\",key=\"%2\"").arg (QCoreApplication::applicationPid ()).arg (key);
+
+
+  //  If we were given a directory we make our own socket in it.
+
+  path = QFileInfo (name).absoluteFilePath ();
+
+  if (QFileInfo (name).isDir ()) path = QDir (path).absoluteFilePath (QString ("LASwaveMonitor_%1.sock").arg (QCoreApplication::applicationPid ()));
+
+
+  server = new QLocalServer (this);
+  server->setSocketOptions (QLocalServer::UserAccessOption);
+
+
+  //  A socket left behind by a monitor that died would keep us from listening.  Anything else with that name (a file,
+  //  or the socket of a monitor that's still running) is left alone and we don't serve the metrics.
+
+#ifndef _WIN32
+  struct stat st;
+
+  if (!lstat (path.toLocal8Bit ().constData (), &st))
+    {
+      uint8_t in_use = NVFalse;
+
+      if (S_ISSOCK (st.st_mode))
+        {
+          QLocalSocket probe;
+
+          probe.connectToServer (path);
+          in_use = probe.waitForConnected (METRICS_PROBE_TIMEOUT);
+          probe.abort ();
+        }
+
+      if (!S_ISSOCK (st.st_mode) || in_use)
+        {
+          fprintf (stderr, "Not serving metrics, %s %s\n", path.toLocal8Bit ().constData (),
+                   in_use ? "is in use by another process" : "already exists and is not a socket");
+          fflush (stderr);
+          return;
+        }
+
+      QLocalServer::removeServer (path);
+    }
+#endif
+
+  if (!server->listen (path))
+    {
+      fprintf (stderr, "Unable to listen for metrics requests on %s : %s\n", path.toLocal8Bit ().constData (),
+               server->errorString ().toLocal8Bit ().constData ());
+      fflush (stderr);
+      return;
+    }
+
+  connect (server, SIGNAL (newConnection ()), this, SLOT (slotNewConnection ()));
+}
+
+
+
+metricsServer::~metricsServer ()
+{
+  //  This removes the socket.
+
+  server->close ();
+}
+
+
+
+uint8_t
+metricsServer::isListening ()
+{
+  return (server->isListening ());
+}
+
+
+
+QString
+metricsServer::socketPath ()
+{
+  return (path);
+}
+
+
+
+//  Add the HELP and TYPE lines and one sample.  Extra labels (name="value") can be added to the ones that every sample
+//  has.  If help is NULL only the sample is added (for the second and later samples of a metric).
+
+void
+metricsServer::metric (QByteArray &out, const char *name, const char *type, const char *help, double value, QString extra)
+{
+  if (help)
+    {
+      out += QString ("# HELP %1 %2\n# TYPE %1 %3\n").arg (name).arg (help).arg (type).toUtf8 ();
+    }
+
+  out += QString ("%1{%2%3} ").arg (name).arg (labels).arg (extra.isEmpty () ? QString () : "," + extra).toUtf8 ();
+
+  if (std::isnan (value))
+    {
+      out += "NaN\n";
+    }
+  else
+    {
+      out += QByteArray::number (value, 'g', 15) + "\n";
+    }
+}
+
+
+
+//  Make the metrics text (Prometheus text exposition format 0.0.4).
+
+QByteArray
+metricsServer::text ()
+{
+  SLAS_METRICS_TOTALS totals;
+  QByteArray out;
+
+
+  slas_metrics_totals (&totals);
+
+
+  double displayed = totals.counter[SLAS_METRIC_RECORDS_DISPLAYED];
+  double skipped = totals.counter[SLAS_METRIC_RECORDS_SKIPPED] + totals.counter[SLAS_METRIC_RING_OVERFLOWS];
+  double hits = totals.counter[SLAS_METRIC_CACHE_HITS], misses = totals.counter[SLAS_METRIC_CACHE_MISSES];
+  double laz_hits = totals.counter[SLAS_METRIC_LAZ_HITS], laz_misses = totals.counter[SLAS_METRIC_LAZ_MISSES];
+
+
+  metric (out, "laswavemonitor_uptime_seconds", "gauge", "Seconds since the metrics endpoint was started.", upClock.elapsed () / 1000.0);
+
+  metric (out, "laswavemonitor_records_displayed_total", "counter", "New point records whose waveforms were drawn.", displayed);
+  metric (out, "laswavemonitor_records_skipped_total", "counter",
+          "Point records the cursor passed over that weren't drawn (only known when the parent queues record changes).",
+          totals.counter[SLAS_METRIC_RECORDS_SKIPPED]);
+  metric (out, "laswavemonitor_record_ring_overflows_total", "counter", "Record changes lost because the record ring overflowed.",
+          totals.counter[SLAS_METRIC_RING_OVERFLOWS]);
+  metric (out, "laswavemonitor_record_drop_ratio", "gauge", "Skipped and lost records over all of the records the cursor went to.",
+          displayed + skipped > 0.0 ? skipped / (displayed + skipped) : NAN);
+
+  metric (out, "laswavemonitor_shared_cache_hits_total", "counter", "Shared waveform cache lookups by this process that hit.", hits);
+  metric (out, "laswavemonitor_shared_cache_misses_total", "counter", "Shared waveform cache lookups by this process that missed.", misses);
+  metric (out, "laswavemonitor_shared_cache_hit_ratio", "gauge", "Shared waveform cache hit ratio for this process.",
+          hits + misses > 0.0 ? hits / (hits + misses) : NAN);
+
+  if (sharedCache)
+    {
+      uint64_t machine_hits, machine_misses;
+
+      slas_shared_cache_stats (sharedCache, &machine_hits, &machine_misses);
+
+      metric (out, "laswavemonitor_shared_cache_machine_hits_total", "counter", "Shared waveform cache hits by every process on the machine.",
+              machine_hits);
+      metric (out, "laswavemonitor_shared_cache_machine_misses_total", "counter",
+              "Shared waveform cache misses by every process on the machine.", machine_misses);
+    }
+
+  metric (out, "laswavemonitor_laz_cache_hits_total", "counter", "LAZ point reads from an already decompressed chunk.", laz_hits);
+  metric (out, "laswavemonitor_laz_cache_misses_total", "counter", "LAZ point reads that had to decompress a chunk.", laz_misses);
+  metric (out, "laswavemonitor_laz_cache_hit_ratio", "gauge", "LAZ chunk cache hit ratio.",
+          laz_hits + laz_misses > 0.0 ? laz_hits / (laz_hits + laz_misses) : NAN);
+
+  metric (out, "laswavemonitor_read_bytes_total", "counter", "Bytes read from LAS, .wdp, and .wdc files.",
+          totals.counter[SLAS_METRIC_POINT_BYTES], "kind=\"point\"");
+  metric (out, "laswavemonitor_read_bytes_total", NULL, NULL, totals.counter[SLAS_METRIC_WAVE_BYTES], "kind=\"waveform\"");
+
+  metric (out, "laswavemonitor_open_failures_total", "counter", "Failed attempts to open or read a LAS or waveform file.",
+          totals.counter[SLAS_METRIC_OPEN_FAILURES]);
+
+
+  int64_t resident;
+  int32_t open_files;
+
+  if (!slas_metrics_process (&resident, &open_files))
+    {
+      metric (out, "laswavemonitor_open_files", "gauge", "Open file descriptors.", open_files);
+      metric (out, "laswavemonitor_resident_memory_bytes", "gauge", "Resident memory size in bytes.", resident);
+    }
+
+
+  //  The latency histogram buckets are cumulative in the exposition format.
+
+  uint64_t cumulative = 0;
+
+  out += "# HELP laswavemonitor_record_to_pixel_seconds Time from seeing a new record in shared memory to having its waveform drawn.\n";
+  out += "# TYPE laswavemonitor_record_to_pixel_seconds histogram\n";
+
+  for (int32_t i = 0 ; i <= SLAS_METRICS_LATENCY_BUCKETS ; i++)
+    {
+      cumulative += totals.latency[i];
+
+      QString le = i < SLAS_METRICS_LATENCY_BUCKETS ? QString::number (slas_metrics_bucket_bound (i)) : QString ("+Inf");
+
+      metric (out, "laswavemonitor_record_to_pixel_seconds_bucket", NULL, NULL, cumulative, QString ("le=\"%1\"").arg (le));
+    }
+
+  metric (out, "laswavemonitor_record_to_pixel_seconds_sum", NULL, NULL, totals.latency_sum);
+  metric (out, "laswavemonitor_record_to_pixel_seconds_count", NULL, NULL, totals.latency_count);
+
+  metric (out, "laswavemonitor_record_to_pixel_p95_seconds", "gauge",
+          "95th percentile record to pixel latency (estimated from the histogram).", slas_metrics_percentile (&totals, 0.95));
+
+
+  return (out);
+}
+
+
+
+//  Send the metrics and close the connection.
+
+void
+metricsServer::respond (QLocalSocket *socket, uint8_t http)
+{
+  QByteArray body = text ();
+
+
+  socket->setProperty ("answered", true);
+
+  if (http)
+    {
+      QByteArray header = "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4; charset=utf-8\r\n";
+
+      header += "Content-Length: " + QByteArray::number (body.size ()) + "\r\nConnection: close\r\n\r\n";
+
+      socket->write (header);
+    }
+
+  socket->write (body);
+
+
+  //  This waits for the data to be written before disconnecting.
+
+  socket->disconnectFromServer ();
+}
+
+
+
+void
+metricsServer::slotNewConnection ()
+{
+  while (server->hasPendingConnections ())
+    {
+      QLocalSocket *socket = server->nextPendingConnection ();
+
+      connect (socket, SIGNAL (readyRead ()), this, SLOT (slotReadyRead ()));
+      connect (socket, SIGNAL (disconnected ()), socket, SLOT (deleteLater ()));
+
+
+      //  If the client doesn't send a request it gets plain text.
+
+      QTimer *timer = new QTimer (socket);
+      timer->setSingleShot (true);
+      connect (timer, SIGNAL (timeout ()), this, SLOT (slotPlainTimeout ()));
+      timer->start (METRICS_PLAIN_DELAY);
+    }
+}
+
+
+
+//  Wait for the end of the HTTP request header (we don't care what it asked for, there's only one thing to send).
+
+void
+metricsServer::slotReadyRead ()
+{
+  QLocalSocket *socket = qobject_cast<QLocalSocket *> (sender ());
+
+  if (!socket || socket->property ("answered").toBool ()) return;
+
+
+  QByteArray request = socket->property ("request").toByteArray () + socket->readAll ();
+
+  socket->setProperty ("request", request);
+
+  if (request.contains ("\r\n\r\n") || request.contains ("\n\n") || request.size () > METRICS_MAX_REQUEST) respond (socket, NVTrue);
+}
+
+
+
+void
+metricsServer::slotPlainTimeout ()
+{
+  QTimer *timer = qobject_cast<QTimer *> (sender ());
+  QLocalSocket *socket = timer ? qobject_cast<QLocalSocket *> (timer->parent ()) : NULL;
+
+  if (!socket || socket->property ("answered").toBool ()) return;
+
+
+  //  Somebody who started an HTTP request but didn't finish it still gets an HTTP response.
+
+  respond (socket, !socket->property ("request").toByteArray ().isEmpty ());
+}
@@ -0,0 +1,112 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! or / / ! are being used by Doxygen to
+    document the software.  Dashes in these comment blocks are used to create bullet lists.
+    The lack of blank lines after a block of dash preceeded comments means that the next
+    block of dash preceeded comments is a new, indented bullet list.  I've tried to keep the
+    Doxygen formatting to a minimum but there are some other items (like <br> and <pre>)
+    that need to be left alone.  If you see a comment that starts with / * ! or / / ! and
+    there is something that looks a bit weird it is probably due to some arcane Doxygen
+    syntax.  Be very careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+/*  Metrics endpoint definitions.  */
+
+#ifndef METRICS_SERVER_H
+#define METRICS_SERVER_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <cmath>
+
+#include "nvutility.h"
+
+#include "slas_metrics.hpp"
+#include "slas_shared_cache.hpp"
+
+
+#include <QtCore>
+#include <QtNetwork>
+
+
+#define METRICS_PLAIN_DELAY       200      //  Milliseconds to wait for an HTTP request before sending plain text
+#define METRICS_MAX_REQUEST       8192     //  Longest HTTP request header we'll wait for
+#define METRICS_PROBE_TIMEOUT     500      //  Milliseconds to wait for an answer on a socket that's already there
+
+
+/*  Serves the monitor's counters (see slas_metrics.hpp) on a local (Unix domain) socket in the Prometheus text format.  A
+    client that sends an HTTP request (curl --unix-socket SOCKET http://localhost/metrics, or a local scraper) gets an
+    HTTP response.  A client that doesn't send anything (socat - UNIX-CONNECT:SOCKET) gets the text by itself.  Either way
+    the connection is closed after one response.  If the socket name is a directory the socket is
+    DIRECTORY/LASwaveMonitor_PID.sock so a scraper can find every monitor on the machine in one place.  An existing file
+    with the socket's name is only removed if it is a socket that nobody answers on (left by a monitor that died),
+    otherwise the metrics aren't served.  */
+
+class metricsServer:public QObject
+{
+  Q_OBJECT 
+
+
+public:
+
+  metricsServer (QObject *parent, QString name, int32_t key, SLAS_SHARED_CACHE *cache);
+  ~metricsServer ();
+
+  uint8_t isListening ();
+  QString socketPath ();
+  QByteArray text ();
+
+
+protected:
+
+  QLocalServer    *server;
+
+  QString         path;
+
+  QString         labels;          //  Labels on every sample (pid="...",key="...")
+
+  SLAS_SHARED_CACHE *sharedCache;
+
+  QElapsedTimer   upClock;
+
+
+  void respond (QLocalSocket *socket, uint8_t http);
+  void metric (QByteArray &out, const char *name, const char *type, const char *help, double value, QString extra = QString ());
+
+
+protected slots:
+
+  void slotNewConnection ();
+  void slotReadyRead ();
+  void slotPlainTimeout ();
+};
+
+#endif
@@ -0,0 +1,469 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! or / / ! are being used by Doxygen to
+    document the software.  Dashes in these comment blocks are used to create bullet lists.
+    The lack of blank lines after a block of dash preceeded comments means that the next
+    block of dash preceeded comments is a new, indented bullet list.  I've tried to keep the
+    Doxygen formatting to a minimum but there are some other items (like <br> and <pre>)
+    that need to be left alone.  If you see a comment that starts with / * ! or / / ! and
+    there is something that looks a bit weird it is probably due to some arcane Doxygen
+    syntax.  Be very careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+#include <stddef.h>
+
+#include <atomic>
+
+#include "record_ring.hpp"
+#include "nvutility.hpp"
+
+#include <QtCore>
+
+
+#define RECORD_RING_MAGIC         0x52494e47u        //  "RING"
+#define RECORD_RING_VERSION       2
+
+
+static_assert (ATOMIC_INT_LOCK_FREE == 2 && ATOMIC_LLONG_LOCK_FREE == 2, "The record ring needs lock free atomics");
+
+
+typedef struct
+{
+  uint64_t                    recnum;
+  int32_t                     type;
+  uint32_t                    file;
+  uint32_t                    generation;
+  uint32_t                    pad;
+} RING_ENTRY;
+
+
+typedef struct
+{
+  std::atomic<uint32_t>       generation;
+  char                        name[RECORD_RING_NAME_SIZE];
+} RING_FILE;
+
+
+struct RECORD_RING_SEGMENT
+{
+  std::atomic<uint32_t>       magic;
+  uint32_t                    version;
+  std::atomic<uint32_t>       epoch;                 //  Bumped (odd while it's being reset) when a producer takes over
+  alignas (64) std::atomic<uint64_t> head;           //  Written by the producer
+  alignas (64) std::atomic<uint64_t> tail;           //  Written by the consumer
+  alignas (64) std::atomic<uint64_t> dropped;        //  Written by the producer
+  RING_ENTRY                  entries[RECORD_RING_ENTRIES];
+  RING_FILE                   files[RECORD_RING_FILES];
+};
+
+
+
+static QString ring_key (int32_t key)
+{
+  QString skey;
+  skey.sprintf ("%d_abe_records", key);
+
+  return (skey);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    record_ring_create
+
+ - Purpose:     Create (or take over) the record change ring for an ABE_SHARE key.  This is
+                called by the parent program, which is the only producer.
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - key            =    The ABE_SHARE key
+
+ - Returns:     RECORD_RING *    =    The ring or NULL on error
+
+*********************************************************************************************/
+
+RECORD_RING *record_ring_create (int32_t key)
+{
+  QSharedMemory *shm = new QSharedMemory (ring_key (key));
+
+
+  //  If a producer that died left one behind we just take it over.
+
+  uint8_t created = shm->create (sizeof (RECORD_RING_SEGMENT));
+
+  if (!created && (shm->error () != QSharedMemory::AlreadyExists || !shm->attach () ||
+                   (size_t) shm->size () < sizeof (RECORD_RING_SEGMENT)))
+    {
+      fprintf (stderr, "Unable to create the record ring : %s\n", shm->errorString ().toLatin1 ().data ());
+      fflush (stderr);
+      delete shm;
+      return (NULL);
+    }
+
+
+  RECORD_RING *ring = new RECORD_RING;
+
+  ring->shm = shm;
+  ring->segment = (RECORD_RING_SEGMENT *) shm->data ();
+  ring->next_file = 0;
+  ring->dropped = 0;
+
+
+  //  The events and file table left by the old producer mean nothing to us (we'd reuse its file table entries from the
+  //  start) so everything is reset.  The epoch is odd while we're doing it and changes so that an attached consumer
+  //  throws away anything it read from the old ring.
+
+  RECORD_RING_SEGMENT *seg = ring->segment;
+
+  if (!created)
+    {
+      uint32_t epoch = seg->epoch.load (std::memory_order_relaxed);
+
+      seg->epoch.store (epoch | 1, std::memory_order_relaxed);
+      std::atomic_thread_fence (std::memory_order_release);
+
+      seg->head.store (0, std::memory_order_relaxed);
+      seg->tail.store (0, std::memory_order_relaxed);
+
+      for (int32_t i = 0 ; i < RECORD_RING_FILES ; i++)
+        {
+          seg->files[i].generation.store (0, std::memory_order_relaxed);
+          seg->files[i].name[0] = 0;
+        }
+
+      seg->epoch.store ((epoch | 1) + 1, std::memory_order_release);
+    }
+
+  seg->version = RECORD_RING_VERSION;
+  seg->magic.store (RECORD_RING_MAGIC, std::memory_order_release);
+
+
+  return (ring);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    record_ring_attach
+
+ - Purpose:     Attach to the record change ring for an ABE_SHARE key as the consumer.
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - key            =    The ABE_SHARE key
+
+ - Returns:     RECORD_RING *    =    The ring or NULL if the parent didn't create one
+
+*********************************************************************************************/
+
+RECORD_RING *record_ring_attach (int32_t key)
+{
+  QSharedMemory *shm = new QSharedMemory (ring_key (key));
+
+
+  if (!shm->attach ())
+    {
+      delete shm;
+      return (NULL);
+    }
+
+  RECORD_RING_SEGMENT *segment = (RECORD_RING_SEGMENT *) shm->data ();
+
+  if ((size_t) shm->size () < sizeof (RECORD_RING_SEGMENT) || segment->magic.load (std::memory_order_acquire) != RECORD_RING_MAGIC ||
+      segment->version != RECORD_RING_VERSION)
+    {
+      shm->detach ();
+      delete shm;
+      return (NULL);
+    }
+
+
+  RECORD_RING *ring = new RECORD_RING;
+
+  ring->shm = shm;
+  ring->segment = segment;
+  ring->next_file = 0;
+  ring->dropped = segment->dropped.load ();
+  ring->epoch = segment->epoch.load (std::memory_order_acquire) & ~1u;
+
+
+  //  Start with what's being queued now, not whatever was left in the ring before we got here.
+
+  segment->tail.store (segment->head.load (std::memory_order_acquire), std::memory_order_release);
+
+
+  return (ring);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    record_ring_push
+
+ - Purpose:     Append a record change to the ring (producer only).  This never waits.  If
+                the ring is full the event is dropped.
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - ring           =    The ring from record_ring_create (may be NULL)
+                - filename       =    The file the record is in
+                - type           =    The data type (PFM_LAS_DATA, ...)
+                - recnum         =    The record number (as it would be put in ABE_SHARE)
+
+ - Returns:     int32_t          =    0 if it was queued, -1 if it was dropped
+
+*********************************************************************************************/
+
+int32_t record_ring_push (RECORD_RING *ring, const char *filename, int32_t type, uint64_t recnum)
+{
+  if (ring == NULL) return (-1);
+
+
+  RECORD_RING_SEGMENT *seg = ring->segment;
+  uint64_t head = seg->head.load (std::memory_order_relaxed);
+
+  if (head - seg->tail.load (std::memory_order_acquire) >= RECORD_RING_ENTRIES)
+    {
+      seg->dropped.fetch_add (1, std::memory_order_relaxed);
+      return (-1);
+    }
+
+
+  //  Find the file in the table or reuse the oldest entry.  Only we write the table so we can read it without checking.
+
+  uint32_t file = RECORD_RING_FILES;
+
+  for (uint32_t i = 0 ; i < RECORD_RING_FILES ; i++)
+    {
+      if (seg->files[i].generation.load (std::memory_order_relaxed) && !strncmp (seg->files[i].name, filename, RECORD_RING_NAME_SIZE))
+        {
+          file = i;
+          break;
+        }
+    }
+
+  if (file == RECORD_RING_FILES)
+    {
+      file = ring->next_file;
+      ring->next_file = (ring->next_file + 1) % RECORD_RING_FILES;
+
+      RING_FILE *entry = &seg->files[file];
+      uint32_t generation = entry->generation.load (std::memory_order_relaxed);
+
+      entry->generation.store (generation + 1, std::memory_order_relaxed);
+      std::atomic_thread_fence (std::memory_order_release);
+
+      strncpy (entry->name, filename, RECORD_RING_NAME_SIZE - 1);
+      entry->name[RECORD_RING_NAME_SIZE - 1] = 0;
+
+      entry->generation.store (generation + 2, std::memory_order_release);
+    }
+
+
+  RING_ENTRY *entry = &seg->entries[head & (RECORD_RING_ENTRIES - 1)];
+
+  entry->recnum = recnum;
+  entry->type = type;
+  entry->file = file;
+  entry->generation = seg->files[file].generation.load (std::memory_order_relaxed);
+
+  seg->head.store (head + 1, std::memory_order_release);
+
+
+  return (0);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    record_ring_drain
+
+ - Purpose:     Take everything that is in the ring (consumer only).
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - ring           =    The ring from record_ring_attach (may be NULL)
+                - events         =    The events (oldest first) are appended to this
+                - dropped        =    Returned number of events that were dropped (or whose
+                                      file table entry was reused) since the last drain.
+                                      The path has a gap if this isn't 0.
+
+ - Returns:     int32_t          =    Number of events appended
+
+*********************************************************************************************/
+
+int32_t record_ring_drain (RECORD_RING *ring, std::vector<RECORD_RING_EVENT> &events, uint64_t *dropped)
+{
+  *dropped = 0;
+
+  if (ring == NULL) return (0);
+
+
+  RECORD_RING_SEGMENT *seg = ring->segment;
+
+
+  //  Wait for the next drain if a new producer is resetting the ring.  If it was reset since the last drain, everything
+  //  in it now was queued by the new producer.
+
+  uint32_t epoch = seg->epoch.load (std::memory_order_acquire);
+
+  if (epoch & 1) return (0);
+
+  uint64_t tail = seg->tail.load (std::memory_order_relaxed);
+  uint64_t head = seg->head.load (std::memory_order_acquire);
+  size_t first = events.size ();
+  int32_t count = 0;
+  uint64_t lost = 0;
+
+  if (epoch != ring->epoch)
+    {
+      ring->epoch = epoch;
+      ring->dropped = seg->dropped.load (std::memory_order_relaxed);
+      tail = 0;
+    }
+
+
+  //  If the producer was restarted the counters may have gone backwards.
+
+  if (head < tail) tail = head;
+
+  for ( ; tail < head ; tail++)
+    {
+      RING_ENTRY entry = seg->entries[tail & (RECORD_RING_ENTRIES - 1)];
+
+      if (entry.file >= RECORD_RING_FILES)
+        {
+          lost++;
+          continue;
+        }
+
+
+      //  Copy the file name and make sure it's still the same file that the event was queued with.
+
+      RING_FILE *file = &seg->files[entry.file];
+      char name[RECORD_RING_NAME_SIZE];
+
+      if (file->generation.load (std::memory_order_acquire) != entry.generation)
+        {
+          lost++;
+          continue;
+        }
+
+      memcpy (name, file->name, RECORD_RING_NAME_SIZE);
+      name[RECORD_RING_NAME_SIZE - 1] = 0;
+
+      std::atomic_thread_fence (std::memory_order_acquire);
+
+      if (file->generation.load (std::memory_order_relaxed) != entry.generation)
+        {
+          lost++;
+          continue;
+        }
+
+
+      RECORD_RING_EVENT event;
+
+      event.filename = name;
+      event.type = entry.type;
+      event.recnum = entry.recnum;
+
+      events.push_back (event);
+      count++;
+    }
+
+
+  //  If a new producer took over while we were reading, what we read may be from either ring so it's thrown away.
+
+  std::atomic_thread_fence (std::memory_order_acquire);
+
+  if (seg->epoch.load (std::memory_order_relaxed) != epoch)
+    {
+      events.resize (first);
+      return (0);
+    }
+
+  seg->tail.store (tail, std::memory_order_release);
+
+
+  uint64_t total = seg->dropped.load (std::memory_order_relaxed);
+
+  *dropped = total - ring->dropped + lost;
+  ring->dropped = total;
+
+
+  return (count);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    record_ring_detach
+
+ - Purpose:     Detach from the record change ring.
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - ring           =    The ring (may be NULL)
+
+ - Returns:     void
+
+*********************************************************************************************/
+
+void record_ring_detach (RECORD_RING *ring)
+{
+  if (ring == NULL) return;
+
+  ring->shm->detach ();
+  delete ring->shm;
+  delete ring;
+}
@@ -0,0 +1,99 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! or / / ! are being used by Doxygen to
+    document the software.  Dashes in these comment blocks are used to create bullet lists.
+    The lack of blank lines after a block of dash preceeded comments means that the next
+    block of dash preceeded comments is a new, indented bullet list.  I've tried to keep the
+    Doxygen formatting to a minimum but there are some other items (like <br> and <pre>)
+    that need to be left alone.  If you see a comment that starts with / * ! or / / ! and
+    there is something that looks a bit weird it is probably due to some arcane Doxygen
+    syntax.  Be very careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+/*  Record change ring (companion to ABE_SHARE) definitions.  */
+
+#ifndef __RECORD_RING_HPP__
+#define __RECORD_RING_HPP__
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <errno.h>
+#include <sys/types.h>
+
+#include <string>
+#include <vector>
+
+
+#define RECORD_RING_ENTRIES       4096     //!<  Must be a power of 2
+#define RECORD_RING_FILES         64       //!<  File names that can be referenced by the events in the ring at once
+#define RECORD_RING_NAME_SIZE     512      //!<  Same as ABE_SHARE nearest_filename
+
+
+/*!  ABE_SHARE only holds the current record so a monitor that looks at it every 10 milliseconds misses the records that
+     the cursor passes over between looks.  The parent program (pfmEdit3D, pfmView, ...) can also append every record
+     change to this single producer, single consumer ring in a second shared memory segment ("KEY_abe_records" where KEY
+     is the ABE_SHARE key).  The monitor drains it in batches.  Nothing waits on anything: if the ring is full (or nobody
+     is draining it) new events are dropped and counted, and the monitor just has the current record from ABE_SHARE like
+     it always did.
+
+     Events refer to their file by an index into a small table of file names that only the producer writes.  Each table
+     entry has a generation number (odd while the name is being written) so that the consumer can tell if the entry was
+     reused for another file after the event was queued.  A producer that takes over a ring left by one that died resets
+     it and bumps the ring's epoch so the consumer starts over instead of reading the old events against the new table.  */
+
+class QSharedMemory;
+
+typedef struct RECORD_RING_SEGMENT RECORD_RING_SEGMENT;
+
+typedef struct
+{
+  QSharedMemory               *shm;
+  RECORD_RING_SEGMENT         *segment;
+  uint32_t                    next_file;      //!<  Producer only, next file table entry to reuse
+  uint64_t                    dropped;        //!<  Consumer only, dropped count at the last drain
+  uint32_t                    epoch;          //!<  Consumer only, producer epoch at the last drain
+} RECORD_RING;
+
+
+typedef struct
+{
+  std::string                 filename;
+  int32_t                     type;           //!<  Data type (PFM_LAS_DATA, ...)
+  uint64_t                    recnum;         //!<  Record number as it appears in ABE_SHARE
+} RECORD_RING_EVENT;
+
+
+RECORD_RING *record_ring_create (int32_t key);
+RECORD_RING *record_ring_attach (int32_t key);
+int32_t record_ring_push (RECORD_RING *ring, const char *filename, int32_t type, uint64_t recnum);
+int32_t record_ring_drain (RECORD_RING *ring, std::vector<RECORD_RING_EVENT> &events, uint64_t *dropped);
+void record_ring_detach (RECORD_RING *ring);
+
+
+#endif
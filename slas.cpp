@@ -36,13 +36,631 @@
 *****************************************  IMPORTANT NOTE  **********************************/
 
 
-#include <lasreader.hpp>
 #include "slas.hpp"
+#include "slas_metrics.hpp"
 #include "nvutility.hpp"
 
 #include <QtCore>
 
 
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_read_header
+
+ - Purpose:     Read the parts of the LAS header that we need.  This is much lighter than
+                opening the file with LASreadOpener since we only read the public header
+                block, the waveform packet descriptor VLRs (record IDs 100 through 354), and
+                the LAS 1.4 EVLR pointers.  All other VLRs are skipped without reading their
+                payloads.
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - fp             =    The file pointer
+                - swap           =    Flag that indicates that the system is big endian and
+                                      therefor we need to byte swap the header
+                - header         =    The returned SLAS_HEADER
+
+ - Returns:     int32_t          =    Negative number on error, 0 on success
+
+*********************************************************************************************/
+
+int32_t slas_read_header (FILE *fp, uint8_t swap, SLAS_HEADER *header)
+{
+  uint8_t   data[375], vlr[54], wpd[26];
+  uint16_t  record_id, record_length;
+  uint32_t  number_of_point_records;
+  int64_t   addr;
+
+
+  memset (header, 0, sizeof (SLAS_HEADER));
+  memset (data, 0, 375);
+
+
+  if (fseeko64 (fp, 0, SEEK_SET) < 0)
+    {
+      fprintf (stderr, "Error on fseek :\n%s\nFunction: %s, Line: %d\n", strerror (errno),  __FUNCTION__, __LINE__);
+      fflush (stderr);
+      return (-1);
+    }
+
+
+  //  The header size (at byte 94) tells us how much of the public header block there is to read (227 for 1.2,
+  //  235 for 1.3, 375 for 1.4).
+
+  if (!fread (data, 96, 1, fp) || strncmp ((char *) data, "LASF", 4))
+    {
+      fprintf (stderr, "Error reading LAS header :\n%s\nFunction: %s, Line: %d\n", strerror (errno),  __FUNCTION__, __LINE__);
+      fflush (stderr);
+      return (-2);
+    }
+
+  memcpy (&header->header_size, &data[94], 2);
+  if (swap) swap_short ((int16_t *) &header->header_size);
+
+  int32_t size = header->header_size;
+  if (size > 375) size = 375;
+
+  if (size < 227 || !fread (&data[96], size - 96, 1, fp))
+    {
+      fprintf (stderr, "Error reading LAS header :\n%s\nFunction: %s, Line: %d\n", strerror (errno),  __FUNCTION__, __LINE__);
+      fflush (stderr);
+      return (-3);
+    }
+
+
+  memcpy (&header->global_encoding, &data[6], 2);
+  header->version_major = data[24];
+  header->version_minor = data[25];
+  memcpy (&header->offset_to_point_data, &data[96], 4);
+  memcpy (&header->number_of_variable_length_records, &data[100], 4);
+  header->point_data_format = data[104] & 0x3f;
+  header->compressed = (data[104] & 0xc0) ? 1 : 0;
+  memcpy (&header->point_data_record_length, &data[105], 2);
+  memcpy (&number_of_point_records, &data[107], 4);
+  memcpy (&header->x_scale_factor, &data[131], 8);
+  memcpy (&header->y_scale_factor, &data[139], 8);
+  memcpy (&header->z_scale_factor, &data[147], 8);
+  memcpy (&header->x_offset, &data[155], 8);
+  memcpy (&header->y_offset, &data[163], 8);
+  memcpy (&header->z_offset, &data[171], 8);
+  if (size >= 235) memcpy (&header->start_of_waveform_data_packet_record, &data[227], 8);
+  if (size >= 375)
+    {
+      memcpy (&header->start_of_first_extended_variable_length_record, &data[235], 8);
+      memcpy (&header->number_of_extended_variable_length_records, &data[243], 4);
+      memcpy (&header->extended_number_of_point_records, &data[247], 8);
+    }
+
+
+  if (swap)
+    {
+      swap_short ((int16_t *) &header->global_encoding);
+      swap_int ((int32_t *) &header->offset_to_point_data);
+      swap_int ((int32_t *) &header->number_of_variable_length_records);
+      swap_short ((int16_t *) &header->point_data_record_length);
+      swap_int ((int32_t *) &number_of_point_records);
+      swap_double (&header->x_scale_factor);
+      swap_double (&header->y_scale_factor);
+      swap_double (&header->z_scale_factor);
+      swap_double (&header->x_offset);
+      swap_double (&header->y_offset);
+      swap_double (&header->z_offset);
+      swap_double ((double *) &header->start_of_waveform_data_packet_record);
+      swap_double ((double *) &header->start_of_first_extended_variable_length_record);
+      swap_int ((int32_t *) &header->number_of_extended_variable_length_records);
+      swap_double ((double *) &header->extended_number_of_point_records);
+    }
+
+
+  header->number_of_point_records = number_of_point_records;
+  if (header->version_minor < 4) header->extended_number_of_point_records = number_of_point_records;
+
+
+  //  Walk the VLRs (they start right after the public header block).  We only read the payloads of the waveform
+  //  packet descriptors, everything else is skipped.
+
+  addr = header->header_size;
+
+  for (uint32_t i = 0 ; i < header->number_of_variable_length_records ; i++)
+    {
+      if (fseeko64 (fp, addr, SEEK_SET) < 0 || !fread (vlr, 54, 1, fp))
+        {
+          fprintf (stderr, "Error reading LAS VLR header :\n%s\nFunction: %s, Line: %d\n", strerror (errno),  __FUNCTION__, __LINE__);
+          fflush (stderr);
+          return (-4);
+        }
+
+      memcpy (&record_id, &vlr[18], 2);
+      memcpy (&record_length, &vlr[20], 2);
+
+      if (swap)
+        {
+          swap_short ((int16_t *) &record_id);
+          swap_short ((int16_t *) &record_length);
+        }
+
+
+      if (record_id > 99 && record_id < 355 && record_length >= 26 && !strncmp ((char *) &vlr[2], "LASF_Spec", 9))
+        {
+          if (!fread (wpd, 26, 1, fp))
+            {
+              fprintf (stderr, "Error reading LAS waveform packet descriptor :\n%s\nFunction: %s, Line: %d\n", strerror (errno),
+                       __FUNCTION__, __LINE__);
+              fflush (stderr);
+              return (-5);
+            }
+
+          SLAS_WAVEFORM_PACKET_DESCRIPTOR *desc = &header->wf_packet_desc[record_id - 99];
+
+          desc->index = record_id - 99;
+          desc->bits_per_sample = wpd[0];
+          desc->compression_type = wpd[1];
+          memcpy (&desc->number_of_samples, &wpd[2], 4);
+          memcpy (&desc->temporal_spacing, &wpd[6], 4);
+          memcpy (&desc->digitizer_gain, &wpd[10], 8);
+          memcpy (&desc->digitizer_offset, &wpd[18], 8);
+
+          if (swap)
+            {
+              swap_int ((int32_t *) &desc->number_of_samples);
+              swap_int ((int32_t *) &desc->temporal_spacing);
+              swap_double (&desc->digitizer_gain);
+              swap_double (&desc->digitizer_offset);
+            }
+        }
+
+      addr += 54 + record_length;
+    }
+
+
+  return (0);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_refresh_point_count
+
+ - Purpose:     Update the number of point records in a header for a file that is still
+                being written.  Only the point counts and waveform/EVLR start fields are
+                read again (not the VLRs).  Since many writers don't update the point counts
+                until the file is closed, the number of complete records that fit in the file
+                is used if it is larger than the count in the header.  This isn't done for
+                compressed files or files with internal waveforms (since the waveforms follow
+                the points).
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - fp             =    The file pointer
+                - swap           =    Flag that indicates that the system is big endian and
+                                      therefor we need to byte swap the header
+                - header         =    The SLAS_HEADER retrieved from the LAS file (updated)
+
+ - Returns:     int32_t          =    Negative number on error, 1 if the number of point
+                                      records changed, 0 if it didn't
+
+*********************************************************************************************/
+
+int32_t slas_refresh_point_count (FILE *fp, uint8_t swap, SLAS_HEADER *header)
+{
+  uint8_t  data[28];
+  uint32_t number_of_point_records;
+  uint64_t extended_number_of_point_records = 0, start_of_first_evlr = 0, start_of_wdp = header->start_of_waveform_data_packet_record;
+
+
+  if (fseeko64 (fp, 107, SEEK_SET) < 0 || !fread (&number_of_point_records, 4, 1, fp)) return (-1);
+  if (swap) swap_int ((int32_t *) &number_of_point_records);
+
+
+  if (header->header_size >= 235)
+    {
+      if (fseeko64 (fp, 227, SEEK_SET) < 0 || !fread (data, header->header_size >= 375 ? 28 : 8, 1, fp)) return (-1);
+
+      memcpy (&start_of_wdp, &data[0], 8);
+      if (swap) swap_double ((double *) &start_of_wdp);
+
+      if (header->header_size >= 375)
+        {
+          memcpy (&start_of_first_evlr, &data[8], 8);
+          memcpy (&extended_number_of_point_records, &data[20], 8);
+
+          if (swap)
+            {
+              swap_double ((double *) &start_of_first_evlr);
+              swap_double ((double *) &extended_number_of_point_records);
+            }
+        }
+    }
+
+
+  uint64_t count = header->version_minor < 4 ? number_of_point_records : extended_number_of_point_records;
+
+
+  //  Count the complete records in the file.
+
+  if (!header->compressed && !(header->global_encoding & 0x2) && header->point_data_record_length)
+    {
+      if (fseeko64 (fp, 0, SEEK_END) < 0) return (-1);
+
+      int64_t end = ftello64 (fp);
+
+      if (start_of_first_evlr > header->offset_to_point_data && (int64_t) start_of_first_evlr < end) end = start_of_first_evlr;
+
+      if (end > (int64_t) header->offset_to_point_data)
+        {
+          uint64_t in_file = (end - header->offset_to_point_data) / header->point_data_record_length;
+
+          if (in_file > count) count = in_file;
+        }
+    }
+
+
+  int32_t changed = (count != header->extended_number_of_point_records);
+
+  header->number_of_point_records = number_of_point_records;
+  header->extended_number_of_point_records = count;
+  header->start_of_waveform_data_packet_record = start_of_wdp;
+  header->start_of_first_extended_variable_length_record = start_of_first_evlr;
+
+
+  return (changed);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Structure:   slas_layout
+
+ - Purpose:     Byte offsets of the format dependent fields in a point data record for each
+                of the LAS point data formats (0 through 10).  A value of -1 means the field
+                isn't in that format.  This lets us go straight to the fields that we need
+                instead of walking the whole record.
+
+*********************************************************************************************/
+
+typedef struct
+{
+  int16_t                     gps_time;
+  int16_t                     rgb;
+  int16_t                     NIR;
+  int16_t                     wave_packet;
+} SLAS_LAYOUT;
+
+
+static const SLAS_LAYOUT slas_layout[11] = {{-1, -1, -1, -1},     //  0
+                                            {20, -1, -1, -1},     //  1
+                                            {-1, 20, -1, -1},     //  2
+                                            {20, 28, -1, -1},     //  3
+                                            {20, -1, -1, 28},     //  4
+                                            {20, 28, -1, 34},     //  5
+                                            {22, -1, -1, -1},     //  6
+                                            {22, 30, -1, -1},     //  7
+                                            {22, 30, 36, -1},     //  8
+                                            {22, -1, -1, 30},     //  9
+                                            {22, 30, 36, 38}};    //  10
+
+
+
+//  Decode the requested fields from a raw point data record.  This is forced inline so that, when it's called with a
+//  constant mask (see slas_decode_point_data), the compiler drops all of the tests and code for fields we don't want.
+
+static inline __attribute__ ((always_inline)) void slas_decode_fields (const uint8_t *data, const SLAS_HEADER *lasheader, uint8_t swap,
+                                                                       uint32_t mask, SLAS_POINT_DATA *record)
+{
+  const SLAS_LAYOUT *layout = &slas_layout[lasheader->point_data_format];
+  uint8_t extended = (lasheader->point_data_format > 5);
+
+
+  if (mask & SLAS_FIELD_XYZ)
+    {
+      int32_t x, y, z;
+
+      memcpy (&x, &data[0], 4);
+      memcpy (&y, &data[4], 4);
+      memcpy (&z, &data[8], 4);
+
+      if (swap)
+        {
+          swap_int (&x);
+          swap_int (&y);
+          swap_int (&z);
+        }
+
+      record->x = ((double) x * lasheader->x_scale_factor) + lasheader->x_offset;
+      record->y = ((double) y * lasheader->y_scale_factor) + lasheader->y_offset;
+      record->z = (float) (((double) z * lasheader->z_scale_factor) + lasheader->z_offset);
+    }
+
+
+  if (mask & SLAS_FIELD_INTENSITY)
+    {
+      memcpy (&record->intensity, &data[12], 2);
+      if (swap) swap_short ((int16_t *) &record->intensity);
+    }
+
+
+  if (mask & SLAS_FIELD_RETURNS)
+    {
+      uint8_t rets = data[14];
+
+      if (extended)
+        {
+          uint8_t cls = data[15];
+
+          record->return_number = rets & 0x0f;
+          record->number_of_returns = (rets & 0xf0) >> 4;
+          record->scanner_channel = (cls & 0x30) >> 4;
+          record->scan_direction_flag = (cls & 0x40) >> 6;
+          record->edge_of_flightline = (cls & 0x80) >> 7;
+        }
+      else
+        {
+          record->return_number = rets & 0x07;
+          record->number_of_returns = (rets & 0x38) >> 3;
+          record->scanner_channel = 0;
+          record->scan_direction_flag = (rets & 0x40) >> 6;
+          record->edge_of_flightline = (rets & 0x80) >> 7;
+        }
+    }
+
+
+  //  Just to make life easier we're breaking out the classification flags.
+
+  if (mask & SLAS_FIELD_CLASSIFICATION)
+    {
+      uint8_t cls = data[15];
+
+      if (extended)
+        {
+          record->classification = data[16];
+          record->synthetic = cls & 0x01;
+          record->keypoint = (cls & 0x02) >> 1;
+          record->withheld = (cls & 0x04) >> 2;
+          record->overlap = (cls & 0x08) >> 3;
+        }
+      else
+        {
+          record->classification = cls & 0x1f;
+          record->synthetic = (cls & 0x20) >> 5;
+          record->keypoint = (cls & 0x40) >> 6;
+          record->withheld = (cls & 0x80) >> 7;
+          record->overlap = 0;
+        }
+    }
+
+
+  if (mask & SLAS_FIELD_USER_DATA) record->user_data = data[17];
+
+
+  if (mask & SLAS_FIELD_SCAN_ANGLE)
+    {
+      if (extended)
+        {
+          memcpy (&record->scan_angle, &data[18], 2);
+          if (swap) swap_short (&record->scan_angle);
+        }
+      else
+        {
+          record->scan_angle = (int8_t) data[16];
+        }
+    }
+
+
+  if (mask & SLAS_FIELD_POINT_SOURCE)
+    {
+      memcpy (&record->point_source_id, &data[extended ? 20 : 18], 2);
+      if (swap) swap_short ((int16_t *) &record->point_source_id);
+    }
+
+
+  if ((mask & SLAS_FIELD_GPS_TIME) && layout->gps_time >= 0)
+    {
+      memcpy (&record->gps_time, &data[layout->gps_time], 8);
+      if (swap) swap_double (&record->gps_time);
+    }
+
+
+  if ((mask & SLAS_FIELD_RGB) && layout->rgb >= 0)
+    {
+      memcpy (&record->red, &data[layout->rgb], 2);
+      memcpy (&record->green, &data[layout->rgb + 2], 2);
+      memcpy (&record->blue, &data[layout->rgb + 4], 2);
+
+      if (swap)
+        {
+          swap_short ((int16_t *) &record->red);
+          swap_short ((int16_t *) &record->green);
+          swap_short ((int16_t *) &record->blue);
+        }
+    }
+
+
+  if ((mask & SLAS_FIELD_NIR) && layout->NIR >= 0)
+    {
+      memcpy (&record->NIR, &data[layout->NIR], 2);
+      if (swap) swap_short ((int16_t *) &record->NIR);
+    }
+
+
+  if ((mask & SLAS_FIELD_WAVE_PACKET) && layout->wave_packet >= 0)
+    {
+      int32_t pos = layout->wave_packet;
+
+      record->wavepacket_descriptor_index = data[pos];
+      memcpy (&record->byte_offset_to_waveform_data, &data[pos + 1], 8);
+      memcpy (&record->waveform_packet_size, &data[pos + 9], 4);
+      memcpy (&record->return_point_waveform_location, &data[pos + 13], 4);
+
+      if (swap)
+        {
+          swap_double ((double *) &record->byte_offset_to_waveform_data);
+          swap_int ((int32_t *) &record->waveform_packet_size);
+          swap_float (&record->return_point_waveform_location);
+        }
+    }
+
+
+  if ((mask & SLAS_FIELD_XYZT) && layout->wave_packet >= 0)
+    {
+      int32_t pos = layout->wave_packet + 17;
+
+      memcpy (&record->Xt, &data[pos], 4);
+      memcpy (&record->Yt, &data[pos + 4], 4);
+      memcpy (&record->Zt, &data[pos + 8], 4);
+
+      if (swap)
+        {
+          swap_float (&record->Xt);
+          swap_float (&record->Yt);
+          swap_float (&record->Zt);
+        }
+    }
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_decode_point_data
+
+ - Purpose:     Decode only the requested fields of a raw LAS point data record.  Fields that
+                aren't in the mask (or aren't in the point data format) are not touched.  The
+                common masks (SLAS_MASK_ALL, SLAS_MASK_WAVEFORM, SLAS_MASK_WAVEFORM_TIME, and
+                SLAS_MASK_POSITION) have their own compiled versions of the decoder so they
+                don't even pay for testing the mask.
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - data           =    The raw point data record
+                - lasheader      =    The SLAS_HEADER retrieved from the LAS file
+                - swap           =    Flag that indicates that the system is big endian and
+                                      therefor we need to byte swap the records
+                - mask           =    The SLAS_FIELD_* bits of the fields to be decoded
+                - record         =    The returned Simple LAS point data record
+
+ - Returns:     void
+
+*********************************************************************************************/
+
+void slas_decode_point_data (const uint8_t *data, const SLAS_HEADER *lasheader, uint8_t swap, uint32_t mask, SLAS_POINT_DATA *record)
+{
+  switch (mask)
+    {
+    case SLAS_MASK_ALL:
+      slas_decode_fields (data, lasheader, swap, SLAS_MASK_ALL, record);
+      break;
+
+    case SLAS_MASK_WAVEFORM:
+      slas_decode_fields (data, lasheader, swap, SLAS_MASK_WAVEFORM, record);
+      break;
+
+    case SLAS_MASK_WAVEFORM_TIME:
+      slas_decode_fields (data, lasheader, swap, SLAS_MASK_WAVEFORM_TIME, record);
+      break;
+
+    case SLAS_MASK_POSITION:
+      slas_decode_fields (data, lasheader, swap, SLAS_MASK_POSITION, record);
+      break;
+
+    default:
+      slas_decode_fields (data, lasheader, swap, mask, record);
+      break;
+    }
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_wave_packet_offset
+
+ - Purpose:     Get the byte offset of the wave packet fields (wavepacket_descriptor_index
+                followed by byte_offset_to_waveform_data) in a point data record.
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - point_data_format =  The LAS point data format
+
+ - Returns:     int32_t          =    The byte offset or -1 if the format has no wave packet
+
+*********************************************************************************************/
+
+int32_t slas_wave_packet_offset (uint8_t point_data_format)
+{
+  if (point_data_format > 10) return (-1);
+
+  return (slas_layout[point_data_format].wave_packet);
+}
+
+
+
+//  Read the raw bytes of a point data record.
+
+static int32_t slas_read_point_buffer (FILE *fp, uint64_t recnum, SLAS_HEADER *lasheader, uint8_t *data)
+{
+  int64_t  addr;
+
+
+  //  Check for record out of bounds.
+
+  if (recnum >= lasheader->extended_number_of_point_records || lasheader->point_data_format > 10 || lasheader->point_data_record_length > 128)
+    {
+      fprintf (stderr, "Record number %" PRIu64 " out of range :\nFunction: %s, Line: %d\n", recnum,  __FUNCTION__, __LINE__);
+      fflush (stderr);
+      return (-1);
+    }
+
+
+  addr = (int64_t) lasheader->offset_to_point_data + (int64_t) lasheader->point_data_record_length * (int64_t) recnum;
+
+
+  if (fseeko64 (fp, addr, SEEK_SET) < 0)
+    {
+      fprintf (stderr, "Error on fseek :\n%s\nFunction: %s, Line: %d\n", strerror (errno),  __FUNCTION__, __LINE__);
+      fflush (stderr);
+      return (-2);
+    }
+
+
+  memset (data, 0, 128);
+
+
+  //  Read the data buffer.
+
+  if (!fread (data, lasheader->point_data_record_length, 1, fp))
+    {
+      fprintf (stderr, "Error reading LAS record :\n%s\nFunction: %s, Line: %d\n", strerror (errno),  __FUNCTION__, __LINE__);
+      fflush (stderr);
+      return (-3);
+    }
+
+  slas_metrics_add (SLAS_METRIC_POINT_BYTES, lasheader->point_data_record_length);
+
+
+  return (0);
+}
+
+
+
 /********************************************************************************************/
 /*!
 
@@ -58,7 +676,7 @@
                 - fp             =    The file pointer
                 - recnum         =    The record number of the LAS point data record to be
                                       retrieved (records start at 0)
-                - lasheader      =    The LASheader retrieved from the LAS file
+                - lasheader      =    The SLAS_HEADER retrieved from the LAS file
                 - swap           =    Flag that indicates that the system is big endian and
                                       therefor we need to byte swap the records
                 - record         =    The returned Simple LAS point data record
@@ -67,293 +685,245 @@
 
 *********************************************************************************************/
 
-int32_t slas_read_point_data (FILE *fp, uint64_t recnum, LASheader *lasheader, uint8_t swap, SLAS_POINT_DATA *record)
+int32_t slas_read_point_data (FILE *fp, uint64_t recnum, SLAS_HEADER *lasheader, uint8_t swap, SLAS_POINT_DATA *record)
 {
-  int32_t  x, y, z;
-  int64_t  addr, pos;
-  uint8_t  data[128], rets, cls;
+  uint8_t  data[128];
+  int32_t  status;
 
 
-  //  Check for record out of bounds.
+  if ((status = slas_read_point_buffer (fp, recnum, lasheader, data)) < 0) return (status);
 
-  if (lasheader->version_minor < 4)
-    {
-      if (recnum >= (uint64_t) lasheader->number_of_point_records)
-        {
-#ifdef _WIN32
-          fprintf (stderr, "Record number %I64d out of range :\nFunction: %s, Line: %d\n", recnum,  __FUNCTION__, __LINE__);
-#else
-          fprintf (stderr, "Record number %ld out of range :\nFunction: %s, Line: %d\n", recnum,  __FUNCTION__, __LINE__);
-#endif
-          fflush (stderr);
-          return (-1);
-        }
-    }
-  else
-    {
-      if (recnum >= lasheader->extended_number_of_point_records)
-        {
-#ifdef _WIN32
-          fprintf (stderr, "Record number %I64d out of range :\nFunction: %s, Line: %d\n", recnum,  __FUNCTION__, __LINE__);
-#else
-          fprintf (stderr, "Record number %ld out of range :\nFunction: %s, Line: %d\n", recnum,  __FUNCTION__, __LINE__);
-#endif
-          fflush (stderr);
-          return (-1);
-        }
-    }
 
+  memset (record, 0, sizeof (SLAS_POINT_DATA));
+
+  slas_decode_point_data (data, lasheader, swap, SLAS_MASK_ALL, record);
+
+
+  return (0);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_read_point_fields
+
+ - Purpose:     Retrieve only the requested fields of a LAS point data record.  Unlike
+                slas_read_point_data the record is not cleared first, fields that aren't in
+                the mask are left as they were.
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - fp             =    The file pointer
+                - recnum         =    The record number of the LAS point data record to be
+                                      retrieved (records start at 0)
+                - lasheader      =    The SLAS_HEADER retrieved from the LAS file
+                - swap           =    Flag that indicates that the system is big endian and
+                                      therefor we need to byte swap the records
+                - mask           =    The SLAS_FIELD_* bits of the fields to be decoded
+                - record         =    The returned Simple LAS point data record
+
+ - Returns:     int32_t          =    Negative number on error, 0 on success
+
+*********************************************************************************************/
+
+int32_t slas_read_point_fields (FILE *fp, uint64_t recnum, SLAS_HEADER *lasheader, uint8_t swap, uint32_t mask, SLAS_POINT_DATA *record)
+{
+  uint8_t  data[128];
+  int32_t  status;
+
+
+  if ((status = slas_read_point_buffer (fp, recnum, lasheader, data)) < 0) return (status);
+
+
+  slas_decode_point_data (data, lasheader, swap, mask, record);
+
+
+  return (0);
+}
 
-  addr = (int64_t) lasheader->offset_to_point_data + (int64_t) lasheader->point_data_record_length * (int64_t) recnum;
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_read_waveform_data
+
+ - Purpose:     Retrieve a LAS waveform record.
+
+ - Author:      Jan C. Depner (area.based.editor@gmail.com)
+
+ - Date:        03/20/15
+
+ - Arguments:
+                - fp             =    The file pointer
+                - lasheader      =    The SLAS_HEADER retrieved from the LAS file
+                - record         =    The Simple LAS point data record for which waveform data
+                                      is to be retrieved
+                - wave           =    The waveform samples (this is where we stuff the waveform
+                                      data, it is resized to fit)
+
+ - Returns:     int32_t          =    Negative number on error, 0 on success
+
+*********************************************************************************************/
+
+int32_t slas_read_waveform_data (FILE *fp, SLAS_HEADER *lasheader, SLAS_POINT_DATA *record, SLAS_SAMPLES *wave)
+{
+  int64_t  addr;
+  uint8_t  *wave_data;
+
+
+  addr = lasheader->start_of_waveform_data_packet_record + record->byte_offset_to_waveform_data;
 
 
   if (fseeko64 (fp, addr, SEEK_SET) < 0)
     {
-      fprintf (stderr, "Error on fseek :\n%s\nFunction: %s, Line: %d\n", strerror (errno),  __FUNCTION__, __LINE__);
+      fprintf (stderr, "Error on fseek :\n%s\nFunction: %s, Line: %d\n", strerror (errno), __FUNCTION__, __LINE__);
       fflush (stderr);
-      return (-2);
+      return (-1);
     }
 
 
-  memset (record, 0, sizeof (SLAS_POINT_DATA));
-  memset (data, 0, 128);
+  wave_data = (uint8_t *) malloc (record->waveform_packet_size);
 
 
-  //  Read the data buffer.
+  //  Read the wave_data buffer.
 
-  if (!fread (data, lasheader->point_data_record_length, 1, fp))
+  if (!fread (wave_data, record->waveform_packet_size, 1, fp))
     {
-      fprintf (stderr, "Error reading LAS record :\n%s\nFunction: %s, Line: %d\n", strerror (errno),  __FUNCTION__, __LINE__);
+      fprintf (stderr, "Error reading LAS waveform data :\n%s\nFunction: %s, Line: %d\n", strerror (errno),  __FUNCTION__, __LINE__);
       fflush (stderr);
-      return (-3);
+      free (wave_data);
+      return (-2);
     }
 
+  slas_metrics_add (SLAS_METRIC_WAVE_BYTES, record->waveform_packet_size);
 
-  //  Get the data out of the buffer.
 
-  pos = 0;
-  memcpy (&x, &data[pos], 4); pos += 4;
-  memcpy (&y, &data[pos], 4); pos += 4;
-  memcpy (&z, &data[pos], 4); pos += 4;
-  memcpy (&record->intensity, &data[pos], 2); pos += 2;
-  memcpy (&rets, &data[pos], 1); pos += 1;
-  memcpy (&cls, &data[pos], 1); pos += 1;
+  slas_unpack_waveform (wave_data, &lasheader->wf_packet_desc[record->wavepacket_descriptor_index], wave);
 
 
-  //  Check for point format ID above 5.
+  free (wave_data);
 
-  if (lasheader->point_data_format > 5)
-    {
-      memcpy (&record->classification, &data[pos], 1); pos += 1;
-      memcpy (&record->user_data, &data[pos], 1); pos += 1;
-      memcpy (&record->scan_angle, &data[pos], 2); pos += 2;
-    }
-  else
-    {
-      memcpy (&record->scan_angle, &data[pos], 1); pos += 1;
-      memcpy (&record->user_data, &data[pos], 1); pos += 1;
-    }
 
-  memcpy (&record->point_source_id, &data[pos], 2); pos += 2;
+  return (0);
+}
 
 
-  switch (lasheader->point_data_format)
-    {
-    case 1:
-    case 6:
-      memcpy (&record->gps_time, &data[pos], 8); pos += 8;
-      break;
 
-    case 2:
-      memcpy (&record->red, &data[pos], 2); pos += 2;
-      memcpy (&record->green, &data[pos], 2); pos += 2;
-      memcpy (&record->blue, &data[pos], 2); pos += 2;
-      break;
+//  Unpack count samples of size bits, starting at bit offset pos, into the storage type T.  T is always wide enough to
+//  hold size bits.
 
-    case 3:
-    case 7:
-      memcpy (&record->gps_time, &data[pos], 8); pos += 8;
-      memcpy (&record->red, &data[pos], 2); pos += 2;
-      memcpy (&record->green, &data[pos], 2); pos += 2;
-      memcpy (&record->blue, &data[pos], 2); pos += 2;
-      break;
+template <typename T> static void slas_unpack_samples (const uint8_t *wave_data, int64_t pos, int32_t count, int32_t size, T *wave)
+{
+  //  Byte aligned samples are by far the most common so we don't need to go through bit_unpack for them.  These
+  //  use the same (most significant bit first) order as bit_unpack.  Byte sized samples always start on a byte.
 
-    case 4:
-    case 9:
-      memcpy (&record->gps_time, &data[pos], 8); pos += 8;
-      memcpy (&record->wavepacket_descriptor_index, &data[pos], 1); pos += 1;
-      memcpy (&record->byte_offset_to_waveform_data, &data[pos], 8); pos += 8;
-      memcpy (&record->waveform_packet_size, &data[pos], 4); pos += 4;
-      memcpy (&record->return_point_waveform_location, &data[pos], 4); pos += 4;
-      memcpy (&record->Xt, &data[pos], 4); pos += 4;
-      memcpy (&record->Yt, &data[pos], 4); pos += 4;
-      memcpy (&record->Zt, &data[pos], 4); pos += 4;
-      break;
+  wave_data += pos / 8;
+  pos %= 8;
 
-    case 5:
-      memcpy (&record->gps_time, &data[pos], 8); pos += 8;
-      memcpy (&record->red, &data[pos], 2); pos += 2;
-      memcpy (&record->green, &data[pos], 2); pos += 2;
-      memcpy (&record->blue, &data[pos], 2); pos += 2;
-      memcpy (&record->wavepacket_descriptor_index, &data[pos], 1); pos += 1;
-      memcpy (&record->byte_offset_to_waveform_data, &data[pos], 8); pos += 8;
-      memcpy (&record->waveform_packet_size, &data[pos], 4); pos += 4;
-      memcpy (&record->return_point_waveform_location, &data[pos], 4); pos += 4;
-      memcpy (&record->Xt, &data[pos], 4); pos += 4;
-      memcpy (&record->Yt, &data[pos], 4); pos += 4;
-      memcpy (&record->Zt, &data[pos], 4); pos += 4;
+  switch (size)
+    {
+    case 8:
+      for (int32_t i = 0 ; i < count ; i++) wave[i] = (T) wave_data[i];
       break;
 
-    case 8:
-      memcpy (&record->gps_time, &data[pos], 8); pos += 8;
-      memcpy (&record->red, &data[pos], 2); pos += 2;
-      memcpy (&record->green, &data[pos], 2); pos += 2;
-      memcpy (&record->blue, &data[pos], 2); pos += 2;
-      memcpy (&record->NIR, &data[pos], 2); pos += 2;
+    case 16:
+      for (int32_t i = 0 ; i < count ; i++) wave[i] = (T) (((uint32_t) wave_data[i * 2] << 8) | (uint32_t) wave_data[i * 2 + 1]);
       break;
 
-    case 10:
-      memcpy (&record->gps_time, &data[pos], 8); pos += 8;
-      memcpy (&record->red, &data[pos], 2); pos += 2;
-      memcpy (&record->green, &data[pos], 2); pos += 2;
-      memcpy (&record->blue, &data[pos], 2); pos += 2;
-      memcpy (&record->NIR, &data[pos], 2); pos += 2;
-      memcpy (&record->wavepacket_descriptor_index, &data[pos], 1); pos += 1;
-      memcpy (&record->byte_offset_to_waveform_data, &data[pos], 8); pos += 8;
-      memcpy (&record->waveform_packet_size, &data[pos], 4); pos += 4;
-      memcpy (&record->return_point_waveform_location, &data[pos], 4); pos += 4;
-      memcpy (&record->Xt, &data[pos], 4); pos += 4;
-      memcpy (&record->Yt, &data[pos], 4); pos += 4;
-      memcpy (&record->Zt, &data[pos], 4); pos += 4;
+    default:
+      for (int32_t i = 0 ; i < count ; i++)
+        {
+          wave[i] = (T) bit_unpack ((uint8_t *) wave_data, pos, size); pos += size;
+        }
       break;
     }
+}
 
 
-  //  If we have to swap the fields of the record, do so.
 
-  if (swap)
-    {
-      swap_int (&x);
-      swap_int (&y);
-      swap_int (&z);
-      swap_short ((int16_t *) &record->intensity);
-      swap_short ((int16_t *) &record->point_source_id);
+/********************************************************************************************/
+/*!
 
-      switch (lasheader->point_data_format)
-        {
-        case 1:
-        case 6:
-          swap_double (&record->gps_time);
-          break;
+ - Function:    slas_unpack_waveform
 
-        case 2:
-          swap_short ((int16_t *) &record->red);
-          swap_short ((int16_t *) &record->green);
-          swap_short ((int16_t *) &record->blue);
-          break;
+ - Purpose:     Unpack the samples of a raw waveform data packet.
 
-        case 3:
-        case 7:
-          swap_double (&record->gps_time);
-          swap_short ((int16_t *) &record->red);
-          swap_short ((int16_t *) &record->green);
-          swap_short ((int16_t *) &record->blue);
-          break;
+ - Author:      PFM Software
 
-        case 4:
-        case 9:
-          swap_double (&record->gps_time);
-          swap_double ((double *) &record->byte_offset_to_waveform_data);
-          swap_int ((int32_t *) &record->waveform_packet_size);
-          swap_float (&record->return_point_waveform_location);
-          swap_float (&record->Xt);
-          swap_float (&record->Yt);
-          swap_float (&record->Zt);
-          break;
+ - Date:        10/19/26
 
-        case 5:
-          swap_double (&record->gps_time);
-          swap_short ((int16_t *) &record->red);
-          swap_short ((int16_t *) &record->green);
-          swap_short ((int16_t *) &record->blue);
-          swap_double ((double *) &record->byte_offset_to_waveform_data);
-          swap_int ((int32_t *) &record->waveform_packet_size);
-          swap_float (&record->return_point_waveform_location);
-          swap_float (&record->Xt);
-          swap_float (&record->Yt);
-          swap_float (&record->Zt);
-          break;
+ - Arguments:
+                - wave_data      =    The raw waveform data packet
+                - wf_packet_desc =    The waveform packet descriptor for the packet
+                - wave           =    The samples (resized to wf_packet_desc->number_of_samples
+                                      stored in the narrowest type that holds bits_per_sample)
 
-        case 8:
-          swap_double (&record->gps_time);
-          swap_short ((int16_t *) &record->red);
-          swap_short ((int16_t *) &record->green);
-          swap_short ((int16_t *) &record->blue);
-          swap_short ((int16_t *) &record->NIR);
-          break;
+ - Returns:     void
 
-        case 10:
-          swap_double (&record->gps_time);
-          swap_short ((int16_t *) &record->red);
-          swap_short ((int16_t *) &record->green);
-          swap_short ((int16_t *) &record->blue);
-          swap_short ((int16_t *) &record->NIR);
-          swap_double ((double *) &record->byte_offset_to_waveform_data);
-          swap_int ((int32_t *) &record->waveform_packet_size);
-          swap_float (&record->return_point_waveform_location);
-          swap_float (&record->Xt);
-          swap_float (&record->Yt);
-          swap_float (&record->Zt);
-          break;
-        }
-    }
+*********************************************************************************************/
 
+void slas_unpack_waveform (uint8_t *wave_data, SLAS_WAVEFORM_PACKET_DESCRIPTOR *wf_packet_desc, SLAS_SAMPLES *wave)
+{
+  slas_unpack_waveform_range (wave_data, wf_packet_desc, 0, wf_packet_desc->number_of_samples, wave);
+}
 
-  //  Now put the rest of the data into the structure.
 
-  record->x = ((double) x * lasheader->x_scale_factor) + lasheader->x_offset;
-  record->y = ((double) y * lasheader->y_scale_factor) + lasheader->y_offset;
-  record->z = (float) (((double) z * lasheader->z_scale_factor) + lasheader->z_offset);
 
+/********************************************************************************************/
+/*!
 
-  //  Check for point format ID above 5.
+ - Function:    slas_unpack_waveform_range
 
-  if (lasheader->point_data_format > 5)
-    {
-      record->return_number = rets & 0x0f;
-      record->number_of_returns = (rets & 0xf0) >> 4;
-      record->scanner_channel = (cls & 0x30) >> 4;
-      record->scan_direction_flag = (cls & 0x40) >> 6;
-      record->edge_of_flightline = (cls & 0x80) >> 7;
+ - Purpose:     Unpack count samples of a raw waveform data packet starting at bit offset
+                bit_offset.  The samples don't have to start on a byte boundary.
 
+ - Author:      PFM Software
 
-      //  Just to make life easier we're breaking out the 4 bits of the classification flags.
+ - Date:        10/19/26
 
-      uint8_t new_cls = cls & 0x0f;
-      record->overlap = (new_cls & 0x10) >> 4;
-      record->synthetic = (new_cls & 0x20) >> 5;
-      record->keypoint = (new_cls & 0x40) >> 6;
-      record->withheld = (new_cls & 0x80) >> 7;
-    }
-  else
-    {
-      record->return_number = rets & 0x07;
-      record->number_of_returns = (rets & 0x38) >> 3;
-      record->scan_direction_flag = (rets & 0x40) >> 6;
-      record->edge_of_flightline = (rets & 0x80) >> 7;
-      record->classification = cls & 0x1f;
+ - Arguments:
+                - wave_data      =    The raw waveform data (at least (bit_offset + count *
+                                      bits_per_sample + 7) / 8 bytes)
+                - wf_packet_desc =    The waveform packet descriptor for the packet
+                - bit_offset     =    Bit offset of the first sample in wave_data
+                - count          =    Number of samples to unpack
+                - wave           =    The samples (resized to count stored in the narrowest type
+                                      that holds bits_per_sample)
+
+ - Returns:     void
 
+*********************************************************************************************/
 
-      //  Just to make life easier we're breaking out the 4 bits of the classification flags.
+void slas_unpack_waveform_range (uint8_t *wave_data, SLAS_WAVEFORM_PACKET_DESCRIPTOR *wf_packet_desc, int64_t bit_offset, uint32_t count,
+                                 SLAS_SAMPLES *wave)
+{
+  int32_t size = wf_packet_desc->bits_per_sample;
 
-      record->synthetic = (cls & 0x20) >> 5;
-      record->keypoint = (cls & 0x40) >> 6;
-      record->withheld = (cls & 0x80) >> 7;
-      record->overlap = 0;
-    }
 
+  //  The samples are stored in the narrowest type that will hold bits_per_sample.
 
-  return (0);
+  wave->resize (count, size);
+
+  switch (wave->bytesPerSample ())
+    {
+    case 1:
+      slas_unpack_samples (wave_data, bit_offset, count, size, wave->ptr8 ());
+      break;
+
+    case 2:
+      slas_unpack_samples (wave_data, bit_offset, count, size, wave->ptr16 ());
+      break;
+
+    default:
+      slas_unpack_samples (wave_data, bit_offset, count, size, wave->ptr32 ());
+      break;
+    }
 }
 
 
@@ -361,37 +931,53 @@ int32_t slas_read_point_data (FILE *fp, uint64_t recnum, LASheader *lasheader, u
 /********************************************************************************************/
 /*!
 
- - Function:    slas_read_waveform_data
+ - Function:    slas_read_waveform_range
 
- - Purpose:     Retrieve a LAS waveform record.
+ - Purpose:     Retrieve part of a LAS waveform record.  Only the bytes that hold samples
+                first through first + count - 1 are read from the file.  This is used when
+                the view is zoomed in on part of a long waveform.
 
- - Author:      Jan C. Depner (area.based.editor@gmail.com)
+ - Author:      PFM Software
 
- - Date:        03/20/15
+ - Date:        10/19/26
 
  - Arguments:
                 - fp             =    The file pointer
-                - lasheader      =    The LASheader retrieved from the LAS file
+                - lasheader      =    The SLAS_HEADER retrieved from the LAS file
                 - record         =    The Simple LAS point data record for which waveform data
                                       is to be retrieved
-                - wf_packet_desc =    The array of 255 possible waveform packet descriptor
-                                      records
-                - wave           =    wf_packet_desc[record->wavepacket_descriptor_index].number_of_samples
-                                      sized array of uint32_t variables (this is where we stuff the
-                                      waveform data)
+                - first          =    The first sample to retrieve
+                - count          =    The number of samples to retrieve (clipped to the end of
+                                      the waveform)
+                - wave           =    The waveform samples (this is where we stuff the waveform
+                                      data, it is resized to fit)
 
  - Returns:     int32_t          =    Negative number on error, 0 on success
 
 *********************************************************************************************/
 
-int32_t slas_read_waveform_data (FILE *fp, LASheader *lasheader, SLAS_POINT_DATA *record, SLAS_WAVEFORM_PACKET_DESCRIPTOR *wf_packet_desc, uint32_t *wave)
+int32_t slas_read_waveform_range (FILE *fp, SLAS_HEADER *lasheader, SLAS_POINT_DATA *record, uint32_t first, uint32_t count,
+                                  SLAS_SAMPLES *wave)
 {
-  int64_t  addr, pos;
-  uint8_t  *wave_data;
+  SLAS_WAVEFORM_PACKET_DESCRIPTOR *desc = &lasheader->wf_packet_desc[record->wavepacket_descriptor_index];
 
 
-  addr = lasheader->start_of_waveform_data_packet_record + record->byte_offset_to_waveform_data;
+  if (first >= desc->number_of_samples || !count) return (-3);
 
+  if (count > desc->number_of_samples - first) count = desc->number_of_samples - first;
+
+
+  //  Figure out the exact byte span that holds the samples we want.
+
+  int64_t start_bit = (int64_t) first * desc->bits_per_sample;
+  int64_t end_bit = start_bit + (int64_t) count * desc->bits_per_sample;
+  int64_t start_byte = start_bit / 8;
+  int64_t end_byte = (end_bit + 7) / 8;
+
+  if (end_byte > (int64_t) record->waveform_packet_size) return (-4);
+
+
+  int64_t addr = lasheader->start_of_waveform_data_packet_record + record->byte_offset_to_waveform_data + start_byte;
 
   if (fseeko64 (fp, addr, SEEK_SET) < 0)
     {
@@ -401,35 +987,60 @@ int32_t slas_read_waveform_data (FILE *fp, LASheader *lasheader, SLAS_POINT_DATA
     }
 
 
-  wave_data = (uint8_t *) malloc (record->waveform_packet_size);
-
-
-  //  Read the wave_data buffer.
+  std::vector<uint8_t> wave_data (end_byte - start_byte);
 
-  if (!fread (wave_data, record->waveform_packet_size, 1, fp))
+  if (!fread (wave_data.data (), wave_data.size (), 1, fp))
     {
       fprintf (stderr, "Error reading LAS waveform data :\n%s\nFunction: %s, Line: %d\n", strerror (errno),  __FUNCTION__, __LINE__);
       fflush (stderr);
-      free (wave_data);
       return (-2);
     }
 
+  slas_metrics_add (SLAS_METRIC_WAVE_BYTES, wave_data.size ());
 
-  int32_t ndx = record->wavepacket_descriptor_index;
-  int32_t count = wf_packet_desc[ndx].number_of_samples;
-  int32_t size = wf_packet_desc[ndx].bits_per_sample;
 
-  pos = 0;
-  for (int32_t i = 0 ; i < count ; i++)
-    {
-      wave[i] = bit_unpack (wave_data, pos, size); pos += size;
-    }
+  slas_unpack_waveform_range (wave_data.data (), desc, start_bit - start_byte * 8, count, wave);
 
 
-  free (wave_data);
+  return (0);
+}
 
 
-  return (0);
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_wave_file_name
+
+ - Purpose:     Build the name of the external waveform (.wdp) file that goes with a LAS or
+                LAZ file.
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - las_name       =    The LAS or LAZ file name
+                - wave_name      =    The returned waveform file name
+
+ - Returns:     void
+
+*********************************************************************************************/
+
+void slas_wave_file_name (const char *las_name, char *wave_name)
+{
+  strcpy (wave_name, las_name);
+
+  int32_t len = strlen (wave_name);
+
+  if (len > 4 && (!strcasecmp (&wave_name[len - 4], ".las") || !strcasecmp (&wave_name[len - 4], ".laz")))
+    {
+      strcpy (&wave_name[len - 4], ".wdp");
+    }
+  else
+    {
+      strcat (wave_name, ".wdp");
+    }
 }
 
 
@@ -450,7 +1061,7 @@ int32_t slas_read_waveform_data (FILE *fp, LASheader *lasheader, SLAS_POINT_DATA
                 - fp             =    The file pointer
                 - recnum         =    The record number of the LAS point data record to be written
 		                      (records start at 0)
-                - lasheader      =    The LASheader retrieved from the LAS file
+                - lasheader      =    The SLAS_HEADER retrieved from the LAS file
                 - swap           =    Flag that indicates that the system is big endian and
                                       therefor we need to byte swap the records
                 - record         =    The SLAS_POINT_DATA structure to be updated
@@ -459,7 +1070,7 @@ int32_t slas_read_waveform_data (FILE *fp, LASheader *lasheader, SLAS_POINT_DATA
 
 *********************************************************************************************/
 
-int32_t slas_update_point_data (FILE *fp, uint64_t recnum, LASheader *lasheader, uint8_t swap, SLAS_POINT_DATA *record)
+int32_t slas_update_point_data (FILE *fp, uint64_t recnum, SLAS_HEADER *lasheader, uint8_t swap, SLAS_POINT_DATA *record)
 {
   int32_t   pos;
   uint8_t   data[128], cls;
@@ -472,11 +1083,7 @@ int32_t slas_update_point_data (FILE *fp, uint64_t recnum, LASheader *lasheader,
     {
       if (recnum >= (uint64_t) lasheader->number_of_point_records)
         {
-#ifdef _WIN32
-          fprintf (stderr, "Record number %I64d out of range :\nFunction: %s, Line: %d\n", recnum,  __FUNCTION__, __LINE__);
-#else
-          fprintf (stderr, "Record number %ld out of range :\nFunction: %s, Line: %d\n", recnum,  __FUNCTION__, __LINE__);
-#endif
+          fprintf (stderr, "Record number %" PRIu64 " out of range :\nFunction: %s, Line: %d\n", recnum,  __FUNCTION__, __LINE__);
           fflush (stderr);
           return (-1);
         }
@@ -485,11 +1092,7 @@ int32_t slas_update_point_data (FILE *fp, uint64_t recnum, LASheader *lasheader,
     {
       if (recnum >= lasheader->extended_number_of_point_records)
         {
-#ifdef _WIN32
-          fprintf (stderr, "Record number %I64d out of range :\nFunction: %s, Line: %d\n", recnum,  __FUNCTION__, __LINE__);
-#else
-          fprintf (stderr, "Record number %ld out of range :\nFunction: %s, Line: %d\n", recnum,  __FUNCTION__, __LINE__);
-#endif
+          fprintf (stderr, "Record number %" PRIu64 " out of range :\nFunction: %s, Line: %d\n", recnum,  __FUNCTION__, __LINE__);
           fflush (stderr);
           return (-1);
         }
@@ -48,6 +48,32 @@
 #include <errno.h>
 #include <sys/types.h>
 
+#include "slas_samples.hpp"
+
+
+/*!  Field mask bits for slas_decode_point_data and slas_read_point_fields.  */
+
+#define SLAS_FIELD_XYZ            0x0001     //!<  x, y, z
+#define SLAS_FIELD_INTENSITY      0x0002     //!<  intensity
+#define SLAS_FIELD_RETURNS        0x0004     //!<  return_number, number_of_returns, scanner_channel, scan_direction_flag, edge_of_flightline
+#define SLAS_FIELD_CLASSIFICATION 0x0008     //!<  classification, synthetic, keypoint, withheld, overlap
+#define SLAS_FIELD_USER_DATA      0x0010     //!<  user_data
+#define SLAS_FIELD_SCAN_ANGLE     0x0020     //!<  scan_angle
+#define SLAS_FIELD_POINT_SOURCE   0x0040     //!<  point_source_id
+#define SLAS_FIELD_GPS_TIME       0x0080     //!<  gps_time
+#define SLAS_FIELD_RGB            0x0100     //!<  red, green, blue
+#define SLAS_FIELD_NIR            0x0200     //!<  NIR
+#define SLAS_FIELD_WAVE_PACKET    0x0400     //!<  wavepacket_descriptor_index, byte_offset_to_waveform_data, waveform_packet_size, return_point_waveform_location
+#define SLAS_FIELD_XYZT           0x0800     //!<  Xt, Yt, Zt
+
+
+/*!  Common field masks.  These have their own compiled decoders in slas_decode_point_data.  */
+
+#define SLAS_MASK_ALL             0x0fff
+#define SLAS_MASK_WAVEFORM        (SLAS_FIELD_WAVE_PACKET)
+#define SLAS_MASK_WAVEFORM_TIME   (SLAS_FIELD_WAVE_PACKET | SLAS_FIELD_GPS_TIME)
+#define SLAS_MASK_POSITION        (SLAS_FIELD_XYZ | SLAS_FIELD_GPS_TIME)
+
 
 typedef struct
 {
@@ -95,9 +121,49 @@ typedef struct
 } SLAS_WAVEFORM_PACKET_DESCRIPTOR;
 
 
-int32_t slas_read_point_data (FILE *fp, uint64_t recnum, LASheader *lasheader, uint8_t swap, SLAS_POINT_DATA *record);
-int32_t slas_read_waveform_data (FILE *fp, LASheader *lasheader, SLAS_POINT_DATA *record, SLAS_WAVEFORM_PACKET_DESCRIPTOR *wf_packet_desc, uint32_t *wave);
-int32_t slas_update_point_data (FILE *fp, uint64_t recnum, LASheader *lasheader, uint8_t swap, SLAS_POINT_DATA *record);
+/*!  Compact LAS header.  This only contains the parts of the public header block, the waveform packet descriptor VLRs,
+     and the LAS 1.4 EVLR pointers that we actually use.  Field names match the LASlib LASheader fields.  */
+
+typedef struct
+{
+  uint16_t                    global_encoding;
+  uint8_t                     version_major;
+  uint8_t                     version_minor;
+  uint16_t                    header_size;
+  uint32_t                    offset_to_point_data;
+  uint32_t                    number_of_variable_length_records;
+  uint8_t                     point_data_format;               //!<  With the LAZ compression bits removed.
+  uint8_t                     compressed;                      //!<  Set if the point data format had the LAZ compression bits set.
+  uint16_t                    point_data_record_length;
+  uint32_t                    number_of_point_records;
+  double                      x_scale_factor;
+  double                      y_scale_factor;
+  double                      z_scale_factor;
+  double                      x_offset;
+  double                      y_offset;
+  double                      z_offset;
+  uint64_t                    start_of_waveform_data_packet_record;
+  uint64_t                    start_of_first_extended_variable_length_record;
+  uint32_t                    number_of_extended_variable_length_records;
+  uint64_t                    extended_number_of_point_records;  //!<  Set to number_of_point_records for pre 1.4 files.
+  SLAS_WAVEFORM_PACKET_DESCRIPTOR wf_packet_desc[256];         //!<  Indexed by record_id - 99 (index 0 means no waveform).
+} SLAS_HEADER;
+
+
+int32_t slas_read_header (FILE *fp, uint8_t swap, SLAS_HEADER *header);
+int32_t slas_refresh_point_count (FILE *fp, uint8_t swap, SLAS_HEADER *header);
+int32_t slas_read_point_data (FILE *fp, uint64_t recnum, SLAS_HEADER *lasheader, uint8_t swap, SLAS_POINT_DATA *record);
+int32_t slas_read_point_fields (FILE *fp, uint64_t recnum, SLAS_HEADER *lasheader, uint8_t swap, uint32_t mask, SLAS_POINT_DATA *record);
+int32_t slas_wave_packet_offset (uint8_t point_data_format);
+void slas_decode_point_data (const uint8_t *data, const SLAS_HEADER *lasheader, uint8_t swap, uint32_t mask, SLAS_POINT_DATA *record);
+int32_t slas_read_waveform_data (FILE *fp, SLAS_HEADER *lasheader, SLAS_POINT_DATA *record, SLAS_SAMPLES *wave);
+int32_t slas_read_waveform_range (FILE *fp, SLAS_HEADER *lasheader, SLAS_POINT_DATA *record, uint32_t first, uint32_t count,
+                                  SLAS_SAMPLES *wave);
+void slas_unpack_waveform (uint8_t *wave_data, SLAS_WAVEFORM_PACKET_DESCRIPTOR *wf_packet_desc, SLAS_SAMPLES *wave);
+void slas_unpack_waveform_range (uint8_t *wave_data, SLAS_WAVEFORM_PACKET_DESCRIPTOR *wf_packet_desc, int64_t bit_offset, uint32_t count,
+                                 SLAS_SAMPLES *wave);
+void slas_wave_file_name (const char *las_name, char *wave_name);
+int32_t slas_update_point_data (FILE *fp, uint64_t recnum, SLAS_HEADER *lasheader, uint8_t swap, SLAS_POINT_DATA *record);
 
 
 #endif
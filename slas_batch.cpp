@@ -0,0 +1,628 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! or / / ! are being used by Doxygen to
+    document the software.  Dashes in these comment blocks are used to create bullet lists.
+    The lack of blank lines after a block of dash preceeded comments means that the next
+    block of dash preceeded comments is a new, indented bullet list.  I've tried to keep the
+    Doxygen formatting to a minimum but there are some other items (like <br> and <pre>)
+    that need to be left alone.  If you see a comment that starts with / * ! or / / ! and
+    there is something that looks a bit weird it is probably due to some arcane Doxygen
+    syntax.  Be very careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+#include "slas_batch.hpp"
+#include "slas_wdc.hpp"
+#include "slaz.hpp"
+#include "slas_metrics.hpp"
+#include "nvutility.hpp"
+
+#include <fcntl.h>
+
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+#ifdef SLAS_HAVE_LIBURING
+#include <liburing.h>
+#endif
+
+#include <QtCore>
+
+
+typedef struct
+{
+  uint64_t                    recnum;
+  int32_t                     status;
+  SLAS_POINT_DATA             point;
+} BATCH_RECORD;
+
+
+typedef struct
+{
+  int64_t                     offset;         //!<  Absolute offset of the packet in the waveform file
+  uint32_t                    size;           //!<  Packet size in bytes
+  uint32_t                    done;           //!<  Bytes read so far (io_uring may return short reads)
+  int64_t                     first;          //!<  First entry in the offset sorted record list that uses this packet
+  int64_t                     last;           //!<  Last entry in the offset sorted record list that uses this packet
+  uint8_t                     reported;       //!<  Set once its records have been handed to the callback
+  uint8_t                     *buffer;
+} BATCH_PACKET;
+
+
+typedef struct
+{
+  char                        wave_name[1024];
+  SLAS_HEADER                 *lasheader;
+  std::vector<BATCH_RECORD>   records;
+  std::vector<int64_t>        order;          //!<  Indices into records sorted by waveform offset
+  std::vector<BATCH_PACKET>   packets;
+  std::atomic<size_t>         next;
+  std::mutex                  mutex;
+  SLAS_BATCH_CALLBACK         callback;
+  void                        *user_data;
+} BATCH_CONTEXT;
+
+
+
+//  Decode the packet for every record that uses it and hand the results to the caller.
+
+static void batch_complete (BATCH_CONTEXT *ctx, BATCH_PACKET *pkt, uint8_t *buffer, int32_t status)
+{
+  SLAS_SAMPLES wave;
+
+
+  pkt->reported = 1;
+
+  if (!status) slas_metrics_add (SLAS_METRIC_WAVE_BYTES, pkt->size);
+
+  for (int64_t i = pkt->first ; i <= pkt->last ; i++)
+    {
+      BATCH_RECORD *rec = &ctx->records[ctx->order[i]];
+      SLAS_WAVEFORM_PACKET_DESCRIPTOR *desc = &ctx->lasheader->wf_packet_desc[rec->point.wavepacket_descriptor_index];
+      int32_t rec_status = status;
+
+
+      //  Make sure the descriptor doesn't ask for more bits than the packet holds.
+
+      if (!rec_status && ((uint64_t) desc->number_of_samples * desc->bits_per_sample + 7) / 8 > pkt->size) rec_status = -4;
+
+      if (!rec_status)
+        {
+          slas_unpack_waveform (buffer, desc, &wave);
+        }
+
+
+      std::lock_guard<std::mutex> lock (ctx->mutex);
+      (*ctx->callback) (ctx->user_data, rec->recnum, &rec->point, rec_status ? NULL : &wave, rec_status);
+    }
+}
+
+
+
+//  Report every record whose packet hasn't been handed to the callback yet as a failure so that, whatever went wrong,
+//  the caller still gets one callback per record.
+
+static void batch_fail_pending (BATCH_CONTEXT *ctx, int32_t status)
+{
+  for (size_t i = 0 ; i < ctx->packets.size () ; i++)
+    {
+      if (!ctx->packets[i].reported) batch_complete (ctx, &ctx->packets[i], NULL, status);
+    }
+}
+
+
+
+//  Thread pool fallback.  Each worker pulls the next packet (in offset order) and reads it with pread.
+
+static void batch_worker (BATCH_CONTEXT *ctx, int fd)
+{
+  std::vector<uint8_t> buffer;
+
+
+#ifdef _WIN32
+  FILE *fp = fopen64 (ctx->wave_name, "rb");
+#endif
+
+
+  while (NVTrue)
+    {
+      size_t i = ctx->next.fetch_add (1);
+      if (i >= ctx->packets.size ()) break;
+
+      BATCH_PACKET *pkt = &ctx->packets[i];
+      int32_t status = 0;
+
+      buffer.resize (pkt->size);
+
+#ifdef _WIN32
+      if (!fp || fseeko64 (fp, pkt->offset, SEEK_SET) < 0 || !fread (buffer.data (), pkt->size, 1, fp)) status = -3;
+#else
+      size_t done = 0;
+      while (done < pkt->size)
+        {
+          ssize_t n = pread64 (fd, buffer.data () + done, pkt->size - done, pkt->offset + done);
+
+          if (n < 0 && errno == EINTR) continue;
+
+          if (n <= 0)
+            {
+              status = -3;
+              break;
+            }
+
+          done += n;
+        }
+#endif
+
+      batch_complete (ctx, pkt, buffer.data (), status);
+    }
+
+
+#ifdef _WIN32
+  if (fp) fclose (fp);
+#endif
+}
+
+
+
+static void batch_thread_pool (BATCH_CONTEXT *ctx, int fd, int32_t queue_depth)
+{
+  std::vector<std::thread> workers;
+
+
+  int32_t nthreads = queue_depth;
+  if ((size_t) nthreads > ctx->packets.size ()) nthreads = ctx->packets.size ();
+
+  ctx->next = 0;
+
+  for (int32_t i = 0 ; i < nthreads ; i++) workers.push_back (std::thread (batch_worker, ctx, fd));
+
+  for (int32_t i = 0 ; i < nthreads ; i++) workers[i].join ();
+}
+
+
+
+#ifdef SLAS_HAVE_LIBURING
+
+//  Give up on a ring whose completion queue can't be waited on.  The reads that are still outstanding are cancelled and
+//  waited for so their buffers can be freed, and every record that hasn't been delivered (including the packets that
+//  were never submitted) goes to the callback as a failure so the caller still gets one callback per record.  If we
+//  can't wait for an outstanding read we can't free its buffer (the kernel may still write to it) so it's left alone.
+
+static void batch_uring_abort (BATCH_CONTEXT *ctx, struct io_uring *ring, size_t next, int32_t in_flight)
+{
+  //  The packets before next that still have a buffer are the ones in flight.
+
+  for (size_t i = 0 ; i < next ; i++)
+    {
+      if (!ctx->packets[i].buffer) continue;
+
+      struct io_uring_sqe *sqe = io_uring_get_sqe (ring);
+
+      if (!sqe)
+        {
+          io_uring_submit (ring);
+          if ((sqe = io_uring_get_sqe (ring)) == NULL) break;
+        }
+
+      io_uring_prep_cancel (sqe, &ctx->packets[i], 0);
+      io_uring_sqe_set_data (sqe, NULL);
+    }
+
+  io_uring_submit (ring);
+
+
+  //  Cancelled reads complete with -ECANCELED, ones that were too far along to cancel complete normally.  The cancel
+  //  requests themselves complete with no packet.
+
+  while (in_flight)
+    {
+      struct io_uring_cqe *cqe;
+
+      int32_t ret = io_uring_wait_cqe (ring, &cqe);
+      if (ret == -EINTR) continue;
+      if (ret < 0) break;
+
+      BATCH_PACKET *pkt = (BATCH_PACKET *) io_uring_cqe_get_data (cqe);
+      int32_t res = cqe->res;
+      io_uring_cqe_seen (ring, cqe);
+
+      if (!pkt) continue;
+
+      in_flight--;
+
+      batch_complete (ctx, pkt, pkt->buffer, (res > 0 && pkt->done + res >= pkt->size) ? 0 : -5);
+
+      free (pkt->buffer);
+      pkt->buffer = NULL;
+    }
+
+
+  for (size_t i = 0 ; i < ctx->packets.size () ; i++)
+    {
+      BATCH_PACKET *pkt = &ctx->packets[i];
+
+      if (i < next && !pkt->buffer) continue;
+
+      batch_complete (ctx, pkt, NULL, -5);
+      pkt->buffer = NULL;
+    }
+}
+
+
+
+//  Keep up to queue_depth reads outstanding in an io_uring.  Returns -1 if the ring can't be set up (old kernel, seccomp,
+//  etc.) so that the caller can fall back to the thread pool.
+
+static int32_t batch_uring (BATCH_CONTEXT *ctx, int fd, int32_t queue_depth)
+{
+  struct io_uring ring;
+  size_t          next = 0;
+  int32_t         in_flight = 0;
+
+
+  if (io_uring_queue_init (queue_depth, &ring, 0) < 0) return (-1);
+
+
+  while (next < ctx->packets.size () || in_flight)
+    {
+      //  Fill the submission queue.
+
+      while (next < ctx->packets.size () && in_flight < queue_depth)
+        {
+          BATCH_PACKET *pkt = &ctx->packets[next];
+
+          if ((pkt->buffer = (uint8_t *) malloc (pkt->size)) == NULL)
+            {
+              batch_complete (ctx, pkt, NULL, -5);
+              next++;
+              continue;
+            }
+
+          struct io_uring_sqe *sqe = io_uring_get_sqe (&ring);
+          if (!sqe)
+            {
+              free (pkt->buffer);
+              pkt->buffer = NULL;
+              break;
+            }
+
+          pkt->done = 0;
+          io_uring_prep_read (sqe, fd, pkt->buffer, pkt->size, pkt->offset);
+          io_uring_sqe_set_data (sqe, pkt);
+
+          next++;
+          in_flight++;
+        }
+
+      io_uring_submit (&ring);
+
+
+      struct io_uring_cqe *cqe;
+
+      int32_t ret = io_uring_wait_cqe (&ring, &cqe);
+      if (ret == -EINTR) continue;
+
+      if (ret < 0)
+        {
+          fprintf (stderr, "Error waiting for io_uring completion :\n%s\nFunction: %s, Line: %d\n", strerror (-ret),  __FUNCTION__, __LINE__);
+          fflush (stderr);
+          batch_uring_abort (ctx, &ring, next, in_flight);
+          io_uring_queue_exit (&ring);
+          return (-2);
+        }
+
+      BATCH_PACKET *pkt = (BATCH_PACKET *) io_uring_cqe_get_data (cqe);
+      int32_t res = cqe->res;
+      io_uring_cqe_seen (&ring, cqe);
+
+
+      //  Short read, ask for the rest.
+
+      if (res > 0 && pkt->done + res < pkt->size)
+        {
+          pkt->done += res;
+
+          struct io_uring_sqe *sqe = io_uring_get_sqe (&ring);
+          io_uring_prep_read (sqe, fd, pkt->buffer + pkt->done, pkt->size - pkt->done, pkt->offset + pkt->done);
+          io_uring_sqe_set_data (sqe, pkt);
+          continue;
+        }
+
+      in_flight--;
+
+      batch_complete (ctx, pkt, pkt->buffer, res > 0 ? 0 : -3);
+
+      free (pkt->buffer);
+      pkt->buffer = NULL;
+    }
+
+
+  io_uring_queue_exit (&ring);
+
+  return (0);
+}
+
+#endif
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_batch_fetch_waveforms
+
+ - Purpose:     Retrieve the waveforms for a set of LAS point records.  The point records are
+                read in record order, then the waveform packet reads are sorted by file offset
+                (packets shared by more than one return are only read once) and issued with
+                up to queue_depth reads outstanding.  On Linux, if the program was built with
+                SLAS_HAVE_LIBURING, the reads are submitted through io_uring.  Otherwise (or if
+                the ring can't be set up) a pool of queue_depth threads issues pread calls.
+                Each waveform is decoded and handed to the callback as soon as it arrives so
+                the callback order is not the order of recnums.
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - las_name       =    The LAS or LAZ file name
+                - lasheader      =    The SLAS_HEADER retrieved from the LAS file
+                - swap           =    Flag that indicates that the system is big endian and
+                                      therefor we need to byte swap the records
+                - point_mask     =    SLAS_FIELD_* bits of the point fields the caller needs
+                                      in the callback (the waveform packet fields are always
+                                      decoded, LAZ records are always fully decoded)
+                - recnums        =    The record numbers of the LAS point data records
+                                      (records start at 0)
+                - count          =    Number of record numbers in recnums
+                - queue_depth    =    Maximum number of outstanding waveform reads (1 to
+                                      SLAS_BATCH_MAX_QUEUE_DEPTH)
+                - callback       =    Function called for each record as its waveform is
+                                      decoded (or fails)
+                - user_data      =    Passed through to the callback
+
+ - Returns:     int32_t          =    Negative number on error, 0 on success (individual record
+                                      failures are reported through the callback).  Once the
+                                      arguments have been checked (any error but -1 or -2) the
+                                      callback has been called for every record, even if the
+                                      LAS or waveform file couldn't be opened.
+
+*********************************************************************************************/
+
+int32_t slas_batch_fetch_waveforms (const char *las_name, SLAS_HEADER *lasheader, uint8_t swap, uint32_t point_mask, const uint64_t *recnums,
+                                    int64_t count,
+                                    int32_t queue_depth, SLAS_BATCH_CALLBACK callback, void *user_data)
+{
+  BATCH_CONTEXT  ctx;
+  FILE           *las_fp = NULL;
+  SLAZ_HANDLE    *laz = NULL;
+  int            fd = -1;
+
+
+  if (queue_depth < 1) queue_depth = 1;
+  if (queue_depth > SLAS_BATCH_MAX_QUEUE_DEPTH) queue_depth = SLAS_BATCH_MAX_QUEUE_DEPTH;
+
+  ctx.lasheader = lasheader;
+  ctx.callback = callback;
+  ctx.user_data = user_data;
+
+
+  if (lasheader->point_data_format != 4 && lasheader->point_data_format != 5 && lasheader->point_data_format != 9 &&
+      lasheader->point_data_format != 10)
+    {
+      fprintf (stderr, "Point data format %d has no waveforms :\nFunction: %s, Line: %d\n", lasheader->point_data_format,  __FUNCTION__, __LINE__);
+      fflush (stderr);
+      return (-1);
+    }
+
+
+  try
+    {
+      ctx.records.resize (count);
+      ctx.order.reserve (count);
+    }
+  catch (std::bad_alloc&)
+    {
+      fprintf (stderr, "Error allocating batch records :\nFunction: %s, Line: %d\n", __FUNCTION__, __LINE__);
+      fflush (stderr);
+      return (-2);
+    }
+
+
+  //  Read the point records in record order so that the point file is read as sequentially as possible.  Only the
+  //  fields that were asked for are decoded (the rest stay zeroed).
+
+  for (int64_t i = 0 ; i < count ; i++) ctx.records[i].recnum = recnums[i];
+
+  std::sort (ctx.records.begin (), ctx.records.end (), [] (const BATCH_RECORD &a, const BATCH_RECORD &b) {return a.recnum < b.recnum;});
+
+
+  if (lasheader->compressed)
+    {
+      laz = slaz_open (las_name);
+    }
+  else
+    {
+      las_fp = fopen64 (las_name, "rb");
+    }
+
+  if (!laz && !las_fp)
+    {
+      fprintf (stderr, "Error opening %s :\n%s\nFunction: %s, Line: %d\n", las_name, strerror (errno),  __FUNCTION__, __LINE__);
+      fflush (stderr);
+
+      for (int64_t i = 0 ; i < count ; i++) (*callback) (user_data, ctx.records[i].recnum, &ctx.records[i].point, NULL, -3);
+
+      return (-3);
+    }
+
+
+  for (int64_t i = 0 ; i < count ; i++)
+    {
+      BATCH_RECORD *rec = &ctx.records[i];
+
+      if (laz)
+        {
+          rec->status = slaz_read_point_data (laz, rec->recnum, &rec->point);
+        }
+      else
+        {
+          rec->status = slas_read_point_fields (las_fp, rec->recnum, lasheader, swap, point_mask | SLAS_MASK_WAVEFORM, &rec->point);
+        }
+
+
+      //  Records without a waveform (or with a descriptor that isn't defined) are reported right away.
+
+      if (!rec->status && (!rec->point.wavepacket_descriptor_index || !rec->point.waveform_packet_size ||
+                           !lasheader->wf_packet_desc[rec->point.wavepacket_descriptor_index].bits_per_sample)) rec->status = -2;
+
+      if (rec->status)
+        {
+          (*callback) (user_data, rec->recnum, &rec->point, NULL, rec->status);
+        }
+      else
+        {
+          ctx.order.push_back (i);
+        }
+    }
+
+  if (laz) slaz_close (laz);
+  if (las_fp) fclose (las_fp);
+
+
+  //  Sort the waveform reads by offset and merge records that share a packet.
+
+  std::sort (ctx.order.begin (), ctx.order.end (), [&ctx] (int64_t a, int64_t b)
+             {
+               return ctx.records[a].point.byte_offset_to_waveform_data < ctx.records[b].point.byte_offset_to_waveform_data;
+             });
+
+  for (int64_t i = 0 ; i < (int64_t) ctx.order.size () ; i++)
+    {
+      SLAS_POINT_DATA *point = &ctx.records[ctx.order[i]].point;
+      int64_t offset = lasheader->start_of_waveform_data_packet_record + point->byte_offset_to_waveform_data;
+
+      if (!ctx.packets.empty () && ctx.packets.back ().offset == offset && ctx.packets.back ().size == point->waveform_packet_size)
+        {
+          ctx.packets.back ().last = i;
+        }
+      else
+        {
+          BATCH_PACKET pkt;
+
+          pkt.offset = offset;
+          pkt.size = point->waveform_packet_size;
+          pkt.done = 0;
+          pkt.reported = 0;
+          pkt.first = pkt.last = i;
+          pkt.buffer = NULL;
+
+          ctx.packets.push_back (pkt);
+        }
+    }
+
+  if (ctx.packets.empty ()) return (0);
+
+
+  //  External waveforms are in the .wdp file, internal waveforms are in the LAS file itself.
+
+  if (lasheader->global_encoding & 0x4)
+    {
+      slas_wave_file_name (las_name, ctx.wave_name);
+
+
+      //  If there's no .wdp file but there is a compressed one (.wdc) we read the packets from that.  They're already in
+      //  offset order which is the order they're stored in the .wdc file so we just go through them in this thread.
+
+      SLAS_WDC *wdc;
+      char wdc_name[1024];
+
+      slas_wdc_file_name (las_name, wdc_name);
+
+      if (access (ctx.wave_name, F_OK) && (wdc = slas_wdc_open (wdc_name)) != NULL)
+        {
+          std::vector<uint8_t> buffer;
+
+          for (size_t i = 0 ; i < ctx.packets.size () ; i++)
+            {
+              BATCH_PACKET *pkt = &ctx.packets[i];
+
+              buffer.resize (pkt->size);
+              batch_complete (&ctx, pkt, buffer.data (), slas_wdc_read_packet (wdc, pkt->offset, pkt->size, buffer.data ()) < 0 ? -3 : 0);
+            }
+
+          slas_wdc_close (wdc);
+
+          return (0);
+        }
+    }
+  else
+    {
+      strcpy (ctx.wave_name, las_name);
+    }
+
+
+#ifndef _WIN32
+  if ((fd = open64 (ctx.wave_name, O_RDONLY)) < 0)
+    {
+      fprintf (stderr, "Error opening %s :\n%s\nFunction: %s, Line: %d\n", ctx.wave_name, strerror (errno),  __FUNCTION__, __LINE__);
+      fflush (stderr);
+      batch_fail_pending (&ctx, -3);
+      return (-4);
+    }
+#endif
+
+
+  int32_t status = -1;
+
+#ifdef SLAS_HAVE_LIBURING
+  status = batch_uring (&ctx, fd, queue_depth);
+#endif
+
+  if (status == -1) batch_thread_pool (&ctx, fd, queue_depth);
+
+
+#ifndef _WIN32
+  close (fd);
+#endif
+
+
+  //  batch_uring_abort should have reported everything but make sure.
+
+  if (status == -2)
+    {
+      batch_fail_pending (&ctx, -5);
+      return (-5);
+    }
+
+
+  return (0);
+}
@@ -0,0 +1,70 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! or / / ! are being used by Doxygen to
+    document the software.  Dashes in these comment blocks are used to create bullet lists.
+    The lack of blank lines after a block of dash preceeded comments means that the next
+    block of dash preceeded comments is a new, indented bullet list.  I've tried to keep the
+    Doxygen formatting to a minimum but there are some other items (like <br> and <pre>)
+    that need to be left alone.  If you see a comment that starts with / * ! or / / ! and
+    there is something that looks a bit weird it is probably due to some arcane Doxygen
+    syntax.  Be very careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+/*  Batched waveform fetch definitions.  */
+
+#ifndef __SLAS_BATCH_HPP__
+#define __SLAS_BATCH_HPP__
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/types.h>
+
+#include "slas.hpp"
+
+
+#define SLAS_BATCH_DEFAULT_QUEUE_DEPTH   32
+#define SLAS_BATCH_MAX_QUEUE_DEPTH       256
+
+
+/*!  Called once for every requested record as its waveform completes.  The callback is never called from more than one
+     thread at a time but, when the thread pool fallback is being used, it may be called from one of the worker threads.
+     The point record and wave samples are only valid for the duration of the call (copy the SLAS_SAMPLES to keep them,
+     it only holds bits_per_sample sized storage).  On error, status is negative and wave is NULL.  */
+
+typedef void (*SLAS_BATCH_CALLBACK) (void *user_data, uint64_t recnum, SLAS_POINT_DATA *record, SLAS_SAMPLES *wave, int32_t status);
+
+
+int32_t slas_batch_fetch_waveforms (const char *las_name, SLAS_HEADER *lasheader, uint8_t swap, uint32_t point_mask, const uint64_t *recnums,
+                                    int64_t count,
+                                    int32_t queue_depth, SLAS_BATCH_CALLBACK callback, void *user_data);
+
+
+#endif
@@ -0,0 +1,268 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! or / / ! are being used by Doxygen to
+    document the software.  Dashes in these comment blocks are used to create bullet lists.
+    The lack of blank lines after a block of dash preceeded comments means that the next
+    block of dash preceeded comments is a new, indented bullet list.  I've tried to keep the
+    Doxygen formatting to a minimum but there are some other items (like <br> and <pre>)
+    that need to be left alone.  If you see a comment that starts with / * ! or / / ! and
+    there is something that looks a bit weird it is probably due to some arcane Doxygen
+    syntax.  Be very careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+#include <stddef.h>
+
+#include <vector>
+#include <algorithm>
+
+#include "slas_block.hpp"
+#include "slas_batch.hpp"
+
+
+typedef struct
+{
+  SLAS_BLOCK                  *block;
+  std::vector<std::pair<uint64_t, int64_t> > index;   //  (recnum, row) sorted by recnum
+} BLOCK_CONTEXT;
+
+
+
+//  Batch callback.  Callbacks are serialized by slas_batch_fetch_waveforms so we don't need a lock here.  The same record
+//  may be in the block more than once so we fill the first row for it that hasn't been loaded yet.
+
+static void block_callback (void *user_data, uint64_t recnum, SLAS_POINT_DATA *record, SLAS_SAMPLES *wave, int32_t status)
+{
+  BLOCK_CONTEXT *ctx = (BLOCK_CONTEXT *) user_data;
+  SLAS_BLOCK *block = ctx->block;
+
+
+  std::vector<std::pair<uint64_t, int64_t> >::iterator it = std::lower_bound (ctx->index.begin (), ctx->index.end (),
+                                                                               std::make_pair (recnum, (int64_t) -1));
+
+  while (it != ctx->index.end () && it->first == recnum && block->row[it->second].status != 1) it++;
+
+  if (it == ctx->index.end () || it->first != recnum) return;
+
+
+  SLAS_BLOCK_ROW *row = &block->row[it->second];
+
+  if (!status && record->wavepacket_descriptor_index != block->wavepacket_descriptor_index) status = -5;
+
+  row->gps_time = record->gps_time;
+  row->return_point_waveform_location = record->return_point_waveform_location;
+  row->wavepacket_descriptor_index = record->wavepacket_descriptor_index;
+  row->status = status;
+
+  if (!status) memcpy (slas_block_row (block, it->second), wave->ptr8 (), std::min (wave->bytes (),
+                                                                                      (size_t) block->number_of_samples * block->bytes_per_sample));
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_block_alloc
+
+ - Purpose:     Allocate an aligned waveform block for rows waveforms that use the waveform
+                packet descriptor wavepacket_descriptor_index.
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - lasheader      =    The SLAS_HEADER retrieved from the LAS file
+                - wavepacket_descriptor_index = The waveform packet descriptor index (1-255)
+                - rows           =    Number of waveforms in the block
+
+ - Returns:     SLAS_BLOCK *     =    The block (free it with slas_block_free) or NULL on
+                                      error (bad descriptor or out of memory)
+
+*********************************************************************************************/
+
+SLAS_BLOCK *slas_block_alloc (SLAS_HEADER *lasheader, uint8_t wavepacket_descriptor_index, int64_t rows)
+{
+  SLAS_WAVEFORM_PACKET_DESCRIPTOR *desc = &lasheader->wf_packet_desc[wavepacket_descriptor_index];
+
+
+  if (!wavepacket_descriptor_index || !desc->bits_per_sample || !desc->number_of_samples || rows <= 0) return (NULL);
+
+
+  SLAS_BLOCK *block = (SLAS_BLOCK *) calloc (1, sizeof (SLAS_BLOCK));
+
+  if (block == NULL) return (NULL);
+
+
+  block->wavepacket_descriptor_index = wavepacket_descriptor_index;
+  block->bits_per_sample = desc->bits_per_sample;
+  block->bytes_per_sample = SLAS_SAMPLES::widthForBits (desc->bits_per_sample);
+  block->number_of_samples = desc->number_of_samples;
+  block->rows = rows;
+
+
+  //  Pad the rows out to the alignment.
+
+  uint32_t per_line = SLAS_BLOCK_ALIGNMENT / block->bytes_per_sample;
+  block->stride = ((block->number_of_samples + per_line - 1) / per_line) * per_line;
+
+  size_t size = (size_t) rows * block->stride * block->bytes_per_sample;
+
+
+#ifdef _WIN32
+  block->data = (uint8_t *) _aligned_malloc (size, SLAS_BLOCK_ALIGNMENT);
+#else
+  if (posix_memalign ((void **) &block->data, SLAS_BLOCK_ALIGNMENT, size)) block->data = NULL;
+#endif
+
+  block->row = (SLAS_BLOCK_ROW *) calloc (rows, sizeof (SLAS_BLOCK_ROW));
+
+  if (block->data == NULL || block->row == NULL)
+    {
+      slas_block_free (block);
+      return (NULL);
+    }
+
+  memset (block->data, 0, size);
+
+  for (int64_t i = 0 ; i < rows ; i++) block->row[i].status = 1;
+
+
+  return (block);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_block_load
+
+ - Purpose:     Load block->rows waveforms into a block.  The waveforms are read in parallel
+                by slas_batch_fetch_waveforms and copied into their rows as they arrive.  Row
+                i gets record recnums[i].
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - las_name       =    The LAS or LAZ file name
+                - lasheader      =    The SLAS_HEADER retrieved from the LAS file
+                - swap           =    Flag that indicates that the system is big endian and
+                                      therefor we need to byte swap the records
+                - recnums        =    block->rows record numbers of the LAS point data records
+                                      (records start at 0)
+                - queue_depth    =    Maximum number of outstanding waveform reads (1 to
+                                      SLAS_BATCH_MAX_QUEUE_DEPTH)
+                - block          =    The block from slas_block_alloc
+
+ - Returns:     int64_t          =    Negative number on error, otherwise the number of rows
+                                      that were loaded (check block->row[i].status for the
+                                      ones that weren't)
+
+*********************************************************************************************/
+
+int64_t slas_block_load (const char *las_name, SLAS_HEADER *lasheader, uint8_t swap, const uint64_t *recnums, int32_t queue_depth,
+                         SLAS_BLOCK *block)
+{
+  BLOCK_CONTEXT ctx;
+
+
+  ctx.block = block;
+  ctx.index.resize (block->rows);
+
+  for (int64_t i = 0 ; i < block->rows ; i++)
+    {
+      ctx.index[i] = std::make_pair (recnums[i], i);
+      block->row[i].recnum = recnums[i];
+      block->row[i].status = 1;
+    }
+
+  std::sort (ctx.index.begin (), ctx.index.end ());
+
+
+  int32_t status = slas_batch_fetch_waveforms (las_name, lasheader, swap, SLAS_MASK_WAVEFORM_TIME, recnums, block->rows, queue_depth,
+                                               block_callback, &ctx);
+
+  if (status < 0) return (status);
+
+
+  //  Clear the rows that didn't load so the block doesn't have stale data in it.
+
+  int64_t loaded = 0;
+
+  for (int64_t i = 0 ; i < block->rows ; i++)
+    {
+      if (block->row[i].status)
+        {
+          memset (slas_block_row (block, i), 0, (size_t) block->stride * block->bytes_per_sample);
+        }
+      else
+        {
+          loaded++;
+        }
+    }
+
+
+  return (loaded);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_block_free
+
+ - Purpose:     Free a block allocated by slas_block_alloc.
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - block          =    The block (may be NULL)
+
+ - Returns:     void
+
+*********************************************************************************************/
+
+void slas_block_free (SLAS_BLOCK *block)
+{
+  if (block == NULL) return;
+
+#ifdef _WIN32
+  if (block->data) _aligned_free (block->data);
+#else
+  free (block->data);
+#endif
+
+  free (block->row);
+  free (block);
+}
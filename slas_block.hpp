@@ -0,0 +1,123 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! or / / ! are being used by Doxygen to
+    document the software.  Dashes in these comment blocks are used to create bullet lists.
+    The lack of blank lines after a block of dash preceeded comments means that the next
+    block of dash preceeded comments is a new, indented bullet list.  I've tried to keep the
+    Doxygen formatting to a minimum but there are some other items (like <br> and <pre>)
+    that need to be left alone.  If you see a comment that starts with / * ! or / / ! and
+    there is something that looks a bit weird it is probably due to some arcane Doxygen
+    syntax.  Be very careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+/*  Aligned waveform block definitions.  */
+
+#ifndef __SLAS_BLOCK_HPP__
+#define __SLAS_BLOCK_HPP__
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/types.h>
+
+#include "slas.hpp"
+
+
+#define SLAS_BLOCK_ALIGNMENT          64       //!<  Byte alignment of the block and of every row
+
+
+/*!  Per row metadata.  status is 0 if the row was loaded, negative on error (-5 means the record uses a different
+     waveform packet descriptor than the block), and 1 if the row hasn't been loaded.  */
+
+typedef struct
+{
+  uint64_t                    recnum;
+  double                      gps_time;
+  float                       return_point_waveform_location;
+  uint8_t                     wavepacket_descriptor_index;   //!<  The record's descriptor (it may not be the block's)
+  int32_t                     status;
+} SLAS_BLOCK_ROW;
+
+
+/*!  A block of waveforms that all use the same waveform packet descriptor stored as a row major matrix.  Samples are
+     stored in the narrowest type that holds bits_per_sample (see SLAS_SAMPLES).  Each row is stride samples long (stride
+     * bytes_per_sample is a multiple of SLAS_BLOCK_ALIGNMENT) so every row starts on an aligned boundary.  The padding
+     at the end of each row (and any row that failed to load) is zero.  */
+
+typedef struct
+{
+  uint8_t                     wavepacket_descriptor_index;
+  uint8_t                     bits_per_sample;
+  uint8_t                     bytes_per_sample;
+  uint32_t                    number_of_samples;
+  uint32_t                    stride;                 //!<  Samples per row, including padding
+  int64_t                     rows;
+  uint8_t                     *data;                  //!<  rows * stride * bytes_per_sample bytes, aligned
+  SLAS_BLOCK_ROW              *row;
+} SLAS_BLOCK;
+
+
+SLAS_BLOCK *slas_block_alloc (SLAS_HEADER *lasheader, uint8_t wavepacket_descriptor_index, int64_t rows);
+int64_t slas_block_load (const char *las_name, SLAS_HEADER *lasheader, uint8_t swap, const uint64_t *recnums, int32_t queue_depth,
+                         SLAS_BLOCK *block);
+void slas_block_free (SLAS_BLOCK *block);
+
+
+//!  Pointer to the first sample of row i.
+
+inline uint8_t *slas_block_row (SLAS_BLOCK *block, int64_t i)
+{
+  return (block->data + (size_t) i * block->stride * block->bytes_per_sample);
+}
+
+
+/*!  Call kernel.template run<T> (data, rows, stride, number_of_samples) with T set to the sample storage type of the
+     block.  This is the block version of slas_dispatch_samples.  */
+
+template <typename KERNEL> inline void slas_dispatch_block (const SLAS_BLOCK *block, KERNEL &kernel)
+{
+  switch (block->bytes_per_sample)
+    {
+    case 1:
+      kernel.template run<uint8_t> ((const uint8_t *) block->data, block->rows, block->stride, block->number_of_samples);
+      break;
+
+    case 2:
+      kernel.template run<uint16_t> ((const uint16_t *) block->data, block->rows, block->stride, block->number_of_samples);
+      break;
+
+    default:
+      kernel.template run<uint32_t> ((const uint32_t *) block->data, block->rows, block->stride, block->number_of_samples);
+      break;
+    }
+}
+
+
+#endif
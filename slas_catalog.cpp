@@ -0,0 +1,575 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! or / / ! are being used by Doxygen to
+    document the software.  Dashes in these comment blocks are used to create bullet lists.
+    The lack of blank lines after a block of dash preceeded comments means that the next
+    block of dash preceeded comments is a new, indented bullet list.  I've tried to keep the
+    Doxygen formatting to a minimum but there are some other items (like <br> and <pre>)
+    that need to be left alone.  If you see a comment that starts with / * ! or / / ! and
+    there is something that looks a bit weird it is probably due to some arcane Doxygen
+    syntax.  Be very careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+#include <stddef.h>
+
+#include "slas_catalog.hpp"
+#include "nvutility.hpp"
+
+#include <QtCore>
+
+
+#define SLAS_CATALOG_MAGIC        "SLASCAT1"
+
+
+
+//  Get the size and modification time of a file.  These are used to decide if a cached header is still good.
+
+static uint8_t catalog_identity (const char *filename, int64_t *size, int64_t *mtime)
+{
+  QFileInfo info (QString::fromLocal8Bit (filename));
+
+  if (!info.exists ()) return (NVFalse);
+
+  *size = info.size ();
+  *mtime = info.lastModified ().toMSecsSinceEpoch ();
+
+  return (NVTrue);
+}
+
+
+
+//  Read the catalog cache file.  Only entries for files that are in the file list are kept.  The cache file is written
+//  in native byte order with the raw header structures so it is rejected if the structure sizes don't match.
+
+static void catalog_load (SLAS_CATALOG *catalog)
+{
+  FILE      *fp;
+  char      magic[8];
+  uint32_t  count, header_bytes, desc_bytes;
+
+
+  if ((fp = fopen64 (catalog->cache_file.c_str (), "rb")) == NULL) return;
+
+
+  if (!fread (magic, 8, 1, fp) || memcmp (magic, SLAS_CATALOG_MAGIC, 8) || !fread (&header_bytes, 4, 1, fp) ||
+      !fread (&desc_bytes, 4, 1, fp) || !fread (&count, 4, 1, fp) || header_bytes != offsetof (SLAS_HEADER, wf_packet_desc) ||
+      desc_bytes != sizeof (SLAS_WAVEFORM_PACKET_DESCRIPTOR))
+    {
+      fclose (fp);
+      return;
+    }
+
+
+  std::map<std::string, int32_t> wanted;
+  for (size_t i = 0 ; i < catalog->files.size () ; i++) wanted[catalog->files[i]] = 1;
+
+
+  for (uint32_t i = 0 ; i < count ; i++)
+    {
+      SLAS_CATALOG_ENTRY entry;
+      char path[1024];
+      uint16_t len, ndesc;
+      uint8_t ndx;
+
+
+      memset (&entry, 0, sizeof (SLAS_CATALOG_ENTRY));
+
+      if (!fread (&len, 2, 1, fp) || len >= sizeof (path) || (len && !fread (path, len, 1, fp))) break;
+      path[len] = 0;
+
+      if (!fread (&entry.size, 8, 1, fp) || !fread (&entry.mtime, 8, 1, fp) || !fread (&entry.status, 4, 1, fp) ||
+          !fread (&entry.header, header_bytes, 1, fp) || !fread (&ndesc, 2, 1, fp)) break;
+
+      uint8_t bad = NVFalse;
+      for (int32_t j = 0 ; j < ndesc ; j++)
+        {
+          if (!fread (&ndx, 1, 1, fp) || !fread (&entry.header.wf_packet_desc[ndx], desc_bytes, 1, fp))
+            {
+              bad = NVTrue;
+              break;
+            }
+        }
+      if (bad) break;
+
+      if (wanted.count (path)) catalog->entries[path] = entry;
+    }
+
+
+  fclose (fp);
+}
+
+
+
+//  Write the catalog cache file.  We write to a temporary file and rename it so that another monitor reading the cache
+//  file at the same time never sees a partial file.
+
+static void catalog_save (SLAS_CATALOG *catalog)
+{
+  FILE      *fp;
+  uint32_t  count, header_bytes, desc_bytes;
+
+
+  std::string tmp_file = catalog->cache_file + ".tmp";
+
+  if ((fp = fopen64 (tmp_file.c_str (), "wb")) == NULL)
+    {
+      fprintf (stderr, "Error creating catalog cache file %s :\n%s\nFunction: %s, Line: %d\n", tmp_file.c_str (), strerror (errno),
+               __FUNCTION__, __LINE__);
+      fflush (stderr);
+      return;
+    }
+
+
+  std::lock_guard<std::mutex> lock (catalog->mutex);
+
+  header_bytes = offsetof (SLAS_HEADER, wf_packet_desc);
+  desc_bytes = sizeof (SLAS_WAVEFORM_PACKET_DESCRIPTOR);
+  count = catalog->entries.size ();
+
+  fwrite (SLAS_CATALOG_MAGIC, 8, 1, fp);
+  fwrite (&header_bytes, 4, 1, fp);
+  fwrite (&desc_bytes, 4, 1, fp);
+  fwrite (&count, 4, 1, fp);
+
+  for (std::map<std::string, SLAS_CATALOG_ENTRY>::iterator it = catalog->entries.begin () ; it != catalog->entries.end () ; ++it)
+    {
+      SLAS_CATALOG_ENTRY *entry = &it->second;
+      uint16_t len = it->first.size (), ndesc = 0;
+
+      fwrite (&len, 2, 1, fp);
+      fwrite (it->first.c_str (), len, 1, fp);
+      fwrite (&entry->size, 8, 1, fp);
+      fwrite (&entry->mtime, 8, 1, fp);
+      fwrite (&entry->status, 4, 1, fp);
+      fwrite (&entry->header, header_bytes, 1, fp);
+
+
+      //  Only the descriptors that are defined are written.
+
+      for (int32_t j = 1 ; j < 256 ; j++) if (entry->header.wf_packet_desc[j].bits_per_sample) ndesc++;
+
+      fwrite (&ndesc, 2, 1, fp);
+
+      for (int32_t j = 1 ; j < 256 ; j++)
+        {
+          if (entry->header.wf_packet_desc[j].bits_per_sample)
+            {
+              uint8_t ndx = j;
+              fwrite (&ndx, 1, 1, fp);
+              fwrite (&entry->header.wf_packet_desc[j], desc_bytes, 1, fp);
+            }
+        }
+    }
+
+
+  if (fclose (fp))
+    {
+      remove (tmp_file.c_str ());
+      return;
+    }
+
+#ifdef _WIN32
+  remove (catalog->cache_file.c_str ());
+#endif
+
+  rename (tmp_file.c_str (), catalog->cache_file.c_str ());
+}
+
+
+
+//  Each worker takes the next file from the list and, if it isn't already in the catalog with the same size and
+//  modification time, reads the header.
+
+static void catalog_worker (SLAS_CATALOG *catalog)
+{
+  SLAS_CATALOG_ENTRY entry;
+
+
+  while (!catalog->abort)
+    {
+      size_t i = catalog->next.fetch_add (1);
+      if (i >= catalog->files.size ()) break;
+
+      const char *name = catalog->files[i].c_str ();
+
+
+      memset (&entry, 0, sizeof (SLAS_CATALOG_ENTRY));
+      entry.status = SLAS_CATALOG_OPEN_ERROR;
+
+      if (catalog_identity (name, &entry.size, &entry.mtime))
+        {
+          {
+            std::lock_guard<std::mutex> lock (catalog->mutex);
+
+            std::map<std::string, SLAS_CATALOG_ENTRY>::iterator it = catalog->entries.find (catalog->files[i]);
+
+            if (it != catalog->entries.end () && !it->second.status && it->second.size == entry.size && it->second.mtime == entry.mtime)
+              continue;
+          }
+
+
+          FILE *fp = fopen64 (name, "rb");
+
+          if (fp)
+            {
+              entry.status = slas_read_header (fp, catalog->swap, &entry.header);
+              fclose (fp);
+            }
+        }
+
+
+      std::lock_guard<std::mutex> lock (catalog->mutex);
+
+
+      //  Don't rewrite the cache file just because a file is still failing the same way.
+
+      std::map<std::string, SLAS_CATALOG_ENTRY>::iterator it = catalog->entries.find (catalog->files[i]);
+
+      if (it != catalog->entries.end () && entry.status && it->second.status == entry.status && it->second.size == entry.size &&
+          it->second.mtime == entry.mtime) continue;
+
+      catalog->entries[catalog->files[i]] = entry;
+      catalog->changed = 1;
+    }
+}
+
+
+
+static void catalog_main (SLAS_CATALOG *catalog)
+{
+  std::vector<std::thread> workers;
+
+
+  catalog_load (catalog);
+
+
+  int32_t nthreads = catalog->nthreads;
+  if ((size_t) nthreads > catalog->files.size ()) nthreads = catalog->files.size ();
+
+  for (int32_t i = 0 ; i < nthreads ; i++) workers.push_back (std::thread (catalog_worker, catalog));
+
+  for (int32_t i = 0 ; i < nthreads ; i++) workers[i].join ();
+
+
+  if (catalog->changed && !catalog->abort) catalog_save (catalog);
+
+
+  catalog->done = 1;
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_catalog_build
+
+ - Purpose:     Start building a catalog of the LAS headers (including the waveform packet
+                descriptors) for a list of files.  Headers are taken from the cache file if
+                the file size and modification time haven't changed, otherwise they are read
+                in parallel by nthreads threads.  The cache file is rewritten if anything
+                changed.  This runs in the background, catalog->done is set when it's
+                finished.
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - files          =    The LAS file names
+                - cache_file     =    The catalog cache file name
+                - swap           =    Flag that indicates that the system is big endian and
+                                      therefor we need to byte swap the headers
+                - nthreads       =    Number of reader threads (0 for the number of cores up to
+                                      SLAS_CATALOG_MAX_THREADS)
+
+ - Returns:     SLAS_CATALOG *   =    The catalog (free it with slas_catalog_close) or NULL on
+                                      error
+
+*********************************************************************************************/
+
+SLAS_CATALOG *slas_catalog_build (const std::vector<std::string> &files, const char *cache_file, uint8_t swap, int32_t nthreads)
+{
+  SLAS_CATALOG *catalog;
+
+
+  try
+    {
+      catalog = new SLAS_CATALOG;
+    }
+  catch (std::bad_alloc&)
+    {
+      fprintf (stderr, "Error allocating catalog :\nFunction: %s, Line: %d\n", __FUNCTION__, __LINE__);
+      fflush (stderr);
+      return (NULL);
+    }
+
+
+  if (nthreads <= 0) nthreads = std::thread::hardware_concurrency ();
+  if (nthreads <= 0) nthreads = 1;
+  if (nthreads > SLAS_CATALOG_MAX_THREADS) nthreads = SLAS_CATALOG_MAX_THREADS;
+
+  catalog->files = files;
+  catalog->cache_file = cache_file;
+  catalog->swap = swap;
+  catalog->nthreads = nthreads;
+  catalog->next = 0;
+  catalog->done = 0;
+  catalog->changed = 0;
+  catalog->abort = 0;
+
+  catalog->thread = std::thread (catalog_main, catalog);
+
+
+  return (catalog);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_catalog_lookup
+
+ - Purpose:     Get the header for a file from the catalog.  The file is checked (one stat)
+                to make sure it hasn't changed since the header was read.
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - catalog        =    The catalog (may be NULL)
+                - filename       =    The LAS file name
+                - header         =    The returned SLAS_HEADER
+
+ - Returns:     int32_t          =    0 if the header was found and is current, otherwise -1
+
+*********************************************************************************************/
+
+int32_t slas_catalog_lookup (SLAS_CATALOG *catalog, const char *filename, SLAS_HEADER *header)
+{
+  int64_t size, mtime;
+
+
+  if (!catalog) return (-1);
+
+  if (!catalog_identity (filename, &size, &mtime)) return (-1);
+
+
+  std::lock_guard<std::mutex> lock (catalog->mutex);
+
+  std::map<std::string, SLAS_CATALOG_ENTRY>::iterator it = catalog->entries.find (filename);
+
+  if (it == catalog->entries.end () || it->second.status || it->second.size != size || it->second.mtime != mtime) return (-1);
+
+  *header = it->second.header;
+
+
+  return (0);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_catalog_insert
+
+ - Purpose:     Add (or replace) a header that was read outside of the catalog scan.
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - catalog        =    The catalog (may be NULL)
+                - filename       =    The LAS file name
+                - header         =    The SLAS_HEADER
+
+ - Returns:     void
+
+*********************************************************************************************/
+
+void slas_catalog_insert (SLAS_CATALOG *catalog, const char *filename, SLAS_HEADER *header)
+{
+  SLAS_CATALOG_ENTRY entry;
+
+
+  if (!catalog) return;
+
+  if (!catalog_identity (filename, &entry.size, &entry.mtime)) return;
+
+  entry.status = 0;
+  entry.header = *header;
+
+
+  std::lock_guard<std::mutex> lock (catalog->mutex);
+
+  catalog->entries[filename] = entry;
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_catalog_extend
+
+ - Purpose:     Bring the catalog entry for a file that is still being written (tail mode) up
+                to date without reading the whole header again.  The cached header's point
+                counts are refreshed with slas_refresh_point_count and the entry's size and
+                modification time are updated.
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - catalog        =    The catalog (may be NULL)
+                - filename       =    The LAS file name
+                - fp             =    The open LAS file
+                - header         =    The returned SLAS_HEADER
+
+ - Returns:     int32_t          =    Negative number if there is no good entry for the file
+                                      (or the refresh failed), 1 if the number of point
+                                      records changed, 0 if it didn't
+
+*********************************************************************************************/
+
+int32_t slas_catalog_extend (SLAS_CATALOG *catalog, const char *filename, FILE *fp, SLAS_HEADER *header)
+{
+  SLAS_CATALOG_ENTRY entry;
+
+
+  if (!catalog) return (-1);
+
+  if (!catalog_identity (filename, &entry.size, &entry.mtime)) return (-1);
+
+
+  {
+    std::lock_guard<std::mutex> lock (catalog->mutex);
+
+    std::map<std::string, SLAS_CATALOG_ENTRY>::iterator it = catalog->entries.find (filename);
+
+    if (it == catalog->entries.end () || it->second.status) return (-1);
+
+    entry.header = it->second.header;
+  }
+
+
+  //  Don't hold the lock while we're reading the file.
+
+  int32_t changed = slas_refresh_point_count (fp, catalog->swap, &entry.header);
+
+  if (changed < 0) return (changed);
+
+  entry.status = 0;
+  *header = entry.header;
+
+
+  std::lock_guard<std::mutex> lock (catalog->mutex);
+
+  catalog->entries[filename] = entry;
+
+
+  return (changed);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_catalog_failures
+
+ - Purpose:     Get the list of files that couldn't be opened or whose headers couldn't be
+                read during the catalog scan.
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - catalog        =    The catalog
+                - names          =    The returned file names
+                - status         =    The returned status for each file (SLAS_CATALOG_OPEN_ERROR
+                                      or the slas_read_header error)
+
+ - Returns:     void
+
+*********************************************************************************************/
+
+void slas_catalog_failures (SLAS_CATALOG *catalog, std::vector<std::string> &names, std::vector<int32_t> &status)
+{
+  names.clear ();
+  status.clear ();
+
+
+  std::lock_guard<std::mutex> lock (catalog->mutex);
+
+  for (std::map<std::string, SLAS_CATALOG_ENTRY>::iterator it = catalog->entries.begin () ; it != catalog->entries.end () ; ++it)
+    {
+      if (it->second.status)
+        {
+          names.push_back (it->first);
+          status.push_back (it->second.status);
+        }
+    }
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_catalog_close
+
+ - Purpose:     Stop the catalog scan (if it's still running) and free the catalog.
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - catalog        =    The catalog (may be NULL)
+
+ - Returns:     void
+
+*********************************************************************************************/
+
+void slas_catalog_close (SLAS_CATALOG *catalog)
+{
+  if (!catalog) return;
+
+  catalog->abort = 1;
+
+  if (catalog->thread.joinable ()) catalog->thread.join ();
+
+  delete catalog;
+}
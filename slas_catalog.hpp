@@ -0,0 +1,97 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! or / / ! are being used by Doxygen to
+    document the software.  Dashes in these comment blocks are used to create bullet lists.
+    The lack of blank lines after a block of dash preceeded comments means that the next
+    block of dash preceeded comments is a new, indented bullet list.  I've tried to keep the
+    Doxygen formatting to a minimum but there are some other items (like <br> and <pre>)
+    that need to be left alone.  If you see a comment that starts with / * ! or / / ! and
+    there is something that looks a bit weird it is probably due to some arcane Doxygen
+    syntax.  Be very careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+/*  LAS header catalog definitions.  */
+
+#ifndef __SLAS_CATALOG_HPP__
+#define __SLAS_CATALOG_HPP__
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/types.h>
+
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <thread>
+
+#include "slas.hpp"
+
+
+#define SLAS_CATALOG_MAX_THREADS      16
+#define SLAS_CATALOG_OPEN_ERROR       -100     //!<  Status for files that couldn't be opened
+
+
+typedef struct
+{
+  int64_t                     size;           //!<  File size when the header was read
+  int64_t                     mtime;          //!<  File modification time (milliseconds since epoch) when the header was read
+  int32_t                     status;         //!<  0 on success, SLAS_CATALOG_OPEN_ERROR, or the slas_read_header error
+  SLAS_HEADER                 header;
+} SLAS_CATALOG_ENTRY;
+
+
+typedef struct
+{
+  std::map<std::string, SLAS_CATALOG_ENTRY> entries;
+  std::vector<std::string>    files;          //!<  Files to be scanned
+  std::string                 cache_file;
+  uint8_t                     swap;
+  int32_t                     nthreads;
+  std::atomic<size_t>         next;
+  std::atomic<int32_t>        done;           //!<  Set when the scan (and cache file update) has finished
+  std::atomic<int32_t>        changed;        //!<  Set if anything was read from a file instead of the cache file
+  std::atomic<int32_t>        abort;
+  std::mutex                  mutex;
+  std::thread                 thread;
+} SLAS_CATALOG;
+
+
+SLAS_CATALOG *slas_catalog_build (const std::vector<std::string> &files, const char *cache_file, uint8_t swap, int32_t nthreads);
+int32_t slas_catalog_lookup (SLAS_CATALOG *catalog, const char *filename, SLAS_HEADER *header);
+void slas_catalog_insert (SLAS_CATALOG *catalog, const char *filename, SLAS_HEADER *header);
+int32_t slas_catalog_extend (SLAS_CATALOG *catalog, const char *filename, FILE *fp, SLAS_HEADER *header);
+void slas_catalog_failures (SLAS_CATALOG *catalog, std::vector<std::string> &names, std::vector<int32_t> &status);
+void slas_catalog_close (SLAS_CATALOG *catalog);
+
+
+#endif
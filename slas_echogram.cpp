@@ -0,0 +1,741 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! or / / ! are being used by Doxygen to
+    document the software.  Dashes in these comment blocks are used to create bullet lists.
+    The lack of blank lines after a block of dash preceeded comments means that the next
+    block of dash preceeded comments is a new, indented bullet list.  I've tried to keep the
+    Doxygen formatting to a minimum but there are some other items (like <br> and <pre>)
+    that need to be left alone.  If you see a comment that starts with / * ! or / / ! and
+    there is something that looks a bit weird it is probably due to some arcane Doxygen
+    syntax.  Be very careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+#include "slas_echogram.hpp"
+
+
+
+//  Tile keys sort by level and then by index.
+
+static inline uint64_t echogram_key (int32_t level, int64_t index)
+{
+  return (((uint64_t) level << 56) | (uint64_t) index);
+}
+
+
+
+//  Point records covered by one tile at a level.
+
+static inline int64_t echogram_span (int32_t level)
+{
+  return ((int64_t) SLAS_ECHOGRAM_TILE_COLUMNS << level);
+}
+
+
+
+static inline size_t echogram_tile_bytes (SLAS_ECHOGRAM *echo)
+{
+  return ((size_t) echo->height * SLAS_ECHOGRAM_TILE_COLUMNS);
+}
+
+
+
+//  Writes one waveform into its column.  Samples are scaled to 0-255 by the largest value the descriptor's
+//  bits_per_sample can hold and, when the waveform is longer than the tile height, rows get the largest of their samples.
+
+class ECHOGRAM_COLUMN_KERNEL
+{
+public:
+
+  uint8_t                     *column;
+  int32_t                     height;
+  uint32_t                    samples;
+  double                      scale;
+
+  template <typename T> void run (const T *data, uint32_t count)
+  {
+    if (count > samples) count = samples;
+
+    for (uint32_t i = 0 ; i < count ; i++)
+      {
+        int32_t row = (int32_t) ((uint64_t) i * height / samples);
+        uint8_t value = (uint8_t) std::min (255.0, (double) data[i] * scale + 0.5);
+
+        uint8_t *pixel = column + (size_t) row * SLAS_ECHOGRAM_TILE_COLUMNS;
+        if (value > *pixel) *pixel = value;
+      }
+  }
+};
+
+
+
+//  Batch fetch context for echogram_build_columns.
+
+typedef struct
+{
+  SLAS_ECHOGRAM               *echo;
+  int64_t                     first;
+  int64_t                     count;
+  uint8_t                     *tiles;
+} ECHOGRAM_BATCH;
+
+
+
+static void echogram_callback (void *user_data, uint64_t recnum, SLAS_POINT_DATA *record, SLAS_SAMPLES *wave, int32_t status)
+{
+  ECHOGRAM_BATCH *batch = (ECHOGRAM_BATCH *) user_data;
+  SLAS_ECHOGRAM *echo = batch->echo;
+
+
+  //  Records without a waveform are left as zeros.
+
+  if (status < 0 || !wave || !wave->size ()) return;
+
+  int64_t column = echo->order == SLAS_ECHOGRAM_TIME_ORDER ? (int64_t) echo->record_column[recnum] : (int64_t) recnum;
+  int64_t local = column - batch->first;
+
+  if (local < 0 || local >= batch->count) return;
+
+
+  SLAS_WAVEFORM_PACKET_DESCRIPTOR *desc = &echo->header.wf_packet_desc[record->wavepacket_descriptor_index];
+  int32_t bits = desc->bits_per_sample ? desc->bits_per_sample : 8;
+
+  ECHOGRAM_COLUMN_KERNEL kernel;
+  kernel.column = batch->tiles + (size_t) (local / SLAS_ECHOGRAM_TILE_COLUMNS) * echogram_tile_bytes (echo) +
+    local % SLAS_ECHOGRAM_TILE_COLUMNS;
+  kernel.height = echo->height;
+  kernel.samples = echo->samples;
+  kernel.scale = 255.0 / (double) ((bits >= 32) ? 0xffffffffULL : ((1ULL << bits) - 1));
+
+  slas_dispatch_samples (*wave, kernel);
+}
+
+
+
+//  Build the level 0 tiles for count columns starting at first (a multiple of SLAS_ECHOGRAM_TILE_COLUMNS).  The
+//  columns past the end of the file are zero.
+
+static int32_t echogram_build_columns (SLAS_ECHOGRAM *echo, int64_t first, int64_t count, std::vector<uint8_t> &tiles)
+{
+  int64_t ntiles = (count + SLAS_ECHOGRAM_TILE_COLUMNS - 1) / SLAS_ECHOGRAM_TILE_COLUMNS;
+
+  tiles.assign ((size_t) ntiles * echogram_tile_bytes (echo), 0);
+
+
+  std::vector<uint64_t> recnums (count);
+
+  for (int64_t i = 0 ; i < count ; i++) recnums[i] = slas_echogram_record (echo, first + i);
+
+
+  ECHOGRAM_BATCH batch;
+  batch.echo = echo;
+  batch.first = first;
+  batch.count = count;
+  batch.tiles = tiles.data ();
+
+  return (slas_batch_fetch_waveforms (echo->las_name.c_str (), &echo->header, echo->swap, SLAS_FIELD_WAVE_PACKET, recnums.data (), count,
+                                      SLAS_BATCH_DEFAULT_QUEUE_DEPTH, echogram_callback, &batch));
+}
+
+
+
+//  Reduce a child tile to half width into the left (half = 0) or right (half = 1) half of its parent.
+
+static void echogram_reduce (SLAS_ECHOGRAM *echo, const uint8_t *child, uint8_t *parent, int32_t half)
+{
+  int32_t offset = half * SLAS_ECHOGRAM_TILE_COLUMNS / 2;
+
+  for (int32_t row = 0 ; row < echo->height ; row++)
+    {
+      const uint8_t *in = child + (size_t) row * SLAS_ECHOGRAM_TILE_COLUMNS;
+      uint8_t *out = parent + (size_t) row * SLAS_ECHOGRAM_TILE_COLUMNS + offset;
+
+      for (int32_t col = 0 ; col < SLAS_ECHOGRAM_TILE_COLUMNS / 2 ; col++) out[col] = std::max (in[2 * col], in[2 * col + 1]);
+    }
+}
+
+
+
+//  Add a tile to the pyramid.  Tiles below keep_level go in the LRU cache, dropping the least recently used ones (other
+//  than the new one) to stay under max_cache_bytes.
+
+static void echogram_store (SLAS_ECHOGRAM *echo, int32_t level, int64_t index, const uint8_t *data)
+{
+  SLAS_ECHOGRAM_ENTRY entry;
+  entry.tile = std::make_shared<const std::vector<uint8_t> > (data, data + echogram_tile_bytes (echo));
+
+
+  std::lock_guard<std::mutex> lock (echo->mutex);
+
+  uint64_t key = echogram_key (level, index);
+  entry.last_used = ++echo->clock;
+
+  std::map<uint64_t, SLAS_ECHOGRAM_ENTRY>::iterator it = echo->tiles.find (key);
+
+  if (it != echo->tiles.end ())
+    {
+      it->second = entry;
+    }
+  else
+    {
+      echo->tiles[key] = entry;
+
+      if (level < echo->keep_level)
+        {
+          echo->cache_bytes += echogram_tile_bytes (echo);
+
+          while (echo->cache_bytes > echo->max_cache_bytes)
+            {
+              std::map<uint64_t, SLAS_ECHOGRAM_ENTRY>::iterator oldest = echo->tiles.end ();
+
+              for (it = echo->tiles.begin () ; it != echo->tiles.end () && it->first < echogram_key (echo->keep_level, 0) ; it++)
+                {
+                  if (it->first != key && (oldest == echo->tiles.end () || it->second.last_used < oldest->second.last_used)) oldest = it;
+                }
+
+              if (oldest == echo->tiles.end ()) break;
+
+              echo->tiles.erase (oldest);
+              echo->cache_bytes -= echogram_tile_bytes (echo);
+            }
+        }
+    }
+
+  echo->generation++;
+}
+
+
+
+//  Build one tile (below keep_level) that was dropped from the cache, along with the tiles below it.
+
+static int32_t echogram_rebuild (SLAS_ECHOGRAM *echo, int32_t level, int64_t index)
+{
+  int64_t first = index * echogram_span (level);
+  int64_t count = std::min (echogram_span (level), echo->columns - first);
+
+  if (count <= 0) return (0);
+
+
+  std::vector<uint8_t> tiles, batch;
+  size_t tile_bytes = echogram_tile_bytes (echo);
+
+  for (int64_t start = 0 ; start < count ; start += SLAS_ECHOGRAM_BATCH)
+    {
+      if (echo->abort) return (0);
+
+      int32_t status = echogram_build_columns (echo, first + start, std::min ((int64_t) SLAS_ECHOGRAM_BATCH, count - start), batch);
+      if (status < 0) return (status);
+
+      tiles.insert (tiles.end (), batch.begin (), batch.end ());
+    }
+
+
+  //  Reduce level by level, storing each level on the way up (the viewer is probably zooming in to them).
+
+  int64_t ntiles = tiles.size () / tile_bytes;
+
+  for (int32_t l = 0 ; ; l++)
+    {
+      int64_t base = index << (level - l);
+
+      for (int64_t i = 0 ; i < ntiles ; i++) echogram_store (echo, l, base + i, &tiles[i * tile_bytes]);
+
+      if (l == level) break;
+
+
+      int64_t nparents = (ntiles + 1) / 2;
+      std::vector<uint8_t> parents ((size_t) nparents * tile_bytes, 0);
+
+      for (int64_t i = 0 ; i < ntiles ; i++) echogram_reduce (echo, &tiles[i * tile_bytes], &parents[(i / 2) * tile_bytes], i % 2);
+
+      tiles.swap (parents);
+      ntiles = nparents;
+    }
+
+  return (0);
+}
+
+
+
+static void echogram_serve_requests (SLAS_ECHOGRAM *echo)
+{
+  while (!echo->abort)
+    {
+      uint64_t key;
+
+      {
+        std::lock_guard<std::mutex> lock (echo->mutex);
+
+        if (echo->requests.empty ()) return;
+
+        key = echo->requests.front ();
+        echo->requests.pop_front ();
+
+        if (echo->tiles.count (key)) continue;
+      }
+
+      echogram_rebuild (echo, (int32_t) (key >> 56), (int64_t) (key & 0x00ffffffffffffffULL));
+    }
+}
+
+
+
+//  Sort the columns by GPS time.  The point records are read sequentially (through the LAZ chunk cache for LAZ files).
+
+static int32_t echogram_time_order (SLAS_ECHOGRAM *echo)
+{
+  std::vector<double> gps_time (echo->columns);
+  SLAS_POINT_DATA record;
+
+
+  if (echo->header.compressed || slaz_is_laz (echo->las_name.c_str ()))
+    {
+      SLAZ_HANDLE *laz = slaz_open (echo->las_name.c_str ());
+
+      if (!laz) return (-1);
+
+      for (int64_t i = 0 ; i < echo->columns && !echo->abort ; i++)
+        {
+          if (slaz_read_point_data (laz, i, &record) < 0)
+            {
+              slaz_close (laz);
+              return (-1);
+            }
+
+          gps_time[i] = record.gps_time;
+        }
+
+      slaz_close (laz);
+    }
+  else
+    {
+      FILE *fp;
+
+      if ((fp = fopen64 (echo->las_name.c_str (), "rb")) == NULL)
+        {
+          fprintf (stderr, "Error opening %s : %s\nFunction: %s, Line: %d\n", echo->las_name.c_str (), strerror (errno), __FUNCTION__, __LINE__);
+          fflush (stderr);
+          return (-1);
+        }
+
+      fseeko64 (fp, (off64_t) echo->header.offset_to_point_data, SEEK_SET);
+
+      size_t length = echo->header.point_data_record_length;
+      std::vector<uint8_t> buffer ((size_t) SLAS_ECHOGRAM_BATCH * length);
+
+      for (int64_t i = 0 ; i < echo->columns && !echo->abort ; i += SLAS_ECHOGRAM_BATCH)
+        {
+          size_t count = (size_t) std::min ((int64_t) SLAS_ECHOGRAM_BATCH, echo->columns - i);
+
+          if (fread (buffer.data (), length, count, fp) != count)
+            {
+              fprintf (stderr, "Error reading %s point records\nFunction: %s, Line: %d\n", echo->las_name.c_str (), __FUNCTION__, __LINE__);
+              fflush (stderr);
+              fclose (fp);
+              return (-1);
+            }
+
+          for (size_t j = 0 ; j < count ; j++)
+            {
+              slas_decode_point_data (&buffer[j * length], &echo->header, echo->swap, SLAS_FIELD_GPS_TIME, &record);
+              gps_time[i + j] = record.gps_time;
+            }
+        }
+
+      fclose (fp);
+    }
+
+
+  echo->column_record.resize (echo->columns);
+  for (int64_t i = 0 ; i < echo->columns ; i++) echo->column_record[i] = i;
+
+  std::stable_sort (echo->column_record.begin (), echo->column_record.end (),
+                    [&gps_time] (uint64_t a, uint64_t b) {return (gps_time[a] < gps_time[b]);});
+
+  echo->record_column.resize (echo->columns);
+  for (int64_t i = 0 ; i < echo->columns ; i++) echo->record_column[echo->column_record[i]] = i;
+
+  return (0);
+}
+
+
+
+//  The streaming pass.  Level 0 tiles are built a batch at a time and each one is reduced into its parent's pending tile
+//  (one per level).  A parent is stored as soon as its right child (or the last tile of the level) has been added.
+//  Requests for dropped tiles are handled between batches and, after the pass, until the echogram is closed.
+
+static void echogram_main (SLAS_ECHOGRAM *echo)
+{
+  if (echo->order == SLAS_ECHOGRAM_TIME_ORDER && echogram_time_order (echo) < 0)
+    {
+      echo->status = -1;
+      echo->done = 1;
+      return;
+    }
+
+  echo->ordered = 1;
+
+
+  size_t tile_bytes = echogram_tile_bytes (echo);
+  std::vector<std::vector<uint8_t> > pending (echo->levels);
+  std::vector<uint8_t> tiles;
+
+  for (int64_t first = 0 ; first < echo->columns && !echo->abort ; first += SLAS_ECHOGRAM_BATCH)
+    {
+      echogram_serve_requests (echo);
+
+      int32_t status = echogram_build_columns (echo, first, std::min ((int64_t) SLAS_ECHOGRAM_BATCH, echo->columns - first), tiles);
+
+      if (status < 0)
+        {
+          echo->status = status;
+          break;
+        }
+
+
+      int64_t ntiles = tiles.size () / tile_bytes;
+
+      for (int64_t i = 0 ; i < ntiles ; i++)
+        {
+          const uint8_t *data = &tiles[i * tile_bytes];
+          int64_t index = first / SLAS_ECHOGRAM_TILE_COLUMNS + i;
+
+          for (int32_t level = 0 ; ; level++)
+            {
+              echogram_store (echo, level, index, data);
+
+              if (level == echo->levels - 1) break;
+
+              std::vector<uint8_t> &parent = pending[level + 1];
+
+              if (!(index % 2)) parent.assign (tile_bytes, 0);
+
+              echogram_reduce (echo, data, parent.data (), index % 2);
+
+              if (!(index % 2) && index != slas_echogram_tile_count (echo, level) - 1) break;
+
+              data = parent.data ();
+              index /= 2;
+            }
+        }
+
+      echo->built = std::min (first + SLAS_ECHOGRAM_BATCH, echo->columns);
+    }
+
+  echo->done = 1;
+
+
+  while (!echo->abort)
+    {
+      {
+        std::unique_lock<std::mutex> lock (echo->mutex);
+        echo->wake.wait (lock, [echo] {return (echo->abort || !echo->requests.empty ());});
+      }
+
+      echogram_serve_requests (echo);
+    }
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_echogram_open
+
+ - Purpose:     Start building the echogram (waterfall) tile pyramid for a LAS file.  The
+                waveforms are read and the tiles are built in the background.  Use
+                slas_echogram_tile to get tiles as they become available.
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - las_name       =    The LAS or LAZ file name
+                - lasheader      =    The SLAS_HEADER retrieved from the LAS file
+                - swap           =    Flag that indicates that the system is big endian and
+                                      therefor we need to byte swap the records
+                - order          =    SLAS_ECHOGRAM_RECORD_ORDER or SLAS_ECHOGRAM_TIME_ORDER
+                - memory         =    Megabytes of tiles to keep (0 for
+                                      SLAS_ECHOGRAM_DEFAULT_MEMORY)
+
+ - Returns:     SLAS_ECHOGRAM *  =    The echogram (free it with slas_echogram_close) or NULL
+                                      if the file has no waveforms or on error
+
+*********************************************************************************************/
+
+SLAS_ECHOGRAM *slas_echogram_open (const char *las_name, SLAS_HEADER *lasheader, uint8_t swap, int32_t order, int32_t memory)
+{
+  //  The tile height comes from the longest waveform of all of the descriptors.
+
+  uint32_t samples = 0;
+
+  for (int32_t i = 1 ; i < 256 ; i++) samples = std::max (samples, lasheader->wf_packet_desc[i].number_of_samples);
+
+  if (!samples || !lasheader->extended_number_of_point_records) return (NULL);
+
+
+  SLAS_ECHOGRAM *echo;
+
+  try
+    {
+      echo = new SLAS_ECHOGRAM;
+    }
+  catch (std::bad_alloc&)
+    {
+      fprintf (stderr, "Error allocating echogram :\nFunction: %s, Line: %d\n", __FUNCTION__, __LINE__);
+      fflush (stderr);
+      return (NULL);
+    }
+
+
+  if (memory <= 0) memory = SLAS_ECHOGRAM_DEFAULT_MEMORY;
+
+  echo->las_name = las_name;
+  echo->header = *lasheader;
+  echo->swap = swap;
+  echo->order = order;
+  echo->columns = lasheader->extended_number_of_point_records;
+  echo->samples = samples;
+  echo->height = std::min (samples, (uint32_t) SLAS_ECHOGRAM_MAX_HEIGHT);
+
+  echo->levels = 1;
+  while (slas_echogram_tile_count (echo, echo->levels - 1) > 1) echo->levels++;
+
+
+  //  Keep everything from the lowest level up that fits in half of the memory.  The rest goes to the LRU cache.
+
+  int64_t limit = (int64_t) memory * 1048576, kept = 0;
+  int64_t tile_bytes = echogram_tile_bytes (echo);
+
+  echo->keep_level = echo->levels;
+
+  for (int32_t level = echo->levels - 1 ; level >= 0 ; level--)
+    {
+      kept += slas_echogram_tile_count (echo, level) * tile_bytes;
+
+      if (kept > limit / 2 && level < echo->levels - 1) break;
+
+      echo->keep_level = level;
+    }
+
+  echo->max_cache_bytes = std::max (limit / 2, 16 * tile_bytes);
+  echo->cache_bytes = 0;
+  echo->clock = 0;
+  echo->ordered = (order != SLAS_ECHOGRAM_TIME_ORDER);
+  echo->built = 0;
+  echo->generation = 0;
+  echo->done = 0;
+  echo->status = 0;
+  echo->abort = 0;
+
+  echo->thread = std::thread (echogram_main, echo);
+
+
+  return (echo);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_echogram_tile
+
+ - Purpose:     Get a tile from the echogram pyramid.  If the tile isn't available it is
+                queued to be built (if it was dropped from the cache) or will show up when the
+                streaming pass gets to it.  Check echo->generation to find out when new tiles
+                have been added.
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - echo           =    The echogram
+                - level          =    Pyramid level (0 is full resolution)
+                - index          =    Tile index within the level
+                - tile           =    Returned tile
+
+ - Returns:     int32_t          =    1 if the tile was returned, 0 if it isn't available yet
+
+*********************************************************************************************/
+
+int32_t slas_echogram_tile (SLAS_ECHOGRAM *echo, int32_t level, int64_t index, SLAS_ECHOGRAM_TILE *tile)
+{
+  if (level < 0 || level >= echo->levels || index < 0 || index >= slas_echogram_tile_count (echo, level)) return (0);
+
+
+  std::lock_guard<std::mutex> lock (echo->mutex);
+
+  uint64_t key = echogram_key (level, index);
+  std::map<uint64_t, SLAS_ECHOGRAM_ENTRY>::iterator it = echo->tiles.find (key);
+
+  if (it != echo->tiles.end ())
+    {
+      it->second.last_used = ++echo->clock;
+      *tile = it->second.tile;
+      return (1);
+    }
+
+
+  //  Tiles that are always kept will be added by the streaming pass.  Anything past the part that has been streamed will
+  //  be too, but the viewer shouldn't have to wait for the whole file to see the part it's looking at.
+
+  if (level >= echo->keep_level && !echo->done) return (0);
+
+  if (std::find (echo->requests.begin (), echo->requests.end (), key) == echo->requests.end ())
+    {
+      echo->requests.push_back (key);
+      echo->wake.notify_one ();
+    }
+
+  return (0);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_echogram_tile_count
+
+ - Purpose:     Get the number of tiles in a pyramid level.
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - echo           =    The echogram
+                - level          =    Pyramid level
+
+ - Returns:     int64_t          =    Number of tiles
+
+*********************************************************************************************/
+
+int64_t slas_echogram_tile_count (SLAS_ECHOGRAM *echo, int32_t level)
+{
+  return ((echo->columns + echogram_span (level) - 1) / echogram_span (level));
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_echogram_column
+
+ - Purpose:     Get the echogram column of a point record.
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - echo           =    The echogram
+                - recnum         =    Record number (records start at 0)
+
+ - Returns:     int64_t          =    The column or -1 if the record isn't in the echogram
+                                      (or the time order hasn't been built yet)
+
+*********************************************************************************************/
+
+int64_t slas_echogram_column (SLAS_ECHOGRAM *echo, uint64_t recnum)
+{
+  if (recnum >= (uint64_t) echo->columns) return (-1);
+
+  if (echo->order != SLAS_ECHOGRAM_TIME_ORDER) return ((int64_t) recnum);
+
+  if (!echo->ordered) return (-1);
+
+  return ((int64_t) echo->record_column[recnum]);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_echogram_record
+
+ - Purpose:     Get the point record in an echogram column.
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - echo           =    The echogram
+                - column         =    The column
+
+ - Returns:     uint64_t         =    The record number (records start at 0)
+
+*********************************************************************************************/
+
+uint64_t slas_echogram_record (SLAS_ECHOGRAM *echo, int64_t column)
+{
+  if (echo->order != SLAS_ECHOGRAM_TIME_ORDER || !echo->ordered || column < 0 || column >= echo->columns) return ((uint64_t) column);
+
+  return (echo->column_record[column]);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_echogram_close
+
+ - Purpose:     Stop building the echogram and free it.
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - echo           =    The echogram (may be NULL)
+
+ - Returns:     void
+
+*********************************************************************************************/
+
+void slas_echogram_close (SLAS_ECHOGRAM *echo)
+{
+  if (!echo) return;
+
+  {
+    std::lock_guard<std::mutex> lock (echo->mutex);
+    echo->abort = 1;
+    echo->wake.notify_one ();
+  }
+
+  if (echo->thread.joinable ()) echo->thread.join ();
+
+  delete echo;
+}
@@ -0,0 +1,134 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! or / / ! are being used by Doxygen to
+    document the software.  Dashes in these comment blocks are used to create bullet lists.
+    The lack of blank lines after a block of dash preceeded comments means that the next
+    block of dash preceeded comments is a new, indented bullet list.  I've tried to keep the
+    Doxygen formatting to a minimum but there are some other items (like <br> and <pre>)
+    that need to be left alone.  If you see a comment that starts with / * ! or / / ! and
+    there is something that looks a bit weird it is probably due to some arcane Doxygen
+    syntax.  Be very careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+/*  Echogram (waterfall) tile pyramid definitions.  */
+
+#ifndef __SLAS_ECHOGRAM_HPP__
+#define __SLAS_ECHOGRAM_HPP__
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <sys/types.h>
+
+#include <string>
+#include <vector>
+#include <map>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <thread>
+#include <algorithm>
+
+#include "slas.hpp"
+#include "slas_batch.hpp"
+#include "slaz.hpp"
+
+
+#define SLAS_ECHOGRAM_TILE_COLUMNS     256      //!<  Columns (point records) in a tile at level 0
+#define SLAS_ECHOGRAM_BATCH            65536    //!<  Records read per streaming batch (a multiple of SLAS_ECHOGRAM_TILE_COLUMNS)
+#define SLAS_ECHOGRAM_MAX_HEIGHT       1024     //!<  Rows in a tile (longer waveforms are reduced to this many rows)
+#define SLAS_ECHOGRAM_DEFAULT_MEMORY   256      //!<  Megabytes of tiles
+#define SLAS_ECHOGRAM_RECORD_ORDER     0        //!<  Columns are in point record order
+#define SLAS_ECHOGRAM_TIME_ORDER       1        //!<  Columns are in GPS time order
+
+
+/*!  A tile is height rows of SLAS_ECHOGRAM_TILE_COLUMNS 8 bit intensities (row major, row 0 is the first sample).  Tiles
+     are never modified once they have been built so they can be shared with the viewer without copying.  */
+
+typedef std::shared_ptr<const std::vector<uint8_t> > SLAS_ECHOGRAM_TILE;
+
+
+typedef struct
+{
+  SLAS_ECHOGRAM_TILE          tile;
+  int64_t                     last_used;
+} SLAS_ECHOGRAM_ENTRY;
+
+
+/*!  Echogram of one LAS file.  Each point record's waveform is a column of the image.  Level 0 tiles hold
+     SLAS_ECHOGRAM_TILE_COLUMNS columns and every level above that is half the resolution of the one below it (each column
+     is the maximum of two columns below it) until the whole file fits in one tile.  A background thread streams the
+     waveforms through the batch waveform fetch in SLAS_ECHOGRAM_BATCH record batches and builds the pyramid from the
+     bottom up as it goes.  Tiles at keep_level and above are always kept (they are sized to fit in half of the memory
+     limit).  Tiles below keep_level are kept in an LRU cache and rebuilt from the file when they are asked for again.  A
+     rebuild reads at most SLAS_ECHOGRAM_TILE_COLUMNS << (keep_level - 1) records.  */
+
+typedef struct
+{
+  std::string                 las_name;
+  SLAS_HEADER                 header;
+  uint8_t                     swap;
+  int32_t                     order;          //!<  SLAS_ECHOGRAM_RECORD_ORDER or SLAS_ECHOGRAM_TIME_ORDER
+  int64_t                     columns;        //!<  Number of point records
+  int32_t                     height;         //!<  Rows in a tile
+  uint32_t                    samples;        //!<  Longest waveform (samples), mapped to height rows
+  int32_t                     levels;         //!<  Number of pyramid levels (the top level is one tile)
+  int32_t                     keep_level;
+  int64_t                     max_cache_bytes; //!<  Limit for the tiles below keep_level
+  int64_t                     cache_bytes;
+  int64_t                     clock;          //!<  LRU counter
+  std::vector<uint64_t>       column_record;  //!<  Time order only, the record in each column
+  std::vector<uint64_t>       record_column;  //!<  Time order only, the column of each record
+  std::map<uint64_t, SLAS_ECHOGRAM_ENTRY> tiles;
+  std::deque<uint64_t>        requests;       //!<  Evicted tiles that the viewer asked for
+  std::mutex                  mutex;
+  std::condition_variable     wake;
+  std::atomic<int32_t>        ordered;        //!<  Set when the column order is known (the time order is built in the background)
+  std::atomic<int64_t>        built;          //!<  Columns streamed so far
+  std::atomic<int32_t>        generation;     //!<  Incremented every time tiles are added
+  std::atomic<int32_t>        done;           //!<  Set when the streaming pass has finished
+  std::atomic<int32_t>        status;         //!<  Negative if the streaming pass failed
+  std::atomic<int32_t>        abort;
+  std::thread                 thread;
+} SLAS_ECHOGRAM;
+
+
+SLAS_ECHOGRAM *slas_echogram_open (const char *las_name, SLAS_HEADER *lasheader, uint8_t swap, int32_t order, int32_t memory);
+int32_t slas_echogram_tile (SLAS_ECHOGRAM *echo, int32_t level, int64_t index, SLAS_ECHOGRAM_TILE *tile);
+int64_t slas_echogram_tile_count (SLAS_ECHOGRAM *echo, int32_t level);
+int64_t slas_echogram_column (SLAS_ECHOGRAM *echo, uint64_t recnum);
+uint64_t slas_echogram_record (SLAS_ECHOGRAM *echo, int64_t column);
+void slas_echogram_close (SLAS_ECHOGRAM *echo);
+
+
+#endif
@@ -0,0 +1,422 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! or / / ! are being used by Doxygen to
+    document the software.  Dashes in these comment blocks are used to create bullet lists.
+    The lack of blank lines after a block of dash preceeded comments means that the next
+    block of dash preceeded comments is a new, indented bullet list.  I've tried to keep the
+    Doxygen formatting to a minimum but there are some other items (like <br> and <pre>)
+    that need to be left alone.  If you see a comment that starts with / * ! or / / ! and
+    there is something that looks a bit weird it is probably due to some arcane Doxygen
+    syntax.  Be very careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+#include "slas_metrics.hpp"
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+#ifdef __linux__
+#include <dirent.h>
+#endif
+
+#include <new>
+#include <vector>
+#include <mutex>
+#include <algorithm>
+
+
+std::atomic<uint8_t> slas_metrics_on (0);
+
+
+//  Upper bounds (in seconds) of the record to pixel latency histogram buckets.
+
+static const double latency_bounds[SLAS_METRICS_LATENCY_BUCKETS] = {0.001, 0.002, 0.005, 0.01, 0.02, 0.05, 0.1, 0.2, 0.5, 1.0,
+                                                                      2.0, 5.0};
+
+
+//  One thread's counters.  Only that thread writes them so relaxed adds are all we need.  They're cache line aligned so
+//  two threads never write the same line.
+
+typedef struct alignas (64)
+{
+  std::atomic<uint64_t>       counter[SLAS_METRIC_COUNT];
+  std::atomic<uint64_t>       latency[SLAS_METRICS_LATENCY_BUCKETS + 1];
+  std::atomic<uint64_t>       latency_sum;                   //  Microseconds
+} METRICS_SHARD;
+
+
+//  The list of blocks is only locked when a thread adds its block, when a thread exits, and when the totals are read.
+//  These are never freed so threads that are still running when the program exits can't use them after they're gone.
+
+static std::mutex *shard_mutex = new std::mutex;
+static std::vector<METRICS_SHARD *> *shards = new std::vector<METRICS_SHARD *>;
+static SLAS_METRICS_TOTALS *retired = new SLAS_METRICS_TOTALS ();   //  Totals of the threads that have exited
+
+
+static void metrics_add_shard (SLAS_METRICS_TOTALS *totals, const METRICS_SHARD *shard)
+{
+  for (int32_t i = 0 ; i < SLAS_METRIC_COUNT ; i++) totals->counter[i] += shard->counter[i].load (std::memory_order_relaxed);
+
+  for (int32_t i = 0 ; i <= SLAS_METRICS_LATENCY_BUCKETS ; i++)
+    {
+      uint64_t count = shard->latency[i].load (std::memory_order_relaxed);
+
+      totals->latency[i] += count;
+      totals->latency_count += count;
+    }
+
+  totals->latency_sum += shard->latency_sum.load (std::memory_order_relaxed) / 1000000.0;
+}
+
+
+//  Each thread's block is made the first time it counts something.  When the thread exits its counts are moved to the
+//  retired totals and the block is freed.
+
+class METRICS_THREAD
+{
+public:
+
+  METRICS_SHARD               *shard;
+
+  METRICS_THREAD () {shard = NULL;}
+
+  ~METRICS_THREAD ()
+  {
+    if (shard == NULL) return;
+
+    std::lock_guard<std::mutex> lock (*shard_mutex);
+
+    metrics_add_shard (retired, shard);
+    shards->erase (std::remove (shards->begin (), shards->end (), shard), shards->end ());
+
+    shard->~METRICS_SHARD ();
+
+#ifdef _WIN32
+    _aligned_free (shard);
+#else
+    free (shard);
+#endif
+  }
+};
+
+static thread_local METRICS_THREAD metrics_thread;
+
+
+static METRICS_SHARD *metrics_shard ()
+{
+  if (metrics_thread.shard == NULL)
+    {
+      void *memory;
+
+#ifdef _WIN32
+      if ((memory = _aligned_malloc (sizeof (METRICS_SHARD), 64)) == NULL) return (NULL);
+#else
+      if (posix_memalign (&memory, 64, sizeof (METRICS_SHARD))) return (NULL);
+#endif
+
+      METRICS_SHARD *shard = new (memory) METRICS_SHARD;
+
+      for (int32_t i = 0 ; i < SLAS_METRIC_COUNT ; i++) shard->counter[i].store (0, std::memory_order_relaxed);
+      for (int32_t i = 0 ; i <= SLAS_METRICS_LATENCY_BUCKETS ; i++) shard->latency[i].store (0, std::memory_order_relaxed);
+      shard->latency_sum.store (0, std::memory_order_relaxed);
+
+      std::lock_guard<std::mutex> lock (*shard_mutex);
+
+      shards->push_back (shard);
+      metrics_thread.shard = shard;
+    }
+
+  return (metrics_thread.shard);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_metrics_enable
+
+ - Purpose:     Turn the metrics counters on.  Call this before starting any threads
+                that should be counted (counts made before this are lost).
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:   N/A
+
+ - Returns:     void
+
+*********************************************************************************************/
+
+void slas_metrics_enable ()
+{
+  slas_metrics_on.store (1);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_metrics_count
+
+ - Purpose:     Add to a counter in this thread's block.  Use slas_metrics_add which
+                doesn't call this when the metrics are off.
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - metric         =    SLAS_METRIC_...
+                - n              =    Amount to add
+
+ - Returns:     void
+
+*********************************************************************************************/
+
+void slas_metrics_count (int32_t metric, uint64_t n)
+{
+  METRICS_SHARD *shard;
+
+  if (metric < 0 || metric >= SLAS_METRIC_COUNT || (shard = metrics_shard ()) == NULL) return;
+
+  shard->counter[metric].fetch_add (n, std::memory_order_relaxed);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_metrics_observe
+
+ - Purpose:     Add a record to pixel latency to this thread's histogram.  Use
+                slas_metrics_latency which doesn't call this when the metrics are off.
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - seconds        =    The latency
+
+ - Returns:     void
+
+*********************************************************************************************/
+
+void slas_metrics_observe (double seconds)
+{
+  METRICS_SHARD *shard = metrics_shard ();
+  int32_t bucket = 0;
+
+
+  if (shard == NULL) return;
+
+  while (bucket < SLAS_METRICS_LATENCY_BUCKETS && seconds > latency_bounds[bucket]) bucket++;
+
+  shard->latency[bucket].fetch_add (1, std::memory_order_relaxed);
+  shard->latency_sum.fetch_add ((uint64_t) (std::max (seconds, 0.0) * 1000000.0 + 0.5), std::memory_order_relaxed);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_metrics_totals
+
+ - Purpose:     Add up the counters and latency histograms of all of the threads.
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - totals         =    The returned totals
+
+ - Returns:     void
+
+*********************************************************************************************/
+
+void slas_metrics_totals (SLAS_METRICS_TOTALS *totals)
+{
+  std::lock_guard<std::mutex> lock (*shard_mutex);
+
+
+  *totals = *retired;
+
+  for (size_t i = 0 ; i < shards->size () ; i++) metrics_add_shard (totals, (*shards)[i]);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_metrics_bucket_bound
+
+ - Purpose:     Get the upper bound of a latency histogram bucket.
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - bucket         =    0 to SLAS_METRICS_LATENCY_BUCKETS - 1
+
+ - Returns:     double           =    Seconds
+
+*********************************************************************************************/
+
+double slas_metrics_bucket_bound (int32_t bucket)
+{
+  return (latency_bounds[std::min (std::max (bucket, 0), SLAS_METRICS_LATENCY_BUCKETS - 1)]);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_metrics_percentile
+
+ - Purpose:     Estimate a latency percentile from the histogram (interpolating
+                linearly inside the bucket it falls in).
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - totals         =    Totals from slas_metrics_totals
+                - fraction       =    0.95 for the 95th percentile, etc.
+
+ - Returns:     double           =    Seconds (0 if there's nothing in the histogram,
+                                      the largest bucket bound if it's past that)
+
+*********************************************************************************************/
+
+double slas_metrics_percentile (const SLAS_METRICS_TOTALS *totals, double fraction)
+{
+  if (!totals->latency_count) return (0.0);
+
+
+  double rank = fraction * totals->latency_count;
+  uint64_t below = 0;
+
+  for (int32_t i = 0 ; i < SLAS_METRICS_LATENCY_BUCKETS ; i++)
+    {
+      if (totals->latency[i] && below + totals->latency[i] >= rank)
+        {
+          double low = i ? latency_bounds[i - 1] : 0.0;
+
+          return (low + (latency_bounds[i] - low) * (rank - below) / totals->latency[i]);
+        }
+
+      below += totals->latency[i];
+    }
+
+
+  return (latency_bounds[SLAS_METRICS_LATENCY_BUCKETS - 1]);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_metrics_process
+
+ - Purpose:     Get the resident memory size and number of open files of this process
+                (from /proc on Linux).
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - resident_bytes =    Returned resident set size in bytes
+                - open_files     =    Returned number of open file descriptors
+
+ - Returns:     int32_t          =    0 on success, -1 if they aren't available
+
+*********************************************************************************************/
+
+int32_t slas_metrics_process (int64_t *resident_bytes, int32_t *open_files)
+{
+  *resident_bytes = 0;
+  *open_files = 0;
+
+#ifdef __linux__
+
+  FILE *fp = fopen ("/proc/self/statm", "r");
+  long long size, resident;
+
+  if (fp == NULL) return (-1);
+
+  if (fscanf (fp, "%lld %lld", &size, &resident) != 2)
+    {
+      fclose (fp);
+      return (-1);
+    }
+
+  fclose (fp);
+
+  *resident_bytes = (int64_t) resident * sysconf (_SC_PAGESIZE);
+
+
+  DIR *dir = opendir ("/proc/self/fd");
+  struct dirent *entry;
+
+  if (dir == NULL) return (-1);
+
+  while ((entry = readdir (dir)) != NULL)
+    {
+      if (entry->d_name[0] != '.') (*open_files)++;
+    }
+
+  closedir (dir);
+
+
+  //  Don't count the one we used to read the directory.
+
+  (*open_files)--;
+
+  return (0);
+
+#else
+
+  return (-1);
+
+#endif
+}
@@ -0,0 +1,108 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! or / / ! are being used by Doxygen to
+    document the software.  Dashes in these comment blocks are used to create bullet lists.
+    The lack of blank lines after a block of dash preceeded comments means that the next
+    block of dash preceeded comments is a new, indented bullet list.  I've tried to keep the
+    Doxygen formatting to a minimum but there are some other items (like <br> and <pre>)
+    that need to be left alone.  If you see a comment that starts with / * ! or / / ! and
+    there is something that looks a bit weird it is probably due to some arcane Doxygen
+    syntax.  Be very careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+/*  Process metrics definitions.  */
+
+#ifndef __SLAS_METRICS_HPP__
+#define __SLAS_METRICS_HPP__
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <sys/types.h>
+
+#include <atomic>
+
+
+/*!  Counters for the metrics endpoint (LASwaveMonitor --metrics).  They're off unless slas_metrics_enable is called, in
+     which case slas_metrics_add is just a relaxed load and a branch.  When they're on each thread adds to its own block
+     of counters (no locks, no shared cache lines) and slas_metrics_totals adds up the blocks of all of the threads (and of
+     the threads that have finished) when somebody asks for them.  */
+
+#define SLAS_METRIC_RECORDS_DISPLAYED     0        //!<  New point records that were drawn
+#define SLAS_METRIC_RECORDS_SKIPPED       1        //!<  Records the cursor passed over (from the record ring) that weren't drawn
+#define SLAS_METRIC_RING_OVERFLOWS        2        //!<  Record changes lost because the record ring overflowed
+#define SLAS_METRIC_CACHE_HITS            3        //!<  Shared waveform cache lookups by this process
+#define SLAS_METRIC_CACHE_MISSES          4
+#define SLAS_METRIC_LAZ_HITS              5        //!<  LAZ chunk cache
+#define SLAS_METRIC_LAZ_MISSES            6
+#define SLAS_METRIC_POINT_BYTES           7        //!<  Bytes of point records read
+#define SLAS_METRIC_WAVE_BYTES            8        //!<  Bytes of waveform packets (or compressed blocks) read
+#define SLAS_METRIC_OPEN_FAILURES         9
+#define SLAS_METRIC_COUNT                 10
+
+#define SLAS_METRICS_LATENCY_BUCKETS      12       //!<  Latency histogram buckets (plus one for anything longer)
+
+
+typedef struct
+{
+  uint64_t            counter[SLAS_METRIC_COUNT];
+  uint64_t            latency[SLAS_METRICS_LATENCY_BUCKETS + 1];   //!<  Count in each bucket (not cumulative)
+  uint64_t            latency_count;
+  double              latency_sum;                                 //!<  Seconds
+} SLAS_METRICS_TOTALS;
+
+
+extern std::atomic<uint8_t> slas_metrics_on;
+
+
+void slas_metrics_enable ();
+void slas_metrics_count (int32_t metric, uint64_t n);
+void slas_metrics_observe (double seconds);
+void slas_metrics_totals (SLAS_METRICS_TOTALS *totals);
+double slas_metrics_bucket_bound (int32_t bucket);
+double slas_metrics_percentile (const SLAS_METRICS_TOTALS *totals, double fraction);
+int32_t slas_metrics_process (int64_t *resident_bytes, int32_t *open_files);
+
+
+//!  Add n to a counter (if the metrics are on).
+
+inline void slas_metrics_add (int32_t metric, uint64_t n)
+{
+  if (slas_metrics_on.load (std::memory_order_relaxed)) slas_metrics_count (metric, n);
+}
+
+
+//!  Add a record to pixel latency (in seconds) to the histogram (if the metrics are on).
+
+inline void slas_metrics_latency (double seconds)
+{
+  if (slas_metrics_on.load (std::memory_order_relaxed)) slas_metrics_observe (seconds);
+}
+
+
+#endif
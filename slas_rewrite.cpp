@@ -0,0 +1,691 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! or / / ! are being used by Doxygen to
+    document the software.  Dashes in these comment blocks are used to create bullet lists.
+    The lack of blank lines after a block of dash preceeded comments means that the next
+    block of dash preceeded comments is a new, indented bullet list.  I've tried to keep the
+    Doxygen formatting to a minimum but there are some other items (like <br> and <pre>)
+    that need to be left alone.  If you see a comment that starts with / * ! or / / ! and
+    there is something that looks a bit weird it is probably due to some arcane Doxygen
+    syntax.  Be very careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+#include <stddef.h>
+
+#include <vector>
+#include <deque>
+#include <queue>
+#include <algorithm>
+#include <unordered_map>
+
+#include "slas_rewrite.hpp"
+#include "nvutility.hpp"
+
+
+#define REWRITE_POINT_CHUNK       65536     //  Point records read or written at a time
+
+
+//  Pass 1 record.  One for every point record that has a waveform.
+
+typedef struct
+{
+  uint64_t                    key;           //  Output order (the record number or the Hilbert index)
+  uint64_t                    recnum;
+  uint64_t                    offset;        //  Input byte_offset_to_waveform_data
+  uint32_t                    size;
+  int32_t                     x;
+  int32_t                     y;
+} REWRITE_PACKET;
+
+
+//  Pass 2 record.  The new byte_offset_to_waveform_data for a point record.
+
+typedef struct
+{
+  uint64_t                    recnum;
+  uint64_t                    offset;
+} REWRITE_MAP;
+
+
+//  A packet to be copied from the input waveform file to the output waveform file.
+
+typedef struct
+{
+  uint64_t                    in_offset;
+  uint64_t                    out_offset;
+  uint32_t                    size;
+} REWRITE_COPY;
+
+
+typedef struct
+{
+  uint64_t                    out_offset;
+  uint32_t                    size;
+} REWRITE_SEEN;
+
+
+
+//  Hilbert curve index of a point on a 65536 by 65536 grid.
+
+static uint64_t rewrite_hilbert (uint32_t x, uint32_t y)
+{
+  const uint32_t n = 65536;
+  uint64_t d = 0;
+
+
+  for (uint32_t s = n / 2 ; s > 0 ; s /= 2)
+    {
+      uint32_t rx = (x & s) > 0;
+      uint32_t ry = (y & s) > 0;
+
+      d += (uint64_t) s * s * ((3 * rx) ^ ry);
+
+      if (!ry)
+        {
+          if (rx)
+            {
+              x = n - 1 - x;
+              y = n - 1 - y;
+            }
+
+          std::swap (x, y);
+        }
+    }
+
+
+  return (d);
+}
+
+
+
+//  External merge sort of fixed size records from in to out.  Runs of max_records are sorted in memory and written to
+//  temporary files, then the runs are merged.  Both files are rewound.
+
+template <typename T, typename CMP> static int32_t rewrite_sort (FILE *in, FILE *out, size_t max_records, CMP cmp)
+{
+  std::vector<FILE *> runs;
+  std::vector<T> buffer;
+  int32_t status = 0;
+
+
+  rewind (in);
+
+  while (!status)
+    {
+      buffer.resize (max_records);
+
+      size_t n = fread (buffer.data (), sizeof (T), max_records, in);
+
+      if (!n) break;
+
+      buffer.resize (n);
+      std::sort (buffer.begin (), buffer.end (), cmp);
+
+      FILE *run = tmpfile ();
+
+      if (run == NULL || fwrite (buffer.data (), sizeof (T), n, run) != n)
+        {
+          fprintf (stderr, "Error writing sort run :\n%s\nFunction: %s, Line: %d\n", strerror (errno), __FUNCTION__, __LINE__);
+          fflush (stderr);
+          if (run) fclose (run);
+          status = -1;
+          break;
+        }
+
+      rewind (run);
+      runs.push_back (run);
+    }
+
+  std::vector<T> ().swap (buffer);
+
+
+  //  Merge the runs.
+
+  typedef std::pair<T, size_t> ITEM;
+  auto greater = [&cmp] (const ITEM &a, const ITEM &b) {return cmp (b.first, a.first);};
+  std::priority_queue<ITEM, std::vector<ITEM>, decltype (greater)> heap (greater);
+
+  if (!status)
+    {
+      for (size_t i = 0 ; i < runs.size () ; i++)
+        {
+          T rec;
+          if (fread (&rec, sizeof (T), 1, runs[i])) heap.push (ITEM (rec, i));
+        }
+
+      rewind (out);
+
+      while (!heap.empty ())
+        {
+          ITEM item = heap.top ();
+          heap.pop ();
+
+          if (!fwrite (&item.first, sizeof (T), 1, out))
+            {
+              fprintf (stderr, "Error writing sorted records :\n%s\nFunction: %s, Line: %d\n", strerror (errno), __FUNCTION__, __LINE__);
+              fflush (stderr);
+              status = -2;
+              break;
+            }
+
+          if (fread (&item.first, sizeof (T), 1, runs[item.second])) heap.push (item);
+        }
+
+      fflush (out);
+      rewind (out);
+    }
+
+
+  for (size_t i = 0 ; i < runs.size () ; i++) fclose (runs[i]);
+
+
+  return (status);
+}
+
+
+
+//  Copy a group of packets.  The output offsets in the group are contiguous (in group order) so the packets are read in
+//  input file order (to keep the input reads as sequential as we can) into one buffer and written with a single write.
+
+static int32_t rewrite_copy (FILE *in_wfp, FILE *out_wfp, std::vector<REWRITE_COPY> &group, std::vector<uint8_t> &buffer)
+{
+  if (group.empty ()) return (0);
+
+
+  uint64_t base = group[0].out_offset;
+  uint64_t size = group.back ().out_offset + group.back ().size - base;
+
+  buffer.resize (size);
+
+
+  std::vector<size_t> order (group.size ());
+  for (size_t i = 0 ; i < order.size () ; i++) order[i] = i;
+
+  std::sort (order.begin (), order.end (), [&group] (size_t a, size_t b) {return group[a].in_offset < group[b].in_offset;});
+
+
+  for (size_t i = 0 ; i < order.size () ; i++)
+    {
+      REWRITE_COPY *copy = &group[order[i]];
+
+      if (fseeko64 (in_wfp, copy->in_offset, SEEK_SET) < 0 || !fread (&buffer[copy->out_offset - base], copy->size, 1, in_wfp))
+        {
+          fprintf (stderr, "Error reading waveform packet at %" PRIu64 " :\n%s\nFunction: %s, Line: %d\n", copy->in_offset, strerror (errno),
+                   __FUNCTION__, __LINE__);
+          fflush (stderr);
+          return (-1);
+        }
+    }
+
+
+  if (fseeko64 (out_wfp, base, SEEK_SET) < 0 || !fwrite (buffer.data (), size, 1, out_wfp))
+    {
+      fprintf (stderr, "Error writing waveform packets :\n%s\nFunction: %s, Line: %d\n", strerror (errno), __FUNCTION__, __LINE__);
+      fflush (stderr);
+      return (-2);
+    }
+
+
+  group.clear ();
+
+
+  return (0);
+}
+
+
+
+//  Copy len bytes from in (at in_addr) to out (at its current position).
+
+static int32_t rewrite_copy_bytes (FILE *in, int64_t in_addr, int64_t len, FILE *out)
+{
+  std::vector<uint8_t> buffer (1048576);
+
+
+  if (fseeko64 (in, in_addr, SEEK_SET) < 0) return (-1);
+
+  while (len > 0)
+    {
+      size_t n = (size_t) std::min ((int64_t) buffer.size (), len);
+
+      if (!fread (buffer.data (), n, 1, in) || !fwrite (buffer.data (), n, 1, out)) return (-1);
+
+      len -= n;
+    }
+
+
+  return (0);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_rewrite
+
+ - Purpose:     Rewrite a LAS file and its external waveform (.wdp) file so that the waveform
+                packets are stored in the order that they will be read.  With
+                SLAS_REWRITE_POINT_ORDER the packets are written in point record order, with
+                SLAS_REWRITE_HILBERT_ORDER they are written in Hilbert curve order of the point
+                positions (so spatially close waveforms are close in the file).  Packets that
+                are shared by more than one point record (or are duplicated within the last
+                SLAS_REWRITE_DEDUP_WINDOW packets) are only written once, and packets that no
+                point record uses are dropped.  The point records stay in the same order (so
+                PFM record numbers are still valid), only their byte_offset_to_waveform_data
+                is changed.  Everything else in the LAS file is copied as is.
+                <br><br>
+                This is done in three streaming passes (point records to packet list, packet
+                copy, and point records with new offsets) with external sorts in between so
+                memory use is bounded by the memory argument, not the size of the files.
+                <br><br>
+                LAZ files and files with internal waveforms are not supported.
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - in_name        =    The input LAS file name
+                - out_name       =    The output LAS file name (the output .wdp file name is
+                                      built from this)
+                - swap           =    Flag that indicates that the system is big endian and
+                                      therefor we need to byte swap the records
+                - order          =    SLAS_REWRITE_POINT_ORDER or SLAS_REWRITE_HILBERT_ORDER
+                - memory         =    Approximate memory limit in megabytes
+
+ - Returns:     int32_t          =    Negative number on error, 0 on success
+
+*********************************************************************************************/
+
+int32_t slas_rewrite (const char *in_name, const char *out_name, uint8_t swap, int32_t order, int64_t memory)
+{
+  FILE           *in_fp = NULL, *in_wfp = NULL, *out_fp = NULL, *out_wfp = NULL, *packet_fp = NULL, *sorted_fp = NULL, *map_fp = NULL,
+                 *map_sorted_fp = NULL;
+  char           in_wave[1024], out_wave[1024];
+  SLAS_HEADER    *header = NULL;
+  int32_t        status = 0;
+
+
+  if (memory <= 0) memory = SLAS_REWRITE_DEFAULT_MEMORY;
+  memory *= 1048576;
+
+
+  slas_wave_file_name (in_name, in_wave);
+  slas_wave_file_name (out_name, out_wave);
+
+  if (!strcmp (in_name, out_name) || !strcmp (in_wave, out_wave))
+    {
+      fprintf (stderr, "The output file can't be the input file\n");
+      return (-1);
+    }
+
+
+  //  SLAS_HEADER is large (the waveform packet descriptors) so we don't put it on the stack.
+
+  header = (SLAS_HEADER *) calloc (1, sizeof (SLAS_HEADER));
+
+  if (header == NULL || (in_fp = fopen64 (in_name, "rb")) == NULL || slas_read_header (in_fp, swap, header) < 0)
+    {
+      fprintf (stderr, "Error opening or reading %s :\n%s\n", in_name, strerror (errno));
+      status = -2;
+      goto done;
+    }
+
+
+  int32_t wave_packet;
+  wave_packet = slas_wave_packet_offset (header->point_data_format);
+
+  if (header->compressed || wave_packet < 0 || !(header->global_encoding & 0x4))
+    {
+      fprintf (stderr, "%s is compressed, has no waveforms, or has internal waveforms\n", in_name);
+      status = -3;
+      goto done;
+    }
+
+
+  if ((in_wfp = fopen64 (in_wave, "rb")) == NULL || (out_fp = fopen64 (out_name, "wb")) == NULL || (out_wfp = fopen64 (out_wave, "wb")) == NULL ||
+      (packet_fp = tmpfile ()) == NULL || (map_fp = tmpfile ()) == NULL)
+    {
+      fprintf (stderr, "Error opening files :\n%s\n", strerror (errno));
+      status = -4;
+      goto done;
+    }
+
+
+  {
+    uint16_t reclen = header->point_data_record_length;
+    uint64_t count = header->extended_number_of_point_records;
+    std::vector<uint8_t> points ((size_t) REWRITE_POINT_CHUNK * reclen);
+    int32_t min_x = INT32_MAX, max_x = INT32_MIN, min_y = INT32_MAX, max_y = INT32_MIN;
+    uint64_t packets = 0;
+
+
+    //  Pass 1 - Read the point records (sequentially) and write a packet record for each one that has a waveform.
+
+    fprintf (stdout, "Pass 1 of 3 - reading point records\n");
+    fflush (stdout);
+
+    if (fseeko64 (in_fp, header->offset_to_point_data, SEEK_SET) < 0) status = -5;
+
+    for (uint64_t start = 0 ; !status && start < count ; start += REWRITE_POINT_CHUNK)
+      {
+        uint64_t n = std::min ((uint64_t) REWRITE_POINT_CHUNK, count - start);
+
+        if (!fread (points.data (), n * reclen, 1, in_fp))
+          {
+            fprintf (stderr, "Error reading point records :\n%s\n", strerror (errno));
+            status = -5;
+            break;
+          }
+
+        for (uint64_t i = 0 ; i < n ; i++)
+          {
+            SLAS_POINT_DATA record;
+            REWRITE_PACKET pkt;
+            uint8_t *data = &points[i * reclen];
+
+            slas_decode_point_data (data, header, swap, SLAS_MASK_WAVEFORM, &record);
+
+            if (!record.wavepacket_descriptor_index || !record.waveform_packet_size) continue;
+
+            memcpy (&pkt.x, &data[0], 4);
+            memcpy (&pkt.y, &data[4], 4);
+
+            if (swap)
+              {
+                swap_int (&pkt.x);
+                swap_int (&pkt.y);
+              }
+
+            min_x = std::min (min_x, pkt.x);
+            max_x = std::max (max_x, pkt.x);
+            min_y = std::min (min_y, pkt.y);
+            max_y = std::max (max_y, pkt.y);
+
+            pkt.recnum = start + i;
+            pkt.key = pkt.recnum;
+            pkt.offset = header->start_of_waveform_data_packet_record + record.byte_offset_to_waveform_data;
+            pkt.size = record.waveform_packet_size;
+
+            if (!fwrite (&pkt, sizeof (REWRITE_PACKET), 1, packet_fp))
+              {
+                fprintf (stderr, "Error writing temporary file :\n%s\n", strerror (errno));
+                status = -6;
+                break;
+              }
+
+            packets++;
+          }
+      }
+
+    if (status) goto done;
+
+
+    //  Put the packets in output order.  In point order they already are.
+
+    size_t max_records = std::max ((int64_t) 1024, memory / (int64_t) (2 * sizeof (REWRITE_PACKET)));
+
+    if (order == SLAS_REWRITE_HILBERT_ORDER && packets)
+      {
+        //  We can't compute the Hilbert index until we know the extents so we do that while making the sort runs.
+
+        double scale_x = 65535.0 / std::max (1.0, (double) max_x - (double) min_x);
+        double scale_y = 65535.0 / std::max (1.0, (double) max_y - (double) min_y);
+
+        FILE *keyed_fp = tmpfile ();
+        std::vector<REWRITE_PACKET> buffer (std::min ((size_t) REWRITE_POINT_CHUNK, max_records));
+
+        rewind (packet_fp);
+
+        size_t n;
+        while (keyed_fp && (n = fread (buffer.data (), sizeof (REWRITE_PACKET), buffer.size (), packet_fp)) > 0)
+          {
+            for (size_t i = 0 ; i < n ; i++)
+              {
+                buffer[i].key = rewrite_hilbert ((uint32_t) (((double) buffer[i].x - min_x) * scale_x), (uint32_t) (((double) buffer[i].y - min_y) * scale_y));
+              }
+
+            if (fwrite (buffer.data (), sizeof (REWRITE_PACKET), n, keyed_fp) != n) break;
+          }
+
+        fclose (packet_fp);
+        packet_fp = keyed_fp;
+
+        if (packet_fp == NULL || (sorted_fp = tmpfile ()) == NULL ||
+            rewrite_sort<REWRITE_PACKET> (packet_fp, sorted_fp, max_records, [] (const REWRITE_PACKET &a, const REWRITE_PACKET &b)
+                                          {return a.key < b.key || (a.key == b.key && a.recnum < b.recnum);}) < 0)
+          {
+            status = -7;
+            goto done;
+          }
+      }
+    else
+      {
+        sorted_fp = packet_fp;
+        packet_fp = NULL;
+        rewind (sorted_fp);
+      }
+
+
+    //  Pass 2 - Copy the packets in output order, skipping duplicates, and write the new offset for each point record.
+
+    fprintf (stdout, "Pass 2 of 3 - copying %" PRIu64 " waveform packets\n", packets);
+    fflush (stdout);
+
+
+    //  Keep the EVLR header at the start of the .wdp file (if it has one) and anything before
+    //  start_of_waveform_data_packet_record (the packet offsets are relative to that).
+
+    uint8_t evlr[60], has_evlr = NVFalse;
+    uint64_t next_out = header->start_of_waveform_data_packet_record;
+
+    if (fread (evlr, 60, 1, in_wfp) && !strncmp ((char *) &evlr[2], "LASF_Spec", 9))
+      {
+        has_evlr = NVTrue;
+        next_out = std::max (next_out, (uint64_t) 60);
+      }
+
+    if (next_out && rewrite_copy_bytes (in_wfp, 0, next_out, out_wfp) < 0)
+      {
+        status = -8;
+        goto done;
+      }
+
+
+    std::unordered_map<uint64_t, REWRITE_SEEN> seen;
+    std::deque<uint64_t> fifo;
+    size_t window = (size_t) std::min ((int64_t) SLAS_REWRITE_DEDUP_WINDOW, std::max ((int64_t) 1024, memory / 256));
+    std::vector<REWRITE_COPY> group;
+    std::vector<uint8_t> copy_buffer;
+    uint64_t group_bytes = 0, group_limit = std::max ((int64_t) 1048576, memory / 4), duplicates = 0;
+    REWRITE_PACKET pkt;
+
+    while (fread (&pkt, sizeof (REWRITE_PACKET), 1, sorted_fp))
+      {
+        REWRITE_MAP map;
+        map.recnum = pkt.recnum;
+
+        std::unordered_map<uint64_t, REWRITE_SEEN>::iterator it = seen.find (pkt.offset);
+
+        if (it != seen.end () && it->second.size == pkt.size)
+          {
+            map.offset = it->second.out_offset;
+            duplicates++;
+          }
+        else
+          {
+            REWRITE_COPY copy;
+            copy.in_offset = pkt.offset;
+            copy.out_offset = next_out;
+            copy.size = pkt.size;
+            group.push_back (copy);
+
+            map.offset = next_out;
+            next_out += pkt.size;
+            group_bytes += pkt.size;
+
+
+            REWRITE_SEEN prev;
+            prev.out_offset = map.offset;
+            prev.size = pkt.size;
+
+            if (it == seen.end ()) fifo.push_back (pkt.offset);
+            seen[pkt.offset] = prev;
+
+            if (fifo.size () > window)
+              {
+                seen.erase (fifo.front ());
+                fifo.pop_front ();
+              }
+          }
+
+        if (!fwrite (&map, sizeof (REWRITE_MAP), 1, map_fp))
+          {
+            status = -8;
+            goto done;
+          }
+
+        if (group_bytes >= group_limit)
+          {
+            if ((status = rewrite_copy (in_wfp, out_wfp, group, copy_buffer)) < 0) goto done;
+            group_bytes = 0;
+          }
+      }
+
+    if ((status = rewrite_copy (in_wfp, out_wfp, group, copy_buffer)) < 0) goto done;
+
+
+    //  Fix the record length in the EVLR header.
+
+    if (has_evlr)
+      {
+        uint64_t length = next_out - 60;
+
+        if (swap) swap_double ((double *) &length);
+
+        fseeko64 (out_wfp, 20, SEEK_SET);
+        fwrite (&length, 8, 1, out_wfp);
+      }
+
+
+    //  Put the new offsets in point record order.
+
+    if (order == SLAS_REWRITE_HILBERT_ORDER && packets)
+      {
+        if ((map_sorted_fp = tmpfile ()) == NULL ||
+            rewrite_sort<REWRITE_MAP> (map_fp, map_sorted_fp, memory / (2 * sizeof (REWRITE_MAP)) + 1024,
+                                       [] (const REWRITE_MAP &a, const REWRITE_MAP &b) {return a.recnum < b.recnum;}) < 0)
+          {
+            status = -9;
+            goto done;
+          }
+      }
+    else
+      {
+        map_sorted_fp = map_fp;
+        map_fp = NULL;
+        rewind (map_sorted_fp);
+      }
+
+
+    //  Pass 3 - Copy the LAS file with the new offsets in the point records.
+
+    fprintf (stdout, "Pass 3 of 3 - writing point records (%" PRIu64 " duplicate packets removed)\n", duplicates);
+    fflush (stdout);
+
+    if (rewrite_copy_bytes (in_fp, 0, header->offset_to_point_data, out_fp) < 0)
+      {
+        status = -10;
+        goto done;
+      }
+
+
+    REWRITE_MAP map;
+    uint8_t have_map = fread (&map, sizeof (REWRITE_MAP), 1, map_sorted_fp);
+
+    if (fseeko64 (in_fp, header->offset_to_point_data, SEEK_SET) < 0) status = -11;
+
+    for (uint64_t start = 0 ; !status && start < count ; start += REWRITE_POINT_CHUNK)
+      {
+        uint64_t n = std::min ((uint64_t) REWRITE_POINT_CHUNK, count - start);
+
+        if (!fread (points.data (), n * reclen, 1, in_fp))
+          {
+            status = -11;
+            break;
+          }
+
+        while (have_map && map.recnum < start + n)
+          {
+            uint64_t offset = map.offset - header->start_of_waveform_data_packet_record;
+
+            if (swap) swap_double ((double *) &offset);
+
+            memcpy (&points[(map.recnum - start) * reclen + wave_packet + 1], &offset, 8);
+
+            have_map = fread (&map, sizeof (REWRITE_MAP), 1, map_sorted_fp);
+          }
+
+        if (!fwrite (points.data (), n * reclen, 1, out_fp))
+          {
+            status = -12;
+            break;
+          }
+      }
+
+    if (status) goto done;
+
+
+    //  Copy anything after the point records (LAS 1.4 EVLRs).
+
+    int64_t end_of_points = header->offset_to_point_data + (int64_t) count * reclen;
+
+    fseeko64 (in_fp, 0, SEEK_END);
+    int64_t in_size = ftello64 (in_fp);
+
+    if (in_size > end_of_points && rewrite_copy_bytes (in_fp, end_of_points, in_size - end_of_points, out_fp) < 0) status = -13;
+  }
+
+
+ done:
+
+  if (status < -4) fprintf (stderr, "Error rewriting %s :\n%s\n", in_name, strerror (errno));
+
+  if (in_fp) fclose (in_fp);
+  if (in_wfp) fclose (in_wfp);
+  if (out_fp) fclose (out_fp);
+  if (out_wfp) fclose (out_wfp);
+  if (packet_fp) fclose (packet_fp);
+  if (sorted_fp) fclose (sorted_fp);
+  if (map_fp) fclose (map_fp);
+  if (map_sorted_fp) fclose (map_sorted_fp);
+  free (header);
+
+
+  return (status);
+}
@@ -0,0 +1,174 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! or / / ! are being used by Doxygen to
+    document the software.  Dashes in these comment blocks are used to create bullet lists.
+    The lack of blank lines after a block of dash preceeded comments means that the next
+    block of dash preceeded comments is a new, indented bullet list.  I've tried to keep the
+    Doxygen formatting to a minimum but there are some other items (like <br> and <pre>)
+    that need to be left alone.  If you see a comment that starts with / * ! or / / ! and
+    there is something that looks a bit weird it is probably due to some arcane Doxygen
+    syntax.  Be very careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+/*  Compact waveform sample storage.  */
+
+#ifndef __SLAS_SAMPLES_HPP__
+#define __SLAS_SAMPLES_HPP__
+
+#include <stdint.h>
+#include <string.h>
+
+#include <vector>
+#include <algorithm>
+
+
+/*!  Waveform samples stored in the narrowest unsigned type that will hold the descriptor's bits_per_sample (uint8_t for
+     1-8 bits, uint16_t for 9-16 bits, uint32_t for 17-32 bits).  Anything that needs speed should get the typed array
+     with ptr8, ptr16, or ptr32 (based on width) or use slas_dispatch_samples, which calls a templated kernel with the
+     right type, rather than going through operator[].  */
+
+class SLAS_SAMPLES
+{
+public:
+
+  SLAS_SAMPLES () : width (1), count (0) {}
+
+
+  static uint8_t widthForBits (int32_t bits_per_sample)
+  {
+    if (bits_per_sample > 16) return (4);
+    if (bits_per_sample > 8) return (2);
+    return (1);
+  }
+
+
+  void resize (uint32_t new_count, int32_t bits_per_sample)
+  {
+    width = widthForBits (bits_per_sample);
+    count = new_count;
+    data.resize ((size_t) count * width);
+  }
+
+
+  void clear ()
+  {
+    count = 0;
+    data.clear ();
+  }
+
+
+  void swap (SLAS_SAMPLES &other)
+  {
+    std::swap (width, other.width);
+    std::swap (count, other.count);
+    data.swap (other.data);
+  }
+
+
+  uint32_t size () const {return (count);}
+
+  uint8_t bytesPerSample () const {return (width);}
+
+  size_t bytes () const {return (data.size ());}
+
+
+  uint32_t operator[] (uint32_t i) const
+  {
+    switch (width)
+      {
+      case 1:
+        return (data[i]);
+
+      case 2:
+        return (((const uint16_t *) data.data ())[i]);
+
+      default:
+        return (((const uint32_t *) data.data ())[i]);
+      }
+  }
+
+
+  void set (uint32_t i, uint32_t value)
+  {
+    switch (width)
+      {
+      case 1:
+        data[i] = (uint8_t) value;
+        break;
+
+      case 2:
+        ((uint16_t *) data.data ())[i] = (uint16_t) value;
+        break;
+
+      default:
+        ((uint32_t *) data.data ())[i] = value;
+        break;
+      }
+  }
+
+
+  uint8_t *ptr8 () {return (data.data ());}
+  uint16_t *ptr16 () {return ((uint16_t *) data.data ());}
+  uint32_t *ptr32 () {return ((uint32_t *) data.data ());}
+  const uint8_t *ptr8 () const {return (data.data ());}
+  const uint16_t *ptr16 () const {return ((const uint16_t *) data.data ());}
+  const uint32_t *ptr32 () const {return ((const uint32_t *) data.data ());}
+
+
+protected:
+
+  uint8_t                     width;
+  uint32_t                    count;
+  std::vector<uint8_t>        data;
+};
+
+
+
+/*!  Call kernel.template run<T> (samples, count) with T set to the storage type of the samples.  This lets a kernel be
+     written once as a template and run on every width without copying the samples to a common type.  */
+
+template <typename KERNEL> inline void slas_dispatch_samples (const SLAS_SAMPLES &samples, KERNEL &kernel)
+{
+  switch (samples.bytesPerSample ())
+    {
+    case 1:
+      kernel.template run<uint8_t> (samples.ptr8 (), samples.size ());
+      break;
+
+    case 2:
+      kernel.template run<uint16_t> (samples.ptr16 (), samples.size ());
+      break;
+
+    default:
+      kernel.template run<uint32_t> (samples.ptr32 (), samples.size ());
+      break;
+    }
+}
+
+
+#endif
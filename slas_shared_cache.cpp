@@ -0,0 +1,614 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! or / / ! are being used by Doxygen to
+    document the software.  Dashes in these comment blocks are used to create bullet lists.
+    The lack of blank lines after a block of dash preceeded comments means that the next
+    block of dash preceeded comments is a new, indented bullet list.  I've tried to keep the
+    Doxygen formatting to a minimum but there are some other items (like <br> and <pre>)
+    that need to be left alone.  If you see a comment that starts with / * ! or / / ! and
+    there is something that looks a bit weird it is probably due to some arcane Doxygen
+    syntax.  Be very careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+#include <stddef.h>
+
+#include <atomic>
+#include <thread>
+#include <chrono>
+
+#include "slas_shared_cache.hpp"
+#include "slas_batch.hpp"
+#include "slas_metrics.hpp"
+#include "nvutility.hpp"
+
+#include <QtCore>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <signal.h>
+#endif
+
+
+#define SHARED_CACHE_MAGIC        0x534c4153u        //  "SLAS"
+#define SHARED_CACHE_VERSION      2
+
+
+//  The slots are shared between processes so the atomics have to be lock free (no hidden process local locks).
+
+static_assert (ATOMIC_INT_LOCK_FREE == 2 && ATOMIC_LLONG_LOCK_FREE == 2, "The shared waveform cache needs lock free atomics");
+
+
+struct SLAS_SHARED_CACHE_HEADER
+{
+  std::atomic<uint32_t>       magic;                 //  Set last by the process that creates the segment
+  uint32_t                    version;
+  uint32_t                    number_of_sets;
+  uint32_t                    slot_bytes;
+  std::atomic<uint64_t>       hits;
+  std::atomic<uint64_t>       misses;
+  std::atomic<uint32_t>       hand[1];               //  Clock hand for each set (number_of_sets of them)
+};
+
+
+struct SLAS_SHARED_CACHE_SLOT
+{
+  std::atomic<uint64_t>       seq;                   //  Sequence number (low 32 bits, odd while a writer is filling the slot)
+                                                     //  and process id of the writer (high 32 bits)
+  std::atomic<uint32_t>       referenced;            //  Clock bit
+  std::atomic<int64_t>        claimed;               //  When the writer claimed the slot (milliseconds since the epoch)
+  uint64_t                    file_id;
+  uint64_t                    recnum;
+  uint32_t                    count;
+  uint8_t                     width;
+  uint8_t                     valid;
+  uint8_t                     pad[2];
+  uint8_t                     data[SLAS_SHARED_CACHE_SLOT_BYTES];
+};
+
+
+
+static int64_t shared_cache_now ()
+{
+  return (std::chrono::duration_cast<std::chrono::milliseconds> (std::chrono::system_clock::now ().time_since_epoch ()).count ());
+}
+
+
+
+//  Check to see if the process that claimed a slot is still running.
+
+static uint8_t shared_cache_alive (int64_t pid)
+{
+#ifdef _WIN32
+  return (NVFalse);
+#else
+  return (!(kill ((pid_t) pid, 0) < 0 && errno == ESRCH));
+#endif
+}
+
+
+
+//  The writer's process id is in the same word as the sequence number so a claim (or taking over a dead writer's claim)
+//  sets both at once.  Otherwise two processes could both decide that the old owner was dead and both fill the slot.
+
+static inline uint64_t shared_cache_seq (uint32_t seq, int64_t pid)
+{
+  return (((uint64_t) (uint32_t) pid << 32) | seq);
+}
+
+
+
+static uint64_t shared_cache_hash (uint64_t file_id, uint64_t recnum)
+{
+  uint64_t h = file_id ^ (recnum * 0x9e3779b97f4a7c15ULL);
+
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+
+  return (h);
+}
+
+
+
+static size_t shared_cache_header_size (uint32_t number_of_sets)
+{
+  size_t size = offsetof (SLAS_SHARED_CACHE_HEADER, hand) + number_of_sets * sizeof (std::atomic<uint32_t>);
+
+  return ((size + 63) & ~(size_t) 63);
+}
+
+
+
+//  Look for a waveform and, if wave isn't NULL, copy the samples from first to first + count out of it.
+
+static int32_t shared_cache_find (SLAS_SHARED_CACHE *cache, uint64_t file_id, uint64_t recnum, uint32_t first, uint32_t count,
+                                  SLAS_SAMPLES *wave)
+{
+  uint64_t set = shared_cache_hash (file_id, recnum) % cache->number_of_sets;
+  SLAS_SHARED_CACHE_SLOT *slots = &cache->slots[set * SLAS_SHARED_CACHE_WAYS];
+
+  for (int32_t way = 0 ; way < SLAS_SHARED_CACHE_WAYS ; way++)
+    {
+      SLAS_SHARED_CACHE_SLOT *slot = &slots[way];
+      uint64_t seq = slot->seq.load (std::memory_order_acquire);
+
+      if ((seq & 1) || slot->file_id != file_id || slot->recnum != recnum || !slot->valid) continue;
+
+      uint32_t total = slot->count;
+      uint8_t width = slot->width;
+
+      if (first + count > total || (size_t) total * width > SLAS_SHARED_CACHE_SLOT_BYTES) continue;
+
+
+      //  Copy it out and then make sure nobody changed it while we were copying.
+
+      if (wave)
+        {
+          wave->resize (count, width * 8);
+          memcpy (wave->ptr8 (), &slot->data[(size_t) first * width], (size_t) count * width);
+        }
+
+      std::atomic_thread_fence (std::memory_order_acquire);
+
+      if (slot->seq.load (std::memory_order_relaxed) != seq) continue;
+
+
+      slot->referenced.store (1, std::memory_order_relaxed);
+
+      return (0);
+    }
+
+
+  return (-1);
+}
+
+
+
+//  Batch fetch callback for slas_shared_cache_prefetch.
+
+typedef struct
+{
+  SLAS_SHARED_CACHE           *cache;
+  uint64_t                    file_id;
+} PREFETCH_DATA;
+
+
+static void shared_cache_prefetched (void *user_data, uint64_t recnum, SLAS_POINT_DATA *record __attribute__ ((unused)), SLAS_SAMPLES *wave,
+                                     int32_t status)
+{
+  PREFETCH_DATA *data = (PREFETCH_DATA *) user_data;
+
+  if (!status) slas_shared_cache_put (data->cache, data->file_id, recnum, wave);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_shared_cache_attach
+
+ - Purpose:     Attach to the shared decoded waveform cache, creating it if no other process
+                has.  Only the process that creates it uses megabytes, everybody else uses
+                the size that it was created with.
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - key            =    Shared memory key (normally SLAS_SHARED_CACHE_KEY)
+                - megabytes      =    Size of the cache if we have to create it
+
+ - Returns:     SLAS_SHARED_CACHE * = The cache (detach with slas_shared_cache_detach) or NULL
+                                      if it couldn't be created or attached.  Everything works
+                                      without it, it's just slower.
+
+*********************************************************************************************/
+
+SLAS_SHARED_CACHE *slas_shared_cache_attach (const char *key, int32_t megabytes)
+{
+  QSharedMemory *shm = new QSharedMemory (QString (key));
+  uint8_t created = NVFalse;
+
+
+  uint32_t number_of_sets = qMax (1, (int32_t) (((int64_t) megabytes * 1048576) / (sizeof (SLAS_SHARED_CACHE_SLOT) * SLAS_SHARED_CACHE_WAYS)));
+  size_t size = shared_cache_header_size (number_of_sets) + (size_t) number_of_sets * SLAS_SHARED_CACHE_WAYS * sizeof (SLAS_SHARED_CACHE_SLOT);
+
+  if (shm->create ((int) size))
+    {
+      created = NVTrue;
+    }
+  else if (shm->error () != QSharedMemory::AlreadyExists || !shm->attach ())
+    {
+      fprintf (stderr, "Unable to attach the shared waveform cache : %s\n", shm->errorString ().toLatin1 ().data ());
+      fflush (stderr);
+      delete shm;
+      return (NULL);
+    }
+
+
+  SLAS_SHARED_CACHE_HEADER *header = (SLAS_SHARED_CACHE_HEADER *) shm->data ();
+
+
+  //  New segments are zero filled so all we have to set up is the header.  The magic number goes in last so that
+  //  anyone attaching while we're doing this waits for it.
+
+  if (created)
+    {
+      header->version = SHARED_CACHE_VERSION;
+      header->number_of_sets = number_of_sets;
+      header->slot_bytes = SLAS_SHARED_CACHE_SLOT_BYTES;
+      header->magic.store (SHARED_CACHE_MAGIC, std::memory_order_release);
+    }
+  else
+    {
+      for (int32_t i = 0 ; i < 100 && header->magic.load (std::memory_order_acquire) != SHARED_CACHE_MAGIC ; i++)
+        std::this_thread::sleep_for (std::chrono::milliseconds (1));
+
+      if (header->magic.load (std::memory_order_acquire) != SHARED_CACHE_MAGIC || header->version != SHARED_CACHE_VERSION ||
+          header->slot_bytes != SLAS_SHARED_CACHE_SLOT_BYTES ||
+          (size_t) shm->size () < shared_cache_header_size (header->number_of_sets) +
+          (size_t) header->number_of_sets * SLAS_SHARED_CACHE_WAYS * sizeof (SLAS_SHARED_CACHE_SLOT))
+        {
+          fprintf (stderr, "The shared waveform cache is not compatible with this program, not using it\n");
+          fflush (stderr);
+          shm->detach ();
+          delete shm;
+          return (NULL);
+        }
+    }
+
+
+  SLAS_SHARED_CACHE *cache = new SLAS_SHARED_CACHE;
+
+  cache->shm = shm;
+  cache->header = header;
+  cache->number_of_sets = header->number_of_sets;
+  cache->slots = (SLAS_SHARED_CACHE_SLOT *) ((uint8_t *) shm->data () + shared_cache_header_size (cache->number_of_sets));
+  cache->prefetching = 0;
+#ifdef _WIN32
+  cache->pid = _getpid ();
+#else
+  cache->pid = getpid ();
+#endif
+
+
+  return (cache);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_shared_cache_file_id
+
+ - Purpose:     Make the id that is used for a LAS file in the shared cache.  Every process
+                gets the same id for the same file (the canonical path and the modification
+                time) so they share the cached waveforms.  If the file is rewritten, its id
+                changes and the old entries just age out.
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - filename       =    The LAS file name
+
+ - Returns:     uint64_t         =    The file id (0 if the file doesn't exist)
+
+*********************************************************************************************/
+
+uint64_t slas_shared_cache_file_id (const char *filename)
+{
+  QFileInfo info (QString::fromLocal8Bit (filename));
+
+  if (!info.exists ()) return (0);
+
+
+  QByteArray path = info.canonicalFilePath ().toUtf8 ();
+  uint64_t h = 0xcbf29ce484222325ULL;
+
+  for (int32_t i = 0 ; i < path.size () ; i++) h = (h ^ (uint8_t) path[i]) * 0x100000001b3ULL;
+
+
+  return (shared_cache_hash (h, (uint64_t) info.lastModified ().toMSecsSinceEpoch ()) | 1);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_shared_cache_get
+
+ - Purpose:     Look for a decoded waveform in the shared cache and copy the samples from
+                first to first + count out of it.  This never waits on other processes.
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - cache          =    The cache (may be NULL)
+                - file_id        =    File id from slas_shared_cache_file_id
+                - recnum         =    Zero based record number
+                - first          =    First sample to return
+                - count          =    Number of samples to return
+                - wave           =    The returned samples
+
+ - Returns:     int32_t          =    0 on a hit, -1 on a miss
+
+*********************************************************************************************/
+
+int32_t slas_shared_cache_get (SLAS_SHARED_CACHE *cache, uint64_t file_id, uint64_t recnum, uint32_t first, uint32_t count,
+                               SLAS_SAMPLES *wave)
+{
+  if (cache == NULL || !file_id) return (-1);
+
+
+  if (!shared_cache_find (cache, file_id, recnum, first, count, wave))
+    {
+      cache->header->hits.fetch_add (1, std::memory_order_relaxed);
+      slas_metrics_add (SLAS_METRIC_CACHE_HITS, 1);
+      return (0);
+    }
+
+
+  cache->header->misses.fetch_add (1, std::memory_order_relaxed);
+  slas_metrics_add (SLAS_METRIC_CACHE_MISSES, 1);
+
+  return (-1);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_shared_cache_put
+
+ - Purpose:     Store a decoded (whole) waveform in the shared cache.  If no slot in its set
+                can be claimed right away the waveform just isn't cached.
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - cache          =    The cache (may be NULL)
+                - file_id        =    File id from slas_shared_cache_file_id
+                - recnum         =    Zero based record number
+                - wave           =    All of the samples of the waveform
+
+ - Returns:     void
+
+*********************************************************************************************/
+
+void slas_shared_cache_put (SLAS_SHARED_CACHE *cache, uint64_t file_id, uint64_t recnum, const SLAS_SAMPLES *wave)
+{
+  if (cache == NULL || !file_id || !wave->size () || wave->bytes () > SLAS_SHARED_CACHE_SLOT_BYTES) return;
+
+
+  uint64_t set = shared_cache_hash (file_id, recnum) % cache->number_of_sets;
+  SLAS_SHARED_CACHE_SLOT *slots = &cache->slots[set * SLAS_SHARED_CACHE_WAYS];
+  std::atomic<uint32_t> *hand = &cache->header->hand[set];
+  int64_t now = shared_cache_now ();
+
+
+  //  Use the slot it's already in if another process beat us to it, otherwise the first slot that isn't being filled
+  //  and hasn't been used since the clock hand went by.  Slots left odd by a process that died are taken back.
+
+  SLAS_SHARED_CACHE_SLOT *slot = NULL;
+  uint64_t seq = 0;
+
+  for (int32_t i = 0 ; i < 2 * SLAS_SHARED_CACHE_WAYS && !slot ; i++)
+    {
+      uint32_t way = hand->fetch_add (1, std::memory_order_relaxed) % SLAS_SHARED_CACHE_WAYS;
+      SLAS_SHARED_CACHE_SLOT *s = &slots[way];
+      uint64_t sq = s->seq.load (std::memory_order_acquire);
+
+      if (sq & 1)
+        {
+          if (now - s->claimed.load (std::memory_order_relaxed) < SLAS_SHARED_CACHE_STALE || shared_cache_alive ((int64_t) (sq >> 32))) continue;
+        }
+      else if (s->valid && s->file_id == file_id && s->recnum == recnum)
+        {
+          return;
+        }
+      else if (s->valid && s->referenced.exchange (0, std::memory_order_relaxed) && i < SLAS_SHARED_CACHE_WAYS)
+        {
+          continue;
+        }
+
+
+      //  Claim it.  An odd sequence number stays odd (we take over the dead writer's claim).  The compare and swap fails
+      //  if anyone else claimed or took over the slot since we looked at it.
+
+      uint32_t count = (uint32_t) sq;
+      uint64_t claimed = shared_cache_seq ((count & 1) ? count + 2 : count + 1, cache->pid);
+
+      if (s->seq.compare_exchange_strong (sq, claimed, std::memory_order_acquire))
+        {
+          slot = s;
+          seq = claimed;
+        }
+    }
+
+  if (!slot) return;
+
+
+  slot->claimed.store (now, std::memory_order_relaxed);
+
+  std::atomic_thread_fence (std::memory_order_release);
+
+  slot->valid = 0;
+  slot->file_id = file_id;
+  slot->recnum = recnum;
+  slot->count = wave->size ();
+  slot->width = wave->bytesPerSample ();
+  memcpy (slot->data, wave->ptr8 (), wave->bytes ());
+  slot->valid = 1;
+  slot->referenced.store (1, std::memory_order_relaxed);
+
+
+  //  If somebody decided we were dead and took the slot, leave it to them.
+
+  slot->seq.compare_exchange_strong (seq, seq + 1, std::memory_order_release);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_shared_cache_prefetch
+
+ - Purpose:     Decode waveforms into the shared cache in the background (so a monitor can
+                warm the cache with the records that the cursor passed over).  Records that
+                are already cached are skipped.  Only one prefetch runs at a time, if one is
+                still running the records are just not prefetched.
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - cache          =    The cache (may be NULL)
+                - las_name       =    The LAS file name
+                - lasheader      =    The SLAS_HEADER of the LAS file (it's copied)
+                - swap           =    Flag that indicates that the system is big endian
+                - recnums        =    Zero based record numbers
+
+ - Returns:     int32_t          =    Number of records being prefetched, -1 if a prefetch
+                                      is already running
+
+*********************************************************************************************/
+
+int32_t slas_shared_cache_prefetch (SLAS_SHARED_CACHE *cache, const char *las_name, SLAS_HEADER *lasheader, uint8_t swap,
+                                    const std::vector<uint64_t> &recnums)
+{
+  if (cache == NULL || recnums.empty ()) return (0);
+
+  if (cache->prefetching.load ()) return (-1);
+
+
+  uint64_t file_id = slas_shared_cache_file_id (las_name);
+  std::vector<uint64_t> missing;
+
+  for (size_t i = 0 ; i < recnums.size () ; i++)
+    {
+      if (shared_cache_find (cache, file_id, recnums[i], 0, 0, NULL)) missing.push_back (recnums[i]);
+    }
+
+  if (missing.empty () || !file_id) return (0);
+
+
+  if (cache->prefetch.joinable ()) cache->prefetch.join ();
+
+  cache->prefetching = 1;
+
+  std::string name (las_name);
+  SLAS_HEADER *header = new SLAS_HEADER (*lasheader);
+
+  cache->prefetch = std::thread ([cache, name, header, swap, missing, file_id] ()
+    {
+      PREFETCH_DATA data = {cache, file_id};
+
+      slas_batch_fetch_waveforms (name.c_str (), header, swap, SLAS_MASK_WAVEFORM, missing.data (), missing.size (), SLAS_BATCH_DEFAULT_QUEUE_DEPTH,
+                                  shared_cache_prefetched, &data);
+
+      delete header;
+      cache->prefetching = 0;
+    });
+
+
+  return ((int32_t) missing.size ());
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_shared_cache_stats
+
+ - Purpose:     Get the hit and miss counts of the shared cache (for all processes).
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - cache          =    The cache (may be NULL)
+                - hits           =    Returned number of hits
+                - misses         =    Returned number of misses
+
+ - Returns:     void
+
+*********************************************************************************************/
+
+void slas_shared_cache_stats (SLAS_SHARED_CACHE *cache, uint64_t *hits, uint64_t *misses)
+{
+  *hits = cache ? cache->header->hits.load () : 0;
+  *misses = cache ? cache->header->misses.load () : 0;
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_shared_cache_detach
+
+ - Purpose:     Detach from the shared waveform cache (after waiting for any prefetch to
+                finish).  The segment goes away when the last process detaches.
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - cache          =    The cache (may be NULL)
+
+ - Returns:     void
+
+*********************************************************************************************/
+
+void slas_shared_cache_detach (SLAS_SHARED_CACHE *cache)
+{
+  if (cache == NULL) return;
+
+  if (cache->prefetch.joinable ()) cache->prefetch.join ();
+
+  cache->shm->detach ();
+  delete cache->shm;
+  delete cache;
+}
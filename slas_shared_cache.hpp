@@ -0,0 +1,103 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! or / / ! are being used by Doxygen to
+    document the software.  Dashes in these comment blocks are used to create bullet lists.
+    The lack of blank lines after a block of dash preceeded comments means that the next
+    block of dash preceeded comments is a new, indented bullet list.  I've tried to keep the
+    Doxygen formatting to a minimum but there are some other items (like <br> and <pre>)
+    that need to be left alone.  If you see a comment that starts with / * ! or / / ! and
+    there is something that looks a bit weird it is probably due to some arcane Doxygen
+    syntax.  Be very careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+/*  Shared (cross-process) decoded waveform cache definitions.  */
+
+#ifndef __SLAS_SHARED_CACHE_HPP__
+#define __SLAS_SHARED_CACHE_HPP__
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <errno.h>
+#include <sys/types.h>
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <thread>
+
+#include "slas.hpp"
+
+
+#define SLAS_SHARED_CACHE_KEY             "ABE_WAVEFORM_CACHE"
+#define SLAS_SHARED_CACHE_DEFAULT_SIZE    64       //!<  Megabytes
+#define SLAS_SHARED_CACHE_SLOT_BYTES      4096     //!<  Largest decoded waveform that will be cached (in bytes)
+#define SLAS_SHARED_CACHE_WAYS            8        //!<  Slots that a (file, record) can be stored in
+#define SLAS_SHARED_CACHE_STALE           2000     //!<  Milliseconds before a slot claimed by a dead process is taken back
+
+
+/*!  One shared memory segment (SLAS_SHARED_CACHE_KEY) holds decoded waveforms for every waveform monitor on the
+     workstation, keyed by (file id, record number).  The first monitor to start creates it and the others attach.
+
+     Following the ABE rule about shared memory (see the note in the LASwaveMonitor constructor) nothing ever locks it.
+     Each slot has a sequence number that a writer makes odd (with a compare and swap that also stores its process id)
+     while it is filling the slot and even when it's done.  Readers copy the slot and then check that the sequence number didn't change, so they never
+     wait and never hold on to a slot.  A slot that is odd is just a miss.  If a monitor dies while it is filling a slot,
+     the slot is taken back by the next writer once it's SLAS_SHARED_CACHE_STALE milliseconds old and its owner is gone.
+
+     The slots are SLAS_SHARED_CACHE_WAYS way set associative with a clock (second chance) replacement in each set.  */
+
+class QSharedMemory;
+
+typedef struct SLAS_SHARED_CACHE_HEADER SLAS_SHARED_CACHE_HEADER;
+typedef struct SLAS_SHARED_CACHE_SLOT SLAS_SHARED_CACHE_SLOT;
+
+typedef struct
+{
+  QSharedMemory               *shm;
+  SLAS_SHARED_CACHE_HEADER    *header;
+  SLAS_SHARED_CACHE_SLOT      *slots;
+  uint32_t                    number_of_sets;
+  int64_t                     pid;
+  std::thread                 prefetch;
+  std::atomic<int32_t>        prefetching;
+} SLAS_SHARED_CACHE;
+
+
+SLAS_SHARED_CACHE *slas_shared_cache_attach (const char *key, int32_t megabytes);
+uint64_t slas_shared_cache_file_id (const char *filename);
+int32_t slas_shared_cache_get (SLAS_SHARED_CACHE *cache, uint64_t file_id, uint64_t recnum, uint32_t first, uint32_t count,
+                               SLAS_SAMPLES *wave);
+void slas_shared_cache_put (SLAS_SHARED_CACHE *cache, uint64_t file_id, uint64_t recnum, const SLAS_SAMPLES *wave);
+int32_t slas_shared_cache_prefetch (SLAS_SHARED_CACHE *cache, const char *las_name, SLAS_HEADER *lasheader, uint8_t swap,
+                                    const std::vector<uint64_t> &recnums);
+void slas_shared_cache_stats (SLAS_SHARED_CACHE *cache, uint64_t *hits, uint64_t *misses);
+void slas_shared_cache_detach (SLAS_SHARED_CACHE *cache);
+
+
+#endif
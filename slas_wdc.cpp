@@ -0,0 +1,1249 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! or / / ! are being used by Doxygen to
+    document the software.  Dashes in these comment blocks are used to create bullet lists.
+    The lack of blank lines after a block of dash preceeded comments means that the next
+    block of dash preceeded comments is a new, indented bullet list.  I've tried to keep the
+    Doxygen formatting to a minimum but there are some other items (like <br> and <pre>)
+    that need to be left alone.  If you see a comment that starts with / * ! or / / ! and
+    there is something that looks a bit weird it is probably due to some arcane Doxygen
+    syntax.  Be very careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+#include <stddef.h>
+
+#include <algorithm>
+#include <thread>
+#include <atomic>
+
+#include "slas_wdc.hpp"
+#include "slaz.hpp"
+#include "slas_metrics.hpp"
+#include "nvutility.hpp"
+
+
+#define WDC_ESCAPE                24        //  Unary prefix length that means the value follows uncoded
+#define WDC_PADDING               16        //  Zero bytes after a block so the bit reader can look ahead
+#define WDC_POINT_CHUNK           65536     //  Point records read at a time when building the packet list
+#define WDC_BLOCKS_PER_THREAD     4         //  Blocks per thread in each batch compressed by the converter
+
+
+typedef struct
+{
+  uint64_t                    offset;        //  Absolute offset in the .wdp file
+  uint32_t                    size;
+  uint32_t                    number_of_samples;
+  uint8_t                     bits_per_sample;
+  uint64_t                    raw;           //  Offset of the raw packet in the batch buffer (converter only)
+} WDC_PACKET;
+
+
+
+//  Little endian and variable length integers.
+
+static void wdc_put_u32 (uint8_t *p, uint32_t v)
+{
+  for (int32_t i = 0 ; i < 4 ; i++) p[i] = (uint8_t) (v >> (i * 8));
+}
+
+
+static void wdc_put_u64 (uint8_t *p, uint64_t v)
+{
+  for (int32_t i = 0 ; i < 8 ; i++) p[i] = (uint8_t) (v >> (i * 8));
+}
+
+
+static uint32_t wdc_get_u32 (const uint8_t *p)
+{
+  uint32_t v = 0;
+  for (int32_t i = 3 ; i >= 0 ; i--) v = (v << 8) | p[i];
+  return (v);
+}
+
+
+static uint64_t wdc_get_u64 (const uint8_t *p)
+{
+  uint64_t v = 0;
+  for (int32_t i = 7 ; i >= 0 ; i--) v = (v << 8) | p[i];
+  return (v);
+}
+
+
+static void wdc_put_varint (std::vector<uint8_t> &out, uint64_t v)
+{
+  while (v >= 0x80)
+    {
+      out.push_back ((uint8_t) (v | 0x80));
+      v >>= 7;
+    }
+
+  out.push_back ((uint8_t) v);
+}
+
+
+static uint64_t wdc_get_varint (const uint8_t *&p, const uint8_t *end)
+{
+  uint64_t v = 0;
+
+  for (int32_t shift = 0 ; p < end && shift < 64 ; shift += 7)
+    {
+      uint8_t b = *p++;
+      v |= (uint64_t) (b & 0x7f) << shift;
+      if (!(b & 0x80)) break;
+    }
+
+  return (v);
+}
+
+
+static inline uint64_t wdc_zigzag (int64_t v)
+{
+  return (((uint64_t) v << 1) ^ (uint64_t) (v >> 63));
+}
+
+
+static inline int64_t wdc_unzigzag (uint64_t v)
+{
+  return ((int64_t) (v >> 1) ^ -(int64_t) (v & 1));
+}
+
+
+
+//  Most significant bit first bit writer.
+
+typedef struct
+{
+  std::vector<uint8_t>        *out;
+  uint64_t                    acc;
+  int32_t                     n;
+} WDC_BITS;
+
+
+static inline void wdc_put_bits (WDC_BITS *bits, uint64_t value, int32_t count)
+{
+  if (!count) return;
+
+  bits->acc = (bits->acc << count) | (value & ((count == 64) ? ~0ULL : ((1ULL << count) - 1)));
+  bits->n += count;
+
+  while (bits->n >= 8)
+    {
+      bits->out->push_back ((uint8_t) (bits->acc >> (bits->n - 8)));
+      bits->n -= 8;
+    }
+}
+
+
+static inline void wdc_flush_bits (WDC_BITS *bits)
+{
+  if (bits->n) bits->out->push_back ((uint8_t) (bits->acc << (8 - bits->n)));
+  bits->n = 0;
+}
+
+
+
+//  The next 64 bits starting at bit pos (most significant bit first).  Needs 9 readable bytes after pos / 8.
+
+static inline uint64_t wdc_peek (const uint8_t *buf, uint64_t pos)
+{
+  const uint8_t *p = buf + (pos >> 3);
+  uint64_t v = 0;
+
+  for (int32_t i = 0 ; i < 8 ; i++) v = (v << 8) | p[i];
+
+  uint32_t shift = pos & 7;
+  if (shift) v = (v << shift) | (p[8] >> (8 - shift));
+
+  return (v);
+}
+
+
+
+//  Unpack the samples of a raw packet (same bit order as slas_unpack_waveform) and pack them back.
+
+static void wdc_unpack (const uint8_t *raw, uint32_t count, uint8_t bits, uint32_t *samples)
+{
+  switch (bits)
+    {
+    case 8:
+      for (uint32_t i = 0 ; i < count ; i++) samples[i] = raw[i];
+      break;
+
+    case 16:
+      for (uint32_t i = 0 ; i < count ; i++) samples[i] = ((uint32_t) raw[i * 2] << 8) | raw[i * 2 + 1];
+      break;
+
+    default:
+      for (uint32_t i = 0 ; i < count ; i++) samples[i] = bit_unpack ((uint8_t *) raw, i * bits, bits);
+      break;
+    }
+}
+
+
+static inline void wdc_pack (uint8_t *raw, uint32_t i, uint8_t bits, uint32_t value)
+{
+  switch (bits)
+    {
+    case 8:
+      raw[i] = (uint8_t) value;
+      break;
+
+    case 16:
+      raw[i * 2] = (uint8_t) (value >> 8);
+      raw[i * 2 + 1] = (uint8_t) value;
+      break;
+
+    default:
+      bit_pack (raw, i * bits, bits, (int32_t) value);
+      break;
+    }
+}
+
+
+
+//  Decode one packet.  comp must be followed by WDC_PADDING readable bytes.
+
+static int32_t wdc_decode_packet (const uint8_t *comp, uint32_t comp_size, uint32_t raw_size, uint32_t count, uint8_t bits, uint8_t mode,
+                                  uint8_t *raw)
+{
+  if ((mode & 0x3) == 0)
+    {
+      if (comp_size != raw_size) return (-1);
+      memcpy (raw, comp, raw_size);
+      return (0);
+    }
+
+
+  uint32_t k = mode >> 2;
+  uint32_t needed = (uint32_t) (((uint64_t) count * bits + 7) / 8);
+  uint64_t pos = 0, limit = (uint64_t) comp_size * 8;
+  uint32_t prev = 0;
+
+  if (needed > raw_size || bits > 32) return (-1);
+
+  memset (raw, 0, needed);
+
+  for (uint32_t i = 0 ; i < count ; i++)
+    {
+      uint64_t window = wdc_peek (comp, pos);
+      uint32_t ones = (~window) ? __builtin_clzll (~window) : 64;
+      uint64_t u;
+
+      if (ones >= WDC_ESCAPE)
+        {
+          pos += WDC_ESCAPE;
+          u = wdc_peek (comp, pos) >> (64 - (bits + 1));
+          pos += bits + 1;
+        }
+      else
+        {
+          pos += ones + 1;
+          u = (uint64_t) ones << k;
+          if (k) u |= wdc_peek (comp, pos) >> (64 - k);
+          pos += k;
+        }
+
+      if (pos > limit) return (-2);
+
+      prev = (uint32_t) ((int64_t) prev + wdc_unzigzag (u));
+      wdc_pack (raw, i, bits, prev);
+    }
+
+
+  //  Anything after the samples is stored as is.
+
+  uint64_t tail = (pos + 7) / 8;
+
+  if (tail + (raw_size - needed) != comp_size) return (-3);
+
+  memcpy (&raw[needed], &comp[tail], raw_size - needed);
+
+
+  return (0);
+}
+
+
+
+//  Encode one packet into out.  Falls back to storing it raw if it doesn't unpack and repack exactly or doesn't get any
+//  smaller.
+
+static uint8_t wdc_encode_packet (const uint8_t *raw, WDC_PACKET *pkt, std::vector<uint8_t> &out)
+{
+  uint32_t count = pkt->number_of_samples;
+  uint8_t bits = pkt->bits_per_sample;
+  uint32_t needed = (uint32_t) (((uint64_t) count * bits + 7) / 8);
+  size_t start = out.size ();
+
+
+  if (count && bits && bits <= 32 && needed <= pkt->size)
+    {
+      std::vector<uint32_t> samples (count);
+      wdc_unpack (raw, count, bits, samples.data ());
+
+
+      //  Pick the Rice parameter from the mean of the zigzagged deltas.
+
+      uint64_t sum = 0;
+      uint32_t prev = 0;
+
+      for (uint32_t i = 0 ; i < count ; i++)
+        {
+          sum += wdc_zigzag ((int64_t) samples[i] - (int64_t) prev);
+          prev = samples[i];
+        }
+
+      uint64_t mean = sum / count;
+      uint32_t k = 0;
+      while (k < 31 && (2ULL << k) <= mean) k++;
+
+
+      WDC_BITS bw = {&out, 0, 0};
+      prev = 0;
+
+      for (uint32_t i = 0 ; i < count ; i++)
+        {
+          uint64_t u = wdc_zigzag ((int64_t) samples[i] - (int64_t) prev);
+          uint64_t q = u >> k;
+
+          prev = samples[i];
+
+          if (q >= WDC_ESCAPE)
+            {
+              wdc_put_bits (&bw, (1ULL << WDC_ESCAPE) - 1, WDC_ESCAPE);
+              wdc_put_bits (&bw, u, bits + 1);
+            }
+          else
+            {
+              wdc_put_bits (&bw, ((1ULL << q) - 1) << 1, q + 1);
+              wdc_put_bits (&bw, u, k);
+            }
+        }
+
+      wdc_flush_bits (&bw);
+
+      out.insert (out.end (), raw + needed, raw + pkt->size);
+
+
+      //  Make sure it comes back exactly.
+
+      uint8_t mode = 1 | (k << 2);
+      size_t comp_size = out.size () - start;
+
+      if (comp_size < pkt->size)
+        {
+          std::vector<uint8_t> check (pkt->size), comp (comp_size + WDC_PADDING, 0);
+
+          memcpy (comp.data (), &out[start], comp_size);
+
+          if (!wdc_decode_packet (comp.data (), comp_size, pkt->size, count, bits, mode, check.data ()) &&
+              !memcmp (check.data (), raw, pkt->size)) return (mode);
+        }
+
+      out.resize (start);
+    }
+
+
+  out.insert (out.end (), raw, raw + pkt->size);
+
+
+  return (0);
+}
+
+
+
+//  Encode a block of packets (see slas_wdc.hpp for the layout).
+
+static void wdc_encode_block (const uint8_t *batch, WDC_PACKET *pkts, int32_t count, std::vector<uint8_t> &out)
+{
+  std::vector<uint8_t> payload;
+  std::vector<uint8_t> entries;
+  uint64_t prev_end = pkts[0].offset;
+
+
+  wdc_put_varint (entries, count);
+
+  for (int32_t i = 0 ; i < count ; i++)
+    {
+      size_t start = payload.size ();
+      uint8_t mode = wdc_encode_packet (&batch[pkts[i].raw], &pkts[i], payload);
+
+      wdc_put_varint (entries, wdc_zigzag ((int64_t) pkts[i].offset - (int64_t) prev_end));
+      wdc_put_varint (entries, pkts[i].size);
+      wdc_put_varint (entries, payload.size () - start);
+      wdc_put_varint (entries, pkts[i].number_of_samples);
+      entries.push_back (pkts[i].bits_per_sample);
+      entries.push_back (mode);
+
+      prev_end = pkts[i].offset + pkts[i].size;
+    }
+
+
+  out.swap (entries);
+  out.insert (out.end (), payload.begin (), payload.end ());
+}
+
+
+
+//  The list of packets used by the point records is made in sorted, deduplicated runs of at most max_packets packets so
+//  the memory used by the converter doesn't depend on the number of point records.  If everything fits in one run it
+//  stays in memory, otherwise the runs are written to temporary files and merged as the packets are compressed.
+
+typedef std::pair<WDC_PACKET, size_t> WDC_RUN_HEAD;
+
+typedef struct
+{
+  size_t                      max_packets;
+  std::vector<WDC_PACKET>     buffer;        //  The run being made (or the only run)
+  size_t                      pos;           //  Next packet in buffer if there's only one run
+  std::vector<FILE *>         runs;
+  std::vector<WDC_RUN_HEAD>   heap;          //  Next packet of each run that isn't finished
+  uint64_t                    last_offset;   //  Last packet returned (to drop duplicates from different runs)
+  uint8_t                     have_last;
+} WDC_PACKET_LIST;
+
+
+
+//  Offset order (the largest size first for packets that share an offset, that's the one that's kept so that every
+//  record that points at it can be read, see slas_wdc_read_packet).
+
+static inline bool wdc_packet_less (const WDC_PACKET &a, const WDC_PACKET &b)
+{
+  return (a.offset < b.offset || (a.offset == b.offset && a.size > b.size));
+}
+
+
+static bool wdc_head_greater (const WDC_RUN_HEAD &a, const WDC_RUN_HEAD &b)
+{
+  return (wdc_packet_less (b.first, a.first));
+}
+
+
+
+//  Packets shared by more than one return are only stored once.
+
+static void wdc_sort_packets (std::vector<WDC_PACKET> &packets)
+{
+  std::sort (packets.begin (), packets.end (), wdc_packet_less);
+
+  packets.erase (std::unique (packets.begin (), packets.end (), [] (const WDC_PACKET &a, const WDC_PACKET &b) {return a.offset == b.offset;}),
+                 packets.end ());
+}
+
+
+
+static void wdc_list_init (WDC_PACKET_LIST *list, int64_t memory)
+{
+  list->max_packets = (size_t) std::max ((int64_t) 1024, memory / (int64_t) (2 * sizeof (WDC_PACKET)));
+  list->pos = 0;
+  list->last_offset = 0;
+  list->have_last = NVFalse;
+}
+
+
+
+//  Sort the run that's in memory and write it to a temporary file.
+
+static int32_t wdc_list_flush (WDC_PACKET_LIST *list)
+{
+  if (list->buffer.empty ()) return (0);
+
+  wdc_sort_packets (list->buffer);
+
+  FILE *run = tmpfile ();
+
+  if (run == NULL || fwrite (list->buffer.data (), sizeof (WDC_PACKET), list->buffer.size (), run) != list->buffer.size ())
+    {
+      fprintf (stderr, "Error writing packet list run :\n%s\nFunction: %s, Line: %d\n", strerror (errno), __FUNCTION__, __LINE__);
+      fflush (stderr);
+      if (run) fclose (run);
+      return (-1);
+    }
+
+  rewind (run);
+  list->runs.push_back (run);
+  list->buffer.clear ();
+
+  return (0);
+}
+
+
+
+static int32_t wdc_list_add (WDC_PACKET_LIST *list, const WDC_PACKET &pkt)
+{
+  list->buffer.push_back (pkt);
+
+  if (list->buffer.size () >= list->max_packets) return (wdc_list_flush (list));
+
+  return (0);
+}
+
+
+
+//  Done adding packets.
+
+static int32_t wdc_list_finish (WDC_PACKET_LIST *list)
+{
+  if (list->runs.empty ())
+    {
+      wdc_sort_packets (list->buffer);
+      list->pos = 0;
+      return (0);
+    }
+
+  if (wdc_list_flush (list) < 0) return (-1);
+
+  std::vector<WDC_PACKET> ().swap (list->buffer);
+
+  for (size_t i = 0 ; i < list->runs.size () ; i++)
+    {
+      WDC_PACKET pkt;
+
+      if (fread (&pkt, sizeof (WDC_PACKET), 1, list->runs[i])) list->heap.push_back (WDC_RUN_HEAD (pkt, i));
+    }
+
+  std::make_heap (list->heap.begin (), list->heap.end (), wdc_head_greater);
+
+  return (0);
+}
+
+
+
+//  Add up to count of the next packets (in offset order) to packets.
+
+static void wdc_list_next (WDC_PACKET_LIST *list, std::vector<WDC_PACKET> &packets, size_t count)
+{
+  if (list->runs.empty ())
+    {
+      size_t n = std::min (count, list->buffer.size () - list->pos);
+
+      packets.insert (packets.end (), list->buffer.begin () + list->pos, list->buffer.begin () + list->pos + n);
+      list->pos += n;
+      return;
+    }
+
+  while (count && !list->heap.empty ())
+    {
+      std::pop_heap (list->heap.begin (), list->heap.end (), wdc_head_greater);
+
+      WDC_RUN_HEAD &head = list->heap.back ();
+
+      if (!list->have_last || head.first.offset != list->last_offset)
+        {
+          packets.push_back (head.first);
+          list->last_offset = head.first.offset;
+          list->have_last = NVTrue;
+          count--;
+        }
+
+      if (fread (&head.first, sizeof (WDC_PACKET), 1, list->runs[head.second]))
+        {
+          std::push_heap (list->heap.begin (), list->heap.end (), wdc_head_greater);
+        }
+      else
+        {
+          list->heap.pop_back ();
+        }
+    }
+}
+
+
+
+static void wdc_list_close (WDC_PACKET_LIST *list)
+{
+  for (size_t i = 0 ; i < list->runs.size () ; i++) fclose (list->runs[i]);
+
+  list->runs.clear ();
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_wdc_file_name
+
+ - Purpose:     Build the name of the compressed waveform (.wdc) file that goes with a LAS or
+                LAZ file.
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - las_name       =    The LAS or LAZ file name
+                - wdc_name       =    The returned compressed waveform file name
+
+ - Returns:     void
+
+*********************************************************************************************/
+
+void slas_wdc_file_name (const char *las_name, char *wdc_name)
+{
+  slas_wave_file_name (las_name, wdc_name);
+
+  strcpy (&wdc_name[strlen (wdc_name) - 4], ".wdc");
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_wdc_convert
+
+ - Purpose:     Compress the external waveform (.wdp) file of a LAS or LAZ file to a .wdc
+                file.  Only the packets that are used by the point records are stored.  The
+                blocks are compressed by nthreads threads while the main thread reads and
+                writes in order so the conversion streams through both files.  The list of
+                packets is sorted in runs that fit in memory and merged from temporary files
+                (if there's more than one) so the memory used is bounded by the memory
+                argument, not the number of point records.  The .wdc file is written to a
+                temporary name and renamed when it's done.
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - las_name       =    The LAS or LAZ file name
+                - swap           =    Flag that indicates that the system is big endian and
+                                      therefor we need to byte swap the records
+                - nthreads       =    Number of compression threads (0 for one per core)
+                - memory         =    Approximate memory limit for the packet list in
+                                      megabytes (0 for SLAS_WDC_DEFAULT_MEMORY)
+
+ - Returns:     int32_t          =    Negative number on error, 0 on success
+
+*********************************************************************************************/
+
+int32_t slas_wdc_convert (const char *las_name, uint8_t swap, int32_t nthreads, int64_t memory)
+{
+  char wave_name[1024], wdc_name[1024], tmp_name[1040];
+  FILE *fp = NULL, *wfp = NULL, *cfp = NULL;
+  WDC_PACKET_LIST list;
+  int32_t status = 0;
+
+
+  if (nthreads <= 0) nthreads = std::max (1, (int32_t) std::thread::hardware_concurrency ());
+  nthreads = std::min (nthreads, SLAS_WDC_MAX_THREADS);
+
+  if (memory <= 0) memory = SLAS_WDC_DEFAULT_MEMORY;
+
+  wdc_list_init (&list, memory * 1048576);
+
+
+  SLAS_HEADER *header = (SLAS_HEADER *) calloc (1, sizeof (SLAS_HEADER));
+
+  if (header == NULL || (fp = fopen64 (las_name, "rb")) == NULL || slas_read_header (fp, swap, header) < 0)
+    {
+      fprintf (stderr, "Error opening or reading %s :\n%s\n", las_name, strerror (errno));
+      if (fp) fclose (fp);
+      free (header);
+      return (-1);
+    }
+
+  if (!(header->global_encoding & 0x4) || slas_wave_packet_offset (header->point_data_format) < 0)
+    {
+      fprintf (stderr, "%s has no external waveforms\n", las_name);
+      fclose (fp);
+      free (header);
+      return (-2);
+    }
+
+
+  //  Make the list of packets from the point records.
+
+  uint64_t count = header->extended_number_of_point_records;
+  SLAZ_HANDLE *laz = NULL;
+
+  if (header->compressed || slaz_is_laz (las_name))
+    {
+      fclose (fp);
+      fp = NULL;
+
+      if ((laz = slaz_open (las_name)) == NULL)
+        {
+          fprintf (stderr, "Error opening %s\n", las_name);
+          free (header);
+          return (-3);
+        }
+    }
+  else
+    {
+      fseeko64 (fp, header->offset_to_point_data, SEEK_SET);
+    }
+
+
+  std::vector<uint8_t> points ((size_t) WDC_POINT_CHUNK * header->point_data_record_length);
+
+  for (uint64_t start = 0 ; start < count && !status ; start += WDC_POINT_CHUNK)
+    {
+      uint64_t n = std::min ((uint64_t) WDC_POINT_CHUNK, count - start);
+
+      if (fp && !fread (points.data (), n * header->point_data_record_length, 1, fp))
+        {
+          fprintf (stderr, "Error reading point records :\n%s\n", strerror (errno));
+          status = -4;
+          break;
+        }
+
+      for (uint64_t i = 0 ; i < n ; i++)
+        {
+          SLAS_POINT_DATA record;
+
+          if (laz)
+            {
+              if (slaz_read_point_data (laz, start + i, &record) < 0) continue;
+            }
+          else
+            {
+              slas_decode_point_data (&points[i * header->point_data_record_length], header, swap, SLAS_MASK_WAVEFORM, &record);
+            }
+
+          if (!record.wavepacket_descriptor_index || !record.waveform_packet_size) continue;
+
+          WDC_PACKET pkt;
+          SLAS_WAVEFORM_PACKET_DESCRIPTOR *desc = &header->wf_packet_desc[record.wavepacket_descriptor_index];
+
+          pkt.offset = header->start_of_waveform_data_packet_record + record.byte_offset_to_waveform_data;
+          pkt.size = record.waveform_packet_size;
+          pkt.number_of_samples = desc->number_of_samples;
+          pkt.bits_per_sample = desc->bits_per_sample;
+          pkt.raw = 0;
+
+          if (wdc_list_add (&list, pkt) < 0)
+            {
+              status = -4;
+              break;
+            }
+        }
+    }
+
+  if (fp) fclose (fp);
+  slaz_close (laz);
+  free (header);
+
+  if (!status && wdc_list_finish (&list) < 0) status = -4;
+
+  if (status)
+    {
+      wdc_list_close (&list);
+      return (status);
+    }
+
+
+  slas_wave_file_name (las_name, wave_name);
+  slas_wdc_file_name (las_name, wdc_name);
+  sprintf (tmp_name, "%s.tmp", wdc_name);
+
+  if ((wfp = fopen64 (wave_name, "rb")) == NULL || (cfp = fopen64 (tmp_name, "wb")) == NULL)
+    {
+      fprintf (stderr, "Error opening %s or %s :\n%s\n", wave_name, tmp_name, strerror (errno));
+      if (wfp) fclose (wfp);
+      wdc_list_close (&list);
+      return (-5);
+    }
+
+  fseeko64 (wfp, 0, SEEK_END);
+  uint64_t wdp_size = ftello64 (wfp);
+
+
+  uint8_t head[SLAS_WDC_HEADER_SIZE];
+  memset (head, 0, SLAS_WDC_HEADER_SIZE);
+  fwrite (head, SLAS_WDC_HEADER_SIZE, 1, cfp);
+
+
+  //  Compress the blocks in batches.  The packets for a batch are read (in offset order) by this thread, the blocks are
+  //  compressed in parallel, and then they're written in order.  Every batch but the last is a whole number of blocks.
+
+  uint64_t batch_blocks = (uint64_t) nthreads * WDC_BLOCKS_PER_THREAD;
+  std::vector<WDC_PACKET> packets;
+  std::vector<SLAS_WDC_BLOCK> table;
+  std::vector<uint8_t> batch;
+  std::vector<std::vector<uint8_t> > out (batch_blocks);
+  uint64_t file_offset = SLAS_WDC_HEADER_SIZE, npackets = 0, nblocks = 0;
+  int32_t percent = -1;
+
+  while (!status)
+    {
+      packets.clear ();
+      wdc_list_next (&list, packets, batch_blocks * SLAS_WDC_PACKETS_PER_BLOCK);
+
+      if (packets.empty ()) break;
+
+      uint64_t blocks = (packets.size () + SLAS_WDC_PACKETS_PER_BLOCK - 1) / SLAS_WDC_PACKETS_PER_BLOCK;
+
+
+      //  Read the raw packets.
+
+      uint64_t bytes = 0;
+      for (size_t i = 0 ; i < packets.size () ; i++)
+        {
+          packets[i].raw = bytes;
+          bytes += packets[i].size;
+        }
+
+      batch.resize (bytes);
+
+      for (size_t i = 0 ; i < packets.size () && !status ; i++)
+        {
+          if (fseeko64 (wfp, packets[i].offset, SEEK_SET) < 0 || !fread (&batch[packets[i].raw], packets[i].size, 1, wfp))
+            {
+              fprintf (stderr, "Error reading waveform packet at %" PRIu64 " :\n%s\n", packets[i].offset, strerror (errno));
+              status = -6;
+            }
+        }
+
+      if (status) break;
+
+
+      std::atomic<uint64_t> next (0);
+      std::vector<std::thread> threads;
+
+      for (int32_t t = 0 ; t < nthreads ; t++)
+        {
+          threads.push_back (std::thread ([&] ()
+            {
+              uint64_t b;
+
+              while ((b = next++) < blocks)
+                {
+                  uint64_t q0 = b * SLAS_WDC_PACKETS_PER_BLOCK;
+                  uint64_t q1 = std::min ((uint64_t) packets.size (), q0 + SLAS_WDC_PACKETS_PER_BLOCK);
+
+                  wdc_encode_block (batch.data (), &packets[q0], (int32_t) (q1 - q0), out[b]);
+                }
+            }));
+        }
+
+      for (size_t t = 0 ; t < threads.size () ; t++) threads[t].join ();
+
+
+      for (uint64_t b = 0 ; b < blocks ; b++)
+        {
+          SLAS_WDC_BLOCK entry;
+
+          entry.wdp_offset = packets[b * SLAS_WDC_PACKETS_PER_BLOCK].offset;
+          entry.offset = file_offset;
+          table.push_back (entry);
+
+          if (!fwrite (out[b].data (), out[b].size (), 1, cfp))
+            {
+              fprintf (stderr, "Error writing %s :\n%s\n", tmp_name, strerror (errno));
+              status = -7;
+              break;
+            }
+
+          file_offset += out[b].size ();
+        }
+
+      npackets += packets.size ();
+      nblocks += blocks;
+
+
+      //  We don't know how many packets there are until the merge is done so the progress is by .wdp offset.
+
+      int32_t new_percent = wdp_size ? (int32_t) (packets.back ().offset * 100 / wdp_size) : 100;
+
+      if (new_percent != percent)
+        {
+          percent = new_percent;
+          fprintf (stdout, "%s : %03d%% compressed\r", wdc_name, percent);
+          fflush (stdout);
+        }
+    }
+
+  wdc_list_close (&list);
+  fclose (wfp);
+
+
+  //  Write the block table (with an end entry) and the header.
+
+  SLAS_WDC_BLOCK end;
+  end.wdp_offset = wdp_size;
+  end.offset = file_offset;
+  table.push_back (end);
+
+  for (size_t i = 0 ; i < table.size () && !status ; i++)
+    {
+      uint8_t entry[16];
+
+      wdc_put_u64 (&entry[0], table[i].wdp_offset);
+      wdc_put_u64 (&entry[8], table[i].offset);
+
+      if (!fwrite (entry, 16, 1, cfp)) status = -7;
+    }
+
+  memcpy (head, SLAS_WDC_MAGIC, 8);
+  wdc_put_u32 (&head[8], 1);
+  wdc_put_u32 (&head[12], SLAS_WDC_PACKETS_PER_BLOCK);
+  wdc_put_u64 (&head[16], npackets);
+  wdc_put_u64 (&head[24], nblocks);
+  wdc_put_u64 (&head[32], file_offset);
+  wdc_put_u64 (&head[40], wdp_size);
+
+  if (!status && (fseeko64 (cfp, 0, SEEK_SET) < 0 || !fwrite (head, SLAS_WDC_HEADER_SIZE, 1, cfp))) status = -7;
+
+  if (fclose (cfp)) status = -7;
+
+
+  if (status)
+    {
+      remove (tmp_name);
+      return (status);
+    }
+
+
+  remove (wdc_name);
+
+  if (rename (tmp_name, wdc_name))
+    {
+      fprintf (stderr, "Error renaming %s to %s\n", tmp_name, wdc_name);
+      return (-8);
+    }
+
+
+  fprintf (stdout, "%s : %" PRIu64 " packets, %" PRIu64 " bytes (%.1f%% of %" PRIu64 ")\n", wdc_name, npackets, file_offset,
+           wdp_size ? 100.0 * (double) file_offset / (double) wdp_size : 0.0, wdp_size);
+  fflush (stdout);
+
+
+  return (0);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_wdc_open
+
+ - Purpose:     Open a compressed waveform (.wdc) file and read its block table.
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - wdc_name       =    The .wdc file name
+
+ - Returns:     SLAS_WDC *       =    The handle (close it with slas_wdc_close) or NULL on
+                                      error
+
+*********************************************************************************************/
+
+SLAS_WDC *slas_wdc_open (const char *wdc_name)
+{
+  uint8_t head[SLAS_WDC_HEADER_SIZE];
+  FILE *fp;
+
+
+  if ((fp = fopen64 (wdc_name, "rb")) == NULL) return (NULL);
+
+  if (!fread (head, SLAS_WDC_HEADER_SIZE, 1, fp) || memcmp (head, SLAS_WDC_MAGIC, 8) || wdc_get_u32 (&head[8]) != 1)
+    {
+      fclose (fp);
+      return (NULL);
+    }
+
+
+  SLAS_WDC *wdc = new SLAS_WDC;
+
+  wdc->fp = fp;
+  wdc->number_of_packets = wdc_get_u64 (&head[16]);
+  wdc->wdp_size = wdc_get_u64 (&head[40]);
+  wdc->cached_block = -1;
+
+  uint64_t nblocks = wdc_get_u64 (&head[24]);
+  std::vector<uint8_t> table ((nblocks + 1) * 16);
+
+  if (fseeko64 (fp, wdc_get_u64 (&head[32]), SEEK_SET) < 0 || !fread (table.data (), table.size (), 1, fp))
+    {
+      slas_wdc_close (wdc);
+      return (NULL);
+    }
+
+  wdc->blocks.resize (nblocks + 1);
+
+  for (uint64_t i = 0 ; i <= nblocks ; i++)
+    {
+      wdc->blocks[i].wdp_offset = wdc_get_u64 (&table[i * 16]);
+      wdc->blocks[i].offset = wdc_get_u64 (&table[i * 16 + 8]);
+    }
+
+
+  return (wdc);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_wdc_read_packet
+
+ - Purpose:     Read and decompress one waveform packet.  The block that holds it is read
+                with a single read and kept (the next packet is usually in the same block).
+                This may be called from more than one thread.
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - wdc            =    The handle from slas_wdc_open
+                - offset         =    Absolute offset of the packet in the .wdp file
+                                      (start_of_waveform_data_packet_record +
+                                      byte_offset_to_waveform_data)
+                - size           =    The waveform packet size.  If records that share an
+                                      offset have different sizes the largest is stored so
+                                      a smaller size gets the start of that packet.
+                - data           =    The returned raw packet (size bytes)
+
+ - Returns:     int32_t          =    Negative number on error, 0 on success
+
+*********************************************************************************************/
+
+int32_t slas_wdc_read_packet (SLAS_WDC *wdc, uint64_t offset, uint32_t size, uint8_t *data)
+{
+  if (wdc->blocks.size () < 2) return (-1);
+
+
+  //  Find the last block that starts at or before offset.
+
+  std::vector<SLAS_WDC_BLOCK>::iterator it = std::upper_bound (wdc->blocks.begin (), wdc->blocks.end () - 1, offset,
+                                                               [] (uint64_t value, const SLAS_WDC_BLOCK &b) {return value < b.wdp_offset;});
+
+  if (it == wdc->blocks.begin ()) return (-1);
+
+  int64_t block = (it - wdc->blocks.begin ()) - 1;
+
+
+  std::unique_lock<std::mutex> lock (wdc->mutex);
+
+  if (block != wdc->cached_block)
+    {
+      uint64_t size = wdc->blocks[block + 1].offset - wdc->blocks[block].offset;
+
+      wdc->cached_block = -1;
+      wdc->cache.assign (size + WDC_PADDING, 0);
+
+      if (fseeko64 (wdc->fp, wdc->blocks[block].offset, SEEK_SET) < 0 || !fread (wdc->cache.data (), size, 1, wdc->fp))
+        {
+          fprintf (stderr, "Error reading compressed waveform block :\n%s\nFunction: %s, Line: %d\n", strerror (errno), __FUNCTION__, __LINE__);
+          fflush (stderr);
+          return (-2);
+        }
+
+      slas_metrics_add (SLAS_METRIC_WAVE_BYTES, size);
+
+      wdc->cached_block = block;
+    }
+
+
+  //  Walk the entries to find the packet.
+
+  const uint8_t *p = wdc->cache.data ();
+  const uint8_t *end = p + wdc->cache.size () - WDC_PADDING;
+  uint64_t count = wdc_get_varint (p, end);
+  uint64_t prev_end = wdc->blocks[block].wdp_offset;
+  uint64_t payload = 0;
+
+  uint64_t entry[5] = {0, 0, 0, 0, 0};
+  int64_t found = -1;
+  uint64_t found_payload = 0;
+
+  for (uint64_t i = 0 ; i < count && p < end ; i++)
+    {
+      uint64_t pkt_offset = prev_end + wdc_unzigzag (wdc_get_varint (p, end));
+      uint64_t raw_size = wdc_get_varint (p, end);
+      uint64_t comp_size = wdc_get_varint (p, end);
+      uint64_t samples = wdc_get_varint (p, end);
+      uint8_t bits = *p++;
+      uint8_t mode = *p++;
+
+      if (found < 0 && pkt_offset == offset)
+        {
+          found = i;
+          found_payload = payload;
+          entry[0] = raw_size;
+          entry[1] = comp_size;
+          entry[2] = samples;
+          entry[3] = bits;
+          entry[4] = mode;
+        }
+
+      payload += comp_size;
+      prev_end = pkt_offset + raw_size;
+    }
+
+  if (found < 0 || entry[0] < size || p + found_payload + entry[1] > end) return (-3);
+
+
+  //  Copy the packet out so it can be decoded without holding the lock.  The bit reader looks ahead so it's padded.
+
+  thread_local std::vector<uint8_t> comp;
+
+  comp.resize (entry[1] + WDC_PADDING);
+  memcpy (comp.data (), p + found_payload, entry[1]);
+  memset (comp.data () + entry[1], 0, WDC_PADDING);
+
+  lock.unlock ();
+
+
+  if (entry[0] == size) return (wdc_decode_packet (comp.data (), entry[1], entry[0], entry[2], entry[3], entry[4], data) < 0 ? -4 : 0);
+
+
+  //  The stored packet is bigger than the one this record asked for so we return the start of it.
+
+  thread_local std::vector<uint8_t> raw;
+
+  raw.resize (entry[0]);
+
+  if (wdc_decode_packet (comp.data (), entry[1], entry[0], entry[2], entry[3], entry[4], raw.data ()) < 0) return (-4);
+
+  memcpy (data, raw.data (), size);
+
+  return (0);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_wdc_read_waveform_data
+
+ - Purpose:     Retrieve a LAS waveform record from a compressed waveform (.wdc) file.  This is
+                the .wdc version of slas_read_waveform_data.
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - wdc            =    The handle from slas_wdc_open
+                - lasheader      =    The SLAS_HEADER retrieved from the LAS file
+                - record         =    The Simple LAS point data record for which waveform data
+                                      is to be retrieved
+                - wave           =    The waveform samples (resized to fit)
+
+ - Returns:     int32_t          =    Negative number on error, 0 on success
+
+*********************************************************************************************/
+
+int32_t slas_wdc_read_waveform_data (SLAS_WDC *wdc, SLAS_HEADER *lasheader, SLAS_POINT_DATA *record, SLAS_SAMPLES *wave)
+{
+  SLAS_WAVEFORM_PACKET_DESCRIPTOR *desc = &lasheader->wf_packet_desc[record->wavepacket_descriptor_index];
+
+  return (slas_wdc_read_waveform_range (wdc, lasheader, record, 0, desc->number_of_samples, wave));
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_wdc_read_waveform_range
+
+ - Purpose:     Retrieve part of a LAS waveform record from a compressed waveform (.wdc) file.
+                This is the .wdc version of slas_read_waveform_range.  The whole packet has to
+                be decompressed but only the samples in the range are unpacked.
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - wdc            =    The handle from slas_wdc_open
+                - lasheader      =    The SLAS_HEADER retrieved from the LAS file
+                - record         =    The Simple LAS point data record for which waveform data
+                                      is to be retrieved
+                - first          =    The first sample to retrieve
+                - count          =    The number of samples to retrieve (clipped to the end of
+                                      the waveform)
+                - wave           =    The waveform samples (resized to fit)
+
+ - Returns:     int32_t          =    Negative number on error, 0 on success
+
+*********************************************************************************************/
+
+int32_t slas_wdc_read_waveform_range (SLAS_WDC *wdc, SLAS_HEADER *lasheader, SLAS_POINT_DATA *record, uint32_t first, uint32_t count,
+                                      SLAS_SAMPLES *wave)
+{
+  SLAS_WAVEFORM_PACKET_DESCRIPTOR *desc = &lasheader->wf_packet_desc[record->wavepacket_descriptor_index];
+
+
+  if (first >= desc->number_of_samples || !count) return (-3);
+
+  if (count > desc->number_of_samples - first) count = desc->number_of_samples - first;
+
+  if (((uint64_t) desc->number_of_samples * desc->bits_per_sample + 7) / 8 > record->waveform_packet_size) return (-4);
+
+
+  std::vector<uint8_t> wave_data (record->waveform_packet_size);
+
+  int32_t status = slas_wdc_read_packet (wdc, lasheader->start_of_waveform_data_packet_record + record->byte_offset_to_waveform_data,
+                                         record->waveform_packet_size, wave_data.data ());
+
+  if (status < 0) return (status);
+
+
+  slas_unpack_waveform_range (wave_data.data (), desc, (int64_t) first * desc->bits_per_sample, count, wave);
+
+
+  return (0);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slas_wdc_close
+
+ - Purpose:     Close a compressed waveform (.wdc) file.
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - wdc            =    The handle (may be NULL)
+
+ - Returns:     void
+
+*********************************************************************************************/
+
+void slas_wdc_close (SLAS_WDC *wdc)
+{
+  if (wdc == NULL) return;
+
+  fclose (wdc->fp);
+  delete wdc;
+}
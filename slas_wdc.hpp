@@ -0,0 +1,122 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! or / / ! are being used by Doxygen to
+    document the software.  Dashes in these comment blocks are used to create bullet lists.
+    The lack of blank lines after a block of dash preceeded comments means that the next
+    block of dash preceeded comments is a new, indented bullet list.  I've tried to keep the
+    Doxygen formatting to a minimum but there are some other items (like <br> and <pre>)
+    that need to be left alone.  If you see a comment that starts with / * ! or / / ! and
+    there is something that looks a bit weird it is probably due to some arcane Doxygen
+    syntax.  Be very careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+/*  Compressed waveform (.wdc) file definitions.  */
+
+#ifndef __SLAS_WDC_HPP__
+#define __SLAS_WDC_HPP__
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/types.h>
+
+#include <vector>
+#include <mutex>
+
+#include "slas.hpp"
+
+
+#define SLAS_WDC_MAGIC                "SLASWDC1"
+#define SLAS_WDC_HEADER_SIZE          64
+#define SLAS_WDC_PACKETS_PER_BLOCK    64       //!<  Packets in each randomly accessible block
+#define SLAS_WDC_MAX_THREADS          32
+#define SLAS_WDC_DEFAULT_MEMORY       256      //!<  Megabytes for the converter's packet list
+
+
+/*!  A .wdc file holds the waveform packets of a .wdp file (only the ones used by the LAS file's point records) losslessly
+     compressed.  Each packet is unpacked into samples (using its waveform packet descriptor), delta coded, zigzag mapped,
+     and Rice coded with a per packet parameter.  Packets that don't compress (or don't unpack and repack to exactly the
+     same bytes) are stored raw.  The packets are stored in .wdp offset order in blocks of SLAS_WDC_PACKETS_PER_BLOCK.
+     The block offset table at the end of the file lets us read any packet (by its .wdp offset) with one read of its
+     block.  All values are little endian.
+
+     <pre>
+     Header (SLAS_WDC_HEADER_SIZE bytes):
+         char[8]     SLAS_WDC_MAGIC
+         uint32_t    version (1)
+         uint32_t    packets per block
+         uint64_t    number of packets
+         uint64_t    number of blocks
+         uint64_t    offset of the block table
+         uint64_t    size of the .wdp file that was compressed
+
+     Block:
+         varint      number of packets
+         packet entries (all varints but bits and mode):
+             .wdp offset (delta from the end of the previous packet in the block or, for the first packet, the
+             block's .wdp offset from the block table), raw size, compressed size, number of samples, uint8_t bits per
+             sample, uint8_t mode (0 = raw, 1 = Rice coded deltas, Rice parameter in the upper 6 bits)
+         packet payloads in entry order
+
+     Block table (number of blocks + 1 entries, the last one is the end of the last block):
+         uint64_t    .wdp offset of the first packet in the block
+         uint64_t    file offset of the block
+     </pre>  */
+
+typedef struct
+{
+  uint64_t                    wdp_offset;
+  uint64_t                    offset;
+} SLAS_WDC_BLOCK;
+
+
+typedef struct
+{
+  FILE                        *fp;
+  uint64_t                    number_of_packets;
+  uint64_t                    wdp_size;
+  std::vector<SLAS_WDC_BLOCK> blocks;
+  std::mutex                  mutex;          //!<  Protects fp and the cached block
+  int64_t                     cached_block;   //!<  The last block read (-1 if none)
+  std::vector<uint8_t>        cache;
+} SLAS_WDC;
+
+
+void slas_wdc_file_name (const char *las_name, char *wdc_name);
+int32_t slas_wdc_convert (const char *las_name, uint8_t swap, int32_t nthreads, int64_t memory);
+SLAS_WDC *slas_wdc_open (const char *wdc_name);
+int32_t slas_wdc_read_packet (SLAS_WDC *wdc, uint64_t offset, uint32_t size, uint8_t *data);
+int32_t slas_wdc_read_waveform_data (SLAS_WDC *wdc, SLAS_HEADER *lasheader, SLAS_POINT_DATA *record, SLAS_SAMPLES *wave);
+int32_t slas_wdc_read_waveform_range (SLAS_WDC *wdc, SLAS_HEADER *lasheader, SLAS_POINT_DATA *record, uint32_t first, uint32_t count,
+                                      SLAS_SAMPLES *wave);
+void slas_wdc_close (SLAS_WDC *wdc);
+
+
+#endif
@@ -0,0 +1,392 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! or / / ! are being used by Doxygen to
+    document the software.  Dashes in these comment blocks are used to create bullet lists.
+    The lack of blank lines after a block of dash preceeded comments means that the next
+    block of dash preceeded comments is a new, indented bullet list.  I've tried to keep the
+    Doxygen formatting to a minimum but there are some other items (like <br> and <pre>)
+    that need to be left alone.  If you see a comment that starts with / * ! or / / ! and
+    there is something that looks a bit weird it is probably due to some arcane Doxygen
+    syntax.  Be very careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+#include "slaz.hpp"
+#include "slas_metrics.hpp"
+#include "nvutility.hpp"
+
+#include <QtCore>
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slaz_is_laz
+
+ - Purpose:     Check the file name extension to see if this is a LAZ (compressed) file.
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - filename       =    The LAS/LAZ file name
+
+ - Returns:     uint8_t          =    NVTrue if the file is compressed, otherwise NVFalse
+
+*********************************************************************************************/
+
+uint8_t slaz_is_laz (const char *filename)
+{
+  int32_t len = strlen (filename);
+
+  if (len < 4) return (NVFalse);
+
+  if (!strcasecmp (&filename[len - 4], ".laz")) return (NVTrue);
+
+  return (NVFalse);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slaz_copy_point
+
+ - Purpose:     Move the contents of a LASlib LASpoint into a Simple LAS point data record.
+                The raw (unscaled) values are used for the fields that slas_read_point_data
+                returns raw so that the two paths are interchangeable.
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - point          =    The LASpoint from the LASreader
+                - format         =    LAS point data format
+                - record         =    The returned Simple LAS point data record
+
+ - Returns:     void
+
+*********************************************************************************************/
+
+static void slaz_copy_point (LASpoint *point, uint8_t format, SLAS_POINT_DATA *record)
+{
+  memset (record, 0, sizeof (SLAS_POINT_DATA));
+
+  record->x = point->get_x ();
+  record->y = point->get_y ();
+  record->z = (float) point->get_z ();
+  record->intensity = point->intensity;
+  record->scan_direction_flag = point->scan_direction_flag;
+  record->edge_of_flightline = point->edge_of_flight_line;
+  record->user_data = point->user_data;
+  record->point_source_id = point->point_source_ID;
+
+
+  //  Check for point format ID above 5.
+
+  if (format > 5)
+    {
+      record->return_number = point->extended_return_number;
+      record->number_of_returns = point->extended_number_of_returns;
+      record->scanner_channel = point->extended_scanner_channel;
+      record->classification = point->extended_classification;
+      record->scan_angle = point->extended_scan_angle;
+      record->synthetic = point->extended_classification_flags & 0x01;
+      record->keypoint = (point->extended_classification_flags & 0x02) >> 1;
+      record->withheld = (point->extended_classification_flags & 0x04) >> 2;
+      record->overlap = (point->extended_classification_flags & 0x08) >> 3;
+    }
+  else
+    {
+      record->return_number = point->return_number;
+      record->number_of_returns = point->number_of_returns;
+      record->classification = point->classification;
+      record->scan_angle = point->scan_angle_rank;
+      record->synthetic = point->synthetic_flag;
+      record->keypoint = point->keypoint_flag;
+      record->withheld = point->withheld_flag;
+      record->overlap = 0;
+    }
+
+
+  if (format != 0 && format != 2) record->gps_time = point->gps_time;
+
+
+  if (format == 2 || format == 3 || format == 5 || format == 7 || format == 8 || format == 10)
+    {
+      record->red = point->rgb[0];
+      record->green = point->rgb[1];
+      record->blue = point->rgb[2];
+    }
+
+  if (format == 8 || format == 10) record->NIR = point->rgb[3];
+
+
+  if (format == 4 || format == 5 || format == 9 || format == 10)
+    {
+      record->wavepacket_descriptor_index = point->wavepacket.getIndex ();
+      record->byte_offset_to_waveform_data = point->wavepacket.getOffset ();
+      record->waveform_packet_size = point->wavepacket.getSize ();
+      record->return_point_waveform_location = point->wavepacket.getLocation ();
+      record->Xt = point->wavepacket.getXt ();
+      record->Yt = point->wavepacket.getYt ();
+      record->Zt = point->wavepacket.getZt ();
+    }
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slaz_open
+
+ - Purpose:     Open a LAZ file for random point access.  The LASzip chunk table is used by
+                LASlib to seek directly to the chunk that holds a requested point.  We keep a
+                small LRU cache of decompressed chunks so that cursor moves within the same
+                chunk don't have to pay for decompression again.
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - filename       =    The LAZ file name
+
+ - Returns:     SLAZ_HANDLE *    =    The handle or NULL on error
+
+*********************************************************************************************/
+
+SLAZ_HANDLE *slaz_open (const char *filename)
+{
+  LASreadOpener lasreadopener;
+  SLAZ_HANDLE   *handle;
+
+
+  lasreadopener.set_file_name (filename);
+
+  LASreader *lasreader = lasreadopener.open ();
+  if (!lasreader)
+    {
+      fprintf (stderr, "Error opening LAZ file %s :\n%s\nFunction: %s, Line: %d\n", filename, strerror (errno),  __FUNCTION__, __LINE__);
+      fflush (stderr);
+      return (NULL);
+    }
+
+
+  try
+    {
+      handle = new SLAZ_HANDLE;
+    }
+  catch (std::bad_alloc&)
+    {
+      fprintf (stderr, "Error allocating LAZ handle :\nFunction: %s, Line: %d\n", __FUNCTION__, __LINE__);
+      fflush (stderr);
+      lasreader->close ();
+      delete lasreader;
+      return (NULL);
+    }
+
+
+  strcpy (handle->filename, filename);
+  handle->lasreader = lasreader;
+  handle->point_data_format = lasreader->header.point_data_format;
+  handle->number_of_points = lasreader->npoints;
+  handle->tick = 0;
+  handle->hits = 0;
+  handle->misses = 0;
+
+
+  //  Variable sized chunks (chunk_size == U32_MAX) have no fixed boundaries so we just cache fixed sized blocks of
+  //  points.  LASlib will still use the chunk table to find the chunk that contains the start of the block.
+
+  handle->chunk_size = SLAZ_DEFAULT_CHUNK_SIZE;
+  if (lasreader->header.laszip && lasreader->header.laszip->chunk_size && lasreader->header.laszip->chunk_size != 0xffffffff)
+    handle->chunk_size = lasreader->header.laszip->chunk_size;
+
+
+  for (int32_t i = 0 ; i < SLAZ_CACHE_CHUNKS ; i++)
+    {
+      handle->chunk[i].chunk = -1;
+      handle->chunk[i].last_used = 0;
+    }
+
+
+  return (handle);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slaz_read_point_data
+
+ - Purpose:     Retrieve a LAZ point data record.  If the chunk containing the record is in
+                the cache we just copy it out, otherwise we decompress the entire chunk into
+                the least recently used cache slot.
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - handle         =    The handle returned by slaz_open
+                - recnum         =    The record number of the LAS point data record to be
+                                      retrieved (records start at 0)
+                - record         =    The returned Simple LAS point data record
+
+ - Returns:     int32_t          =    Negative number on error, 0 on success
+
+*********************************************************************************************/
+
+int32_t slaz_read_point_data (SLAZ_HANDLE *handle, uint64_t recnum, SLAS_POINT_DATA *record)
+{
+  //  Check for record out of bounds.
+
+  if (recnum >= handle->number_of_points)
+    {
+      fprintf (stderr, "Record number %" PRIu64 " out of range :\nFunction: %s, Line: %d\n", recnum,  __FUNCTION__, __LINE__);
+      fflush (stderr);
+      return (-1);
+    }
+
+
+  int64_t chunk = recnum / handle->chunk_size;
+  int64_t ndx = recnum % handle->chunk_size;
+
+
+  handle->tick++;
+
+
+  //  Check the cache first.
+
+  int32_t lru = 0;
+  for (int32_t i = 0 ; i < SLAZ_CACHE_CHUNKS ; i++)
+    {
+      if (handle->chunk[i].chunk == chunk)
+        {
+          handle->chunk[i].last_used = handle->tick;
+          handle->hits++;
+          slas_metrics_add (SLAS_METRIC_LAZ_HITS, 1);
+          *record = handle->chunk[i].points[ndx];
+          return (0);
+        }
+
+      if (handle->chunk[i].last_used < handle->chunk[lru].last_used) lru = i;
+    }
+
+
+  //  Cache miss, decompress the chunk into the least recently used slot.
+
+  handle->misses++;
+  slas_metrics_add (SLAS_METRIC_LAZ_MISSES, 1);
+
+  SLAZ_CHUNK *slot = &handle->chunk[lru];
+  slot->chunk = -1;
+
+
+  uint64_t start = chunk * handle->chunk_size;
+  uint64_t count = handle->chunk_size;
+  if (start + count > handle->number_of_points) count = handle->number_of_points - start;
+
+
+  if (!handle->lasreader->seek (start))
+    {
+      fprintf (stderr, "Error seeking in LAZ file %s :\nFunction: %s, Line: %d\n", handle->filename, __FUNCTION__, __LINE__);
+      fflush (stderr);
+      return (-2);
+    }
+
+
+  try
+    {
+      slot->points.resize (count);
+    }
+  catch (std::bad_alloc&)
+    {
+      fprintf (stderr, "Error allocating LAZ chunk :\nFunction: %s, Line: %d\n", __FUNCTION__, __LINE__);
+      fflush (stderr);
+      return (-3);
+    }
+
+
+  for (uint64_t i = 0 ; i < count ; i++)
+    {
+      if (!handle->lasreader->read_point ())
+        {
+          fprintf (stderr, "Error decompressing LAZ record %" PRIu64 " in file %s :\nFunction: %s, Line: %d\n", start + i, handle->filename,
+                   __FUNCTION__, __LINE__);
+          fflush (stderr);
+          return (-4);
+        }
+
+      slaz_copy_point (&handle->lasreader->point, handle->point_data_format, &slot->points[i]);
+    }
+
+
+  slot->chunk = chunk;
+  slot->last_used = handle->tick;
+
+  *record = slot->points[ndx];
+
+
+  return (0);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    slaz_close
+
+ - Purpose:     Close the LAZ file and free the chunk cache.
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - handle         =    The handle returned by slaz_open
+
+ - Returns:     void
+
+*********************************************************************************************/
+
+void slaz_close (SLAZ_HANDLE *handle)
+{
+  if (!handle) return;
+
+  handle->lasreader->close ();
+  delete handle->lasreader;
+
+  delete handle;
+}
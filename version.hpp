@@ -37,7 +37,7 @@
 
 #ifndef VERSION
 
-#define     VERSION     "PFM Software - LASwaveMonitor V1.18 - 06/23/17"
+#define     VERSION     "PFM Software - LASwaveMonitor V1.43 - 10/19/26"
 
 #endif
 
@@ -129,4 +129,252 @@
 
     -  Removed redundant functions from slas.cpp that are available in the nvutility library.
 
+
+    Version 1.19
+    PFM Software
+    10/19/26
+
+    - Added support for LAZ (compressed) point files.  Points are read through LASlib using the LAZ chunk
+      table and the most recently used decompressed chunks are cached so that cursor moves within a chunk
+      don't have to decompress again.  Waveforms must be in an external .wdp file.
+
+
+    Version 1.20
+    PFM Software
+    10/19/26
+
+    - Replaced the LASreadOpener open in trackCursor with slas_read_header in slas.cpp.  It only reads the
+      public header block, the waveform packet descriptor VLRs, and the LAS 1.4 EVLR pointers into a compact
+      SLAS_HEADER structure.  The waveform packet descriptors are now part of SLAS_HEADER.
+
+
+    Version 1.21
+    PFM Software
+    10/19/26
+
+    - Added slas_batch_fetch_waveforms for batched waveform retrieval.  Packet reads are sorted by offset and
+      issued through io_uring (when built with liburing) or a pread thread pool at a configurable queue depth.
+      Decoded waveforms are delivered through a callback as they complete.
+
+
+    Version 1.22
+    PFM Software
+    10/19/26
+
+    - Record numbers are now 64 bit all the way through trackCursor, the LAZ chunk cache, and the batch
+      waveform fetch.  The ABE_SHARE record number is treated as unsigned so records past 2^31 can be reached.
+
+
+    Version 1.23
+    PFM Software
+    10/19/26
+
+    - Added field mask decoding of point records (slas_decode_point_data and slas_read_point_fields).  Only the
+      requested fields are decoded and byte swapped, and the common masks have their own compiled decoders.
+      The batch waveform fetch only decodes the fields the caller asks for.
+    - Fixed the LAS 1.4 classification flags (synthetic, keypoint, withheld, overlap) which were always 0, and
+      the LAS 1.3 scan angle rank which was not sign extended.
+
+
+    Version 1.24
+    PFM Software
+    10/19/26
+
+    - Files that fail to open (missing LAS or .wdp files, bad headers, unsupported versions) are now kept in a
+      negative cache.  They are only checked again (with a single stat) after an exponentially increasing
+      interval, or immediately if they appear or change.  All failures are shown in a single error panel.
+
+
+    Version 1.25
+    PFM Software
+    10/19/26
+
+    - At startup the LAS files in the PFM list file(s) are cataloged in the background.  Headers and waveform
+      packet descriptors are read in parallel (or taken from a cache file in ABE.config if the files haven't
+      changed) so the first cursor hit on a file doesn't have to read its header.  Files that can't be read are
+      reported right away in the error panel.
+
+
+    Version 1.26
+    PFM Software
+    10/19/26
+
+    - Decoded waveform samples are now stored in SLAS_SAMPLES (slas_samples.hpp) which uses the narrowest type
+      that holds the descriptor's bits_per_sample (1, 2, or 4 bytes per sample) instead of always using uint32_t.
+      Kernels can use slas_dispatch_samples to run on the typed samples without copying them.
+
+
+    Version 1.27
+    PFM Software
+    10/19/26
+
+    - Added zooming to the waveform display.  Left click zooms in around the clicked sample, right click zooms
+      out, middle click shows the whole waveform, and the arrow/page keys pan through the waveform when zoomed.  Only the
+      samples in the zoom window are read from the file (slas_read_waveform_range in slas.cpp).
+    - Fixed the sample and amplitude axes which were drawn with each other's lengths.
+
+
+    Version 1.28
+    PFM Software
+    10/19/26
+
+    - Added slas_block.cpp which loads waveforms that share a waveform packet descriptor into a 64 byte aligned,
+      row major, zero padded matrix (SLAS_BLOCK) with the record number, GPS time, and return location for each row.  The
+      rows are filled by the batch waveform fetch.
+
+
+    Version 1.29
+    PFM Software
+    10/19/26
+
+    - Added a tail mode (--tail) for LAS and .wdp files that are still being written.  When the record (or its
+      waveform) hasn't been written yet the monitor shows "Waiting for record" and watches the files (file system
+      notification plus a stat every half second).  When they grow, only the point counts of the cached header are updated
+      (slas_refresh_point_count and slas_catalog_extend) and the record is read again.
+
+
+    Version 1.30
+    PFM Software
+    10/19/26
+
+    - Added a batch (command line) mode (LASwaveMonitor --batch MODE ...) in batch.cpp.  The first mode is rewrite
+      which uses slas_rewrite (slas_rewrite.cpp) to write a new LAS/.wdp pair with the waveform packets in point record order
+      (or Hilbert curve order with --hilbert) and duplicate packets removed.  Point record order doesn't change so PFM
+      record numbers are still good.  It streams in bounded memory (--memory) using external sorts.
+
+
+    Version 1.31
+    PFM Software
+    10/19/26
+
+    - Added a compressed waveform file (.wdc, slas_wdc.cpp) that can be used in place of the .wdp file.  Each packet's
+      samples are delta coded and Rice coded (packets that don't get smaller are stored as is), 64 packets to a block, with a
+      block offset table for random access.  LASwaveMonitor --batch compress LAS... converts the .wdp file using multiple
+      threads.  The monitor and the batch waveform fetch read the .wdc file when there is no .wdp file.
+
+
+    Version 1.32
+    PFM Software
+    10/19/26
+
+    - Added a decoded waveform cache in shared memory (slas_shared_cache.cpp) that is shared by every waveform monitor
+      on the machine.  Waveforms are keyed by file and record number so one read serves every window.  Nothing ever locks
+      the cache (per-slot sequence numbers are used instead) so a monitor that dies can't hang the others.
+
+
+    Version 1.33
+    PFM Software
+    10/19/26
+
+    - Added an optional record change ring (record_ring.cpp) in a second shared memory segment next to ABE_SHARE.  The
+      parent program can queue every record change and the monitor drains them in batches.  The records that the cursor
+      passed over are decoded into the shared waveform cache in the background.  The display still shows the ABE_SHARE
+      record.  If there is no ring, or it overflows, nothing changes.
+
+
+    Version 1.34
+    PFM Software
+    10/19/26
+
+    - Added the qc and extract batch modes.  They are split into shards of point records (batch_shard.cpp) that any
+      number of local processes (--jobs) or hosts sharing the shard directory can claim with O_EXCL lock files.  Shards
+      claimed by a process that died are taken over once the claim is stale.  The last process to finish merges the
+      shard outputs in order, so the output doesn't depend on who did what.
+
+
+    Version 1.35
+    PFM Software
+    10/19/26
+
+    - The qc and extract shards are now checkpointed (--checkpoint) so a shard that was interrupted is picked up from its
+      last checkpoint instead of being started over.  Claims held by a dead process on the same host are taken over right
+      away.  Per file and total counts (records, errors, samples, saturated waveforms, and a peak histogram) are written
+      to OUTPUT.summary.
+
+
+    Version 1.36
+    PFM Software
+    10/19/26
+
+    - Added a render batch mode (LASwaveMonitor --batch render) that draws the monitor's waveform plot and status bar
+      attributes for a list of point records on QImages in parallel and writes PNG sheets or a multi-page PDF.  The plot
+      bounds, drawing, and attribute text were moved to wave_plot.cpp so the monitor and the render mode share them.
+
+
+    Version 1.37
+    PFM Software
+    10/19/26
+
+    - Added a persistence display (the new toolbar button).  Each waveform is added to a floating point accumulation
+      buffer that fades with a settable half life (Preferences) and is color mapped from the waveform color to white by
+      how many waveforms cross each pixel.  A frame only costs one fade/color map pass plus the new trace
+      (wave_persist.cpp).  Fade frames are drawn at up to 60 per second after the cursor stops.
+
+
+    Version 1.38
+    PFM Software
+    10/19/26
+
+    - Added an echogram window (the new toolbar button) that shows the waveforms of every point in the current LAS file
+      as columns of an intensity image, in point record or GPS time order, with the current point marked.  The waveforms
+      are streamed through the batch waveform fetch in large sequential batches by a background thread
+      (slas_echogram.cpp) that builds a pyramid of tiles, each level half the resolution of the one below.  The coarse
+      levels are always kept and the fine levels are kept in a bounded LRU cache and rebuilt from the file when they're
+      needed again, so zooming and panning stay interactive on files with tens of millions of points.
+
+
+    Version 1.39
+    PFM Software
+    10/19/26
+
+    - Added a history of the last waveforms that were displayed (wave_history.cpp).  The Left and Right arrow keys step
+      back and forward through it and End goes back to the current point, all without reading anything.  The previous
+      waveforms can be overlaid under the current one in colors that fade toward the background.  The number of
+      waveforms, the memory the history can use, and the number overlaid are set in the Preferences dialog.
+
+
+    Version 1.40
+    PFM Software
+    10/19/26
+
+    - Added a benchmark batch mode (LASwaveMonitor --batch benchmark) that times full offscreen redraws of the waveform
+      plot (axes, tick text, trace, return marker, and the attribute text) for synthetic waveforms of 100 to 20,000
+      samples at several window sizes in line and dot mode, and prints the frame times and frames per second.  It is
+      meant for checking drawing changes and catching slowdowns in the Qt 5 raster path.
+
+
+    Version 1.41
+    PFM Software
+    10/19/26
+
+    - Faster startup.  The ABE shared memory is attached first and the header of the record in ABE_SHARE is read in a
+      thread (and its waveform decoded into the shared waveform cache) while the window is being built.  The What's This
+      help is set up after the window is up, the acknowledgments file is only read when it's needed, and the echogram
+      window isn't made until it's turned on.  The --timing option prints how long each step of startup took once the
+      first waveform has been drawn.
+
+
+    Version 1.42
+    PFM Software
+    10/19/26
+
+    - Added an optional metrics endpoint (--metrics SOCKET_OR_DIRECTORY).  The records displayed and skipped, record
+      ring overflows, shared waveform cache and LAZ chunk cache hits and misses, bytes read, open failures, open files,
+      resident memory, and a record to pixel latency histogram are served in the Prometheus text format on a local (Unix
+      domain) socket.  If a directory is given the socket is LASwaveMonitor_PID.sock in that directory.  Nothing is
+      counted unless --metrics is used.
+
+
+    Version 1.43
+    PFM Software
+    10/19/26
+
+    - Added waveform analytics.  The baseline and noise, the peak amplitude and sub-sample location, the pulse width
+      (FWHM), the energy, and the number of saturated samples of the whole waveform are shown in a new status bar and
+      the baseline, pulse width, peak, and full scale (if saturated) are marked on the plot (clipped to the zoom window).
+      Since the analytics need every sample, the monitor now reads the whole waveform (and puts it in the shared
+      waveform cache) even when zoomed in.  The passes over the samples are vectorized so the analytics take a few
+      microseconds per waveform.
+
+
 </pre>*/
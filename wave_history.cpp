@@ -0,0 +1,267 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! or / / ! are being used by Doxygen to
+    document the software.  Dashes in these comment blocks are used to create bullet lists.
+    The lack of blank lines after a block of dash preceeded comments means that the next
+    block of dash preceeded comments is a new, indented bullet list.  I've tried to keep the
+    Doxygen formatting to a minimum but there are some other items (like <br> and <pre>)
+    that need to be left alone.  If you see a comment that starts with / * ! or / / ! and
+    there is something that looks a bit weird it is probably due to some arcane Doxygen
+    syntax.  Be very careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+#include <algorithm>
+
+#include "wave_history.hpp"
+
+
+
+//  Drop the oldest snapshot.  The header only counts against the memory limit while some snapshot is using it.
+
+static void history_drop_oldest (WAVE_HISTORY *history)
+{
+  WAVE_SNAPSHOT *snap = &history->slot[history->oldest];
+
+  history->bytes -= (int64_t) (sizeof (WAVE_SNAPSHOT) + snap->samples.bytes () + snap->filename.size ());
+  if (snap->header.use_count () == 1) history->bytes -= (int64_t) sizeof (SLAS_HEADER);
+
+
+  //  Swap the samples out (clear would keep the storage).
+
+  SLAS_SAMPLES empty;
+  snap->samples.swap (empty);
+  snap->header.reset ();
+  snap->filename.clear ();
+
+  history->oldest = (history->oldest + 1) % (int32_t) history->slot.size ();
+  history->count--;
+}
+
+
+
+//  Drop the newest snapshot (when it's being replaced by a redraw of the same record).
+
+static void history_drop_newest (WAVE_HISTORY *history)
+{
+  WAVE_SNAPSHOT *snap = &history->slot[(history->oldest + history->count - 1) % (int32_t) history->slot.size ()];
+
+  history->bytes -= (int64_t) (sizeof (WAVE_SNAPSHOT) + snap->samples.bytes () + snap->filename.size ());
+  if (snap->header.use_count () == 1) history->bytes -= (int64_t) sizeof (SLAS_HEADER);
+
+  SLAS_SAMPLES empty;
+  snap->samples.swap (empty);
+  snap->header.reset ();
+  snap->filename.clear ();
+
+  history->count--;
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    wave_history_init
+
+ - Purpose:     Set up (or resize) a waveform history ring.  Any snapshots in it are
+                dropped.
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - history        =    The history ring
+                - size           =    Maximum number of snapshots (1 to
+                                      WAVE_HISTORY_MAX_SIZE)
+                - memory         =    Maximum megabytes used by the snapshots (1 to
+                                      WAVE_HISTORY_MAX_MEMORY)
+
+ - Returns:     N/A
+
+*********************************************************************************************/
+
+void wave_history_init (WAVE_HISTORY *history, int32_t size, int32_t memory)
+{
+  history->size = std::max (1, std::min (size, WAVE_HISTORY_MAX_SIZE));
+  history->max_bytes = (int64_t) std::max (1, std::min (memory, WAVE_HISTORY_MAX_MEMORY)) * 1048576;
+
+  //  The ring starts out empty and grows as snapshots are pushed so a big ring that only ever holds a few snapshots
+  //  (because of the memory limit) doesn't allocate all of them.
+
+  std::vector<WAVE_SNAPSHOT> ().swap (history->slot);
+  history->oldest = 0;
+  history->count = 0;
+  history->bytes = 0;
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    wave_history_push
+
+ - Purpose:     Add a copy of the displayed waveform to the history ring, dropping the
+                oldest snapshots to stay within the ring size and memory limit.  If the
+                newest snapshot is the same record (a zoom change or a redraw) it is
+                replaced.
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - history        =    The history ring
+                - filename       =    LAS file name
+                - recnum         =    ABE record number (records start at 1)
+                - lasheader      =    The SLAS_HEADER of the LAS file
+                - slas           =    The point record
+                - bounds         =    The plot bounds the waveform was drawn with
+                - stats          =    The analytics of the whole waveform
+                - samples        =    The samples (samples[0] is sample bounds->first)
+
+ - Returns:     N/A
+
+*********************************************************************************************/
+
+void wave_history_push (WAVE_HISTORY *history, const char *filename, uint64_t recnum, const SLAS_HEADER *lasheader,
+                        const SLAS_POINT_DATA *slas, const BOUNDS *bounds, const WAVE_STATS *stats, const SLAS_SAMPLES &samples)
+{
+  const WAVE_SNAPSHOT *newest = wave_history_get (history, 0);
+
+  if (newest && newest->recnum == recnum && newest->filename == filename) history_drop_newest (history);
+
+
+  //  Consecutive records almost always come from the same file so they share one copy of the header.
+
+  std::shared_ptr<const SLAS_HEADER> header;
+
+  newest = wave_history_get (history, 0);
+
+  if (newest && !memcmp (newest->header.get (), lasheader, sizeof (SLAS_HEADER)))
+    {
+      header = newest->header;
+    }
+  else
+    {
+      header = std::make_shared<const SLAS_HEADER> (*lasheader);
+    }
+
+
+  int64_t bytes = (int64_t) (sizeof (WAVE_SNAPSHOT) + samples.bytes () + strlen (filename));
+  if (header.use_count () == 1) bytes += (int64_t) sizeof (SLAS_HEADER);
+
+  if (bytes > history->max_bytes) return;
+
+  //  Our reference to a shared header keeps it counted while the older snapshots that use it are dropped (the new
+  //  snapshot takes it over).
+
+  while (history->count && (history->count == history->size || history->bytes + bytes > history->max_bytes))
+    history_drop_oldest (history);
+
+
+  //  If every slot is in use (and there are fewer than size of them) add one.  The ring is rotated first so that the
+  //  oldest snapshot is in the first slot and the new slot is next after the newest.
+
+  if (history->count == (int32_t) history->slot.size ())
+    {
+      std::rotate (history->slot.begin (), history->slot.begin () + history->oldest, history->slot.end ());
+      history->oldest = 0;
+      history->slot.emplace_back ();
+    }
+
+  WAVE_SNAPSHOT *snap = &history->slot[(history->oldest + history->count) % (int32_t) history->slot.size ()];
+
+  snap->filename = filename;
+  snap->recnum = recnum;
+  snap->header = header;
+  snap->slas = *slas;
+  snap->bounds = *bounds;
+  snap->stats = *stats;
+  snap->samples = samples;
+
+  history->count++;
+  history->bytes += bytes;
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    wave_history_get
+
+ - Purpose:     Get a snapshot from the history ring.
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - history        =    The history ring
+                - age            =    0 for the newest snapshot, 1 for the one before that,
+                                      and so on
+
+ - Returns:     WAVE_SNAPSHOT *  =    The snapshot or NULL if there isn't one that old
+
+*********************************************************************************************/
+
+const WAVE_SNAPSHOT *wave_history_get (const WAVE_HISTORY *history, int32_t age)
+{
+  if (age < 0 || age >= history->count) return (NULL);
+
+  return (&history->slot[(history->oldest + history->count - 1 - age) % (int32_t) history->slot.size ()]);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    wave_history_clear
+
+ - Purpose:     Drop all of the snapshots in the history ring.
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - history        =    The history ring
+
+ - Returns:     N/A
+
+*********************************************************************************************/
+
+void wave_history_clear (WAVE_HISTORY *history)
+{
+  while (history->count) history_drop_oldest (history);
+
+  history->oldest = 0;
+}
@@ -0,0 +1,101 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! or / / ! are being used by Doxygen to
+    document the software.  Dashes in these comment blocks are used to create bullet lists.
+    The lack of blank lines after a block of dash preceeded comments means that the next
+    block of dash preceeded comments is a new, indented bullet list.  I've tried to keep the
+    Doxygen formatting to a minimum but there are some other items (like <br> and <pre>)
+    that need to be left alone.  If you see a comment that starts with / * ! or / / ! and
+    there is something that looks a bit weird it is probably due to some arcane Doxygen
+    syntax.  Be very careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+/*  Waveform history ring definitions.  */
+
+#ifndef __WAVE_HISTORY_HPP__
+#define __WAVE_HISTORY_HPP__
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <sys/types.h>
+#include <string.h>
+
+#include <string>
+#include <vector>
+#include <memory>
+
+#include "slas.hpp"
+#include "wave_plot.hpp"
+
+
+#define WAVE_HISTORY_DEFAULT_SIZE       256      //!<  Snapshots
+#define WAVE_HISTORY_MAX_SIZE           65536
+#define WAVE_HISTORY_DEFAULT_MEMORY     16       //!<  Megabytes
+#define WAVE_HISTORY_MAX_MEMORY         4096
+#define WAVE_HISTORY_DEFAULT_OVERLAY    0        //!<  Previous waveforms drawn under the current one
+#define WAVE_HISTORY_MAX_OVERLAY        16
+
+
+/*!  One displayed waveform.  The header is shared by all of the snapshots from the same file.  */
+
+typedef struct
+{
+  std::string                 filename;
+  uint64_t                    recnum;         //!<  ABE record number (records start at 1)
+  std::shared_ptr<const SLAS_HEADER> header;
+  SLAS_POINT_DATA             slas;
+  BOUNDS                      bounds;
+  WAVE_STATS                  stats;          //!<  Analytics of the whole waveform (not just the samples that were kept)
+  SLAS_SAMPLES                samples;        //!<  samples[0] is sample bounds.first
+} WAVE_SNAPSHOT;
+
+
+/*!  Ring of the last waveforms that were displayed so they can be gone back to (and overlaid) without reading anything.
+     The oldest snapshots are dropped when there are size of them or when they would use more than max_bytes.  Slots are
+     only added when the ring is full so it never has more of them than the memory limit lets it use.  */
+
+typedef struct
+{
+  std::vector<WAVE_SNAPSHOT>  slot;           //!<  Grows (up to size) as it's needed
+  int32_t                     size;           //!<  Capacity (snapshots)
+  int32_t                     oldest;         //!<  Slot of the oldest snapshot
+  int32_t                     count;
+  int64_t                     bytes;          //!<  Memory used by the snapshots
+  int64_t                     max_bytes;
+} WAVE_HISTORY;
+
+
+void wave_history_init (WAVE_HISTORY *history, int32_t size, int32_t memory);
+void wave_history_push (WAVE_HISTORY *history, const char *filename, uint64_t recnum, const SLAS_HEADER *lasheader,
+                        const SLAS_POINT_DATA *slas, const BOUNDS *bounds, const WAVE_STATS *stats, const SLAS_SAMPLES &samples);
+const WAVE_SNAPSHOT *wave_history_get (const WAVE_HISTORY *history, int32_t age);
+void wave_history_clear (WAVE_HISTORY *history);
+
+
+#endif
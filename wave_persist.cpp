@@ -0,0 +1,371 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! or / / ! are being used by Doxygen to
+    document the software.  Dashes in these comment blocks are used to create bullet lists.
+    The lack of blank lines after a block of dash preceeded comments means that the next
+    block of dash preceeded comments is a new, indented bullet list.  I've tried to keep the
+    Doxygen formatting to a minimum but there are some other items (like <br> and <pre>)
+    that need to be left alone.  If you see a comment that starts with / * ! or / / ! and
+    there is something that looks a bit weird it is probably due to some arcane Doxygen
+    syntax.  Be very careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+#include "wave_persist.hpp"
+
+
+
+//  Blend two RGB colors (t from 0 to 1).
+
+static uint32_t persist_blend (uint32_t a, uint32_t b, float t)
+{
+  uint32_t out = 0xff000000;
+
+  for (int32_t shift = 0 ; shift < 24 ; shift += 8)
+    {
+      float ca = (float) ((a >> shift) & 0xff);
+      float cb = (float) ((b >> shift) & 0xff);
+
+      out |= ((uint32_t) (ca + (cb - ca) * t + 0.5f) & 0xff) << shift;
+    }
+
+  return (out);
+}
+
+
+
+static inline uint32_t persist_color (const WAVE_PERSIST *persist, float value)
+{
+  int32_t index = (int32_t) (value * ((float) WAVE_PERSIST_LUT_SIZE / WAVE_PERSIST_SATURATION));
+
+  return (persist->lut[index < WAVE_PERSIST_LUT_SIZE ? index : WAVE_PERSIST_LUT_SIZE - 1]);
+}
+
+
+
+//  Build the color map and recolor the image.
+
+static void persist_build_lut (WAVE_PERSIST *persist)
+{
+  float log_saturation = log1pf (WAVE_PERSIST_SATURATION);
+
+  persist->lut[0] = persist->background_rgb | 0xff000000;
+
+  for (int32_t i = 1 ; i < WAVE_PERSIST_LUT_SIZE ; i++)
+    {
+      float value = ((float) i + 0.5f) * WAVE_PERSIST_SATURATION / (float) WAVE_PERSIST_LUT_SIZE;
+      float t = log1pf (value) / log_saturation;
+
+      if (t < 0.6f)
+        {
+          persist->lut[i] = persist_blend (persist->background_rgb, persist->wave_rgb, 0.25f + 0.75f * t / 0.6f);
+        }
+      else
+        {
+          persist->lut[i] = persist_blend (persist->wave_rgb, 0xffffffff, (t - 0.6f) / 0.4f);
+        }
+    }
+
+  for (size_t i = 0 ; i < persist->accum.size () ; i++) persist->image[i] = persist_color (persist, persist->accum[i]);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    wave_persist_init
+
+ - Purpose:     Initialize a persistence display.  The buffer is allocated by
+                wave_persist_resize.
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - persist        =    The persistence display
+                - half_life      =    Milliseconds for the display to fade to half
+
+ - Returns:     N/A
+
+*********************************************************************************************/
+
+void wave_persist_init (WAVE_PERSIST *persist, float half_life)
+{
+  persist->width = persist->height = 0;
+  memset (&persist->bounds, 0, sizeof (BOUNDS));
+  persist->accum.clear ();
+  persist->image.clear ();
+  persist->background_rgb = 0xff000000;
+  persist->wave_rgb = 0xffffffff;
+  persist->half_life = half_life > 1.0f ? half_life : 1.0f;
+  persist->peak = 0.0f;
+
+  persist_build_lut (persist);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    wave_persist_colors
+
+ - Purpose:     Set the background and waveform colors that the color map is built from.
+                Nothing is done unless they changed.
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - persist        =    The persistence display
+                - background_rgb =    Background color (QColor::rgb)
+                - wave_rgb       =    Waveform color (QColor::rgb)
+
+ - Returns:     N/A
+
+*********************************************************************************************/
+
+void wave_persist_colors (WAVE_PERSIST *persist, uint32_t background_rgb, uint32_t wave_rgb)
+{
+  if (background_rgb == persist->background_rgb && wave_rgb == persist->wave_rgb) return;
+
+  persist->background_rgb = background_rgb;
+  persist->wave_rgb = wave_rgb;
+
+  persist_build_lut (persist);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    wave_persist_resize
+
+ - Purpose:     Make sure the buffer matches the plot.  If the plot size or bounds changed
+                (window resized, zoomed, or a waveform with a different descriptor) the
+                old traces don't line up any more so the buffer is cleared.
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - persist        =    The persistence display
+                - width          =    Plot width in pixels
+                - height         =    Plot height in pixels
+                - bounds         =    Plot bounds from wave_plot_bounds
+
+ - Returns:     N/A
+
+*********************************************************************************************/
+
+void wave_persist_resize (WAVE_PERSIST *persist, int32_t width, int32_t height, const BOUNDS *bounds)
+{
+  if (width == persist->width && height == persist->height && bounds->min_x == persist->bounds.min_x &&
+      bounds->range_x == persist->bounds.range_x && bounds->min_y == persist->bounds.min_y && bounds->range_y == persist->bounds.range_y) return;
+
+  persist->width = qMax (0, width);
+  persist->height = qMax (0, height);
+  persist->bounds = *bounds;
+  persist->accum.assign ((size_t) persist->width * persist->height, 0.0f);
+  persist->image.assign ((size_t) persist->width * persist->height, persist->lut[0]);
+  persist->peak = 0.0f;
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    wave_persist_clear
+
+ - Purpose:     Clear the persistence display.
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - persist        =    The persistence display
+
+ - Returns:     N/A
+
+*********************************************************************************************/
+
+void wave_persist_clear (WAVE_PERSIST *persist)
+{
+  std::fill (persist->accum.begin (), persist->accum.end (), 0.0f);
+  std::fill (persist->image.begin (), persist->image.end (), persist->lut[0]);
+  persist->peak = 0.0f;
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    wave_persist_decay
+
+ - Purpose:     Fade the buffer by the time since the last frame and color map it to the
+                image in the same pass.  Pixels that are already clear are skipped and
+                nothing at all is done once everything has faded out.
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - persist        =    The persistence display
+                - elapsed        =    Milliseconds since the last frame
+
+ - Returns:     N/A
+
+*********************************************************************************************/
+
+void wave_persist_decay (WAVE_PERSIST *persist, float elapsed)
+{
+  if (persist->peak <= 0.0f || elapsed <= 0.0f) return;
+
+
+  float factor = exp2f (-elapsed / persist->half_life);
+  float *accum = persist->accum.data ();
+  uint32_t *image = persist->image.data ();
+  size_t count = persist->accum.size ();
+  float peak = 0.0f;
+
+
+  for (size_t i = 0 ; i < count ; i++)
+    {
+      float value = accum[i];
+
+      if (value == 0.0f) continue;
+
+      value *= factor;
+      if (value < WAVE_PERSIST_MIN_VALUE) value = 0.0f;
+
+      accum[i] = value;
+      image[i] = persist_color (persist, value);
+      if (value > peak) peak = value;
+    }
+
+  persist->peak = peak;
+}
+
+
+
+static inline void persist_hit (WAVE_PERSIST *persist, int32_t x, int32_t y)
+{
+  if (x < 0 || y < 0 || x >= persist->width || y >= persist->height) return;
+
+  size_t i = (size_t) y * persist->width + x;
+  float value = persist->accum[i] + 1.0f;
+
+  persist->accum[i] = value;
+  persist->image[i] = persist_color (persist, value);
+  if (value > persist->peak) persist->peak = value;
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    wave_persist_add
+
+ - Purpose:     Add a waveform to the persistence display.  Each pixel that the trace
+                covers gets one hit (the end points of the segments are only counted
+                once) and only those pixels are recolored.
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - persist        =    The persistence display (sized with
+                                      wave_persist_resize)
+                - samples        =    The samples (samples[0] is sample bounds.first)
+                - line_mode      =    NVTrue to draw lines, NVFalse to draw dots
+
+ - Returns:     N/A
+
+*********************************************************************************************/
+
+void wave_persist_add (WAVE_PERSIST *persist, const SLAS_SAMPLES &samples, uint8_t line_mode)
+{
+  int32_t count = qMin ((int32_t) samples.size (), persist->bounds.length);
+  int32_t x0 = 0, y0 = 0;
+
+
+  for (int32_t i = 0 ; i < count ; i++)
+    {
+      int32_t x1, y1;
+
+      wave_plot_scale (persist->bounds.first + i, samples[i], &x1, &y1, persist->width, persist->height, &persist->bounds);
+
+      if (!line_mode)
+        {
+          for (int32_t j = 0 ; j < WAVE_PLOT_SPOT_SIZE ; j++)
+            for (int32_t k = 0 ; k < WAVE_PLOT_SPOT_SIZE ; k++) persist_hit (persist, x1 + k, y1 + j);
+        }
+      else if (!i)
+        {
+          persist_hit (persist, x1, y1);
+        }
+      else
+        {
+          //  Bresenham from the last point (which was already hit) to this one.
+
+          int32_t dx = abs (x1 - x0), sx = x0 < x1 ? 1 : -1;
+          int32_t dy = -abs (y1 - y0), sy = y0 < y1 ? 1 : -1;
+          int32_t err = dx + dy, x = x0, y = y0;
+
+          while (x != x1 || y != y1)
+            {
+              int32_t e2 = 2 * err;
+
+              if (e2 >= dy)
+                {
+                  err += dy;
+                  x += sx;
+                }
+
+              if (e2 <= dx)
+                {
+                  err += dx;
+                  y += sy;
+                }
+
+              persist_hit (persist, x, y);
+            }
+        }
+
+      x0 = x1;
+      y0 = y1;
+    }
+}
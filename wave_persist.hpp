@@ -0,0 +1,92 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! or / / ! are being used by Doxygen to
+    document the software.  Dashes in these comment blocks are used to create bullet lists.
+    The lack of blank lines after a block of dash preceeded comments means that the next
+    block of dash preceeded comments is a new, indented bullet list.  I've tried to keep the
+    Doxygen formatting to a minimum but there are some other items (like <br> and <pre>)
+    that need to be left alone.  If you see a comment that starts with / * ! or / / ! and
+    there is something that looks a bit weird it is probably due to some arcane Doxygen
+    syntax.  Be very careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+/*  Waveform persistence display definitions.  */
+
+#ifndef __WAVE_PERSIST_HPP__
+#define __WAVE_PERSIST_HPP__
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <sys/types.h>
+#include <cmath>
+#include <string.h>
+
+#include <vector>
+#include <algorithm>
+
+#include "wave_plot.hpp"
+
+
+#define WAVE_PERSIST_DEFAULT_HALF_LIFE  1000     //!<  Milliseconds for the persistence to fade to half
+#define WAVE_PERSIST_FRAME_INTERVAL     16       //!<  Milliseconds between fade frames (60 frames a second)
+#define WAVE_PERSIST_SATURATION         64.0f    //!<  Hits on a pixel that map to the top of the color map
+#define WAVE_PERSIST_MIN_VALUE          0.02f    //!<  Pixels that fade below this are cleared
+#define WAVE_PERSIST_LUT_SIZE           4096
+
+
+/*!  Persistence (accumulation) display.  Every waveform adds one to the pixels its trace covers in a floating point
+     accumulation buffer.  Each frame the buffer decays by the time since the last frame and is color mapped to the
+     image in the same pass, so a frame costs one pass over the buffer plus the new trace no matter how many waveforms
+     have been drawn.  The color map goes from the background color through the waveform color to white on a log scale
+     so single traces are still visible next to dense ones.  */
+
+typedef struct
+{
+  int32_t                     width;          //!<  Plot size in pixels
+  int32_t                     height;
+  BOUNDS                      bounds;         //!<  Bounds the buffer was built with (it's cleared when they change)
+  std::vector<float>          accum;
+  std::vector<uint32_t>       image;          //!<  Color mapped buffer (QImage::Format_RGB32 pixels)
+  uint32_t                    lut[WAVE_PERSIST_LUT_SIZE];
+  uint32_t                    background_rgb;
+  uint32_t                    wave_rgb;
+  float                       half_life;      //!<  Milliseconds
+  float                       peak;           //!<  Largest value in the buffer after the last frame (0 when it has faded out)
+} WAVE_PERSIST;
+
+
+void wave_persist_init (WAVE_PERSIST *persist, float half_life);
+void wave_persist_colors (WAVE_PERSIST *persist, uint32_t background_rgb, uint32_t wave_rgb);
+void wave_persist_resize (WAVE_PERSIST *persist, int32_t width, int32_t height, const BOUNDS *bounds);
+void wave_persist_clear (WAVE_PERSIST *persist);
+void wave_persist_decay (WAVE_PERSIST *persist, float elapsed);
+void wave_persist_add (WAVE_PERSIST *persist, const SLAS_SAMPLES &samples, uint8_t line_mode);
+
+
+#endif
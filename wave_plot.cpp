@@ -0,0 +1,580 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! or / / ! are being used by Doxygen to
+    document the software.  Dashes in these comment blocks are used to create bullet lists.
+    The lack of blank lines after a block of dash preceeded comments means that the next
+    block of dash preceeded comments is a new, indented bullet list.  I've tried to keep the
+    Doxygen formatting to a minimum but there are some other items (like <br> and <pre>)
+    that need to be left alone.  If you see a comment that starts with / * ! or / / ! and
+    there is something that looks a bit weird it is probably due to some arcane Doxygen
+    syntax.  Be very careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+#include "wave_plot.hpp"
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    wave_plot_bounds
+
+ - Purpose:     Set the plot bounds for a waveform.  If we're zoomed in, only the samples in
+                the zoom window are displayed (and read).  The window is clipped to this
+                waveform since it may be shorter than the one that was zoomed.
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - desc           =    The waveform packet descriptor of the point
+                - zoom_first     =    First sample of the zoom window
+                - zoom_count     =    Number of samples in the zoom window (0 for the
+                                      whole waveform)
+                - bounds         =    The returned bounds
+
+ - Returns:     N/A
+
+*********************************************************************************************/
+
+void wave_plot_bounds (const SLAS_WAVEFORM_PACKET_DESCRIPTOR *desc, int32_t zoom_first, int32_t zoom_count, BOUNDS *bounds)
+{
+  bounds->total = desc->number_of_samples;
+  bounds->temporal_spacing = desc->temporal_spacing;
+
+  bounds->first = 0;
+  bounds->length = bounds->total;
+
+  if (zoom_count && zoom_count < bounds->total)
+    {
+      bounds->first = qBound (0, zoom_first, bounds->total - zoom_count);
+      bounds->length = zoom_count;
+    }
+
+
+  bounds->min_y = 0;
+  bounds->height = bounds->max_y = NINT (pow (2.0, (double) desc->bits_per_sample));
+  bounds->min_x = bounds->first;
+  bounds->max_x = bounds->first + bounds->length;
+
+
+  //  Add pixels to the X axis (scaled by the zoom so the margins look the same when zoomed in).
+
+  bounds->buffer_size = qMax (1, 25 * bounds->length / qMax (1, bounds->total));
+  bounds->min_x = bounds->min_x - bounds->buffer_size;
+  bounds->max_x = bounds->max_x + qMax (1, 10 * bounds->length / qMax (1, bounds->total));
+  bounds->range_x = bounds->max_x - bounds->min_x;
+
+
+  //  Add pixels to the Y axis.
+
+  bounds->buffer_size = 25;
+  bounds->min_y = bounds->min_y - bounds->buffer_size;
+  bounds->max_y = bounds->max_y + 10;
+  bounds->range_y = bounds->max_y - bounds->min_y;
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    wave_plot_scale
+
+ - Purpose:     Convert a sample number (x) and amplitude (y) to plot pixels.  The sample
+                axis runs down the plot and the amplitude axis runs across it.
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - x              =    Sample number
+                - y              =    Amplitude
+                - new_x          =    Returned pixel column
+                - new_y          =    Returned pixel row
+                - draw_width     =    Plot width in pixels
+                - draw_height    =    Plot height in pixels
+                - bounds         =    The plot bounds
+
+ - Returns:     N/A
+
+*********************************************************************************************/
+
+void wave_plot_scale (int32_t x, int32_t y, int32_t *new_x, int32_t *new_y, int32_t draw_width, int32_t draw_height, const BOUNDS *bounds)
+{
+  *new_y = NINT (((float) (x - bounds->min_x) / (float) bounds->range_x) * (float) draw_height);
+  *new_x = NINT (((float) (y - bounds->min_y) / (float) bounds->range_y) * (float) draw_width);
+}
+
+
+
+static void plot_line (const WAVE_PLOT_CANVAS *canvas, int32_t x0, int32_t y0, int32_t x1, int32_t y1, const QColor &color, int32_t width,
+                       Qt::PenStyle pen_style)
+{
+  if (canvas->map)
+    {
+      canvas->map->drawLine (x0, y0, x1, y1, color, width, NVFalse, pen_style);
+    }
+  else
+    {
+      canvas->painter->setPen (QPen (color, width, pen_style));
+      canvas->painter->drawLine (x0, y0, x1, y1);
+    }
+}
+
+
+
+static void plot_spot (const WAVE_PLOT_CANVAS *canvas, int32_t x, int32_t y, const QColor &color)
+{
+  if (canvas->map)
+    {
+      canvas->map->fillRectangle (x, y, WAVE_PLOT_SPOT_SIZE, WAVE_PLOT_SPOT_SIZE, color, NVFalse);
+    }
+  else
+    {
+      canvas->painter->fillRect (x, y, WAVE_PLOT_SPOT_SIZE, WAVE_PLOT_SPOT_SIZE, color);
+    }
+}
+
+
+
+//  The axis numbers are drawn rotated 90 degrees (the sample axis runs down the plot).
+
+static void plot_text (const WAVE_PLOT_CANVAS *canvas, const QString &text, int32_t x, int32_t y)
+{
+  if (canvas->map)
+    {
+      canvas->map->drawText (text, x, y, 90.0, WAVE_PLOT_FONT_SIZE, Qt::gray, NVTrue);
+    }
+  else
+    {
+      QFont font = canvas->painter->font ();
+      font.setPointSize (WAVE_PLOT_FONT_SIZE);
+
+      canvas->painter->save ();
+      canvas->painter->setFont (font);
+      canvas->painter->translate (x, y);
+      canvas->painter->rotate (90.0);
+      canvas->painter->setPen (Qt::gray);
+      canvas->painter->drawText (0, 0, text);
+      canvas->painter->restore ();
+    }
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    wave_plot_draw_axes
+
+ - Purpose:     Draw the axes, tick marks, and tick numbers of a waveform plot.  When zoomed
+                in the sample axis starts at the first sample in the zoom window.
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - canvas         =    Where to draw
+                - bounds         =    Bounds from wave_plot_bounds
+
+ - Returns:     N/A
+
+*********************************************************************************************/
+
+void wave_plot_draw_axes (const WAVE_PLOT_CANVAS *canvas, const BOUNDS *bounds)
+{
+  int32_t pix_x[2], pix_y[2];
+  int32_t w = canvas->draw_width, h = canvas->draw_height;
+
+
+  if (!bounds->total) return;
+
+  int32_t first = bounds->first;
+  int32_t inc_x = qMax (1, bounds->length / 5);
+  int32_t inc_y = qMax (1, bounds->height / 5);
+  int32_t x_tics = bounds->length / inc_x + 1;
+  int32_t y_tics = bounds->height / inc_y + 1;
+  int32_t text_off = qMax (1, 4 * bounds->length / bounds->total);
+
+  wave_plot_scale (first, 0, &pix_x[0], &pix_y[0], w, h, bounds);
+  wave_plot_scale (first, bounds->height, &pix_x[1], &pix_y[1], w, h, bounds);
+
+  plot_line (canvas, pix_x[0], pix_y[0], pix_x[1], pix_y[1], Qt::gray, 2, Qt::SolidLine);
+
+  wave_plot_scale (first, 0, &pix_x[0], &pix_y[0], w, h, bounds);
+  wave_plot_scale (first + bounds->length, 0, &pix_x[1], &pix_y[1], w, h, bounds);
+
+  plot_line (canvas, pix_x[0], pix_y[0], pix_x[1], pix_y[1], Qt::gray, 2, Qt::SolidLine);
+
+  for (int32_t i = 0 ; i < x_tics ; i++)
+    {
+      int32_t num = first + i * inc_x;
+
+      wave_plot_scale (num, 0, &pix_x[0], &pix_y[0], w, h, bounds);
+      wave_plot_scale (num, -2, &pix_x[1], &pix_y[1], w, h, bounds);
+
+      plot_line (canvas, pix_x[0], pix_y[0], pix_x[1], pix_y[1], Qt::gray, 2, Qt::SolidLine);
+
+      wave_plot_scale (num + text_off, -22, &pix_x[1], &pix_y[1], w, h, bounds);
+      plot_text (canvas, QString::number (num), pix_x[1], pix_y[1]);
+    }
+
+  for (int32_t i = 0 ; i < y_tics ; i++)
+    {
+      int32_t num = i * inc_y;
+
+      wave_plot_scale (first, num, &pix_x[0], &pix_y[0], w, h, bounds);
+      wave_plot_scale (first - text_off / 2, num, &pix_x[1], &pix_y[1], w, h, bounds);
+
+      plot_line (canvas, pix_x[0], pix_y[0], pix_x[1], pix_y[1], Qt::gray, 2, Qt::SolidLine);
+
+      wave_plot_scale (first - text_off * 5 / 2, num - 10, &pix_x[1], &pix_y[1], w, h, bounds);
+      plot_text (canvas, QString::number (num), pix_x[1], pix_y[1]);
+    }
+}
+
+
+
+//  Mark the waveform analytics on the plot.  The baseline is a dashed line across the window, the pulse width is a line
+//  between the half maximum crossings with a line up to the (interpolated) peak, and, if any samples are saturated, the
+//  full scale value is a dashed line.  The analytics are for the whole waveform (sample positions are from its start) so
+//  the pulse width and peak marks are clipped to the window.
+
+static void plot_stats (const WAVE_PLOT_CANVAS *canvas, const BOUNDS *bounds, const WAVE_STATS *stats, const WAVE_PLOT_STYLE *style)
+{
+  int32_t pix_x[2], pix_y[2];
+  int32_t w = canvas->draw_width, h = canvas->draw_height;
+  int32_t first = bounds->first;
+  int32_t last = bounds->first + bounds->length;
+
+
+  wave_plot_scale (first, NINT (stats->baseline), &pix_x[0], &pix_y[0], w, h, bounds);
+  wave_plot_scale (last, NINT (stats->baseline), &pix_x[1], &pix_y[1], w, h, bounds);
+
+  plot_line (canvas, pix_x[0], pix_y[0], pix_x[1], pix_y[1], Qt::gray, 1, Qt::DashLine);
+
+
+  if (stats->saturated)
+    {
+      int32_t full_scale = (int32_t) qMin ((int64_t) stats->max_value, (int64_t) bounds->height);
+
+      wave_plot_scale (first, full_scale, &pix_x[0], &pix_y[0], w, h, bounds);
+      wave_plot_scale (last, full_scale, &pix_x[1], &pix_y[1], w, h, bounds);
+
+      plot_line (canvas, pix_x[0], pix_y[0], pix_x[1], pix_y[1], Qt::red, 1, Qt::DashLine);
+    }
+
+
+  if (stats->fwhm <= 0.0) return;
+
+  int32_t half = NINT (stats->baseline + 0.5 * stats->peak_amplitude);
+  int32_t half_start = qMax (first, NINT (stats->half_start));
+  int32_t half_end = qMin (last, NINT (stats->half_end));
+  int32_t peak_x = NINT (stats->peak_location);
+
+  if (half_start <= half_end)
+    {
+      wave_plot_scale (half_start, half, &pix_x[0], &pix_y[0], w, h, bounds);
+      wave_plot_scale (half_end, half, &pix_x[1], &pix_y[1], w, h, bounds);
+
+      plot_line (canvas, pix_x[0], pix_y[0], pix_x[1], pix_y[1], style->primary_color, 1, Qt::SolidLine);
+    }
+
+  if (peak_x >= first && peak_x <= last)
+    {
+      wave_plot_scale (peak_x, half, &pix_x[0], &pix_y[0], w, h, bounds);
+      wave_plot_scale (peak_x, NINT (stats->baseline + stats->peak_amplitude), &pix_x[1], &pix_y[1], w, h, bounds);
+
+      plot_line (canvas, pix_x[0], pix_y[0], pix_x[1], pix_y[1], style->primary_color, 1, Qt::DashLine);
+    }
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    wave_plot_draw_wave
+
+ - Purpose:     Draw a waveform, put an X on the return point (if it's in the window), and
+                mark the waveform analytics.  This is split from the axes so that the
+                monitor can put its history overlay between them.
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - canvas         =    Where to draw
+                - bounds         =    Bounds from wave_plot_bounds
+                - samples        =    The samples (samples[0] is sample bounds->first)
+                - return_point_waveform_location = From the point record
+                - stats          =    Analytics of the whole waveform from wave_stats_compute
+                                      (NULL or not valid for no marks)
+                - draw_trace     =    NVFalse if the trace has already been drawn (the
+                                      monitor's persistence display)
+                - style          =    Colors and line/dot mode
+
+ - Returns:     N/A
+
+*********************************************************************************************/
+
+void wave_plot_draw_wave (const WAVE_PLOT_CANVAS *canvas, const BOUNDS *bounds, const SLAS_SAMPLES &samples, float return_point_waveform_location,
+                          const WAVE_STATS *stats, uint8_t draw_trace, const WAVE_PLOT_STYLE *style)
+{
+  int32_t pix_x[2], pix_y[2];
+  int32_t w = canvas->draw_width, h = canvas->draw_height;
+
+
+  if (!bounds->total) return;
+
+
+  //  Draw the waveform.
+
+  int32_t first = bounds->first;
+  int32_t count = qMin ((int32_t) samples.size (), bounds->length);
+
+  if (count) wave_plot_scale (first, samples[0], &pix_x[0], &pix_y[0], w, h, bounds);
+
+  for (int32_t i = 1 ; i < count && draw_trace ; i++)
+    {
+      wave_plot_scale (first + i, samples[i], &pix_x[1], &pix_y[1], w, h, bounds);
+
+      if (style->wave_line_mode)
+        {
+          plot_line (canvas, pix_x[0], pix_y[0], pix_x[1], pix_y[1], style->wave_color, 2, Qt::SolidLine);
+        }
+      else
+        {
+          plot_spot (canvas, pix_x[0], pix_y[0], style->wave_color);
+        }
+      pix_x[0] = pix_x[1];
+      pix_y[0] = pix_y[1];
+    }
+
+
+  //  Figure out where the return location is on the waveform (if it's in the window) and put an X on it.
+
+  int32_t bin = bounds->temporal_spacing ? (int32_t) (return_point_waveform_location / bounds->temporal_spacing) : -1;
+
+  if (bin >= first && bin - first < count)
+    {
+      wave_plot_scale (bin, samples[bin - first], &pix_x[0], &pix_y[0], w, h, bounds);
+
+      plot_line (canvas, pix_x[0] - 5, pix_y[0] + 5, pix_x[0] + 5, pix_y[0] - 5, style->primary_color, 2, Qt::SolidLine);
+      plot_line (canvas, pix_x[0] + 5, pix_y[0] + 5, pix_x[0] - 5, pix_y[0] - 5, style->primary_color, 2, Qt::SolidLine);
+    }
+
+
+  //  Mark the baseline, peak, and pulse width.
+
+  if (stats && stats->valid) plot_stats (canvas, bounds, stats, style);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    wave_plot_draw
+
+ - Purpose:     Draw a waveform plot (axes, waveform, return point marker, and analytics).
+                This is what the monitor draws in slotPlotWaves for a new record (without
+                the persistence and history displays).  The background isn't cleared (the
+                nvMap is cleared when it's redrawn).  With a painter this is safe to use on a
+                QImage outside of the GUI thread.
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - canvas         =    Where to draw
+                - bounds         =    Bounds from wave_plot_bounds
+                - samples        =    The samples (samples[0] is sample bounds->first)
+                - return_point_waveform_location = From the point record
+                - stats          =    Analytics of the whole waveform from wave_stats_compute
+                                      (may be NULL)
+                - style          =    Colors and line/dot mode
+
+ - Returns:     N/A
+
+*********************************************************************************************/
+
+void wave_plot_draw (const WAVE_PLOT_CANVAS *canvas, const BOUNDS *bounds, const SLAS_SAMPLES &samples, float return_point_waveform_location,
+                     const WAVE_STATS *stats, const WAVE_PLOT_STYLE *style)
+{
+  wave_plot_draw_axes (canvas, bounds);
+  wave_plot_draw_wave (canvas, bounds, samples, return_point_waveform_location, stats, NVTrue, style);
+}
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    wave_plot_labels
+
+ - Purpose:     Make the attribute text (rich text) for a point record.  These are the
+                monitor's status bar fields in status bar order (date/time, intensity,
+                return, number of returns, synthetic, keypoint, withheld, overlap, scanner
+                channel, scan direction, edge of flightline, classification, user data,
+                scan angle, point source ID, red, green, blue, NIR, waveform descriptor
+                index, byte offset to waveforms, waveform packet size, return point
+                waveform location, X(t), Y(t), and Z(t)).
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - lasheader      =    The LAS header
+                - slas           =    The point record
+                - gps_start_time =    00:00:00 on 6 January 1980 in POSIX seconds
+                - labels         =    WAVE_PLOT_LABELS returned strings
+
+ - Returns:     N/A
+
+*********************************************************************************************/
+
+void wave_plot_labels (const SLAS_HEADER *lasheader, const SLAS_POINT_DATA *slas, double gps_start_time, QString *labels)
+{
+  int64_t las_timestamp, tv_sec;
+  int32_t year, day, mday, month, hour, minute;
+  float   second;
+  int32_t n = 0;
+
+
+  if (lasheader->point_data_format == 2)
+    {
+      labels[n++] = "<b>GPS seconds : </b>N/A";
+    }
+  else if (lasheader->global_encoding & 0x01)
+    {
+      //  Note, GPS time is ahead of UTC time by some number of leap seconds depending on the date of the survey.
+      //  The leap seconds that are relevant for CHARTS and/or CZMIL data are as follows
+      //
+      //  December 31 2005 23:59:59 - 1136073599 - 14 seconds ahead
+      //  December 31 2008 23:59:59 - 1230767999 - 15 seconds ahead
+      //  June 30 2012 23:59:59     - 1341100799 - 16 seconds ahead
+      //  June 30 2015 23:59:59     - 1435708799 - 17 seconds ahead
+
+      double las_time_offset = 1000000000.0 - 13.0;
+
+      tv_sec = slas->gps_time + gps_start_time + las_time_offset;
+      if (tv_sec > 1136073599) las_time_offset -= 1.0;
+      if (tv_sec > 1230767999) las_time_offset -= 1.0;
+      if (tv_sec > 1341100799) las_time_offset -= 1.0;
+      if (tv_sec > 1435708799) las_time_offset -= 1.0;
+
+      las_timestamp = (int64_t) ((slas->gps_time + gps_start_time + las_time_offset) * 1000000.0);
+      time_t tv_sec = las_timestamp / 1000000;
+      long tv_nsec = las_timestamp % 1000000;
+
+      cvtime (tv_sec, tv_nsec, &year, &day, &hour, &minute, &second);
+      jday2mday (year, day, &month, &mday);
+      month++;
+
+      labels[n++].sprintf ("<b>Date/time : </b>%d-%02d-%02d (%03d) %02d:%02d:%05.2f", year + 1900, month, mday, day, hour, minute, second);
+    }
+  else
+    {
+      labels[n++].sprintf ("<b>GPS seconds : </b>%.6f", slas->gps_time);
+    }
+
+  labels[n++].sprintf ("<b>Intensity : </b>%hd", slas->intensity);
+  labels[n++].sprintf ("<b>Return : </b>%d", slas->return_number);
+  labels[n++].sprintf ("<b>Number of returns : </b>%d", slas->number_of_returns);
+  labels[n++].sprintf ("<b>Synthetic : </b>%d", slas->synthetic);
+  labels[n++].sprintf ("<b>Keypoint : </b>%d", slas->keypoint);
+  labels[n++].sprintf ("<b>Withheld : </b>%d", slas->withheld);
+  labels[n++].sprintf ("<b>Overlap : </b>%d", slas->overlap);
+
+  if (lasheader->point_data_format > 5)
+    {
+      labels[n++].sprintf ("<b>Scanner channel : </b>%d", slas->scanner_channel);
+    }
+  else
+    {
+      labels[n++] = "<b>Scanner channel : </b>N/A";
+    }
+
+  labels[n++].sprintf ("<b>Scan direction flag : </b>%d", slas->scan_direction_flag);
+  labels[n++].sprintf ("<b>Edge of flightline flag : </b>%d", slas->edge_of_flightline);
+  labels[n++].sprintf ("<b>Classification : </b>%d", slas->classification);
+  labels[n++].sprintf ("<b>User data : </b>%d", slas->user_data);
+  labels[n++].sprintf ("<b>Scan angle : </b>%d", slas->scan_angle);
+  labels[n++].sprintf ("<b>Point source ID : </b>%d", slas->point_source_id);
+
+  if (lasheader->point_data_format == 2 || lasheader->point_data_format == 3 || lasheader->point_data_format == 5 ||
+      lasheader->point_data_format == 7 || lasheader->point_data_format == 8 || lasheader->point_data_format == 10)
+    {
+      labels[n++].sprintf ("<b>Red : </b>%hd", slas->red);
+      labels[n++].sprintf ("<b>Green : </b>%hd", slas->green);
+      labels[n++].sprintf ("<b>Blue : </b>%hd", slas->blue);
+    }
+  else
+    {
+      labels[n++] = "<b>Red : </b>N/A";
+      labels[n++] = "<b>Green : </b>N/A";
+      labels[n++] = "<b>Blue : </b>N/A";
+    }
+
+  if (lasheader->point_data_format == 8 || lasheader->point_data_format == 10)
+    {
+      labels[n++].sprintf ("<b>NIR : </b>%hd", slas->NIR);
+    }
+  else
+    {
+      labels[n++] = "<b>NIR : </b>N/A";
+    }
+
+  if (lasheader->point_data_format == 4 || lasheader->point_data_format == 5 || lasheader->point_data_format == 9 ||
+      lasheader->point_data_format == 10)
+    {
+      labels[n++].sprintf ("<b>Waveform descriptor index : </b>%d", slas->wavepacket_descriptor_index);
+      labels[n++].sprintf ("<b>Byte offset to waveforms : </b>%" PRIu64, (uint64_t) slas->byte_offset_to_waveform_data);
+      labels[n++].sprintf ("<b>Waveform packet size : </b>%d", slas->waveform_packet_size);
+      labels[n++].sprintf ("<b>Return point waveform location : </b>%.2f", slas->return_point_waveform_location);
+      labels[n++].sprintf ("<b>X(t) : </b>%.11f", slas->Xt);
+      labels[n++].sprintf ("<b>Y(t) : </b>%.11f", slas->Yt);
+      labels[n++].sprintf ("<b>Z(t) : </b>%.11f", slas->Zt);
+    }
+  else
+    {
+      labels[n++] = "<b>Waveform descriptor index : </b>N/A";
+      labels[n++] = "<b>Byte offset to waveforms : </b>N/A";
+      labels[n++] = "<b>Waveform packet size : </b>N/A";
+      labels[n++] = "<b>Return point waveform location : </b>N/A";
+      labels[n++] = "<b>X(t) : </b>N/A";
+      labels[n++] = "<b>Y(t) : </b>N/A";
+      labels[n++] = "<b>Z(t) : </b>N/A";
+    }
+}
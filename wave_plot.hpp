@@ -0,0 +1,117 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! or / / ! are being used by Doxygen to
+    document the software.  Dashes in these comment blocks are used to create bullet lists.
+    The lack of blank lines after a block of dash preceeded comments means that the next
+    block of dash preceeded comments is a new, indented bullet list.  I've tried to keep the
+    Doxygen formatting to a minimum but there are some other items (like <br> and <pre>)
+    that need to be left alone.  If you see a comment that starts with / * ! or / / ! and
+    there is something that looks a bit weird it is probably due to some arcane Doxygen
+    syntax.  Be very careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+/*  Waveform plot definitions.  The plot geometry, drawing, and attribute text are shared by the monitor display, the
+    batch render mode, and the benchmark so the rendered plots look just like the monitor and the benchmark times the
+    monitor's own drawing.  */
+
+#ifndef __WAVE_PLOT_HPP__
+#define __WAVE_PLOT_HPP__
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <sys/types.h>
+#include <cmath>
+
+#include "nvutility.h"
+#include "nvutility.hpp"
+
+#include "slas.hpp"
+#include "wave_stats.hpp"
+
+#include <QtCore>
+#include <QtGui>
+#if QT_VERSION >= 0x050000
+#include <QtWidgets>
+#endif
+
+
+#define WAVE_PLOT_LABELS          26       //!<  Number of attribute labels (the monitor's status bar fields)
+#define WAVE_PLOT_SPOT_SIZE       2
+#define WAVE_PLOT_FONT_SIZE       8
+
+
+typedef struct
+{
+  int32_t             min_x;
+  int32_t             max_x;
+  int32_t             min_y;
+  int32_t             max_y;
+  int32_t             range_x;
+  int32_t             range_y;
+  int32_t             length;          //  Number of samples in the displayed window
+  int32_t             height;
+  int32_t             first;           //  First sample in the displayed window
+  int32_t             total;           //  Number of samples in the whole waveform
+  uint32_t            temporal_spacing;
+  uint32_t            buffer_size;
+} BOUNDS;
+
+
+typedef struct
+{
+  QColor              wave_color;
+  QColor              primary_color;   //  Return point marker
+  QColor              background_color;
+  uint8_t             wave_line_mode;  //  NVTrue for lines, NVFalse for dots
+} WAVE_PLOT_STYLE;
+
+
+/*!  Where the plot is drawn.  The monitor (and the benchmark) draw on the nvMap, the render mode draws on a QPainter
+     (the plot is drawn from 0,0 so translate the painter to put it somewhere else).  */
+
+typedef struct
+{
+  nvMap               *map;            //  Draw on this map if it isn't NULL...
+  QPainter            *painter;        //  ...otherwise draw with this painter
+  int32_t             draw_width;
+  int32_t             draw_height;
+} WAVE_PLOT_CANVAS;
+
+
+void wave_plot_bounds (const SLAS_WAVEFORM_PACKET_DESCRIPTOR *desc, int32_t zoom_first, int32_t zoom_count, BOUNDS *bounds);
+void wave_plot_scale (int32_t x, int32_t y, int32_t *new_x, int32_t *new_y, int32_t draw_width, int32_t draw_height, const BOUNDS *bounds);
+void wave_plot_draw_axes (const WAVE_PLOT_CANVAS *canvas, const BOUNDS *bounds);
+void wave_plot_draw_wave (const WAVE_PLOT_CANVAS *canvas, const BOUNDS *bounds, const SLAS_SAMPLES &samples, float return_point_waveform_location,
+                          const WAVE_STATS *stats, uint8_t draw_trace, const WAVE_PLOT_STYLE *style);
+void wave_plot_draw (const WAVE_PLOT_CANVAS *canvas, const BOUNDS *bounds, const SLAS_SAMPLES &samples, float return_point_waveform_location,
+                     const WAVE_STATS *stats, const WAVE_PLOT_STYLE *style);
+void wave_plot_labels (const SLAS_HEADER *lasheader, const SLAS_POINT_DATA *slas, double gps_start_time, QString *labels);
+
+
+#endif
@@ -0,0 +1,296 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! or / / ! are being used by Doxygen to
+    document the software.  Dashes in these comment blocks are used to create bullet lists.
+    The lack of blank lines after a block of dash preceeded comments means that the next
+    block of dash preceeded comments is a new, indented bullet list.  I've tried to keep the
+    Doxygen formatting to a minimum but there are some other items (like <br> and <pre>)
+    that need to be left alone.  If you see a comment that starts with / * ! or / / ! and
+    there is something that looks a bit weird it is probably due to some arcane Doxygen
+    syntax.  Be very careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+#include "wave_stats.hpp"
+
+
+
+//  Mean and standard deviation of n samples.
+
+template <typename T> static void stats_window (const T *samples, uint32_t n, double *mean, double *sigma)
+{
+  double sum = 0.0, sum2 = 0.0;
+
+  for (uint32_t i = 0 ; i < n ; i++)
+    {
+      double value = (double) samples[i];
+
+      sum += value;
+      sum2 += value * value;
+    }
+
+  *mean = sum / (double) n;
+  *sigma = sqrt (std::max (0.0, sum2 / (double) n - *mean * *mean));
+}
+
+
+
+/*  The passes over the whole waveform work on WAVE_STATS_CHUNK samples at a time.  With a fixed trip count, no branches,
+    and the reductions kept in the storage type (or just wider for sums), the compiler vectorizes the inner loops at -O2
+    (16 or 32 8 bit samples per instruction with SSE2 or AVX2) without any intrinsics.  Everything else only looks at
+    the ends of the waveform or the samples around the peak.  */
+
+template <typename T> struct STATS_SUM {typedef uint32_t type;};
+template <> struct STATS_SUM<uint32_t> {typedef uint64_t type;};
+
+
+//  Largest value in a chunk.
+
+template <typename T> static inline T stats_chunk_max (const T *samples)
+{
+  T peak = 0;
+
+  for (int32_t i = 0 ; i < WAVE_STATS_CHUNK ; i++) peak = samples[i] > peak ? samples[i] : peak;
+
+  return (peak);
+}
+
+
+//  Sum and count of the samples above gate in a chunk.
+
+template <typename T> static inline void stats_chunk_gated (const T *samples, T gate, uint64_t *sum, uint64_t *above)
+{
+  typename STATS_SUM<T>::type chunk_sum = 0, chunk_above = 0;
+
+  for (int32_t i = 0 ; i < WAVE_STATS_CHUNK ; i++)
+    {
+      typename STATS_SUM<T>::type over = samples[i] > gate;
+
+      chunk_sum += over * samples[i];
+      chunk_above += over;
+    }
+
+  *sum += chunk_sum;
+  *above += chunk_above;
+}
+
+
+typedef struct
+{
+  WAVE_STATS                  *stats;
+
+  template <typename T> void run (const T *samples, uint32_t count)
+  {
+    uint32_t chunks = count / WAVE_STATS_CHUNK, tail = chunks * WAVE_STATS_CHUNK;
+
+
+    //  Baseline and noise from the quieter end.
+
+    uint32_t n = std::max (1U, std::min ((uint32_t) WAVE_STATS_BASELINE_SAMPLES, count / 4));
+    double head_mean, head_sigma, tail_mean, tail_sigma;
+
+    stats_window (samples, n, &head_mean, &head_sigma);
+    stats_window (samples + count - n, n, &tail_mean, &tail_sigma);
+
+    if (tail_mean < head_mean)
+      {
+        stats->baseline = tail_mean;
+        stats->noise = tail_sigma;
+      }
+    else
+      {
+        stats->baseline = head_mean;
+        stats->noise = head_sigma;
+      }
+
+
+    //  Peak value (and the first chunk it's in so we don't have to search the whole waveform for it).
+
+    T peak = 0;
+    uint32_t peak_start = 0;
+
+    for (uint32_t c = 0 ; c < chunks ; c++)
+      {
+        T chunk_peak = stats_chunk_max (samples + c * WAVE_STATS_CHUNK);
+
+        if (chunk_peak > peak)
+          {
+            peak = chunk_peak;
+            peak_start = c * WAVE_STATS_CHUNK;
+          }
+      }
+
+    for (uint32_t i = tail ; i < count ; i++)
+      {
+        if (samples[i] > peak)
+          {
+            peak = samples[i];
+            peak_start = i;
+          }
+      }
+
+
+    //  Energy is the sum of (sample - baseline) for the samples more than WAVE_STATS_NOISE_GATE times the noise above
+    //  the baseline (so the noise doesn't add up over long waveforms).
+
+    double gate = std::min ((double) stats->max_value, floor (stats->baseline + WAVE_STATS_NOISE_GATE * stats->noise));
+    T int_gate = (T) std::max (0.0, gate);
+    uint64_t sum = 0, above = 0;
+
+    for (uint32_t c = 0 ; c < chunks ; c++) stats_chunk_gated (samples + c * WAVE_STATS_CHUNK, int_gate, &sum, &above);
+
+    for (uint32_t i = tail ; i < count ; i++)
+      {
+        if (samples[i] > int_gate)
+          {
+            sum += samples[i];
+            above++;
+          }
+      }
+
+    stats->energy = (double) sum - stats->baseline * (double) above;
+
+
+    //  First and last of the run of peak samples.
+
+    uint32_t first = peak_start;
+
+    while (samples[first] != peak) first++;
+
+    uint32_t last = first;
+
+    while (last + 1 < count && samples[last + 1] == peak) last++;
+
+
+    stats->peak_value = peak;
+    stats->peak_sample = first;
+
+
+    //  Saturated samples (there can't be any unless the peak is at full scale).
+
+    if (peak == (T) stats->max_value)
+      {
+        for (uint32_t i = first ; i < count ; i++) stats->saturated += (samples[i] == peak);
+      }
+
+
+    //  Sub-sample peak.  A flat top (or a peak at the end) can't be fitted so we use the middle of the run.
+
+    double a = first ? (double) samples[first - 1] : 0.0, b = (double) peak, c = last + 1 < count ? (double) samples[last + 1] : 0.0;
+    double denom = a - 2.0 * b + c;
+
+    if (last == first && first && first + 1 < count && denom < 0.0)
+      {
+        double delta = 0.5 * (a - c) / denom;
+
+        stats->peak_location = (double) first + delta;
+        stats->peak_amplitude = b - 0.25 * (a - c) * delta - stats->baseline;
+      }
+    else
+      {
+        stats->peak_location = 0.5 * (double) (first + last);
+        stats->peak_amplitude = b - stats->baseline;
+      }
+
+
+    //  Full width at half maximum of the pulse around the peak.  If the pulse runs off the end of the waveform the
+    //  width stops at the end.
+
+    if (stats->peak_amplitude <= 0.0)
+      {
+        stats->half_start = stats->half_end = stats->peak_location;
+        stats->fwhm = 0.0;
+        stats->snr = 0.0;
+        return;
+      }
+
+    double half = stats->baseline + 0.5 * stats->peak_amplitude;
+    uint32_t left = first, right = last;
+
+    while (left && (double) samples[left - 1] > half) left--;
+
+    while (right + 1 < count && (double) samples[right + 1] > half) right++;
+
+    stats->half_start = (double) left;
+
+    if (left) stats->half_start -= (samples[left] - half) / ((double) samples[left] - (double) samples[left - 1]);
+
+    stats->half_end = (double) right;
+
+    if (right + 1 < count) stats->half_end += (samples[right] - half) / ((double) samples[right] - (double) samples[right + 1]);
+
+    stats->fwhm = stats->half_end - stats->half_start;
+
+    stats->snr = stats->noise > 0.0 ? stats->peak_amplitude / stats->noise : 0.0;
+  }
+} WAVE_STATS_KERNEL;
+
+
+
+/********************************************************************************************/
+/*!
+
+ - Function:    wave_stats_compute
+
+ - Purpose:     Compute the baseline, noise, sub-sample peak, pulse width (FWHM),
+                energy, and saturation of a waveform (see WAVE_STATS).  This is
+                quick enough (a few microseconds for a few thousand samples) to
+                run on every waveform the monitor displays.
+
+ - Author:      PFM Software
+
+ - Date:        10/19/26
+
+ - Arguments:
+                - samples        =    The waveform samples
+                - bits_per_sample =   From the waveform packet descriptor (0 is
+                                      treated as 8)
+                - stats          =    Returned analytics
+
+ - Returns:     N/A
+
+*********************************************************************************************/
+
+void wave_stats_compute (const SLAS_SAMPLES &samples, int32_t bits_per_sample, WAVE_STATS *stats)
+{
+  int32_t bits = bits_per_sample > 0 ? std::min (bits_per_sample, 32) : 8;
+
+  memset (stats, 0, sizeof (WAVE_STATS));
+
+  stats->count = samples.size ();
+  stats->max_value = (uint32_t) ((1ULL << bits) - 1);
+
+  if (stats->count < WAVE_STATS_MIN_SAMPLES) return;
+
+
+  WAVE_STATS_KERNEL kernel;
+  kernel.stats = stats;
+
+  slas_dispatch_samples (samples, kernel);
+
+  stats->valid = 1;
+}
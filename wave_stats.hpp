@@ -0,0 +1,94 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! or / / ! are being used by Doxygen to
+    document the software.  Dashes in these comment blocks are used to create bullet lists.
+    The lack of blank lines after a block of dash preceeded comments means that the next
+    block of dash preceeded comments is a new, indented bullet list.  I've tried to keep the
+    Doxygen formatting to a minimum but there are some other items (like <br> and <pre>)
+    that need to be left alone.  If you see a comment that starts with / * ! or / / ! and
+    there is something that looks a bit weird it is probably due to some arcane Doxygen
+    syntax.  Be very careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+/*  Waveform analytics definitions.  */
+
+#ifndef __WAVE_STATS_HPP__
+#define __WAVE_STATS_HPP__
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <sys/types.h>
+#include <cmath>
+#include <string.h>
+
+#include <algorithm>
+
+#include "slas_samples.hpp"
+
+
+#define WAVE_STATS_BASELINE_SAMPLES     32       //!<  Samples at each end of the waveform used to find the baseline
+#define WAVE_STATS_MIN_SAMPLES          3        //!<  Fewer samples than this aren't analyzed
+#define WAVE_STATS_NOISE_GATE           3.0      //!<  Samples more than this many times the noise above the baseline are energy
+#define WAVE_STATS_CHUNK                64       //!<  Samples per vectorized step
+
+
+/*!  Analytics computed from the samples of one waveform.  Sample positions are from the first sample that was analyzed
+     (the monitor always analyzes the whole waveform, not the zoom window) and amplitudes are in counts.  The baseline is the mean of
+     whichever end of the waveform is lower (the part before the first return or after the last one) and the noise is
+     the standard deviation of that end.  The peak location and amplitude come from a parabola through the largest
+     sample and its neighbors (or the middle of the run of largest samples if the top is flat, as it is when the
+     digitizer saturates).  The full width at half maximum is measured between the linearly interpolated points where
+     the pulse around the peak crosses halfway between the baseline and the peak.  The energy is the sum of the samples
+     above the baseline over the whole waveform, counting only the samples that are more than WAVE_STATS_NOISE_GATE
+     times the noise above the baseline.  */
+
+typedef struct
+{
+  uint8_t                     valid;          //!<  0 if there were fewer than WAVE_STATS_MIN_SAMPLES samples
+  uint32_t                    count;          //!<  Number of samples analyzed
+  double                      baseline;
+  double                      noise;
+  uint32_t                    peak_value;     //!<  Largest sample
+  uint32_t                    peak_sample;    //!<  First sample with the largest value
+  double                      peak_location;  //!<  Sub-sample peak location
+  double                      peak_amplitude; //!<  Interpolated peak above the baseline
+  double                      half_start;     //!<  Sub-sample half maximum crossings on either side of the peak
+  double                      half_end;
+  double                      fwhm;           //!<  half_end - half_start (samples)
+  double                      energy;         //!<  Counts above the baseline times samples (gated, see above)
+  double                      snr;            //!<  Peak amplitude over the noise (0 if there's no noise)
+  uint32_t                    max_value;      //!<  2^bits_per_sample - 1
+  uint32_t                    saturated;      //!<  Number of samples at max_value
+} WAVE_STATS;
+
+
+void wave_stats_compute (const SLAS_SAMPLES &samples, int32_t bits_per_sample, WAVE_STATS *stats);
+
+
+#endif